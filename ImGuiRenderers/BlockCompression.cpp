@@ -0,0 +1,139 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+
+// Values of the palette of a block, as the GPU decodes them
+static void get_palette(u8 red0, u8 red1, u8* palette)
+{
+	palette[0] = red0;
+	palette[1] = red1;
+
+	if (red0 > red1)
+	{
+		for (u32 i = 1; i < 7; i++)
+		{
+			palette[i + 1] = (u8)(((7 - i) * red0 + i * red1 + 3) / 7);
+		}
+	}
+	else
+	{
+		for (u32 i = 1; i < 5; i++)
+		{
+			palette[i + 1] = (u8)(((5 - i) * red0 + i * red1 + 2) / 5);
+		}
+
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+// Picks the closest value of the palette for each pixel and returns the squared error of the block
+static u32 encode_block(u8 red0, u8 red1, const u8* pixels, u64* indices)
+{
+	u8 palette[8];
+	get_palette(red0, red1, palette);
+
+	u32 error = 0;
+	*indices = 0;
+
+	for (u32 i = 0; i < 16; i++)
+	{
+		u32 best_index = 0;
+		u32 best_error = 0xFFFFFFFF;
+
+		for (u32 j = 0; j < 8; j++)
+		{
+			s32 difference = (s32)pixels[i] - (s32)palette[j];
+			u32 pixel_error = (u32)(difference * difference);
+
+			if (pixel_error < best_error)
+			{
+				best_error = pixel_error;
+				best_index = j;
+			}
+		}
+
+		error += best_error;
+		*indices |= (u64)best_index << (i * 3);
+	}
+
+	return error;
+}
+
+void compress_bc4(u8* blocks, const u8* pixels, u32 width, u32 height)
+{
+	for (u32 block_y = 0; block_y < height; block_y += 4)
+	{
+		for (u32 block_x = 0; block_x < width; block_x += 4)
+		{
+			// Partial blocks repeat their last row and column
+			u8 block[16];
+			u8 minimum = 255, maximum = 0;
+			u8 inner_minimum = 255, inner_maximum = 0;
+
+			for (u32 y = 0; y < 4; y++)
+			{
+				for (u32 x = 0; x < 4; x++)
+				{
+					u8 value = pixels[(size_t)std::min(block_y + y, height - 1) * width + std::min(block_x + x, width - 1)];
+					block[y * 4 + x] = value;
+					minimum = std::min(minimum, value);
+					maximum = std::max(maximum, value);
+
+					if (value != 0 && value != 255)
+					{
+						inner_minimum = std::min(inner_minimum, value);
+						inner_maximum = std::max(inner_maximum, value);
+					}
+				}
+			}
+
+			u8 red0, red1;
+			u64 indices;
+
+			if (minimum == maximum)
+			{
+				red0 = red1 = minimum;
+				indices = 0;
+			}
+			else
+			{
+				// 8 values between the extremes of the block
+				u64 interpolated_indices;
+				u32 interpolated_error = encode_block(maximum, minimum, block, &interpolated_indices);
+
+				// 6 values between the extremes of the pixels, which are neither 0 nor 255
+				if (inner_minimum > inner_maximum)
+				{
+					inner_minimum = inner_maximum = 0;
+				}
+
+				u64 explicit_indices;
+				u32 explicit_error = encode_block(inner_minimum, inner_maximum, block, &explicit_indices);
+
+				if (interpolated_error <= explicit_error)
+				{
+					red0 = maximum;
+					red1 = minimum;
+					indices = interpolated_indices;
+				}
+				else
+				{
+					red0 = inner_minimum;
+					red1 = inner_maximum;
+					indices = explicit_indices;
+				}
+			}
+
+			blocks[0] = red0;
+			blocks[1] = red1;
+
+			for (u32 i = 0; i < 6; i++)
+			{
+				blocks[2 + i] = (u8)(indices >> (i * 8));
+			}
+
+			blocks += bc4_block_size;
+		}
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// Bytes of a BC4 block, which holds 4x4 pixels of a single channel
+const u32 bc4_block_size = 8;
+
+// Size of the BC4 blocks of an image, whose partial blocks at the right and bottom edges are padded
+inline u64 get_bc4_size(u32 width, u32 height) { return (u64)((width + 3) / 4) * ((height + 3) / 4) * bc4_block_size; }
+
+// Compresses a single channel image, like the alpha of the font atlas, into BC4 blocks row by row. Each block is
+// encoded with both the 8 value and the 6 value palette, whose explicit 0 and 255 suit glyph edges, keeping the one
+// with the smaller error. The blocks have to hold get_bc4_size bytes.
+void compress_bc4(u8* blocks, const u8* pixels, u32 width, u32 height);
@@ -0,0 +1,129 @@
+#include "DistanceField.h"
+
+#include <algorithm>
+#include <vector>
+#include <math.h>
+
+// Squared distances larger than any in the atlas
+static const float infinite_distance = 1e20f;
+
+// Lower envelope of the parabolas rooted at the samples, which gives the squared distance to the closest sample
+// (Felzenszwalb and Huttenlocher). The buffers have to hold the count of samples, and one more for the boundaries.
+static void transform_line(float* distances, u32 count, u32 stride, float* line, s32* roots, float* boundaries)
+{
+	for (u32 i = 0; i < count; i++)
+	{
+		line[i] = distances[i * stride];
+	}
+
+	s32 parabola = 0;
+	roots[0] = 0;
+	boundaries[0] = -infinite_distance;
+	boundaries[1] = infinite_distance;
+
+	for (s32 q = 1; q < (s32)count; q++)
+	{
+		float intersection;
+
+		while (true)
+		{
+			s32 root = roots[parabola];
+			intersection = ((line[q] + q * q) - (line[root] + root * root)) / (2.0f * (q - root));
+
+			if (intersection > boundaries[parabola] || parabola == 0)
+			{
+				break;
+			}
+
+			parabola--;
+		}
+
+		// The new parabola is below the whole envelope, so it replaces the first one
+		if (intersection <= boundaries[parabola])
+		{
+			roots[0] = q;
+			boundaries[0] = -infinite_distance;
+			boundaries[1] = infinite_distance;
+			parabola = 0;
+			continue;
+		}
+
+		parabola++;
+		roots[parabola] = q;
+		boundaries[parabola] = intersection;
+		boundaries[parabola + 1] = infinite_distance;
+	}
+
+	parabola = 0;
+
+	for (s32 q = 0; q < (s32)count; q++)
+	{
+		while (boundaries[parabola + 1] < q)
+		{
+			parabola++;
+		}
+
+		s32 root = roots[parabola];
+		distances[q * stride] = (q - root) * (q - root) + line[root];
+	}
+}
+
+// Squared distances to the closest pixel, for which the mask is set, separably in x and then in y
+static void transform(std::vector<float>& distances, u32 width, u32 height)
+{
+	u32 size = std::max(width, height);
+	std::vector<float> line(size);
+	std::vector<s32> roots(size);
+	std::vector<float> boundaries(size + 1);
+
+	for (u32 y = 0; y < height; y++)
+	{
+		transform_line(distances.data() + y * width, width, 1, line.data(), roots.data(), boundaries.data());
+	}
+
+	for (u32 x = 0; x < width; x++)
+	{
+		transform_line(distances.data() + x, height, width, line.data(), roots.data(), boundaries.data());
+	}
+}
+
+void build_distance_field(u8* field, const u8* coverage, u32 width, u32 height, u32 spread)
+{
+	u32 count = width * height;
+	std::vector<float> outside(count);
+	std::vector<float> inside(count);
+
+	// Pixels, which are at least half covered, are inside
+	for (u32 i = 0; i < count; i++)
+	{
+		outside[i] = coverage[i] >= 128 ? 0.0f : infinite_distance;
+		inside[i] = coverage[i] >= 128 ? infinite_distance : 0.0f;
+	}
+
+	transform(outside, width, height);
+	transform(inside, width, height);
+
+	const float scale = 0.5f / std::max(spread, 1u);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		// The edge lies halfway between the centres of an inside and an outside pixel, or within a partially covered pixel
+		float distance;
+
+		if (coverage[i] > 0 && coverage[i] < 255)
+		{
+			distance = 0.5f - coverage[i] / 255.0f;
+		}
+		else if (coverage[i] >= 128)
+		{
+			distance = 0.5f - sqrtf(inside[i]);
+		}
+		else
+		{
+			distance = sqrtf(outside[i]) - 0.5f;
+		}
+
+		float value = std::min(std::max(0.5f - distance * scale, 0.0f), 1.0f);
+		field[i] = (u8)(value * 255.0f + 0.5f);
+	}
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// Converts coverage, like the alpha of the font atlas, into a signed distance field of the same size. 128 is on the
+// edges, the values fall off to 0 outside and rise to 255 inside over spread pixels. Pixels, which are partially
+// covered, place the edge within them by their coverage, so anti-aliased glyphs keep their sub-pixel edges.
+// Neighbouring glyphs have to be at least spread pixels apart, or their fields overlap.
+void build_distance_field(u8* field, const u8* coverage, u32 width, u32 height, u32 spread);
@@ -0,0 +1,739 @@
+#include "DrawDataCapture.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef IMGUI_RENDERERS_USE_LZ4
+#include "lz4.h"
+#endif
+
+// Draw commands are captured without their callbacks, which can't be replayed
+struct CapturedCommand
+{
+	float clip_rect[4];
+	u64 texture;
+	u32 element_count;
+	u32 reserved; // 0, pads the command to the alignment of the texture
+};
+
+// Modes of the streams of a draw list
+enum CaptureStreamMode : u8
+{
+	STREAM_UNCHANGED,
+	STREAM_RAW,
+	STREAM_DELTA,
+};
+
+// Unchanged runs shorter than this are cheaper to store as part of the changed bytes around them
+const u32 minimum_unchanged_run = 8;
+
+template<typename T> static void write_value(std::vector<u8>& buffer, const T& value)
+{
+	const u8* bytes = (const u8*)&value;
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T> static bool read_value(const u8*& data, const u8* end, T* value)
+{
+	if ((u64)(end - data) < sizeof(T))
+	{
+		return false;
+	}
+
+	memcpy(value, data, sizeof(T));
+	data += sizeof(T);
+	return true;
+}
+
+const u8* compress_chunk(ImGuiCaptureChunk& chunk, u32 type, u32 flags, const std::vector<u8>& payload, bool compress, std::vector<u8>& compressed)
+{
+	chunk = ImGuiCaptureChunk();
+	chunk.type = type;
+	chunk.flags = flags;
+	chunk.size = (u32)payload.size();
+	chunk.stored_size = (u32)payload.size();
+
+#ifdef IMGUI_RENDERERS_USE_LZ4
+	// Chunks, which don't get smaller, are stored uncompressed
+	if (compress && !payload.empty())
+	{
+		compressed.resize(LZ4_compressBound((int)payload.size()));
+		int compressed_size = LZ4_compress_default((const char*)payload.data(), (char*)compressed.data(), (int)payload.size(), (int)compressed.size());
+
+		if (compressed_size > 0 && (u32)compressed_size < chunk.size)
+		{
+			chunk.flags |= CAPTURE_CHUNK_COMPRESSED;
+			chunk.stored_size = compressed_size;
+			return compressed.data();
+		}
+	}
+#else
+	(void)compress;
+	(void)compressed;
+#endif
+
+	return payload.data();
+}
+
+const u8* decompress_chunk(const ImGuiCaptureChunk& chunk, const u8* stored, std::vector<u8>& decompressed)
+{
+	if (!(chunk.flags & CAPTURE_CHUNK_COMPRESSED))
+	{
+		return chunk.size == chunk.stored_size ? stored : nullptr;
+	}
+
+#ifdef IMGUI_RENDERERS_USE_LZ4
+	// LZ4 takes the sizes as int, and the size comes from the file or the stream before anything checked it
+	if (chunk.size > INT_MAX || chunk.stored_size > INT_MAX)
+	{
+		return nullptr;
+	}
+
+	decompressed.resize(chunk.size);
+
+	if (LZ4_decompress_safe((const char*)stored, (char*)decompressed.data(), (int)chunk.stored_size, (int)chunk.size) != (int)chunk.size)
+	{
+		return nullptr;
+	}
+
+	return decompressed.data();
+#else
+	(void)decompressed;
+	log(ERROR, "The draw data is compressed, which needs IMGUI_RENDERERS_USE_LZ4.");
+	return nullptr;
+#endif
+}
+
+bool fits_rgba_pixels(u32 width, u32 height, u64 size)
+{
+	return width && height && height <= size / 4 / width;
+}
+
+void ImGuiDrawDataEncoder::encode_font(ImFontAtlas* font_atlas, std::vector<u8>& payload)
+{
+	u8* pixels;
+	s32 width, height;
+	font_atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+	payload.clear();
+	write_value(payload, (u32)width);
+	write_value(payload, (u32)height);
+	payload.insert(payload.end(), pixels, pixels + (u64)width * height * 4);
+}
+
+void ImGuiDrawDataEncoder::encode_frame(ImDrawData* draw_data, bool keyframe, std::vector<u8>& payload)
+{
+	ImGuiIO& io = ImGui::GetIO();
+
+	payload.clear();
+	write_value(payload, io.DisplaySize.x);
+	write_value(payload, io.DisplaySize.y);
+	write_value(payload, io.DisplayFramebufferScale.x);
+	write_value(payload, io.DisplayFramebufferScale.y);
+	write_value(payload, (u32)draw_data->CmdListsCount);
+
+	// Draw lists, which no longer exist, are forgotten like in the decoder, or the deltas of the ones taking their place later would differ
+	previous.resize(draw_data->CmdListsCount);
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+
+		commands.resize(draw_list->CmdBuffer.size() * sizeof(CapturedCommand));
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			const ImDrawCmd& draw_cmd = draw_list->CmdBuffer[j];
+
+			CapturedCommand command;
+			memset(&command, 0, sizeof(command));
+			command.clip_rect[0] = draw_cmd.ClipRect.x;
+			command.clip_rect[1] = draw_cmd.ClipRect.y;
+			command.clip_rect[2] = draw_cmd.ClipRect.z;
+			command.clip_rect[3] = draw_cmd.ClipRect.w;
+			command.texture = draw_cmd.TextureId == io.Fonts->TexID ? 0 : (u64)(uintptr_t)draw_cmd.TextureId;
+			command.element_count = draw_cmd.ElemCount;
+
+			memcpy(&commands[j * sizeof(CapturedCommand)], &command, sizeof(command));
+		}
+
+		u64 vertex_bytes = draw_list->VtxBuffer.size() * sizeof(ImDrawVert);
+		u64 index_bytes = draw_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+
+		write_value(payload, (u32)draw_list->VtxBuffer.size());
+		write_value(payload, (u32)draw_list->IdxBuffer.size());
+		write_value(payload, (u32)draw_list->CmdBuffer.size());
+
+		write_stream(payload, vertex_bytes ? (const u8*)&draw_list->VtxBuffer.front() : nullptr, vertex_bytes, previous[i].vertices, keyframe);
+		write_stream(payload, index_bytes ? (const u8*)&draw_list->IdxBuffer.front() : nullptr, index_bytes, previous[i].indices, keyframe);
+		write_stream(payload, commands.data(), commands.size(), previous[i].commands, keyframe);
+
+		captured_bytes += vertex_bytes + index_bytes + commands.size();
+	}
+}
+
+void ImGuiDrawDataEncoder::write_stream(std::vector<u8>& payload, const u8* data, u64 size, std::vector<u8>& previous_stream, bool keyframe)
+{
+	bool same_size = !keyframe && previous_stream.size() == size;
+
+	if (same_size && (size == 0 || memcmp(data, previous_stream.data(), size) == 0))
+	{
+		payload.push_back(STREAM_UNCHANGED);
+		return;
+	}
+
+	if (same_size)
+	{
+		u64 start = payload.size();
+		payload.push_back(STREAM_DELTA);
+		write_value(payload, (u32)0);
+
+		const u8* reference = previous_stream.data();
+		u64 i = 0;
+
+		// Pairs of unchanged and changed runs, the changed bytes are XORed with the previous frame
+		while (i < size)
+		{
+			u64 unchanged_start = i;
+
+			while (i < size && data[i] == reference[i])
+			{
+				i++;
+			}
+
+			u64 changed_start = i;
+			u64 changed_end = i;
+			u32 unchanged = 0;
+
+			while (i < size)
+			{
+				if (data[i] == reference[i])
+				{
+					if (++unchanged == minimum_unchanged_run)
+					{
+						break;
+					}
+				}
+				else
+				{
+					unchanged = 0;
+					changed_end = i + 1;
+				}
+
+				i++;
+			}
+
+			i = changed_end;
+
+			write_value(payload, (u32)(changed_start - unchanged_start));
+			write_value(payload, (u32)(changed_end - changed_start));
+
+			for (u64 j = changed_start; j < changed_end; j++)
+			{
+				payload.push_back(data[j] ^ reference[j]);
+			}
+
+			// Deltas, which are larger than the data, are stored raw
+			if (payload.size() - start > size)
+			{
+				break;
+			}
+		}
+
+		u32 delta_size = (u32)(payload.size() - start - 1 - sizeof(u32));
+
+		if (delta_size < size)
+		{
+			memcpy(&payload[start + 1], &delta_size, sizeof(delta_size));
+			previous_stream.assign(data, data + size);
+			return;
+		}
+
+		payload.resize(start);
+	}
+
+	payload.push_back(STREAM_RAW);
+	payload.insert(payload.end(), data, data + size);
+	previous_stream.assign(data, data + size);
+}
+
+ImGuiDrawDataWriter::~ImGuiDrawDataWriter()
+{
+	close();
+}
+
+bool ImGuiDrawDataWriter::open(const std::string& file_name, ImFontAtlas* font_atlas, bool compress)
+{
+	close();
+
+#ifndef IMGUI_RENDERERS_USE_LZ4
+	if (compress)
+	{
+		log(WARNING, "Captures can't be compressed without IMGUI_RENDERERS_USE_LZ4, the capture is stored uncompressed.");
+		compress = false;
+	}
+#endif
+
+	this->compress = compress;
+	frame_count = 0;
+	captured_bytes = 0;
+	written_bytes = 0;
+	encoder.reset();
+	encoder.captured_bytes = 0;
+
+	file = fopen(file_name.c_str(), "wb");
+
+	if (!file)
+	{
+		log(ERROR, "Failed to create capture file %s.", file_name.c_str());
+		return false;
+	}
+
+	ImGuiCaptureHeader header = {};
+	memcpy(header.magic, "IMDC", 4);
+	header.version = capture_version;
+	header.vertex_size = sizeof(ImDrawVert);
+	header.index_size = sizeof(ImDrawIdx);
+	header.keyframe_interval = keyframe_interval;
+
+	if (fwrite(&header, sizeof(header), 1, file) != 1)
+	{
+		log(ERROR, "Failed to write the capture header.");
+		close();
+		return false;
+	}
+
+	written_bytes += sizeof(header);
+
+	// The font atlas
+	ImGuiDrawDataEncoder::encode_font(font_atlas, payload);
+
+	if (!write_chunk(CAPTURE_CHUNK_FONT, 0, payload))
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiDrawDataWriter::write_frame(ImDrawData* draw_data)
+{
+	if (!file)
+	{
+		return false;
+	}
+
+	bool keyframe = keyframe_interval == 0 || frame_count % keyframe_interval == 0;
+
+	encoder.encode_frame(draw_data, keyframe, payload);
+	captured_bytes = encoder.captured_bytes;
+
+	if (!write_chunk(CAPTURE_CHUNK_FRAME, keyframe ? (u32)CAPTURE_CHUNK_KEYFRAME : 0, payload))
+	{
+		close();
+		return false;
+	}
+
+	frame_count++;
+
+	return true;
+}
+
+void ImGuiDrawDataWriter::close()
+{
+	if (file)
+	{
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+bool ImGuiDrawDataWriter::write_chunk(u32 type, u32 flags, const std::vector<u8>& data)
+{
+	ImGuiCaptureChunk chunk;
+	const u8* stored = compress_chunk(chunk, type, flags, data, compress, compressed);
+
+	if (fwrite(&chunk, sizeof(chunk), 1, file) != 1 || (chunk.stored_size && fwrite(stored, chunk.stored_size, 1, file) != 1))
+	{
+		log(ERROR, "Failed to write into the capture file.");
+		return false;
+	}
+
+	written_bytes += sizeof(chunk) + chunk.stored_size;
+
+	return true;
+}
+
+ImGuiDrawDataDecoder::~ImGuiDrawDataDecoder()
+{
+	reset();
+}
+
+bool ImGuiDrawDataDecoder::decode_font(const u8* data, u64 size, ImFontAtlas* font_atlas)
+{
+	const u8* end = data + size;
+	u32 width, height;
+
+	if (!read_value(data, end, &width) || !read_value(data, end, &height) || !fits_rgba_pixels(width, height, end - data))
+	{
+		log(ERROR, "The font atlas of the draw data is invalid.");
+		return false;
+	}
+
+	// The atlas takes ownership of the pixels and frees them with ImGui's allocator
+	font_atlas->ClearTexData();
+	font_atlas->TexPixelsRGBA32 = (unsigned int*)ImGui::MemAlloc((size_t)width * height * 4);
+	font_atlas->TexWidth = width;
+	font_atlas->TexHeight = height;
+	memcpy(font_atlas->TexPixelsRGBA32, data, (size_t)width * height * 4);
+
+	// The renderers bake single channel atlases from the alpha, which ImGui would otherwise build again from the fonts
+	font_atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc((size_t)width * height);
+
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		font_atlas->TexPixelsAlpha8[i] = data[i * 4 + 3];
+	}
+
+	return true;
+}
+
+bool ImGuiDrawDataDecoder::decode_frame(const u8* data, u64 size, bool keyframe)
+{
+	const u8* end = data + size;
+	ImVec2 display_size, framebuffer_scale;
+	u32 list_count;
+
+	if (!read_value(data, end, &display_size.x) || !read_value(data, end, &display_size.y) ||
+		!read_value(data, end, &framebuffer_scale.x) || !read_value(data, end, &framebuffer_scale.y) ||
+		!read_value(data, end, &list_count))
+	{
+		return false;
+	}
+
+	// Keyframes don't refer to earlier frames
+	if (keyframe)
+	{
+		streams.clear();
+	}
+
+	// Each list takes at least its three counts and the modes of its streams, so a count the frame can't hold is
+	// rejected before the lists are allocated
+	const u64 minimum_list_size = 3 * sizeof(u32) + 3 * sizeof(u8);
+
+	if (list_count > (u64)(end - data) / minimum_list_size)
+	{
+		return false;
+	}
+
+	streams.resize(list_count);
+
+	for (u32 i = 0; i < list_count; i++)
+	{
+		u32 vertex_count, index_count, command_count;
+
+		if (!read_value(data, end, &vertex_count) || !read_value(data, end, &index_count) || !read_value(data, end, &command_count) ||
+			!read_stream(data, end, streams[i].vertices, (u64)vertex_count * sizeof(ImDrawVert)) ||
+			!read_stream(data, end, streams[i].indices, (u64)index_count * sizeof(ImDrawIdx)) ||
+			!read_stream(data, end, streams[i].commands, (u64)command_count * sizeof(CapturedCommand)))
+		{
+			return false;
+		}
+	}
+
+	// The frame is rendered with the display it was encoded with
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = display_size;
+	io.DisplayFramebufferScale = framebuffer_scale;
+
+	return true;
+}
+
+ImDrawData* ImGuiDrawDataDecoder::get_draw_data(ImGuiDrawDataTextureLookup lookup, void* user_data)
+{
+	ImTextureID font_texture = ImGui::GetIO().Fonts->TexID;
+
+	draw_data.Valid = true;
+	draw_data.CmdListsCount = (s32)streams.size();
+	draw_data.TotalVtxCount = 0;
+	draw_data.TotalIdxCount = 0;
+
+	while (draw_lists.size() < streams.size())
+	{
+		draw_lists.push_back(new ImDrawList());
+	}
+
+	for (u32 i = 0; i < streams.size(); i++)
+	{
+		ImDrawList* draw_list = draw_lists[i];
+		ImGuiCaptureStreams& stream = streams[i];
+
+		draw_list->VtxBuffer.resize((s32)(stream.vertices.size() / sizeof(ImDrawVert)));
+		draw_list->IdxBuffer.resize((s32)(stream.indices.size() / sizeof(ImDrawIdx)));
+		draw_list->CmdBuffer.resize((s32)(stream.commands.size() / sizeof(CapturedCommand)));
+
+		if (!stream.vertices.empty())
+		{
+			memcpy(&draw_list->VtxBuffer.front(), stream.vertices.data(), stream.vertices.size());
+		}
+
+		if (!stream.indices.empty())
+		{
+			memcpy(&draw_list->IdxBuffer.front(), stream.indices.data(), stream.indices.size());
+		}
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			CapturedCommand command;
+			memcpy(&command, &stream.commands[j * sizeof(CapturedCommand)], sizeof(command));
+
+			ImDrawCmd& draw_cmd = draw_list->CmdBuffer[j];
+			draw_cmd = ImDrawCmd();
+			draw_cmd.ClipRect = ImVec4(command.clip_rect[0], command.clip_rect[1], command.clip_rect[2], command.clip_rect[3]);
+			draw_cmd.TextureId = command.texture && lookup ? lookup(command.texture, user_data) : font_texture;
+			draw_cmd.ElemCount = command.element_count;
+			draw_cmd.UserCallback = nullptr;
+			draw_cmd.UserCallbackData = nullptr;
+		}
+
+		draw_data.TotalVtxCount += draw_list->VtxBuffer.size();
+		draw_data.TotalIdxCount += draw_list->IdxBuffer.size();
+	}
+
+	draw_data.CmdLists = draw_lists.data();
+
+	return &draw_data;
+}
+
+void ImGuiDrawDataDecoder::reset()
+{
+	for (ImDrawList* draw_list : draw_lists)
+	{
+		delete draw_list;
+	}
+
+	draw_lists.clear();
+	streams.clear();
+}
+
+bool ImGuiDrawDataDecoder::read_stream(const u8*& data, const u8* end, std::vector<u8>& stream, u64 size)
+{
+	u8 mode;
+
+	// Only a stream of the previous frame can be larger than the data left, which raw streams are copied from
+	if (!read_value(data, end, &mode) || (size > (u64)(end - data) && size != stream.size()))
+	{
+		return false;
+	}
+
+	if (mode == STREAM_UNCHANGED)
+	{
+		return stream.size() == size;
+	}
+
+	if (mode == STREAM_RAW)
+	{
+		if ((u64)(end - data) < size)
+		{
+			return false;
+		}
+
+		stream.assign(data, data + size);
+		data += size;
+		return true;
+	}
+
+	u32 delta_size;
+
+	if (mode != STREAM_DELTA || stream.size() != size || !read_value(data, end, &delta_size) || (u64)(end - data) < delta_size)
+	{
+		return false;
+	}
+
+	const u8* delta_end = data + delta_size;
+	u64 position = 0;
+
+	while (data < delta_end)
+	{
+		u32 unchanged, changed;
+
+		if (!read_value(data, delta_end, &unchanged) || !read_value(data, delta_end, &changed) ||
+			position + unchanged + changed > size || (u64)(delta_end - data) < changed)
+		{
+			return false;
+		}
+
+		position += unchanged;
+
+		for (u32 i = 0; i < changed; i++)
+		{
+			stream[position + i] ^= data[i];
+		}
+
+		position += changed;
+		data += changed;
+	}
+
+	return true;
+}
+
+ImGuiDrawDataReader::~ImGuiDrawDataReader()
+{
+	close();
+}
+
+bool ImGuiDrawDataReader::open(const std::string& file_name)
+{
+	close();
+
+	if (!file.open(file_name))
+	{
+		return false;
+	}
+
+	if (file.size() < sizeof(header))
+	{
+		log(ERROR, "Capture file %s is too small.", file_name.c_str());
+		return false;
+	}
+
+	memcpy(&header, file.data(), sizeof(header));
+
+	if (memcmp(header.magic, "IMDC", 4) != 0 || header.version != capture_version)
+	{
+		log(ERROR, "File %s isn't a supported capture.", file_name.c_str());
+		return false;
+	}
+
+	if (header.vertex_size != sizeof(ImDrawVert) || header.index_size != sizeof(ImDrawIdx))
+	{
+		log(ERROR, "Capture file %s was made with a different vertex or index type.", file_name.c_str());
+		return false;
+	}
+
+	// Find the chunks. A capture cut short by a crash is replayed up to the last complete chunk.
+	u64 offset = sizeof(header);
+
+	while (offset + sizeof(ImGuiCaptureChunk) <= file.size())
+	{
+		ImGuiCaptureChunk chunk;
+		memcpy(&chunk, file.data() + offset, sizeof(chunk));
+
+		if (offset + sizeof(chunk) + chunk.stored_size > file.size())
+		{
+			log(WARNING, "Capture file %s is truncated after %u frames.", file_name.c_str(), (u32)frames.size());
+			break;
+		}
+
+		if (chunk.type == CAPTURE_CHUNK_FONT)
+		{
+			font_offset = offset;
+		}
+		else if (chunk.type == CAPTURE_CHUNK_FRAME)
+		{
+			Frame frame;
+			frame.offset = offset;
+			frame.keyframe = (chunk.flags & CAPTURE_CHUNK_KEYFRAME) != 0;
+			frames.push_back(frame);
+		}
+
+		offset += sizeof(chunk) + chunk.stored_size;
+	}
+
+	if (!frames.empty() && !frames[0].keyframe)
+	{
+		log(ERROR, "Capture file %s doesn't start with a keyframe.", file_name.c_str());
+		frames.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void ImGuiDrawDataReader::close()
+{
+	decoder.reset();
+	frames.clear();
+	font_offset = 0;
+	current_frame = -1;
+	file.close();
+}
+
+bool ImGuiDrawDataReader::load_font_atlas(ImFontAtlas* font_atlas)
+{
+	const u8* data;
+	u64 size;
+	ImGuiCaptureChunk chunk;
+
+	if (!font_offset || !read_chunk(font_offset, &chunk, &data, &size))
+	{
+		log(ERROR, "The capture has no font atlas.");
+		return false;
+	}
+
+	return ImGuiDrawDataDecoder::decode_font(data, size, font_atlas);
+}
+
+ImDrawData* ImGuiDrawDataReader::read_frame(u32 index)
+{
+	if (index >= frames.size())
+	{
+		return nullptr;
+	}
+
+	// Deltas are relative to the previous frame, so seeking starts over from the closest keyframe
+	u32 start = index;
+
+	if (current_frame < 0 || index != current_frame + 1)
+	{
+		while (!frames[start].keyframe)
+		{
+			start--;
+		}
+	}
+
+	for (u32 i = start; i <= index; i++)
+	{
+		if (!decode_frame(i))
+		{
+			log(ERROR, "Failed to decode frame %u of the capture.", i);
+			current_frame = -1;
+			return nullptr;
+		}
+	}
+
+	// Only the font atlas is captured, so all the draws sample it
+	return decoder.get_draw_data();
+}
+
+bool ImGuiDrawDataReader::read_chunk(u64 offset, ImGuiCaptureChunk* chunk, const u8** data, u64* size)
+{
+	memcpy(chunk, file.data() + offset, sizeof(*chunk));
+
+	*data = decompress_chunk(*chunk, file.data() + offset + sizeof(*chunk), decompressed);
+	*size = chunk->size;
+
+	return *data != nullptr;
+}
+
+bool ImGuiDrawDataReader::decode_frame(u32 index)
+{
+	const u8* data;
+	u64 size;
+	ImGuiCaptureChunk chunk;
+
+	if (!read_chunk(frames[index].offset, &chunk, &data, &size))
+	{
+		return false;
+	}
+
+	if (!decoder.decode_frame(data, size, frames[index].keyframe))
+	{
+		return false;
+	}
+
+	current_frame = index;
+
+	return true;
+}
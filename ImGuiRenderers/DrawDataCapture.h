@@ -0,0 +1,182 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+#include "MappedFile.h"
+
+// Headers
+#include <stdio.h>
+
+// Captures of the draw data are a header followed by chunks: the font atlas and then one chunk per frame.
+// Frames store each stream of a draw list either unchanged, raw, or as an XOR delta to the same draw list of
+// the previous frame with the runs of unchanged bytes left out. Every keyframe_interval frames a frame is stored
+// without deltas, so that the replay can seek. Chunks are LZ4 compressed, when built with IMGUI_RENDERERS_USE_LZ4.
+// Streams to a remote viewer use the same format, see DrawDataRemote.h.
+const u32 capture_version = 1;
+
+struct ImGuiCaptureHeader
+{
+	char magic[4];           // "IMDC"
+	u32 version;
+	u32 vertex_size;         // sizeof(ImDrawVert) of the capturing build
+	u32 index_size;          // sizeof(ImDrawIdx) of the capturing build
+	u32 keyframe_interval;   // 0 for streams, which only start with a keyframe
+	u32 reserved;
+};
+
+struct ImGuiCaptureChunk
+{
+	u32 type;                // ImGuiCaptureChunkType
+	u32 flags;               // ImGuiCaptureChunkFlags
+	u32 size;                // Size of the payload
+	u32 stored_size;         // Size of the payload in the file, which differs when compressed
+};
+
+enum ImGuiCaptureChunkType : u32
+{
+	CAPTURE_CHUNK_FONT = 0x544E4F46,  // "FONT"
+	CAPTURE_CHUNK_FRAME = 0x4D415246, // "FRAM"
+	CAPTURE_CHUNK_TEXTURE = 0x52545854, // "TXTR", only in streams
+};
+
+enum ImGuiCaptureChunkFlags : u32
+{
+	CAPTURE_CHUNK_COMPRESSED = 1 << 0,
+	CAPTURE_CHUNK_KEYFRAME = 1 << 1,
+};
+
+// Draw lists of the previous frame, which the frames are delta encoded against
+struct ImGuiCaptureStreams
+{
+	std::vector<u8> vertices;
+	std::vector<u8> indices;
+	std::vector<u8> commands;
+};
+
+// Prepares the chunk for the payload and returns the bytes to store after it, which are LZ4 compressed when that makes them smaller
+const u8* compress_chunk(ImGuiCaptureChunk& chunk, u32 type, u32 flags, const std::vector<u8>& payload, bool compress, std::vector<u8>& compressed);
+
+// Returns the payload of a chunk, which is decompressed into the given buffer when needed, or nullptr when it's invalid.
+// Compressed chunks larger than INT_MAX are invalid.
+const u8* decompress_chunk(const ImGuiCaptureChunk& chunk, const u8* stored, std::vector<u8>& decompressed);
+
+// Whether RGBA8 pixels of the size are at most the given bytes. The sizes are read from captures and streams, so they are
+// checked without multiplying them, which could overflow.
+bool fits_rgba_pixels(u32 width, u32 height, u64 size);
+
+// Encodes the font atlas and the frames into the payloads of chunks. Draws sampling the font atlas are encoded with texture 0.
+class ImGuiDrawDataEncoder
+{
+public:
+	static void encode_font(ImFontAtlas* font_atlas, std::vector<u8>& payload);
+
+	// Keyframes are encoded without deltas to the previous frame
+	void encode_frame(ImDrawData* draw_data, bool keyframe, std::vector<u8>& payload);
+
+	// Forgets the previous frame, after which a keyframe has to follow
+	void reset() { previous.clear(); }
+
+	u64 captured_bytes = 0; // Bytes of draw data encoded
+
+private:
+	std::vector<ImGuiCaptureStreams> previous;
+	std::vector<u8> commands;
+
+	void write_stream(std::vector<u8>& payload, const u8* data, u64 size, std::vector<u8>& previous_stream, bool keyframe);
+};
+
+// Returns the TextureId of a texture of the draw data, which was encoded with the given TextureId
+typedef ImTextureID (*ImGuiDrawDataTextureLookup)(u64 texture, void* user_data);
+
+// Decodes the payloads of the chunks of ImGuiDrawDataEncoder back into draw data
+class ImGuiDrawDataDecoder
+{
+public:
+	~ImGuiDrawDataDecoder();
+
+	// Hands the font atlas to ImGui. Must be called before the renderer is initialized, as it uploads the atlas.
+	static bool decode_font(const u8* data, u64 size, ImFontAtlas* font_atlas);
+
+	// Applies a frame to the previous one and sets the display size, which it was rendered with
+	bool decode_frame(const u8* data, u64 size, bool keyframe);
+
+	// The draw data of the last decoded frame, which stays valid until the next call. Without a lookup, all the draws sample the font atlas.
+	ImDrawData* get_draw_data(ImGuiDrawDataTextureLookup lookup = nullptr, void* user_data = nullptr);
+
+	void reset();
+
+private:
+	std::vector<ImGuiCaptureStreams> streams;
+	std::vector<ImDrawList*> draw_lists;
+	ImDrawData draw_data;
+
+	bool read_stream(const u8*& data, const u8* end, std::vector<u8>& stream, u64 size);
+};
+
+// Writes the draw data of the rendered frames into a capture file
+class ImGuiDrawDataWriter
+{
+public:
+	~ImGuiDrawDataWriter();
+
+	// The font atlas is captured right away, as the replay has to upload the same one
+	bool open(const std::string& file_name, ImFontAtlas* font_atlas, bool compress);
+	bool write_frame(ImDrawData* draw_data);
+	void close();
+
+	u32 keyframe_interval = 120;
+
+	// Bytes of draw data captured and bytes written into the file for them
+	u64 captured_bytes = 0;
+	u64 written_bytes = 0;
+
+private:
+	FILE* file = nullptr;
+	bool compress = false;
+	u32 frame_count = 0;
+	ImGuiDrawDataEncoder encoder;
+	std::vector<u8> payload;
+	std::vector<u8> compressed;
+
+	// Internal functions for the writer
+	bool write_chunk(u32 type, u32 flags, const std::vector<u8>& data);
+};
+
+// Replays a capture file, which is mapped into memory. Frames are decoded in the order they were captured,
+// or from the closest keyframe when seeking, so that the same frame always yields the same draw data.
+class ImGuiDrawDataReader
+{
+public:
+	~ImGuiDrawDataReader();
+
+	bool open(const std::string& file_name);
+	void close();
+
+	// Hands the captured font atlas to ImGui. Must be called before the renderer is initialized, as it uploads the atlas.
+	bool load_font_atlas(ImFontAtlas* font_atlas);
+
+	// Decodes a frame and sets the display size, which it was rendered with. The draw data stays valid until the next call.
+	ImDrawData* read_frame(u32 index);
+
+	u32 get_frame_count() const { return (u32)frames.size(); }
+
+private:
+	struct Frame
+	{
+		u64 offset;
+		bool keyframe;
+	};
+
+	ImGuiMappedFile file;
+	ImGuiCaptureHeader header = {};
+	u64 font_offset = 0;
+	std::vector<Frame> frames;
+
+	// Decoded state
+	s64 current_frame = -1;
+	ImGuiDrawDataDecoder decoder;
+	std::vector<u8> decompressed;
+
+	// Internal functions for the reader
+	bool read_chunk(u64 offset, ImGuiCaptureChunk* chunk, const u8** data, u64* size);
+	bool decode_frame(u32 index);
+};
@@ -0,0 +1,738 @@
+#ifdef _WIN32
+// Winsock 2 has to come before windows.h, which includes the first version
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#pragma comment(lib, "ws2_32.lib")
+#endif
+
+#include "DrawDataRemote.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef int SOCKET;
+#define INVALID_SOCKET -1
+#define closesocket close
+#endif
+
+// Writes into a socket, which was closed by the other side, fail instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+const int send_flags = MSG_NOSIGNAL;
+#else
+const int send_flags = 0;
+#endif
+
+// Bytes received from the socket at once
+const u32 receive_size = 64 * 1024;
+
+static bool start_sockets(bool& started)
+{
+#ifdef _WIN32
+	if (!started)
+	{
+		WSADATA data;
+		int result = WSAStartup(MAKEWORD(2, 2), &data);
+
+		if (result != 0)
+		{
+			log(ERROR, "Failed to initialize Winsock. (%d)", result);
+			return false;
+		}
+	}
+#endif
+
+	started = true;
+	return true;
+}
+
+static void stop_sockets(bool& started)
+{
+#ifdef _WIN32
+	if (started)
+	{
+		WSACleanup();
+	}
+#endif
+
+	started = false;
+}
+
+static void close_socket(s64& handle)
+{
+	if (handle != (s64)INVALID_SOCKET)
+	{
+		closesocket((SOCKET)handle);
+		handle = (s64)INVALID_SOCKET;
+	}
+}
+
+static bool would_block()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// Makes the socket non-blocking. TCP sends the frames right away instead of waiting for the acknowledgement of the previous ones.
+static void prepare_socket(SOCKET handle, bool tcp)
+{
+#ifdef _WIN32
+	u_long non_blocking = 1;
+	ioctlsocket(handle, FIONBIO, &non_blocking);
+#else
+	fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+
+#ifdef SO_NOSIGPIPE
+	int no_signal = 1;
+	setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &no_signal, sizeof(no_signal));
+#endif
+#endif
+
+	if (tcp)
+	{
+		int no_delay = 1;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, (const char*)&no_delay, sizeof(no_delay));
+	}
+}
+
+// Listens on or connects to a TCP port, or a Unix socket at the address when the port is 0
+static SOCKET open_socket(const std::string& address, u16 port, bool server)
+{
+	if (port == 0)
+	{
+#ifdef _WIN32
+		log(ERROR, "Unix sockets aren't supported on Windows, a port is needed.");
+		return INVALID_SOCKET;
+#else
+		sockaddr_un socket_address = {};
+		socket_address.sun_family = AF_UNIX;
+
+		if (address.size() >= sizeof(socket_address.sun_path))
+		{
+			log(ERROR, "The path of the Unix socket %s is too long.", address.c_str());
+			return INVALID_SOCKET;
+		}
+
+		memcpy(socket_address.sun_path, address.c_str(), address.size() + 1);
+		SOCKET handle = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if (handle == INVALID_SOCKET)
+		{
+			return INVALID_SOCKET;
+		}
+
+		// A socket left behind by a previous server would keep the address in use
+		if (server)
+		{
+			unlink(address.c_str());
+		}
+
+		if (server ? bind(handle, (sockaddr*)&socket_address, sizeof(socket_address)) != 0 || ::listen(handle, 1) != 0 :
+			::connect(handle, (sockaddr*)&socket_address, sizeof(socket_address)) != 0)
+		{
+			closesocket(handle);
+			return INVALID_SOCKET;
+		}
+
+		return handle;
+#endif
+	}
+
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = server ? AI_PASSIVE : 0;
+
+	addrinfo* addresses = nullptr;
+	std::string service = std::to_string(port);
+
+	if (getaddrinfo(address.empty() ? nullptr : address.c_str(), service.c_str(), &hints, &addresses) != 0)
+	{
+		log(ERROR, "Failed to resolve the address %s.", address.c_str());
+		return INVALID_SOCKET;
+	}
+
+	SOCKET handle = INVALID_SOCKET;
+
+	for (addrinfo* entry = addresses; entry && handle == INVALID_SOCKET; entry = entry->ai_next)
+	{
+		handle = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+
+		if (handle == INVALID_SOCKET)
+		{
+			continue;
+		}
+
+		bool opened;
+
+		if (server)
+		{
+			// Restarting the server shouldn't wait for the connections of the previous one to time out
+			int reuse = 1;
+			setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+			opened = bind(handle, entry->ai_addr, (int)entry->ai_addrlen) == 0 && ::listen(handle, 1) == 0;
+		}
+		else
+		{
+			opened = ::connect(handle, entry->ai_addr, (int)entry->ai_addrlen) == 0;
+		}
+
+		if (!opened)
+		{
+			closesocket(handle);
+			handle = INVALID_SOCKET;
+		}
+	}
+
+	freeaddrinfo(addresses);
+
+	return handle;
+}
+
+ImGuiDrawDataServer::~ImGuiDrawDataServer()
+{
+	close();
+}
+
+bool ImGuiDrawDataServer::listen(const std::string& address, u16 port, ImFontAtlas* font_atlas, bool compress)
+{
+	close();
+
+#ifndef IMGUI_RENDERERS_USE_LZ4
+	if (compress)
+	{
+		log(WARNING, "Streams can't be compressed without IMGUI_RENDERERS_USE_LZ4, the stream is sent uncompressed.");
+		compress = false;
+	}
+#endif
+
+	this->compress = compress;
+
+	if (!start_sockets(started))
+	{
+		return false;
+	}
+
+	SOCKET handle = open_socket(address, port, true);
+
+	if (handle == INVALID_SOCKET)
+	{
+		log(ERROR, "Failed to listen for viewers on %s:%u.", address.c_str(), (u32)port);
+		close();
+		return false;
+	}
+
+	// Accepting is polled every frame
+	prepare_socket(handle, false);
+	listener = (s64)handle;
+	socket_path = port == 0 ? address : std::string();
+
+	ImGuiDrawDataEncoder::encode_font(font_atlas, font_payload);
+
+	return true;
+}
+
+void ImGuiDrawDataServer::close()
+{
+	disconnect();
+	close_socket(listener);
+
+#ifndef _WIN32
+	if (!socket_path.empty())
+	{
+		unlink(socket_path.c_str());
+		socket_path.clear();
+	}
+#endif
+
+	stop_sockets(started);
+	font_payload.clear();
+	textures.clear();
+}
+
+bool ImGuiDrawDataServer::write_frame(ImDrawData* draw_data)
+{
+	if (listener == invalid_socket)
+	{
+		return false;
+	}
+
+	if (connection == invalid_socket)
+	{
+		accept();
+
+		if (connection == invalid_socket)
+		{
+			return true;
+		}
+	}
+
+	if (!flush())
+	{
+		disconnect();
+		return true;
+	}
+
+	// The viewer is still receiving the previous frame, this one would only add to its lag
+	if (pending_offset < pending.size())
+	{
+		dropped_frames++;
+		return true;
+	}
+
+	// Textures, which changed since the last frame, are sent once with their latest pixels before the frame using them
+	for (u64 id : changed_textures)
+	{
+		auto found = textures.find(id);
+		queue_texture(id, found != textures.end() ? &found->second : nullptr);
+	}
+
+	changed_textures.clear();
+
+	// Deltas are relative to the last frame sent, so frames can be dropped in between
+	bool keyframe = frame_count == 0;
+	encoder.encode_frame(draw_data, keyframe, payload);
+	queue_chunk(CAPTURE_CHUNK_FRAME, keyframe ? (u32)CAPTURE_CHUNK_KEYFRAME : 0, payload);
+
+	frame_count++;
+	sent_frames++;
+
+	if (!flush())
+	{
+		disconnect();
+	}
+
+	return true;
+}
+
+void ImGuiDrawDataServer::set_texture(ImTextureID texture, const void* pixels, u32 width, u32 height)
+{
+	u64 id = (u64)(uintptr_t)texture;
+	u64 size = (u64)width * height * 4;
+	u64 hash = hash_bytes(pixels, size);
+
+	Texture& cached = textures[id];
+
+	if (cached.width == width && cached.height == height && cached.hash == hash && !cached.pixels.empty())
+	{
+		return;
+	}
+
+	cached.pixels.assign((const u8*)pixels, (const u8*)pixels + size);
+	cached.width = width;
+	cached.height = height;
+	cached.hash = hash;
+
+	if (connection != invalid_socket)
+	{
+		changed_textures.insert(id);
+	}
+}
+
+void ImGuiDrawDataServer::release_texture(ImTextureID texture)
+{
+	u64 id = (u64)(uintptr_t)texture;
+
+	if (textures.erase(id) && connection != invalid_socket)
+	{
+		changed_textures.insert(id);
+	}
+}
+
+void ImGuiDrawDataServer::accept()
+{
+	SOCKET handle = ::accept((SOCKET)listener, nullptr, nullptr);
+
+	if (handle == INVALID_SOCKET)
+	{
+		return;
+	}
+
+	prepare_socket(handle, socket_path.empty());
+	connection = (s64)handle;
+
+	// A new viewer gets everything from the start: the header, the font atlas, the textures and a keyframe
+	ImGuiCaptureHeader header = {};
+	memcpy(header.magic, "IMDC", 4);
+	header.version = capture_version;
+	header.vertex_size = sizeof(ImDrawVert);
+	header.index_size = sizeof(ImDrawIdx);
+	header.keyframe_interval = 0;
+
+	pending.assign((const u8*)&header, (const u8*)&header + sizeof(header));
+	pending_offset = 0;
+	queue_chunk(CAPTURE_CHUNK_FONT, 0, font_payload);
+
+	for (auto& entry : textures)
+	{
+		queue_texture(entry.first, &entry.second);
+	}
+
+	changed_textures.clear();
+
+	encoder.reset();
+	frame_count = 0;
+
+	log(INFO, "A viewer connected to the draw data stream.");
+}
+
+void ImGuiDrawDataServer::disconnect()
+{
+	if (connection != invalid_socket)
+	{
+		close_socket(connection);
+		log(INFO, "The viewer disconnected from the draw data stream.");
+	}
+
+	pending.clear();
+	pending_offset = 0;
+	changed_textures.clear();
+}
+
+void ImGuiDrawDataServer::queue_chunk(u32 type, u32 flags, const std::vector<u8>& data)
+{
+	ImGuiCaptureChunk chunk;
+	const u8* stored = compress_chunk(chunk, type, flags, data, compress, compressed);
+
+	pending.insert(pending.end(), (const u8*)&chunk, (const u8*)&chunk + sizeof(chunk));
+	pending.insert(pending.end(), stored, stored + chunk.stored_size);
+}
+
+void ImGuiDrawDataServer::queue_texture(u64 texture, const Texture* pixels)
+{
+	// Released textures are sent without a size
+	u32 width = pixels ? pixels->width : 0;
+	u32 height = pixels ? pixels->height : 0;
+
+	payload.resize(sizeof(texture) + sizeof(width) + sizeof(height));
+	memcpy(&payload[0], &texture, sizeof(texture));
+	memcpy(&payload[sizeof(texture)], &width, sizeof(width));
+	memcpy(&payload[sizeof(texture) + sizeof(width)], &height, sizeof(height));
+
+	if (pixels)
+	{
+		payload.insert(payload.end(), pixels->pixels.begin(), pixels->pixels.end());
+	}
+
+	queue_chunk(CAPTURE_CHUNK_TEXTURE, 0, payload);
+}
+
+bool ImGuiDrawDataServer::flush()
+{
+	while (pending_offset < pending.size())
+	{
+		int size = (int)std::min<u64>(pending.size() - pending_offset, 1 << 30);
+		int sent = send((SOCKET)connection, (const char*)pending.data() + pending_offset, size, send_flags);
+
+		if (sent < 0)
+		{
+			return would_block();
+		}
+
+		pending_offset += sent;
+		sent_bytes += sent;
+	}
+
+	// Everything was sent, the capacity is kept for the next frames
+	pending.clear();
+	pending_offset = 0;
+
+	return true;
+}
+
+ImGuiDrawDataClient::~ImGuiDrawDataClient()
+{
+	close();
+}
+
+bool ImGuiDrawDataClient::connect(const std::string& address, u16 port, u32 timeout_milliseconds)
+{
+	close();
+
+	if (!start_sockets(started))
+	{
+		return false;
+	}
+
+	SOCKET handle = open_socket(address, port, false);
+
+	if (handle == INVALID_SOCKET)
+	{
+		log(ERROR, "Failed to connect to the draw data stream on %s:%u.", address.c_str(), (u32)port);
+		close();
+		return false;
+	}
+
+	prepare_socket(handle, port != 0);
+	connection = (s64)handle;
+
+	// The server sends the font atlas right after accepting
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_milliseconds);
+
+	while (font_payload.empty())
+	{
+		auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(handle, &readable);
+
+		timeval timeout;
+		timeout.tv_sec = (long)(std::max<s64>(remaining, 0) / 1000000);
+		timeout.tv_usec = (long)(std::max<s64>(remaining, 0) % 1000000);
+
+		if (remaining <= 0 || select((int)handle + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+		{
+			log(ERROR, "The server didn't send the font atlas in time.");
+			close();
+			return false;
+		}
+
+		if (!receive() || !process_chunks())
+		{
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ImGuiDrawDataClient::close()
+{
+	close_socket(connection);
+	stop_sockets(started);
+
+	header_received = false;
+	frame_decoded = false;
+	received.clear();
+	font_payload.clear();
+	decoder.reset();
+}
+
+bool ImGuiDrawDataClient::load_font_atlas(ImFontAtlas* font_atlas)
+{
+	if (font_payload.empty())
+	{
+		log(ERROR, "No font atlas was received from the server.");
+		return false;
+	}
+
+	return ImGuiDrawDataDecoder::decode_font(font_payload.data(), font_payload.size(), font_atlas);
+}
+
+ImDrawData* ImGuiDrawDataClient::read_frame()
+{
+	if (connection == invalid_socket)
+	{
+		return nullptr;
+	}
+
+	// The frames, which arrived before the server closed the stream, are still shown
+	bool open = receive();
+
+	if (!process_chunks())
+	{
+		close_socket(connection);
+		return nullptr;
+	}
+
+	if (!open)
+	{
+		close_socket(connection);
+	}
+
+	if (!frame_decoded)
+	{
+		return nullptr;
+	}
+
+	frame_decoded = false;
+
+	return decoder.get_draw_data(texture_lookup, texture_user_data);
+}
+
+void ImGuiDrawDataClient::set_texture_callbacks(ImGuiRemoteTextureUpload upload, ImGuiDrawDataTextureLookup lookup, void* user_data)
+{
+	texture_upload = upload;
+	texture_lookup = lookup;
+	texture_user_data = user_data;
+}
+
+bool ImGuiDrawDataClient::receive()
+{
+	for (;;)
+	{
+		u64 size = received.size();
+		received.resize(size + receive_size);
+
+		int count = recv((SOCKET)connection, (char*)received.data() + size, (int)receive_size, 0);
+		received.resize(size + std::max(count, 0));
+
+		if (count == 0)
+		{
+			log(INFO, "The server closed the draw data stream.");
+			return false;
+		}
+
+		if (count < 0)
+		{
+			if (would_block())
+			{
+				return true;
+			}
+
+			log(ERROR, "Failed to receive the draw data stream.");
+			return false;
+		}
+
+		received_bytes += count;
+
+		// Whatever arrives while processing is received with the next frame. A stream, which keeps coming, is received
+		// up to a whole chunk of the largest size, so that the chunks are checked before receiving more.
+		if ((u32)count < receive_size || received.size() >= (u64)max_chunk_size + sizeof(ImGuiCaptureHeader) + sizeof(ImGuiCaptureChunk))
+		{
+			return true;
+		}
+	}
+}
+
+bool ImGuiDrawDataClient::process_chunks()
+{
+	u64 offset = 0;
+
+	if (!header_received)
+	{
+		ImGuiCaptureHeader header;
+
+		if (received.size() < sizeof(header))
+		{
+			return true;
+		}
+
+		memcpy(&header, received.data(), sizeof(header));
+
+		if (memcmp(header.magic, "IMDC", 4) != 0 || header.version != capture_version)
+		{
+			log(ERROR, "The server doesn't send a supported draw data stream.");
+			return false;
+		}
+
+		if (header.vertex_size != sizeof(ImDrawVert) || header.index_size != sizeof(ImDrawIdx))
+		{
+			log(ERROR, "The server was built with a different vertex or index type.");
+			return false;
+		}
+
+		offset = sizeof(header);
+		header_received = true;
+	}
+
+	// Only whole chunks are processed, the rest stays for the next call
+	while (received.size() - offset >= sizeof(ImGuiCaptureChunk))
+	{
+		ImGuiCaptureChunk chunk;
+		memcpy(&chunk, received.data() + offset, sizeof(chunk));
+
+		if (chunk.size > max_chunk_size || chunk.stored_size > max_chunk_size)
+		{
+			log(ERROR, "Received a chunk of %u bytes, which is larger than the limit of %u bytes.", std::max(chunk.size, chunk.stored_size), max_chunk_size);
+			return false;
+		}
+
+		if (received.size() - offset - sizeof(chunk) < chunk.stored_size)
+		{
+			break;
+		}
+
+		const u8* data = decompress_chunk(chunk, received.data() + offset + sizeof(chunk), decompressed);
+
+		if (!data || !process_chunk(chunk, data))
+		{
+			log(ERROR, "Received an invalid chunk of the draw data stream.");
+			return false;
+		}
+
+		offset += sizeof(chunk) + chunk.stored_size;
+	}
+
+	received.erase(received.begin(), received.begin() + offset);
+
+	return true;
+}
+
+bool ImGuiDrawDataClient::process_chunk(const ImGuiCaptureChunk& chunk, const u8* data)
+{
+	if (chunk.type == CAPTURE_CHUNK_FONT)
+	{
+		font_payload.assign(data, data + chunk.size);
+		return true;
+	}
+
+	if (chunk.type == CAPTURE_CHUNK_TEXTURE)
+	{
+		u64 texture;
+		u32 width, height;
+
+		if (chunk.size < sizeof(texture) + sizeof(width) + sizeof(height))
+		{
+			return false;
+		}
+
+		memcpy(&texture, data, sizeof(texture));
+		memcpy(&width, data + sizeof(texture), sizeof(width));
+		memcpy(&height, data + sizeof(texture) + sizeof(width), sizeof(height));
+
+		const u8* pixels = data + sizeof(texture) + sizeof(width) + sizeof(height);
+
+		// Released textures have no size
+		bool released = width == 0 && height == 0;
+
+		if (!released && !fits_rgba_pixels(width, height, chunk.size - (sizeof(texture) + sizeof(width) + sizeof(height))))
+		{
+			return false;
+		}
+
+		if (texture_upload)
+		{
+			texture_upload(texture, released ? nullptr : pixels, width, height, texture_user_data);
+		}
+
+		return true;
+	}
+
+	if (chunk.type == CAPTURE_CHUNK_FRAME)
+	{
+		if (!decoder.decode_frame(data, chunk.size, (chunk.flags & CAPTURE_CHUNK_KEYFRAME) != 0))
+		{
+			return false;
+		}
+
+		// Only the latest frame is returned, the ones before it are only needed for the deltas
+		skipped_frames += frame_decoded ? 1 : 0;
+		received_frames++;
+		frame_decoded = true;
+		return true;
+	}
+
+	// Chunks of later versions are skipped
+	return true;
+}
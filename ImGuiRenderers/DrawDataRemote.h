@@ -0,0 +1,136 @@
+#pragma once
+
+#include "DrawDataCapture.h"
+
+// Headers
+#include <unordered_map>
+#include <unordered_set>
+
+// Streams of the draw data to a remote viewer are a capture sent over a TCP or Unix socket: the header, the font atlas
+// and the textures followed by the frames. Only the first frame after connecting is a keyframe, the others are deltas
+// to the frame sent before them. Textures are sent once and again only when their pixels change.
+
+// Creates, updates or, without pixels, releases a texture of the viewer from the RGBA8 pixels sent by the server
+typedef void (*ImGuiRemoteTextureUpload)(u64 texture, const u8* pixels, u32 width, u32 height, void* user_data);
+
+// Sends the draw data of the rendered frames to a viewer, which connects to it. A viewer, which is still receiving the
+// previous frame, doesn't get the next ones until it's done with it, so a slow connection gets fewer but current frames.
+class ImGuiDrawDataServer
+{
+public:
+	~ImGuiDrawDataServer();
+
+	// Listens on the address and TCP port, or a Unix socket at the address when the port is 0. The font atlas is encoded
+	// right away and sent to every viewer, which connects.
+	bool listen(const std::string& address, u16 port, ImFontAtlas* font_atlas, bool compress = false);
+	void close();
+
+	// Sends the frame, unless no viewer is connected or it hasn't received the previous frame yet. Accepts a waiting viewer.
+	bool write_frame(ImDrawData* draw_data);
+
+	// Registers the RGBA8 pixels of a texture, which the draw commands sample with the TextureId. They are sent to the
+	// viewer with the next frame, unless they are the same as the last time. Textures changed several times in between
+	// are only sent once, so a slow viewer doesn't queue up every version of them.
+	void set_texture(ImTextureID texture, const void* pixels, u32 width, u32 height);
+	void release_texture(ImTextureID texture);
+
+	bool is_connected() const { return connection != invalid_socket; }
+
+	// Statistics of the stream
+	u64 sent_frames = 0;
+	u64 dropped_frames = 0; // Frames, which weren't sent as the viewer hadn't received the previous one yet
+	u64 sent_bytes = 0;
+
+private:
+	struct Texture
+	{
+		std::vector<u8> pixels;
+		u32 width = 0;
+		u32 height = 0;
+		u64 hash = 0;
+	};
+
+	static const s64 invalid_socket = -1;
+
+	s64 listener = invalid_socket;
+	s64 connection = invalid_socket;
+	std::string socket_path; // Unix socket, which is removed when closing
+	bool compress = false;
+	bool started = false; // Whether WSAStartup was called on Windows
+
+	ImGuiDrawDataEncoder encoder;
+	std::vector<u8> font_payload;
+	std::unordered_map<u64, Texture> textures;
+	std::unordered_set<u64> changed_textures; // Set or released since the viewer was last sent the textures
+	u32 frame_count = 0; // Frames sent to the connected viewer
+
+	// Bytes queued for the viewer and how many of them were sent
+	std::vector<u8> pending;
+	u64 pending_offset = 0;
+	std::vector<u8> payload;
+	std::vector<u8> compressed;
+
+	// Internal functions for the server
+	void accept();
+	void disconnect();
+	void queue_chunk(u32 type, u32 flags, const std::vector<u8>& data);
+	void queue_texture(u64 texture, const Texture* pixels);
+	bool flush();
+};
+
+// Receives the draw data from an ImGuiDrawDataServer, so that a viewer renders the frames with its own renderer
+class ImGuiDrawDataClient
+{
+public:
+	~ImGuiDrawDataClient();
+
+	// Connects to the address and TCP port, or a Unix socket at the address when the port is 0, and waits for the font atlas
+	bool connect(const std::string& address, u16 port, u32 timeout_milliseconds = 5000);
+	void close();
+
+	// Hands the font atlas of the server to ImGui. Must be called before the renderer is initialized, as it uploads the atlas.
+	bool load_font_atlas(ImFontAtlas* font_atlas);
+
+	// Receives what the server has sent without blocking and returns the draw data of the latest frame, or nullptr when no frame
+	// arrived since the last call. The frames in between are decoded but skipped, so the viewer never falls behind the server.
+	// The draw data stays valid until the next call.
+	ImDrawData* read_frame();
+
+	// Textures of the server are passed to the upload function, and the draws sample the TextureId, which the lookup returns
+	// for them. Without these, all the draws sample the font atlas.
+	void set_texture_callbacks(ImGuiRemoteTextureUpload upload, ImGuiDrawDataTextureLookup lookup, void* user_data);
+
+	bool is_connected() const { return connection != invalid_socket; }
+
+	// Chunks claiming to be larger are rejected and close the stream, before anything is allocated for them. The sizes
+	// in the chunks are checked against the bytes, which were received, before they are allocated as well.
+	u32 max_chunk_size = 256 * 1024 * 1024;
+
+	// Statistics of the stream
+	u64 received_frames = 0;
+	u64 skipped_frames = 0; // Frames, which were decoded but not returned, as a later one had arrived as well
+	u64 received_bytes = 0;
+
+private:
+	static const s64 invalid_socket = -1;
+
+	s64 connection = invalid_socket;
+	bool started = false;
+	bool header_received = false;
+
+	// Received bytes, which don't make up a whole chunk yet
+	std::vector<u8> received;
+	std::vector<u8> decompressed;
+	std::vector<u8> font_payload;
+
+	ImGuiDrawDataDecoder decoder;
+	bool frame_decoded = false;
+	ImGuiRemoteTextureUpload texture_upload = nullptr;
+	ImGuiDrawDataTextureLookup texture_lookup = nullptr;
+	void* texture_user_data = nullptr;
+
+	// Internal functions for the client
+	bool receive();
+	bool process_chunks();
+	bool process_chunk(const ImGuiCaptureChunk& chunk, const u8* data);
+};
@@ -0,0 +1,58 @@
+#include "DrawDataSnapshot.h"
+
+#include <string.h>
+
+ImGuiDrawDataSnapshot::~ImGuiDrawDataSnapshot()
+{
+	for (ImDrawList* draw_list : draw_lists)
+	{
+		delete draw_list;
+	}
+}
+
+void ImGuiDrawDataSnapshot::copy(const ImDrawData* source)
+{
+	ImGuiIO& io = ImGui::GetIO();
+
+	display_size = io.DisplaySize;
+	framebuffer_scale = io.DisplayFramebufferScale;
+
+	while (draw_lists.size() < (u32)source->CmdListsCount)
+	{
+		draw_lists.push_back(new ImDrawList());
+	}
+
+	for (s32 i = 0; i < source->CmdListsCount; i++)
+	{
+		const ImDrawList* source_list = source->CmdLists[i];
+		ImDrawList* draw_list = draw_lists[i];
+
+		draw_list->VtxBuffer.resize(source_list->VtxBuffer.size());
+		draw_list->IdxBuffer.resize(source_list->IdxBuffer.size());
+		draw_list->CmdBuffer.resize(source_list->CmdBuffer.size());
+
+		if (!source_list->VtxBuffer.empty())
+		{
+			memcpy(&draw_list->VtxBuffer.front(), &source_list->VtxBuffer.front(), source_list->VtxBuffer.size() * sizeof(ImDrawVert));
+		}
+
+		if (!source_list->IdxBuffer.empty())
+		{
+			memcpy(&draw_list->IdxBuffer.front(), &source_list->IdxBuffer.front(), source_list->IdxBuffer.size() * sizeof(ImDrawIdx));
+		}
+
+		// Callbacks are copied too and are called on the thread, which renders the snapshot
+		if (!source_list->CmdBuffer.empty())
+		{
+			memcpy(&draw_list->CmdBuffer.front(), &source_list->CmdBuffer.front(), source_list->CmdBuffer.size() * sizeof(ImDrawCmd));
+		}
+
+		set_owner_name(*draw_list, get_owner_name(*source_list, 0), 0);
+	}
+
+	draw_data.Valid = source->Valid;
+	draw_data.CmdLists = draw_lists.data();
+	draw_data.CmdListsCount = source->CmdListsCount;
+	draw_data.TotalVtxCount = source->TotalVtxCount;
+	draw_data.TotalIdxCount = source->TotalIdxCount;
+}
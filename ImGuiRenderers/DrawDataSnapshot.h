@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// A deep copy of the draw data of a frame, which stays valid while ImGui builds the next frame. The draw lists are
+// reused from frame to frame and keep their capacity, so once the frames stop growing nothing is allocated anymore.
+class ImGuiDrawDataSnapshot
+{
+public:
+	~ImGuiDrawDataSnapshot();
+
+	// Copies the draw data along with the display size and framebuffer scale it was built for
+	void copy(const ImDrawData* source);
+
+	ImDrawData* get_draw_data() { return &draw_data; }
+
+	ImVec2 display_size;
+	ImVec2 framebuffer_scale;
+
+private:
+	std::vector<ImDrawList*> draw_lists;
+	ImDrawData draw_data = ImDrawData();
+};
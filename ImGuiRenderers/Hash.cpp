@@ -0,0 +1,80 @@
+#include "Hash.h"
+
+#include <string.h>
+
+namespace
+{
+	const u64 prime1 = 0x9E3779B185EBCA87ULL;
+	const u64 prime2 = 0xC2B2AE3D27D4EB4FULL;
+	const u64 prime3 = 0x165667B19E3779F9ULL;
+
+	inline u64 rotate_left(u64 value, u32 bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline u64 read_u64(const u8* data)
+	{
+		u64 value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline u64 hash_round(u64 accumulator, u64 input)
+	{
+		return rotate_left(accumulator + input * prime2, 31) * prime1;
+	}
+}
+
+u64 hash_bytes(const void* data, u64 size, u64 seed)
+{
+	const u8* bytes = static_cast<const u8*>(data);
+	const u8* end = bytes + size;
+	u64 hash;
+
+	// Four independent lanes, so that the multiplications don't wait on each other
+	if (size >= 32)
+	{
+		u64 lanes[4] = { seed + prime1 + prime2, seed + prime2, seed, seed - prime1 };
+
+		for (; bytes + 32 <= end; bytes += 32)
+		{
+			lanes[0] = hash_round(lanes[0], read_u64(bytes));
+			lanes[1] = hash_round(lanes[1], read_u64(bytes + 8));
+			lanes[2] = hash_round(lanes[2], read_u64(bytes + 16));
+			lanes[3] = hash_round(lanes[3], read_u64(bytes + 24));
+		}
+
+		hash = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) + rotate_left(lanes[2], 12) + rotate_left(lanes[3], 18);
+
+		for (u8 i = 0; i < 4; i++)
+		{
+			hash = (hash ^ hash_round(0, lanes[i])) * prime1 + prime3;
+		}
+	}
+	else
+	{
+		hash = seed + prime3;
+	}
+
+	hash += size;
+
+	for (; bytes + 8 <= end; bytes += 8)
+	{
+		hash = rotate_left(hash ^ hash_round(0, read_u64(bytes)), 27) * prime1 + prime3;
+	}
+
+	for (; bytes < end; bytes++)
+	{
+		hash = rotate_left(hash ^ (*bytes * prime3), 11) * prime1;
+	}
+
+	// Mix the bits, so that small changes affect the whole hash
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// A fast 64-bit non-cryptographic hash for detecting changed content. Chaining is done by passing the previous hash as the seed.
+u64 hash_bytes(const void* data, u64 size, u64 seed = 0);
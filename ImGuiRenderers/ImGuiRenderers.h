@@ -26,6 +26,16 @@ using u8  = uint8_t;
 #include "Logger.h"
 #endif
 
+// ImDrawList::_OwnerName only exists in some ImGui versions, so it is detected at compile time
+template<typename T> inline auto get_owner_name(const T& draw_list, int) -> decltype(static_cast<const char*>(draw_list._OwnerName)) { return draw_list._OwnerName; }
+template<typename T> inline const char* get_owner_name(const T&, long) { return nullptr; }
+template<typename T> inline auto set_owner_name(T& draw_list, const char* name, int) -> decltype(draw_list._OwnerName = name, void()) { draw_list._OwnerName = name; }
+template<typename T> inline void set_owner_name(T&, const char*, long) {}
+
+// ImFontAtlas::TexGlyphPadding only exists in some ImGui versions. It keeps the distance fields of glyphs apart, so it has to be raised before the atlas is built.
+template<typename T> inline auto set_glyph_padding(T& atlas, s32 padding, int) -> decltype(atlas.TexGlyphPadding = padding, void()) { if (atlas.TexGlyphPadding < padding) atlas.TexGlyphPadding = padding; }
+template<typename T> inline void set_glyph_padding(T&, s32, long) {}
+
 class ImGuiRenderer
 {
 public:
@@ -42,4 +52,6 @@ protected:
 	s64 time;
 };
 
+#include "Renderers/OpenGLRenderer.h"
+#include "Renderers/SoftwareRenderer.h"
 #include "Renderers/VulkanRenderer.h"
\ No newline at end of file
@@ -21,17 +21,16 @@ void log(LogLevel level, const std::string format, ...)
 		fmt += format + "\n";
 	}
 
-	std::vector<char> buffer(vsnprintf(nullptr, 0, fmt.c_str(), args) + 1);
+	// The size is measured with a copy, as the arguments can only be walked once
+	va_list size_args;
+	va_copy(size_args, args);
+	std::vector<char> buffer(vsnprintf(nullptr, 0, fmt.c_str(), size_args) + 1);
+	va_end(size_args);
+
 	vsnprintf(buffer.data(), buffer.size(), fmt.c_str(), args);
 
-	if (level == ERROR)
-	{
-		fprintf(stderr, buffer.data());
-	}
-	else
-	{
-		fprintf(stdout, buffer.data());
-	}
+	// The message may contain percent signs of its own, so it's not used as a format
+	fputs(buffer.data(), level == ERROR ? stderr : stdout);
 
 	va_end(args);
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ImGuiMappedFile::~ImGuiMappedFile()
+{
+	close();
+}
+
+bool ImGuiMappedFile::open(const std::string& file_name)
+{
+	close();
+
+#ifdef _WIN32
+	file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		log(ERROR, "Failed to open file %s.", file_name.c_str());
+		return false;
+	}
+
+	LARGE_INTEGER file_size = {};
+	GetFileSizeEx(file, &file_size);
+	view_size = file_size.QuadPart;
+
+	// Empty files can't be mapped
+	if (!view_size)
+	{
+		return true;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	view = mapping ? (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+	file = ::open(file_name.c_str(), O_RDONLY);
+
+	if (file < 0)
+	{
+		log(ERROR, "Failed to open file %s.", file_name.c_str());
+		return false;
+	}
+
+	struct stat file_stat = {};
+	fstat(file, &file_stat);
+	view_size = file_stat.st_size;
+
+	// Empty files can't be mapped
+	if (!view_size)
+	{
+		return true;
+	}
+
+	void* mapping = mmap(nullptr, view_size, PROT_READ, MAP_PRIVATE, file, 0);
+	view = mapping != MAP_FAILED ? (const u8*)mapping : nullptr;
+#endif
+
+	if (!view)
+	{
+		log(ERROR, "Failed to map file %s.", file_name.c_str());
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void ImGuiMappedFile::close()
+{
+#ifdef _WIN32
+	if (view)
+	{
+		UnmapViewOfFile(view);
+	}
+
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+	}
+
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (view)
+	{
+		munmap((void*)view, view_size);
+	}
+
+	if (file >= 0)
+	{
+		::close(file);
+	}
+
+	file = -1;
+#endif
+
+	view = nullptr;
+	view_size = 0;
+}
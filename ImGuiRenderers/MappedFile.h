@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// A read-only memory mapping of a whole file
+class ImGuiMappedFile
+{
+public:
+	~ImGuiMappedFile();
+
+	bool open(const std::string& file_name);
+	void close();
+
+	const u8* data() const { return view; }
+	u64 size() const { return view_size; }
+
+private:
+	const u8* view = nullptr;
+	u64 view_size = 0;
+
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+};
@@ -0,0 +1,53 @@
+#include "OpenGLDispatch.h"
+
+bool ImGuiOpenGLDispatch::load(ImGuiOpenGLLoader loader)
+{
+#ifdef _WIN32
+	HMODULE library = LoadLibraryA("opengl32.dll");
+
+	if (!loader && library)
+	{
+		loader = (ImGuiOpenGLLoader)GetProcAddress(library, "wglGetProcAddress");
+	}
+#endif
+
+	if (!loader)
+	{
+		log(ERROR, "No function was given to load the OpenGL functions with.");
+		return false;
+	}
+
+	// wglGetProcAddress may also return small values instead of nullptr for missing functions
+	auto get_function = [&](const char* name) -> void*
+	{
+		void* function = loader(name);
+
+		if ((uintptr_t)function <= 3 || (uintptr_t)function == (uintptr_t)-1)
+		{
+			function = nullptr;
+		}
+
+#ifdef _WIN32
+		if (!function && library)
+		{
+			function = (void*)GetProcAddress(library, name);
+		}
+#endif
+
+		return function;
+	};
+
+	bool loaded = true;
+
+#define IMGUI_OPENGL_LOAD_FUNCTION(result, name, arguments) \
+	name = (result (IMGUI_GL_APIENTRY*) arguments)get_function(#name); \
+	if (!name) { log(ERROR, "Failed to get the OpenGL function %s.", #name); loaded = false; }
+	IMGUI_OPENGL_FUNCTIONS(IMGUI_OPENGL_LOAD_FUNCTION)
+#undef IMGUI_OPENGL_LOAD_FUNCTION
+
+#define IMGUI_OPENGL_LOAD_OPTIONAL_FUNCTION(result, name, arguments) name = (result (IMGUI_GL_APIENTRY*) arguments)get_function(#name);
+	IMGUI_OPENGL_OPTIONAL_FUNCTIONS(IMGUI_OPENGL_LOAD_OPTIONAL_FUNCTION)
+#undef IMGUI_OPENGL_LOAD_OPTIONAL_FUNCTION
+
+	return loaded;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+
+// Headers
+#include <stddef.h>
+
+// The types and constants of the OpenGL 3.3 core profile, which the renderer uses. They are defined here instead of
+// including the GL headers, as Windows only ships the ones of OpenGL 1.1.
+#ifdef _WIN32
+#define IMGUI_GL_APIENTRY __stdcall
+#else
+#define IMGUI_GL_APIENTRY
+#endif
+
+typedef u32 GLenum;
+typedef u32 GLuint;
+typedef s32 GLint;
+typedef s32 GLsizei;
+typedef u32 GLbitfield;
+typedef u8 GLboolean;
+typedef u8 GLubyte;
+typedef char GLchar;
+typedef float GLfloat;
+typedef ptrdiff_t GLintptr;
+typedef ptrdiff_t GLsizeiptr;
+typedef u64 GLuint64;
+typedef struct __GLsync* GLsync;
+
+#define GL_NO_ERROR                    0
+#define GL_TRIANGLES                   0x0004
+#define GL_ONE                         1
+#define GL_SRC_ALPHA                   0x0302
+#define GL_ONE_MINUS_SRC_ALPHA         0x0303
+#define GL_CULL_FACE                   0x0B44
+#define GL_DEPTH_TEST                  0x0B71
+#define GL_STENCIL_TEST                0x0B90
+#define GL_BLEND                       0x0BE2
+#define GL_SCISSOR_TEST                0x0C11
+#define GL_UNPACK_ALIGNMENT            0x0CF5
+#define GL_PACK_ALIGNMENT              0x0D05
+#define GL_TEXTURE_2D                  0x0DE1
+#define GL_UNSIGNED_BYTE               0x1401
+#define GL_UNSIGNED_SHORT              0x1403
+#define GL_UNSIGNED_INT                0x1405
+#define GL_FLOAT                       0x1406
+#define GL_RED                         0x1903
+#define GL_RGBA                        0x1908
+#define GL_RENDERER                    0x1F01
+#define GL_LINEAR                      0x2601
+#define GL_TEXTURE_MAG_FILTER          0x2800
+#define GL_TEXTURE_MIN_FILTER          0x2801
+#define GL_TEXTURE_WRAP_S              0x2802
+#define GL_TEXTURE_WRAP_T              0x2803
+#define GL_COLOR_BUFFER_BIT            0x00004000
+#define GL_CLAMP_TO_EDGE               0x812F
+#define GL_FUNC_ADD                    0x8006
+#define GL_RGBA8                       0x8058
+#define GL_TEXTURE0                    0x84C0
+#define GL_ARRAY_BUFFER                0x8892
+#define GL_ELEMENT_ARRAY_BUFFER        0x8893
+#define GL_STREAM_DRAW                 0x88E0
+#define GL_FRAGMENT_SHADER             0x8B30
+#define GL_VERTEX_SHADER               0x8B31
+#define GL_COMPILE_STATUS              0x8B81
+#define GL_LINK_STATUS                 0x8B82
+#define GL_INFO_LOG_LENGTH             0x8B84
+#define GL_FRAMEBUFFER                 0x8D40
+#define GL_RENDERBUFFER                0x8D41
+#define GL_FRAMEBUFFER_COMPLETE        0x8CD5
+#define GL_COLOR_ATTACHMENT0           0x8CE0
+#define GL_R8                          0x8229
+#define GL_TEXTURE_SWIZZLE_RGBA        0x8E46
+#define GL_MAJOR_VERSION               0x821B
+#define GL_MINOR_VERSION               0x821C
+#define GL_NUM_EXTENSIONS              0x821D
+#define GL_EXTENSIONS                  0x1F03
+#define GL_MAP_WRITE_BIT               0x0002
+#define GL_MAP_INVALIDATE_BUFFER_BIT   0x0008
+#define GL_MAP_UNSYNCHRONIZED_BIT      0x0020
+#define GL_MAP_PERSISTENT_BIT          0x0040
+#define GL_MAP_COHERENT_BIT            0x0080
+#define GL_SYNC_GPU_COMMANDS_COMPLETE  0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT     0x00000001
+#define GL_ALREADY_SIGNALED            0x911A
+#define GL_TIMEOUT_EXPIRED             0x911B
+#define GL_CONDITION_SATISFIED         0x911C
+#define GL_WAIT_FAILED                 0x911D
+
+// Functions of the OpenGL 3.3 core profile, which the renderer needs
+#define IMGUI_OPENGL_FUNCTIONS(X) \
+	X(const GLubyte*, glGetString, (GLenum name)) \
+	X(const GLubyte*, glGetStringi, (GLenum name, GLuint index)) \
+	X(void, glGetIntegerv, (GLenum name, GLint* data)) \
+	X(GLenum, glGetError, ()) \
+	X(void, glEnable, (GLenum capability)) \
+	X(void, glDisable, (GLenum capability)) \
+	X(void, glBlendEquation, (GLenum mode)) \
+	X(void, glBlendFuncSeparate, (GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha)) \
+	X(void, glViewport, (GLint x, GLint y, GLsizei width, GLsizei height)) \
+	X(void, glScissor, (GLint x, GLint y, GLsizei width, GLsizei height)) \
+	X(void, glClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)) \
+	X(void, glClear, (GLbitfield mask)) \
+	X(void, glPixelStorei, (GLenum name, GLint value)) \
+	X(void, glReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)) \
+	X(void, glGenTextures, (GLsizei count, GLuint* textures)) \
+	X(void, glDeleteTextures, (GLsizei count, const GLuint* textures)) \
+	X(void, glBindTexture, (GLenum target, GLuint texture)) \
+	X(void, glActiveTexture, (GLenum texture)) \
+	X(void, glTexImage2D, (GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)) \
+	X(void, glTexParameteri, (GLenum target, GLenum name, GLint value)) \
+	X(void, glTexParameteriv, (GLenum target, GLenum name, const GLint* values)) \
+	X(GLuint, glCreateShader, (GLenum type)) \
+	X(void, glShaderSource, (GLuint shader, GLsizei count, const GLchar* const* sources, const GLint* lengths)) \
+	X(void, glCompileShader, (GLuint shader)) \
+	X(void, glGetShaderiv, (GLuint shader, GLenum name, GLint* value)) \
+	X(void, glGetShaderInfoLog, (GLuint shader, GLsizei size, GLsizei* length, GLchar* log)) \
+	X(void, glDeleteShader, (GLuint shader)) \
+	X(GLuint, glCreateProgram, ()) \
+	X(void, glAttachShader, (GLuint program, GLuint shader)) \
+	X(void, glLinkProgram, (GLuint program)) \
+	X(void, glGetProgramiv, (GLuint program, GLenum name, GLint* value)) \
+	X(void, glGetProgramInfoLog, (GLuint program, GLsizei size, GLsizei* length, GLchar* log)) \
+	X(void, glDeleteProgram, (GLuint program)) \
+	X(void, glUseProgram, (GLuint program)) \
+	X(GLint, glGetUniformLocation, (GLuint program, const GLchar* name)) \
+	X(void, glUniform1i, (GLint location, GLint value)) \
+	X(void, glUniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)) \
+	X(void, glGenVertexArrays, (GLsizei count, GLuint* arrays)) \
+	X(void, glDeleteVertexArrays, (GLsizei count, const GLuint* arrays)) \
+	X(void, glBindVertexArray, (GLuint array)) \
+	X(void, glEnableVertexAttribArray, (GLuint index)) \
+	X(void, glVertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* offset)) \
+	X(void, glGenBuffers, (GLsizei count, GLuint* buffers)) \
+	X(void, glDeleteBuffers, (GLsizei count, const GLuint* buffers)) \
+	X(void, glBindBuffer, (GLenum target, GLuint buffer)) \
+	X(void, glBufferData, (GLenum target, GLsizeiptr size, const void* data, GLenum usage)) \
+	X(void*, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)) \
+	X(GLboolean, glUnmapBuffer, (GLenum target)) \
+	X(void, glDrawElementsBaseVertex, (GLenum mode, GLsizei count, GLenum type, const void* offset, GLint base_vertex)) \
+	X(GLsync, glFenceSync, (GLenum condition, GLbitfield flags)) \
+	X(GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout)) \
+	X(void, glDeleteSync, (GLsync sync)) \
+	X(void, glGenFramebuffers, (GLsizei count, GLuint* framebuffers)) \
+	X(void, glDeleteFramebuffers, (GLsizei count, const GLuint* framebuffers)) \
+	X(void, glBindFramebuffer, (GLenum target, GLuint framebuffer)) \
+	X(void, glFramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbuffer_target, GLuint renderbuffer)) \
+	X(GLenum, glCheckFramebufferStatus, (GLenum target)) \
+	X(void, glGenRenderbuffers, (GLsizei count, GLuint* renderbuffers)) \
+	X(void, glDeleteRenderbuffers, (GLsizei count, const GLuint* renderbuffers)) \
+	X(void, glBindRenderbuffer, (GLenum target, GLuint renderbuffer)) \
+	X(void, glRenderbufferStorage, (GLenum target, GLenum internal_format, GLsizei width, GLsizei height))
+
+// Functions of extensions or later versions, which may be missing
+#define IMGUI_OPENGL_OPTIONAL_FUNCTIONS(X) \
+	X(void, glBufferStorage, (GLenum target, GLsizeiptr size, const void* data, GLbitfield flags))
+
+// Loads a function of the current context, like eglGetProcAddress, glXGetProcAddress or wglGetProcAddress
+typedef void* (*ImGuiOpenGLLoader)(const char* name);
+
+// OpenGL entry points of a context, which are loaded at runtime like ImGuiVulkanDispatch
+struct ImGuiOpenGLDispatch
+{
+#define IMGUI_OPENGL_DECLARE_FUNCTION(result, name, arguments) result (IMGUI_GL_APIENTRY* name) arguments = nullptr;
+	IMGUI_OPENGL_FUNCTIONS(IMGUI_OPENGL_DECLARE_FUNCTION)
+	IMGUI_OPENGL_OPTIONAL_FUNCTIONS(IMGUI_OPENGL_DECLARE_FUNCTION)
+#undef IMGUI_OPENGL_DECLARE_FUNCTION
+
+	// Loads the functions of the context, which is current on the calling thread. Without a loader, wglGetProcAddress
+	// is used on Windows. The functions of OpenGL 1.1, which it doesn't return, are taken from opengl32.dll.
+	bool load(ImGuiOpenGLLoader loader);
+};
@@ -0,0 +1,761 @@
+#include "OpenGLRenderer.h"
+#include "OpenGLDispatch.h"
+#include "../DistanceField.h"
+#include "../Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+// The shaders are compiled by the driver, so they are kept as source
+static const char* vertex_shader_source =
+	"#version 330 core\n"
+	"layout(location = 0) in vec2 in_pos;\n"
+	"layout(location = 1) in vec2 in_uv;\n"
+	"layout(location = 2) in vec4 in_color;\n"
+	"uniform mat4 projection_matrix;\n"
+	"out vec2 frag_uv;\n"
+	"out vec4 frag_color;\n"
+	"void main()\n"
+	"{\n"
+	"	frag_uv = in_uv;\n"
+	"	frag_color = in_color;\n"
+	"	gl_Position = projection_matrix * vec4(in_pos, 0, 1);\n"
+	"}\n";
+
+// Like shaders/sdf.frag, the distance in the alpha of the font atlas is turned into coverage over about a pixel on screen
+static const char* fragment_shader_source =
+	"#version 330 core\n"
+	"uniform sampler2D texture_sampler;\n"
+	"uniform bool distance_field;\n"
+	"in vec2 frag_uv;\n"
+	"in vec4 frag_color;\n"
+	"layout(location = 0) out vec4 out_color;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 color = texture(texture_sampler, frag_uv);\n"
+	"	if (distance_field)\n"
+	"	{\n"
+	"		float smoothing = max(fwidth(color.a) * 0.5, 1.0 / 512.0);\n"
+	"		color.a = smoothstep(0.5 - smoothing, 0.5 + smoothing, color.a);\n"
+	"	}\n"
+	"	out_color = frag_color * color;\n"
+	"}\n";
+
+// Frames of the ring start on a whole vertex, so that the base vertex of a draw list is its offset in vertices
+static const u64 frame_alignment = sizeof(ImDrawVert) * sizeof(u32);
+
+// Marks a cached binding as unknown
+static const u32 unknown_binding = 0xFFFFFFFF;
+
+ImGuiOpenGLRenderer::ImGuiOpenGLRenderer()
+{
+}
+
+ImGuiOpenGLRenderer::~ImGuiOpenGLRenderer()
+{
+	if (!gl)
+	{
+		return;
+	}
+
+	destroy_buffer();
+
+	if (vertex_array)
+	{
+		gl->glDeleteVertexArrays(1, &vertex_array);
+	}
+
+	if (program)
+	{
+		gl->glDeleteProgram(program);
+	}
+
+	if (font_texture)
+	{
+		gl->glDeleteTextures(1, &font_texture);
+	}
+
+	if (offscreen_framebuffer)
+	{
+		gl->glDeleteFramebuffers(1, &offscreen_framebuffer);
+		gl->glDeleteRenderbuffers(1, &offscreen_renderbuffer);
+	}
+}
+
+static u32 compile_shader(const ImGuiOpenGLDispatch& gl, GLenum type, const char* source)
+{
+	u32 shader = gl.glCreateShader(type);
+	gl.glShaderSource(shader, 1, &source, nullptr);
+	gl.glCompileShader(shader);
+
+	GLint compiled = 0;
+	gl.glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+	if (!compiled)
+	{
+		GLint length = 0;
+		gl.glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+
+		std::string info(std::max(length, 1), '\0');
+		gl.glGetShaderInfoLog(shader, length, nullptr, &info[0]);
+
+		log(ERROR, "Failed to compile the %s shader: %s", type == GL_VERTEX_SHADER ? "vertex" : "fragment", info.c_str());
+		gl.glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+bool ImGuiOpenGLRenderer::create_program()
+{
+	u32 vertex_shader = compile_shader(*gl, GL_VERTEX_SHADER, vertex_shader_source);
+	u32 fragment_shader = compile_shader(*gl, GL_FRAGMENT_SHADER, fragment_shader_source);
+
+	if (!vertex_shader || !fragment_shader)
+	{
+		gl->glDeleteShader(vertex_shader);
+		gl->glDeleteShader(fragment_shader);
+		return false;
+	}
+
+	program = gl->glCreateProgram();
+	gl->glAttachShader(program, vertex_shader);
+	gl->glAttachShader(program, fragment_shader);
+	gl->glLinkProgram(program);
+
+	// The program keeps the compiled code
+	gl->glDeleteShader(vertex_shader);
+	gl->glDeleteShader(fragment_shader);
+
+	GLint linked = 0;
+	gl->glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+	if (!linked)
+	{
+		GLint length = 0;
+		gl->glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+		std::string info(std::max(length, 1), '\0');
+		gl->glGetProgramInfoLog(program, length, nullptr, &info[0]);
+
+		log(ERROR, "Failed to link the shader program: %s", info.c_str());
+		return false;
+	}
+
+	projection_location = gl->glGetUniformLocation(program, "projection_matrix");
+	distance_field_location = gl->glGetUniformLocation(program, "distance_field");
+
+	gl->glUseProgram(program);
+	gl->glUniform1i(gl->glGetUniformLocation(program, "texture_sampler"), 0);
+	gl->glUniform1i(distance_field_location, 0);
+
+	return true;
+}
+
+bool ImGuiOpenGLRenderer::create_buffer(u64 size)
+{
+	frame_size = (size + frame_alignment - 1) / frame_alignment * frame_alignment;
+
+	gl->glGenBuffers(1, &buffer);
+	gl->glBindVertexArray(vertex_array);
+	gl->glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	// The coherent mapping stays valid while the buffer is drawn from, so the frames of the ring are written without
+	// mapping or flushing, and only waited for when the GPU hasn't finished with them yet
+	if (persistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		gl->glBufferStorage(GL_ARRAY_BUFFER, frame_size * ring_frames, nullptr, flags);
+		ring = (u8*)gl->glMapBufferRange(GL_ARRAY_BUFFER, 0, frame_size * ring_frames, flags);
+
+		if (!ring)
+		{
+			log(ERROR, "Failed to map the ring buffer persistently. (%d)", gl->glGetError());
+			return false;
+		}
+	}
+	else
+	{
+		gl->glBufferData(GL_ARRAY_BUFFER, frame_size, nullptr, GL_STREAM_DRAW);
+	}
+
+	// The vertices and indices of a frame share the buffer
+	gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+	gl->glEnableVertexAttribArray(0);
+	gl->glEnableVertexAttribArray(1);
+	gl->glEnableVertexAttribArray(2);
+	gl->glVertexAttribPointer(0, 2, GL_FLOAT, false, sizeof(ImDrawVert), (void*)offsetof(ImDrawVert, pos));
+	gl->glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(ImDrawVert), (void*)offsetof(ImDrawVert, uv));
+	gl->glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, true, sizeof(ImDrawVert), (void*)offsetof(ImDrawVert, col));
+
+	state.vertex_array = vertex_array;
+	return true;
+}
+
+void ImGuiOpenGLRenderer::destroy_buffer()
+{
+	for (u32 i = 0; i < ring_frames; i++)
+	{
+		if (fences[i])
+		{
+			gl->glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+			gl->glDeleteSync(fences[i]);
+			fences[i] = nullptr;
+		}
+	}
+
+	// Deleting the buffer also unmaps it
+	if (buffer)
+	{
+		gl->glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		ring = nullptr;
+	}
+}
+
+u8* ImGuiOpenGLRenderer::begin_upload(u64 size, u64& offset)
+{
+	// Larger frames replace the buffer, after the GPU has finished with all the frames of the ring
+	if (size > frame_size)
+	{
+		destroy_buffer();
+
+		if (!create_buffer(std::max(size, frame_size * 2)))
+		{
+			return nullptr;
+		}
+	}
+
+	gl->glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	if (!persistent)
+	{
+		// Orphaning gives the buffer new storage, while the GPU may still read the previous one
+		offset = 0;
+		gl->glBufferData(GL_ARRAY_BUFFER, frame_size, nullptr, GL_STREAM_DRAW);
+		return (u8*)gl->glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	}
+
+	__GLsync*& fence = fences[ring_frame];
+
+	if (fence)
+	{
+		ImGuiTraceScope trace("ring fence wait");
+		GLenum result = gl->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			stats.fence_waits++;
+
+			do
+			{
+				result = gl->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+			while (result == GL_TIMEOUT_EXPIRED);
+		}
+
+		if (result == GL_WAIT_FAILED)
+		{
+			log(ERROR, "Failed to wait for the GPU to finish with the ring buffer. (%d)", gl->glGetError());
+		}
+
+		gl->glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	offset = ring_frame * frame_size;
+	return ring + offset;
+}
+
+void ImGuiOpenGLRenderer::end_upload()
+{
+	if (!persistent)
+	{
+		gl->glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+}
+
+void ImGuiOpenGLRenderer::set_state(u32 fb_width, u32 fb_height)
+{
+	// The fixed function state is only set again, after it may have been changed outside of the renderer
+	if (!state.valid || shared_state)
+	{
+		state = State();
+		state.framebuffer = unknown_binding;
+		state.program = unknown_binding;
+		state.vertex_array = unknown_binding;
+		state.texture = unknown_binding;
+		state.viewport[2] = -1;
+		state.scissor[2] = -1;
+		state.valid = true;
+
+		gl->glEnable(GL_BLEND);
+		gl->glBlendEquation(GL_FUNC_ADD);
+		gl->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		gl->glDisable(GL_CULL_FACE);
+		gl->glDisable(GL_DEPTH_TEST);
+		gl->glDisable(GL_STENCIL_TEST);
+		gl->glEnable(GL_SCISSOR_TEST);
+		gl->glActiveTexture(GL_TEXTURE0);
+	}
+
+	u32 target = offscreen_framebuffer ? offscreen_framebuffer : framebuffer;
+
+	if (state.framebuffer != target)
+	{
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, target);
+		state.framebuffer = target;
+		stats.state_changes++;
+	}
+	else
+	{
+		stats.redundant_state_changes++;
+	}
+
+	if (state.program != program)
+	{
+		gl->glUseProgram(program);
+		state.program = program;
+		stats.state_changes++;
+	}
+	else
+	{
+		stats.redundant_state_changes++;
+	}
+
+	if (state.vertex_array != vertex_array)
+	{
+		gl->glBindVertexArray(vertex_array);
+		state.vertex_array = vertex_array;
+		stats.state_changes++;
+	}
+	else
+	{
+		stats.redundant_state_changes++;
+	}
+
+	if (state.viewport[2] != (s32)fb_width || state.viewport[3] != (s32)fb_height)
+	{
+		gl->glViewport(0, 0, fb_width, fb_height);
+		state.viewport[2] = fb_width;
+		state.viewport[3] = fb_height;
+		stats.state_changes++;
+	}
+	else
+	{
+		stats.redundant_state_changes++;
+	}
+}
+
+void ImGuiOpenGLRenderer::bind_texture(u32 texture)
+{
+	if (state.texture == texture)
+	{
+		stats.redundant_state_changes++;
+		return;
+	}
+
+	gl->glBindTexture(GL_TEXTURE_2D, texture);
+	state.texture = texture;
+	stats.state_changes++;
+
+	// The uniform belongs to the program, so it is only set when switching between the font atlas and other textures
+	if (distance_field_font && distance_field_bound != (texture == font_texture))
+	{
+		distance_field_bound = texture == font_texture;
+		gl->glUniform1i(distance_field_location, distance_field_bound);
+		stats.state_changes++;
+	}
+}
+
+void ImGuiOpenGLRenderer::set_scissor(s32 x, s32 y, s32 scissor_width, s32 scissor_height)
+{
+	if (state.scissor[0] == x && state.scissor[1] == y && state.scissor[2] == scissor_width && state.scissor[3] == scissor_height)
+	{
+		stats.redundant_state_changes++;
+		return;
+	}
+
+	gl->glScissor(x, y, scissor_width, scissor_height);
+	state.scissor[0] = x;
+	state.scissor[1] = y;
+	state.scissor[2] = scissor_width;
+	state.scissor[3] = scissor_height;
+	stats.state_changes++;
+}
+
+void ImGuiOpenGLRenderer::render_draw_data(ImDrawData* draw_data)
+{
+	ImGuiTraceScope trace("render");
+	ImGuiIO& io = ImGui::GetIO();
+	auto start = std::chrono::steady_clock::now();
+
+	stats = {};
+
+	u32 fb_width = static_cast<u32>(io.DisplaySize.x * io.DisplayFramebufferScale.x);
+	u32 fb_height = static_cast<u32>(io.DisplaySize.y * io.DisplayFramebufferScale.y);
+
+	if (fb_width == 0 || fb_height == 0)
+	{
+		return;
+	}
+
+	draw_data->ScaleClipRects(io.DisplayFramebufferScale);
+	set_state(fb_width, fb_height);
+
+	// The projection maps the display to the clip space with the y axis pointing down
+	if (projection_size.x != io.DisplaySize.x || projection_size.y != io.DisplaySize.y)
+	{
+		const float projection[16] =
+		{
+			2.0f / io.DisplaySize.x, 0.0f, 0.0f, 0.0f,
+			0.0f, -2.0f / io.DisplaySize.y, 0.0f, 0.0f,
+			0.0f, 0.0f, -1.0f, 0.0f,
+			-1.0f, 1.0f, 0.0f, 1.0f,
+		};
+
+		gl->glUniformMatrix4fv(projection_location, 1, false, projection);
+		projection_size = io.DisplaySize;
+	}
+
+	set_scissor(0, 0, fb_width, fb_height);
+	gl->glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+	gl->glClear(GL_COLOR_BUFFER_BIT);
+
+	// The vertices of all the draw lists come first, followed by their indices
+	u64 vertex_count = 0;
+	u64 index_count = 0;
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		vertex_count += draw_data->CmdLists[i]->VtxBuffer.size();
+		index_count += draw_data->CmdLists[i]->IdxBuffer.size();
+	}
+
+	if (vertex_count == 0 || index_count == 0)
+	{
+		return;
+	}
+
+	stats.vertex_bytes = vertex_count * sizeof(ImDrawVert);
+	stats.index_bytes = index_count * sizeof(ImDrawIdx);
+
+	const u64 index_start = (stats.vertex_bytes + sizeof(u32) - 1) & ~(u64)(sizeof(u32) - 1);
+	u64 frame_offset;
+	u8* data;
+
+	{
+		ImGuiTraceScope upload_trace("upload");
+		data = begin_upload(index_start + stats.index_bytes, frame_offset);
+
+		if (!data)
+		{
+			log(ERROR, "Failed to map the buffer for the vertices and indices.");
+			return;
+		}
+
+		u64 vertex_offset = 0;
+		u64 index_offset = index_start;
+
+		for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+		{
+			const ImDrawList* draw_list = draw_data->CmdLists[i];
+			u64 vertex_bytes = draw_list->VtxBuffer.size() * sizeof(ImDrawVert);
+			u64 index_bytes = draw_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+
+			if (vertex_bytes)
+			{
+				memcpy(data + vertex_offset, draw_list->VtxBuffer.Data, vertex_bytes);
+			}
+
+			if (index_bytes)
+			{
+				memcpy(data + index_offset, draw_list->IdxBuffer.Data, index_bytes);
+			}
+
+			vertex_offset += vertex_bytes;
+			index_offset += index_bytes;
+		}
+
+		end_upload();
+	}
+
+	const GLenum index_type = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	s32 base_vertex = (s32)(frame_offset / sizeof(ImDrawVert));
+	u64 index_offset = frame_offset + index_start;
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			const ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+
+			if (draw_cmd->UserCallback)
+			{
+				// The callback may change any state
+				draw_cmd->UserCallback(draw_list, draw_cmd);
+				state.valid = false;
+				set_state(fb_width, fb_height);
+			}
+			else
+			{
+				s32 x = std::max((s32)draw_cmd->ClipRect.x, 0);
+				s32 y = std::max((s32)draw_cmd->ClipRect.y, 0);
+				s32 right = std::min((s32)draw_cmd->ClipRect.z, (s32)fb_width);
+				s32 bottom = std::min((s32)draw_cmd->ClipRect.w, (s32)fb_height);
+
+				if (right > x && bottom > y && draw_cmd->ElemCount)
+				{
+					bind_texture(draw_cmd->TextureId ? (u32)(uintptr_t)draw_cmd->TextureId : font_texture);
+					set_scissor(x, fb_height - bottom, right - x, bottom - y);
+
+					gl->glDrawElementsBaseVertex(GL_TRIANGLES, draw_cmd->ElemCount, index_type, (void*)(uintptr_t)index_offset, base_vertex);
+					stats.draw_calls++;
+				}
+			}
+
+			index_offset += draw_cmd->ElemCount * sizeof(ImDrawIdx);
+		}
+
+		base_vertex += draw_list->VtxBuffer.size();
+	}
+
+	// The frame of the ring can be written again, once the GPU has passed the fence
+	if (persistent)
+	{
+		fences[ring_frame] = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		ring_frame = (ring_frame + 1) % ring_frames;
+	}
+
+	stats.frame_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ImGuiOpenGLRenderer::imgui_render(ImDrawData* draw_data)
+{
+	ImGuiOpenGLRenderer& renderer = *(ImGuiOpenGLRenderer*)ImGui::GetIO().UserData;
+	renderer.render_draw_data(draw_data);
+}
+
+void ImGuiOpenGLRenderer::set_framebuffer(u32 framebuffer_object, u32 framebuffer_width, u32 framebuffer_height)
+{
+	framebuffer = framebuffer_object;
+	width = static_cast<float>(framebuffer_width);
+	height = static_cast<float>(framebuffer_height);
+
+	if (offscreen_framebuffer)
+	{
+		gl->glBindRenderbuffer(GL_RENDERBUFFER, offscreen_renderbuffer);
+		gl->glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, framebuffer_width, framebuffer_height);
+	}
+}
+
+bool ImGuiOpenGLRenderer::read_pixels(u32* pixels)
+{
+	u32 pixel_width = static_cast<u32>(width);
+	u32 pixel_height = static_cast<u32>(height);
+
+	if (!pixels || !pixel_width || !pixel_height)
+	{
+		return false;
+	}
+
+	u32 target = offscreen_framebuffer ? offscreen_framebuffer : framebuffer;
+	gl->glBindFramebuffer(GL_FRAMEBUFFER, target);
+	state.framebuffer = target;
+
+	gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	gl->glReadPixels(0, 0, pixel_width, pixel_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	GLenum error = gl->glGetError();
+
+	if (error != GL_NO_ERROR)
+	{
+		log(ERROR, "Failed to read the pixels of the framebuffer. (%d)", error);
+		return false;
+	}
+
+	// GL reads the bottom row first
+	std::vector<u32> row(pixel_width);
+
+	for (u32 y = 0; y < pixel_height / 2; y++)
+	{
+		u32* top = pixels + y * pixel_width;
+		u32* bottom = pixels + (pixel_height - 1 - y) * pixel_width;
+
+		memcpy(row.data(), top, pixel_width * sizeof(u32));
+		memcpy(top, bottom, pixel_width * sizeof(u32));
+		memcpy(bottom, row.data(), pixel_width * sizeof(u32));
+	}
+
+	return true;
+}
+
+void ImGuiOpenGLRenderer::new_frame()
+{
+	ImGuiTraceScope trace("new_frame");
+	ImGuiIO& io = ImGui::GetIO();
+
+	// Without a window there is nothing to query, so only the delta time is calculated
+	if (window_handle)
+	{
+		ImGuiRenderer::new_frame();
+	}
+	else
+	{
+		s64 current_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		io.DeltaTime = time ? (float)(current_time - time) / 1000000.0f : 1.0f / 60.0f;
+		time = current_time;
+	}
+
+	io.DisplaySize.x = width;
+	io.DisplaySize.y = height;
+
+	ImGui::NewFrame();
+}
+
+bool ImGuiOpenGLRenderer::initialize(void* handle, void* instance, void* renderer_options)
+{
+	ImGuiRenderer::initialize(handle, instance, renderer_options);
+	ImGuiOpenGLOptions& options = *(ImGuiOpenGLOptions*)renderer_options;
+
+	// Set some basic ImGui info
+	ImGuiIO& io = ImGui::GetIO();
+	io.RenderDrawListsFn = imgui_render;
+	io.UserData = this;
+
+	// Set some internal values
+	clear_color = options.clear_color;
+	shared_state = options.shared_state;
+	distance_field_font = options.distance_field_font;
+
+	if (!handle)
+	{
+		time = 0;
+	}
+
+	gl.reset(new ImGuiOpenGLDispatch());
+
+	if (!gl->load(options.get_proc_address))
+	{
+		log(ERROR, "Failed to load the OpenGL functions, is the context current?");
+		return false;
+	}
+
+	// Contexts before 3.0 don't know the version queries and leave the values untouched
+	GLint major = 0, minor = 0;
+	gl->glGetIntegerv(GL_MAJOR_VERSION, &major);
+	gl->glGetIntegerv(GL_MINOR_VERSION, &minor);
+	version = major * 10 + minor;
+
+	if (version < 33)
+	{
+		log(ERROR, "OpenGL 3.3 is required, the context has %d.%d.", major, minor);
+		return false;
+	}
+
+	log(INFO, "Rendering with %s, OpenGL %d.%d.", gl->glGetString(GL_RENDERER), major, minor);
+
+	// Buffer storage is core in 4.4, before that the extension has to be asked for
+	bool buffer_storage = version >= 44;
+	GLint extension_count = 0;
+	gl->glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+
+	for (GLint i = 0; i < extension_count && !buffer_storage; i++)
+	{
+		const char* extension = (const char*)gl->glGetStringi(GL_EXTENSIONS, i);
+		buffer_storage = extension && !strcmp(extension, "GL_ARB_buffer_storage");
+	}
+
+	persistent = options.persistent_mapping && buffer_storage && gl->glBufferStorage;
+
+	if (options.persistent_mapping && !persistent)
+	{
+		log(WARNING, "ARB_buffer_storage isn't available, the buffer is orphaned every frame instead.");
+	}
+
+	if (!create_program())
+	{
+		return false;
+	}
+
+	gl->glGenVertexArrays(1, &vertex_array);
+
+	if (!create_buffer(std::max(options.ring_size, 1u)))
+	{
+		return false;
+	}
+
+	// A framebuffer of its own, e.g. for a surfaceless context, which has no default framebuffer
+	if (options.offscreen)
+	{
+		gl->glGenRenderbuffers(1, &offscreen_renderbuffer);
+		gl->glGenFramebuffers(1, &offscreen_framebuffer);
+	}
+
+	set_framebuffer(options.framebuffer, options.width, options.height);
+
+	if (offscreen_framebuffer)
+	{
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, offscreen_framebuffer);
+		gl->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreen_renderbuffer);
+
+		if (gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			log(ERROR, "The offscreen framebuffer is incomplete, does it have a size?");
+			return false;
+		}
+	}
+
+	// Upload the font atlas
+	u8* pixels;
+	s32 font_width, font_height;
+
+	gl->glGenTextures(1, &font_texture);
+	gl->glBindTexture(GL_TEXTURE_2D, font_texture);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	if (distance_field_font)
+	{
+		// Baked once into a single channel, which is read as the alpha of white like the RGBA atlas
+		set_glyph_padding(*io.Fonts, (s32)options.distance_field_spread, 0);
+		io.Fonts->GetTexDataAsAlpha8(&pixels, &font_width, &font_height);
+
+		std::vector<u8> field((size_t)font_width * font_height);
+		build_distance_field(field.data(), pixels, (u32)font_width, (u32)font_height, options.distance_field_spread);
+
+		const GLint swizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+		gl->glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, font_width, font_height, 0, GL_RED, GL_UNSIGNED_BYTE, field.data());
+	}
+	else
+	{
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &font_width, &font_height);
+
+		gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, font_width, font_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	io.Fonts->TexID = (void*)(uintptr_t)font_texture;
+
+	// Everything, which was bound during the initialization, is set again by the first frame
+	state.valid = false;
+
+	GLenum error = gl->glGetError();
+
+	if (error != GL_NO_ERROR)
+	{
+		log(ERROR, "Failed to initialize the OpenGL renderer. (%d)", error);
+		return false;
+	}
+
+	return true;
+}
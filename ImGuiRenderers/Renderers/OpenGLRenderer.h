@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+
+// Headers
+#include <memory>
+
+struct ImGuiOpenGLDispatch;
+struct __GLsync;
+
+// Stores the options for the renderer, which are passed during initialization. The GL context is created by the
+// caller and has to be current on the thread, which initializes, renders and destroys the renderer.
+struct ImGuiOpenGLOptions
+{
+	void* (*get_proc_address)(const char* name) = nullptr; // Loads the functions of the context, e.g. eglGetProcAddress. nullptr uses wglGetProcAddress on Windows
+	u32 framebuffer = 0;            // Framebuffer object, which to render into. 0 is the default framebuffer of the context
+	u32 width = 0;                  // Size of the framebuffer in pixels, when rendering without a window
+	u32 height = 0;
+	bool offscreen = false;         // Whether to render into an RGBA8 framebuffer of its own with the size above, e.g. with a surfaceless context. Read back with read_pixels
+	ImVec4 clear_color = ImVec4(0.0f, 0.0f, 0.0f, 1.0f); // Colour, which to clear the framebuffer to every frame
+	bool persistent_mapping = true; // Whether to stream through a persistently mapped ring, when GL 4.4 or ARB_buffer_storage is available. Otherwise the buffer is orphaned every frame
+	u32 ring_size = 1024 * 1024;    // Initial size of each of the three frames of the ring in bytes, it grows to fit larger frames
+	bool shared_state = false;      // Whether the caller changes the GL state between frames, so the state cache is set up again every frame
+	bool distance_field_font = false; // Whether to bake the font atlas into a single channel distance field once, so text stays sharp at any scale
+	u32 distance_field_spread = 4;   // Pixels, over which the distance field falls off around the edges of the glyphs
+};
+
+// Statistics of the last rendered frame
+struct ImGuiOpenGLStats
+{
+	u64 vertex_bytes;            // Bytes of vertex data uploaded
+	u64 index_bytes;             // Bytes of index data uploaded
+	u64 draw_calls;              // Draw calls issued
+	u64 state_changes;           // Bindings and scissor or viewport changes issued
+	u64 redundant_state_changes; // State changes skipped by the state cache, as the state was already set
+	u64 fence_waits;             // Waits for the GPU to finish with the frame of the ring, which was about to be written
+	u64 frame_nanoseconds;       // Time spent on the CPU uploading and issuing the frame
+};
+
+// Renders with OpenGL 3.3, or 4.4 for the persistently mapped ring. Textures are GL texture names cast to ImTextureID.
+class ImGuiOpenGLRenderer : public ImGuiRenderer
+{
+public:
+	ImGuiOpenGLRenderer(); // Defined with the dispatch table, which is only declared here
+	~ImGuiOpenGLRenderer();
+	bool initialize(void* handle, void* instance, void* renderer_options);
+	void new_frame();
+
+	// Changes the framebuffer, which is rendered into, e.g. when the window is resized. An offscreen framebuffer is resized instead
+	void set_framebuffer(u32 framebuffer_object, u32 framebuffer_width, u32 framebuffer_height);
+
+	// Reads the framebuffer back as RGBA8 pixels, with the top row first like the software renderer
+	bool read_pixels(u32* pixels);
+
+	// The next frame sets all its state again, after the caller has changed the GL state
+	void invalidate_state() { state.valid = false; }
+
+	const ImGuiOpenGLStats& get_stats() const { return stats; }
+	bool is_persistently_mapped() const { return persistent; }
+
+private:
+	// State of the context, as the renderer has last set it. Only differing state is set again.
+	struct State
+	{
+		bool valid = false; // Whether the fixed function state is set and the bindings below are known
+		u32 framebuffer;
+		u32 program;
+		u32 vertex_array;
+		u32 texture;
+		s32 viewport[4];
+		s32 scissor[4];
+	};
+
+	// Frames of the ring, each of which can be written again once the GPU has passed its fence
+	static const u32 ring_frames = 3;
+
+	// OpenGL
+	std::unique_ptr<ImGuiOpenGLDispatch> gl;
+	u32 version = 0; // Major version * 10 + minor version
+	u32 program = 0;
+	s32 projection_location = -1;
+	u32 vertex_array = 0;
+	u32 buffer = 0;
+	u32 font_texture = 0;
+
+	// The distance field is only turned back into coverage, while the font atlas is bound
+	bool distance_field_font = false;
+	bool distance_field_bound = false;
+	s32 distance_field_location = -1;
+
+	// Framebuffer
+	u32 framebuffer = 0;
+	u32 offscreen_framebuffer = 0;
+	u32 offscreen_renderbuffer = 0;
+	ImVec4 clear_color;
+
+	// Streaming of the vertices and indices, either through the persistently mapped ring or by orphaning the buffer
+	bool persistent = false;
+	u8* ring = nullptr;
+	u64 frame_size = 0;
+	u32 ring_frame = 0;
+	__GLsync* fences[ring_frames] = {};
+
+	// Cache of the state and the projection, which the program was last given
+	State state;
+	bool shared_state = false;
+	ImVec2 projection_size;
+	ImGuiOpenGLStats stats = {};
+
+	// Internal functions for the renderer
+	bool create_program();
+	bool create_buffer(u64 size);
+	void destroy_buffer();
+	u8* begin_upload(u64 size, u64& offset);
+	void end_upload();
+	void set_state(u32 fb_width, u32 fb_height);
+	void bind_texture(u32 texture);
+	void set_scissor(s32 x, s32 y, s32 scissor_width, s32 scissor_height);
+	void render_draw_data(ImDrawData* draw_data);
+	static void imgui_render(ImDrawData* draw_data);
+};
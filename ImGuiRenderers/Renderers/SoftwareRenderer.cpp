@@ -0,0 +1,723 @@
+#include "SoftwareRenderer.h"
+#include "../Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+// Pick the widest available SIMD instruction set for the edge function evaluation. The shading runs on groups of 4 pixels
+// with SSE2, also in AVX2 builds, and a pixel at a time otherwise.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SOFTWARE_RENDERER_AVX2
+#elif defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SOFTWARE_RENDERER_NEON
+#endif
+
+namespace
+{
+	// Size of the square tiles, which are binned and rasterized independently
+	const u32 tile_size = 64;
+
+#ifdef SOFTWARE_RENDERER_AVX2
+	const u32 span_width = 8;
+#else
+	const u32 span_width = 4;
+#endif
+
+	struct Edge
+	{
+		float a, b, c;
+		bool top_left;
+	};
+
+	// Evaluates the edge functions for a span of pixels at (x, y) and returns a bit mask of the covered pixels.
+	// The unnormalized barycentrics for the second and third vertex are written out for the shading.
+	inline u32 coverage(const Edge* edges, float x, float y, float* w1, float* w2)
+	{
+#if defined(SOFTWARE_RENDERER_AVX2)
+		const __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		const __m256 px = _mm256_add_ps(_mm256_set1_ps(x), offsets);
+		const __m256 zero = _mm256_setzero_ps();
+		__m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		__m256 w[3];
+
+		for (u8 i = 0; i < 3; i++)
+		{
+			w[i] = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edges[i].a), px), _mm256_set1_ps(edges[i].b * (y + 0.5f) + edges[i].c));
+			__m256 inside = edges[i].top_left ? _mm256_cmp_ps(w[i], zero, _CMP_GE_OQ) : _mm256_cmp_ps(w[i], zero, _CMP_GT_OQ);
+			mask = _mm256_and_ps(mask, inside);
+		}
+
+		_mm256_storeu_ps(w1, w[1]);
+		_mm256_storeu_ps(w2, w[2]);
+		return static_cast<u32>(_mm256_movemask_ps(mask));
+#elif defined(SOFTWARE_RENDERER_SSE2)
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 px = _mm_add_ps(_mm_set1_ps(x), offsets);
+		const __m128 zero = _mm_setzero_ps();
+		__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 w[3];
+
+		for (u8 i = 0; i < 3; i++)
+		{
+			w[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edges[i].a), px), _mm_set1_ps(edges[i].b * (y + 0.5f) + edges[i].c));
+			__m128 inside = edges[i].top_left ? _mm_cmpge_ps(w[i], zero) : _mm_cmpgt_ps(w[i], zero);
+			mask = _mm_and_ps(mask, inside);
+		}
+
+		_mm_storeu_ps(w1, w[1]);
+		_mm_storeu_ps(w2, w[2]);
+		return static_cast<u32>(_mm_movemask_ps(mask));
+#elif defined(SOFTWARE_RENDERER_NEON)
+		const float offset_values[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+		const uint32x4_t lane_bits = { 1, 2, 4, 8 };
+		const float32x4_t px = vaddq_f32(vdupq_n_f32(x), vld1q_f32(offset_values));
+		const float32x4_t zero = vdupq_n_f32(0.0f);
+		uint32x4_t mask = vdupq_n_u32(0xFFFFFFFF);
+		float32x4_t w[3];
+
+		for (u8 i = 0; i < 3; i++)
+		{
+			w[i] = vmlaq_f32(vdupq_n_f32(edges[i].b * (y + 0.5f) + edges[i].c), vdupq_n_f32(edges[i].a), px);
+			uint32x4_t inside = edges[i].top_left ? vcgeq_f32(w[i], zero) : vcgtq_f32(w[i], zero);
+			mask = vandq_u32(mask, inside);
+		}
+
+		vst1q_f32(w1, w[1]);
+		vst1q_f32(w2, w[2]);
+
+		uint32x4_t bits = vandq_u32(mask, lane_bits);
+		uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+		return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#else
+		u32 mask = 0;
+
+		for (u32 lane = 0; lane < span_width; lane++)
+		{
+			float px = x + lane + 0.5f;
+			bool inside = true;
+			float w[3];
+
+			for (u8 i = 0; i < 3; i++)
+			{
+				w[i] = edges[i].a * px + edges[i].b * (y + 0.5f) + edges[i].c;
+				inside &= edges[i].top_left ? w[i] >= 0.0f : w[i] > 0.0f;
+			}
+
+			w1[lane] = w[1];
+			w2[lane] = w[2];
+			mask |= inside ? 1 << lane : 0;
+		}
+
+		return mask;
+#endif
+	}
+
+	inline u32 texel(const ImGuiSoftwareTexture* texture, s32 x, s32 y)
+	{
+		x = std::min(std::max(x, 0), static_cast<s32>(texture->width) - 1);
+		y = std::min(std::max(y, 0), static_cast<s32>(texture->height) - 1);
+
+		return texture->pixels[y * texture->width + x];
+	}
+
+	inline u32 sample(const ImGuiSoftwareTexture* texture, float u, float v, bool bilinear)
+	{
+		float x = u * texture->width;
+		float y = v * texture->height;
+
+		if (!bilinear)
+		{
+			return texel(texture, static_cast<s32>(floorf(x)), static_cast<s32>(floorf(y)));
+		}
+
+		x -= 0.5f;
+		y -= 0.5f;
+
+		float x0 = floorf(x);
+		float y0 = floorf(y);
+		u32 fx = static_cast<u32>((x - x0) * 256.0f);
+		u32 fy = static_cast<u32>((y - y0) * 256.0f);
+		s32 ix = static_cast<s32>(x0);
+		s32 iy = static_cast<s32>(y0);
+
+		u32 t00 = texel(texture, ix, iy);
+		u32 t10 = texel(texture, ix + 1, iy);
+		u32 t01 = texel(texture, ix, iy + 1);
+		u32 t11 = texel(texture, ix + 1, iy + 1);
+		u32 result = 0;
+
+		for (u32 shift = 0; shift < 32; shift += 8)
+		{
+			u32 top = ((t00 >> shift) & 0xFF) * (256 - fx) + ((t10 >> shift) & 0xFF) * fx;
+			u32 bottom = ((t01 >> shift) & 0xFF) * (256 - fx) + ((t11 >> shift) & 0xFF) * fx;
+			u32 value = (top * (256 - fy) + bottom * fy + (1 << 15)) >> 16;
+			result |= value << shift;
+		}
+
+		return result;
+	}
+
+	// Blends with the same factors as the Vulkan pipeline: source alpha, one minus source alpha
+	inline u32 blend(u32 source, u32 destination)
+	{
+		u32 alpha = source >> 24;
+
+		if (alpha == 0xFF)
+		{
+			return source;
+		}
+
+		u32 result = 0;
+
+		for (u32 shift = 0; shift < 32; shift += 8)
+		{
+			u32 s = (source >> shift) & 0xFF;
+			u32 d = (destination >> shift) & 0xFF;
+			result |= ((s * alpha + d * (255 - alpha) + 127) / 255) << shift;
+		}
+
+		return result;
+	}
+
+	inline u32 modulate(u32 color, u32 texel)
+	{
+		if (texel == 0xFFFFFFFF)
+		{
+			return color;
+		}
+
+		u32 result = 0;
+
+		for (u32 shift = 0; shift < 32; shift += 8)
+		{
+			result |= ((((color >> shift) & 0xFF) * ((texel >> shift) & 0xFF) + 127) / 255) << shift;
+		}
+
+		return result;
+	}
+
+#if defined(SOFTWARE_RENDERER_AVX2) || defined(SOFTWARE_RENDERER_SSE2)
+	// Divides 16-bit values by 255 like (x + 127) / 255, which is exact up to 255 * 255
+	inline __m128i divide_255(__m128i x)
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(127));
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+	}
+
+	// The same as modulate for 4 pixels. A white texel leaves the colour unchanged without a branch.
+	inline __m128i modulate(__m128i color, __m128i texel)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i low = divide_255(_mm_mullo_epi16(_mm_unpacklo_epi8(color, zero), _mm_unpacklo_epi8(texel, zero)));
+		__m128i high = divide_255(_mm_mullo_epi16(_mm_unpackhi_epi8(color, zero), _mm_unpackhi_epi8(texel, zero)));
+
+		return _mm_packus_epi16(low, high);
+	}
+
+	// The same as blend for 4 pixels. An opaque source replaces the destination without a branch.
+	inline __m128i blend(__m128i source, __m128i destination)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i opaque = _mm_set1_epi16(255);
+		__m128i source_low = _mm_unpacklo_epi8(source, zero);
+		__m128i source_high = _mm_unpackhi_epi8(source, zero);
+
+		// The alpha of each pixel in all of its channels
+		__m128i alpha_low = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source_low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i alpha_high = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source_high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128i low = _mm_add_epi16(_mm_mullo_epi16(source_low, alpha_low), _mm_mullo_epi16(_mm_unpacklo_epi8(destination, zero), _mm_sub_epi16(opaque, alpha_low)));
+		__m128i high = _mm_add_epi16(_mm_mullo_epi16(source_high, alpha_high), _mm_mullo_epi16(_mm_unpackhi_epi8(destination, zero), _mm_sub_epi16(opaque, alpha_high)));
+
+		return _mm_packus_epi16(divide_255(low), divide_255(high));
+	}
+#endif
+
+	inline u32 pack_color(const float* color)
+	{
+		u32 result = 0;
+
+		for (u32 i = 0; i < 4; i++)
+		{
+			float value = std::min(std::max(color[i], 0.0f), 255.0f);
+			result |= static_cast<u32>(value + 0.5f) << (i * 8);
+		}
+
+		return result;
+	}
+}
+
+ImGuiSoftwareRenderer::~ImGuiSoftwareRenderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(worker_mutex);
+		exiting = true;
+	}
+
+	worker_wake.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ImGuiSoftwareRenderer::set_framebuffer(u32* framebuffer_pixels, u32 framebuffer_width, u32 framebuffer_height, u32 framebuffer_stride)
+{
+	framebuffer = framebuffer_pixels;
+	width = static_cast<float>(framebuffer_width);
+	height = static_cast<float>(framebuffer_height);
+	stride = framebuffer_stride ? framebuffer_stride : framebuffer_width;
+
+	tiles_x = (framebuffer_width + tile_size - 1) / tile_size;
+	tiles_y = (framebuffer_height + tile_size - 1) / tile_size;
+	tile_bins.resize(tiles_x * tiles_y);
+}
+
+void ImGuiSoftwareRenderer::new_frame()
+{
+	ImGuiTraceScope trace("new_frame");
+	ImGuiIO& io = ImGui::GetIO();
+
+	// Without a window there is nothing to query, so only the delta time is calculated
+	if (window_handle)
+	{
+		float framebuffer_width = width;
+		float framebuffer_height = height;
+
+		ImGuiRenderer::new_frame();
+
+		width = framebuffer_width;
+		height = framebuffer_height;
+	}
+	else
+	{
+		s64 current_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		io.DeltaTime = time ? (float)(current_time - time) / 1000000.0f : 1.0f / 60.0f;
+		time = current_time;
+	}
+
+	io.DisplaySize.x = width;
+	io.DisplaySize.y = height;
+
+	ImGui::NewFrame();
+}
+
+void ImGuiSoftwareRenderer::setup_triangle(const ImDrawVert& v0, const ImDrawVert& v1, const ImDrawVert& v2, const ImVec4& clip_rect, const ImGuiSoftwareTexture* texture)
+{
+	const ImDrawVert* vertices[3] = { &v0, &v1, &v2 };
+
+	// Edge function for the edge from a to b, evaluated at c, is twice the signed area of the triangle
+	float area = (v0.pos.y - v1.pos.y) * v2.pos.x + (v1.pos.x - v0.pos.x) * v2.pos.y + (v0.pos.x * v1.pos.y - v0.pos.y * v1.pos.x);
+
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	// Make the winding consistent, so that the inside is always positive
+	if (area < 0.0f)
+	{
+		std::swap(vertices[1], vertices[2]);
+		area = -area;
+	}
+
+	Triangle triangle;
+
+	// Clip the bounding box against the scissor rectangle and the framebuffer
+	float min_x = std::min(std::min(v0.pos.x, v1.pos.x), v2.pos.x);
+	float min_y = std::min(std::min(v0.pos.y, v1.pos.y), v2.pos.y);
+	float max_x = std::max(std::max(v0.pos.x, v1.pos.x), v2.pos.x);
+	float max_y = std::max(std::max(v0.pos.y, v1.pos.y), v2.pos.y);
+
+	triangle.min_x = std::max(static_cast<s32>(floorf(std::max(min_x, clip_rect.x))), 0);
+	triangle.min_y = std::max(static_cast<s32>(floorf(std::max(min_y, clip_rect.y))), 0);
+	triangle.max_x = std::min(static_cast<s32>(ceilf(std::min(max_x, clip_rect.z))), static_cast<s32>(width)) - 1;
+	triangle.max_y = std::min(static_cast<s32>(ceilf(std::min(max_y, clip_rect.w))), static_cast<s32>(height)) - 1;
+
+	if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+	{
+		return;
+	}
+
+	// Edge i is opposite to vertex i, so that its function is the unnormalized barycentric of that vertex
+	for (u8 i = 0; i < 3; i++)
+	{
+		const ImVec2& a = vertices[(i + 1) % 3]->pos;
+		const ImVec2& b = vertices[(i + 2) % 3]->pos;
+
+		triangle.edge_a[i] = a.y - b.y;
+		triangle.edge_b[i] = b.x - a.x;
+		triangle.edge_c[i] = a.x * b.y - a.y * b.x;
+		triangle.top_left[i] = triangle.edge_a[i] > 0.0f || (triangle.edge_a[i] == 0.0f && triangle.edge_b[i] > 0.0f);
+	}
+
+	triangle.inverse_area = 1.0f / area;
+
+	triangle.u = vertices[0]->uv.x;
+	triangle.u_delta1 = vertices[1]->uv.x - vertices[0]->uv.x;
+	triangle.u_delta2 = vertices[2]->uv.x - vertices[0]->uv.x;
+	triangle.v = vertices[0]->uv.y;
+	triangle.v_delta1 = vertices[1]->uv.y - vertices[0]->uv.y;
+	triangle.v_delta2 = vertices[2]->uv.y - vertices[0]->uv.y;
+
+	triangle.flat_color = vertices[0]->col == vertices[1]->col && vertices[0]->col == vertices[2]->col;
+
+	for (u8 i = 0; i < 4; i++)
+	{
+		float c0 = static_cast<float>((vertices[0]->col >> (i * 8)) & 0xFF);
+		float c1 = static_cast<float>((vertices[1]->col >> (i * 8)) & 0xFF);
+		float c2 = static_cast<float>((vertices[2]->col >> (i * 8)) & 0xFF);
+
+		triangle.color[i] = c0;
+		triangle.color_delta1[i] = c1 - c0;
+		triangle.color_delta2[i] = c2 - c0;
+	}
+
+	triangle.texture = texture;
+
+	triangles.push_back(triangle);
+	bin_triangle(static_cast<u32>(triangles.size() - 1));
+}
+
+void ImGuiSoftwareRenderer::bin_triangle(u32 index)
+{
+	const Triangle& triangle = triangles[index];
+
+	// Triangles are appended in submission order, so every bin stays correctly ordered for blending
+	for (u32 y = triangle.min_y / tile_size; y <= triangle.max_y / tile_size; y++)
+	{
+		for (u32 x = triangle.min_x / tile_size; x <= triangle.max_x / tile_size; x++)
+		{
+			tile_bins[y * tiles_x + x].push_back(index);
+		}
+	}
+}
+
+void ImGuiSoftwareRenderer::rasterize_tile(u32 tile)
+{
+	s32 tile_x = static_cast<s32>((tile % tiles_x) * tile_size);
+	s32 tile_y = static_cast<s32>((tile / tiles_x) * tile_size);
+	s32 tile_max_x = std::min(tile_x + static_cast<s32>(tile_size), static_cast<s32>(width)) - 1;
+	s32 tile_max_y = std::min(tile_y + static_cast<s32>(tile_size), static_cast<s32>(height)) - 1;
+
+	// Clear the tile
+	for (s32 y = tile_y; y <= tile_max_y; y++)
+	{
+		std::fill(framebuffer + y * stride + tile_x, framebuffer + y * stride + tile_max_x + 1, clear_color);
+	}
+
+	float w1[span_width];
+	float w2[span_width];
+
+	for (u32 index : tile_bins[tile])
+	{
+		const Triangle& triangle = triangles[index];
+
+		s32 min_x = std::max(triangle.min_x, tile_x);
+		s32 min_y = std::max(triangle.min_y, tile_y);
+		s32 max_x = std::min(triangle.max_x, tile_max_x);
+		s32 max_y = std::min(triangle.max_y, tile_max_y);
+
+		Edge edges[3];
+
+		for (u8 i = 0; i < 3; i++)
+		{
+			edges[i] = { triangle.edge_a[i], triangle.edge_b[i], triangle.edge_c[i], triangle.top_left[i] };
+		}
+
+		u32 flat_color = pack_color(triangle.color);
+
+		for (s32 y = min_y; y <= max_y; y++)
+		{
+			u32* row = framebuffer + y * stride;
+
+			for (s32 x = min_x; x <= max_x; x += span_width)
+			{
+				u32 mask = coverage(edges, static_cast<float>(x), static_cast<float>(y), w1, w2);
+
+				// Mask out the pixels past the end of the span
+				if (max_x - x + 1 < static_cast<s32>(span_width))
+				{
+					mask &= (1 << (max_x - x + 1)) - 1;
+				}
+
+				for (u32 group = 0; group < span_width; group += 4)
+				{
+					if (u32 group_mask = (mask >> group) & 0xF)
+					{
+						shade_group(triangle, flat_color, group_mask, w1 + group, w2 + group, row + x + group);
+					}
+				}
+			}
+		}
+	}
+}
+
+void ImGuiSoftwareRenderer::shade_group(const Triangle& triangle, u32 flat_color, u32 mask, const float* w1, const float* w2, u32* pixels)
+{
+#if defined(SOFTWARE_RENDERER_AVX2) || defined(SOFTWARE_RENDERER_SSE2)
+	// The attributes are interpolated in the same order as a pixel at a time, so the results are identical
+	const __m128 inverse_area = _mm_set1_ps(triangle.inverse_area);
+	const __m128 b1 = _mm_mul_ps(_mm_loadu_ps(w1), inverse_area);
+	const __m128 b2 = _mm_mul_ps(_mm_loadu_ps(w2), inverse_area);
+	__m128i color = _mm_set1_epi32(static_cast<s32>(flat_color));
+
+	if (!triangle.flat_color)
+	{
+		color = _mm_setzero_si128();
+
+		for (u8 i = 0; i < 4; i++)
+		{
+			__m128 value = _mm_add_ps(_mm_add_ps(_mm_set1_ps(triangle.color[i]), _mm_mul_ps(b1, _mm_set1_ps(triangle.color_delta1[i]))), _mm_mul_ps(b2, _mm_set1_ps(triangle.color_delta2[i])));
+			value = _mm_add_ps(_mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+			color = _mm_or_si128(color, _mm_sll_epi32(_mm_cvttps_epi32(value), _mm_cvtsi32_si128(i * 8)));
+		}
+	}
+
+	// SSE2 has no gather, so each covered pixel fetches its texels on its own
+	if (triangle.texture)
+	{
+		float u[4], v[4];
+		_mm_storeu_ps(u, _mm_add_ps(_mm_add_ps(_mm_set1_ps(triangle.u), _mm_mul_ps(b1, _mm_set1_ps(triangle.u_delta1))), _mm_mul_ps(b2, _mm_set1_ps(triangle.u_delta2))));
+		_mm_storeu_ps(v, _mm_add_ps(_mm_add_ps(_mm_set1_ps(triangle.v), _mm_mul_ps(b1, _mm_set1_ps(triangle.v_delta1))), _mm_mul_ps(b2, _mm_set1_ps(triangle.v_delta2))));
+
+		u32 texels[4] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
+
+		for (u32 lane = 0; lane < 4; lane++)
+		{
+			if (mask & (1 << lane))
+			{
+				texels[lane] = sample(triangle.texture, u[lane], v[lane], bilinear_filtering);
+			}
+		}
+
+		color = modulate(color, _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels)));
+	}
+
+	if (mask == 0xF)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), blend(color, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels))));
+		return;
+	}
+
+	// Uncovered pixels may be past the tile, which another thread rasterizes, or past the framebuffer, so they aren't touched
+	u32 destination[4] = {};
+	u32 result[4];
+
+	for (u32 lane = 0; lane < 4; lane++)
+	{
+		if (mask & (1 << lane))
+		{
+			destination[lane] = pixels[lane];
+		}
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(result), blend(color, _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination))));
+
+	for (u32 lane = 0; lane < 4; lane++)
+	{
+		if (mask & (1 << lane))
+		{
+			pixels[lane] = result[lane];
+		}
+	}
+#else
+	for (u32 lane = 0; lane < 4; lane++)
+	{
+		if (!(mask & (1 << lane)))
+		{
+			continue;
+		}
+
+		float b1 = w1[lane] * triangle.inverse_area;
+		float b2 = w2[lane] * triangle.inverse_area;
+		u32 color = flat_color;
+
+		if (!triangle.flat_color)
+		{
+			float interpolated[4];
+
+			for (u8 i = 0; i < 4; i++)
+			{
+				interpolated[i] = triangle.color[i] + b1 * triangle.color_delta1[i] + b2 * triangle.color_delta2[i];
+			}
+
+			color = pack_color(interpolated);
+		}
+
+		if (triangle.texture)
+		{
+			float u = triangle.u + b1 * triangle.u_delta1 + b2 * triangle.u_delta2;
+			float v = triangle.v + b1 * triangle.v_delta1 + b2 * triangle.v_delta2;
+			color = modulate(color, sample(triangle.texture, u, v, bilinear_filtering));
+		}
+
+		pixels[lane] = blend(color, pixels[lane]);
+	}
+#endif
+}
+
+void ImGuiSoftwareRenderer::rasterize_tiles()
+{
+	ImGuiTraceScope trace("rasterize");
+	u32 tile_count = tiles_x * tiles_y;
+	u32 tile;
+
+	while ((tile = next_tile++) < tile_count)
+	{
+		rasterize_tile(tile);
+	}
+}
+
+void ImGuiSoftwareRenderer::worker_loop()
+{
+	u64 last_frame = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(worker_mutex);
+			worker_wake.wait(lock, [&] { return exiting || frame_index != last_frame; });
+
+			if (exiting)
+			{
+				return;
+			}
+
+			last_frame = frame_index;
+		}
+
+		rasterize_tiles();
+
+		std::lock_guard<std::mutex> lock(worker_mutex);
+
+		if (--busy_workers == 0)
+		{
+			worker_done.notify_one();
+		}
+	}
+}
+
+void ImGuiSoftwareRenderer::imgui_render(ImDrawData* draw_data)
+{
+	ImGuiSoftwareRenderer& renderer = *(ImGuiSoftwareRenderer*)ImGui::GetIO().UserData;
+	ImGuiTraceScope trace("render");
+
+	if (!renderer.framebuffer)
+	{
+		log(ERROR, "No framebuffer to render into.");
+		return;
+	}
+
+	renderer.triangles.clear();
+
+	for (std::vector<u32>& bin : renderer.tile_bins)
+	{
+		bin.clear();
+	}
+
+	// Set up and bin all the triangles
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+		const ImDrawVert* vertices = draw_list->VtxBuffer.Data;
+		const ImDrawIdx* indices = draw_list->IdxBuffer.Data;
+		u32 index_offset = 0;
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+
+			if (draw_cmd->UserCallback)
+			{
+				draw_cmd->UserCallback(draw_list, draw_cmd);
+			}
+			else
+			{
+				const ImGuiSoftwareTexture* texture = draw_cmd->TextureId ? static_cast<const ImGuiSoftwareTexture*>(draw_cmd->TextureId) : &renderer.font_texture;
+				
+				for (u32 k = 0; k + 2 < draw_cmd->ElemCount; k += 3)
+				{
+					const ImDrawIdx* triangle = indices + index_offset + k;
+					renderer.setup_triangle(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], draw_cmd->ClipRect, texture);
+				}
+			}
+
+			index_offset += draw_cmd->ElemCount;
+		}
+	}
+
+	// Rasterize the tiles on all the threads, including this one
+	renderer.next_tile = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(renderer.worker_mutex);
+		renderer.busy_workers = static_cast<u32>(renderer.workers.size());
+		renderer.frame_index++;
+	}
+
+	renderer.worker_wake.notify_all();
+	renderer.rasterize_tiles();
+
+	std::unique_lock<std::mutex> lock(renderer.worker_mutex);
+	renderer.worker_done.wait(lock, [&] { return renderer.busy_workers == 0; });
+}
+
+bool ImGuiSoftwareRenderer::initialize(void* handle, void* instance, void* renderer_options)
+{
+	ImGuiRenderer::initialize(handle, instance, renderer_options);
+	ImGuiSoftwareOptions& options = *(ImGuiSoftwareOptions*)renderer_options;
+
+	if (!options.framebuffer || !options.width || !options.height)
+	{
+		log(ERROR, "No framebuffer was provided for the software renderer.");
+		return false;
+	}
+
+	// Set some basic ImGui info
+	ImGuiIO& io = ImGui::GetIO();
+	io.RenderDrawListsFn = imgui_render;
+	io.UserData = this;
+
+	// Set some internal values
+	clear_color = options.clear_color;
+	bilinear_filtering = options.bilinear_filtering;
+
+	if (!handle)
+	{
+		time = 0;
+	}
+
+	set_framebuffer(options.framebuffer, options.width, options.height, options.stride);
+
+	// Copy the font atlas, as ImGui is allowed to free its copy
+	u8* pixels;
+	s32 font_width, font_height;
+
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &font_width, &font_height);
+
+	font_pixels.resize(font_width * font_height);
+	memcpy(font_pixels.data(), pixels, font_pixels.size() * sizeof(u32));
+
+	font_texture.pixels = font_pixels.data();
+	font_texture.width = static_cast<u32>(font_width);
+	font_texture.height = static_cast<u32>(font_height);
+	io.Fonts->TexID = &font_texture;
+
+	// The calling thread also rasterizes, so one less worker is needed
+	u32 thread_count = options.thread_count ? options.thread_count : std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (u32 i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(&ImGuiSoftwareRenderer::worker_loop, this);
+	}
+
+	return true;
+}
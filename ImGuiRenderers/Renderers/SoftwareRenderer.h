@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+
+// Headers
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Stores the options for the renderer, which are passed during initialization.
+struct ImGuiSoftwareOptions
+{
+	u32* framebuffer;        // RGBA8 framebuffer, which to render into. Owned by the caller
+	u32 width;               // Width of the framebuffer in pixels
+	u32 height;              // Height of the framebuffer in pixels
+	u32 stride;              // Distance between the framebuffer rows in pixels. 0 means the same as width
+	u32 clear_color;         // Colour, which to clear the framebuffer to every frame (packed like ImU32)
+	bool bilinear_filtering; // Whether to sample textures with bilinear or nearest filtering
+	u32 thread_count;        // Number of threads, which to rasterize with. 0 uses all hardware threads
+};
+
+// A texture, which can be used as an ImTextureID with the software renderer
+struct ImGuiSoftwareTexture
+{
+	const u32* pixels; // RGBA8 pixels (packed like ImU32)
+	u32 width;
+	u32 height;
+};
+
+class ImGuiSoftwareRenderer : public ImGuiRenderer
+{
+public:
+	~ImGuiSoftwareRenderer();
+	bool initialize(void* handle, void* instance, void* renderer_options);
+	void new_frame();
+
+	// Changes the framebuffer, which is rendered into, e.g. when the window is resized
+	void set_framebuffer(u32* framebuffer, u32 framebuffer_width, u32 framebuffer_height, u32 framebuffer_stride);
+
+private:
+	// A triangle after setup. Edge functions are of the form a * x + b * y + c and are positive inside the triangle.
+	struct Triangle
+	{
+		float edge_a[3];
+		float edge_b[3];
+		float edge_c[3];
+		bool top_left[3];
+		float inverse_area;
+
+		// Attributes are interpolated as attribute + barycentric1 * delta1 + barycentric2 * delta2
+		float u, u_delta1, u_delta2;
+		float v, v_delta1, v_delta2;
+		float color[4], color_delta1[4], color_delta2[4];
+		bool flat_color;
+
+		// Bounding box, already clipped against the scissor rectangle and the framebuffer
+		s32 min_x, min_y, max_x, max_y;
+		const ImGuiSoftwareTexture* texture;
+	};
+
+	// Framebuffer
+	u32* framebuffer = nullptr;
+	u32 stride = 0;
+	u32 clear_color = 0;
+	bool bilinear_filtering = false;
+
+	// For font
+	std::vector<u32> font_pixels;
+	ImGuiSoftwareTexture font_texture = {};
+
+	// Binning
+	std::vector<Triangle> triangles;
+	std::vector<std::vector<u32>> tile_bins;
+	u32 tiles_x = 0;
+	u32 tiles_y = 0;
+
+	// Worker threads, which rasterize the tiles in parallel
+	std::vector<std::thread> workers;
+	std::mutex worker_mutex;
+	std::condition_variable worker_wake;
+	std::condition_variable worker_done;
+	std::atomic<u32> next_tile;
+	u64 frame_index = 0;
+	u32 busy_workers = 0;
+	bool exiting = false;
+
+	// Internal functions for the renderer
+	void setup_triangle(const ImDrawVert& v0, const ImDrawVert& v1, const ImDrawVert& v2, const ImVec4& clip_rect, const ImGuiSoftwareTexture* texture);
+	void bin_triangle(u32 index);
+	void rasterize_tiles();
+	void rasterize_tile(u32 tile);
+	void shade_group(const Triangle& triangle, u32 flat_color, u32 mask, const float* w1, const float* w2, u32* pixels);
+	void worker_loop();
+	static void imgui_render(ImDrawData* draw_data);
+};
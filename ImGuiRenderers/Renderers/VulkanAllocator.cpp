@@ -0,0 +1,898 @@
+#include "VulkanRenderer.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the highest set bit, the value must not be 0
+static u32 find_last_set(u64 value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return index;
+#elif defined(__GNUC__)
+	return 63 - __builtin_clzll(value);
+#else
+	u32 index = 0;
+
+	while (value >>= 1)
+	{
+		index++;
+	}
+
+	return index;
+#endif
+}
+
+// Index of the lowest set bit, the value must not be 0
+static u32 find_first_set(u64 value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#elif defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	u32 index = 0;
+
+	while (!(value & 1))
+	{
+		value >>= 1;
+		index++;
+	}
+
+	return index;
+#endif
+}
+
+static u64 align_up(u64 value, u64 alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+ImGuiVulkanAllocator::~ImGuiVulkanAllocator()
+{
+	destroy();
+}
+
+bool ImGuiVulkanAllocator::initialize(const ImGuiVulkanDispatch* dispatch, const VkAllocationCallbacks* allocation_callbacks, VkInstance instance, VkPhysicalDevice physical_device, VkDevice device, bool dedicated_allocation, bool memory_budget)
+{
+	vk = dispatch;
+	this->allocation_callbacks = allocation_callbacks;
+	this->physical_device = physical_device;
+	this->device = device;
+
+	vk->vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+	heaps.assign(memory_properties.memoryHeapCount, ImGuiVulkanHeapBudget());
+
+	for (u32 i = 0; i < memory_properties.memoryHeapCount; i++)
+	{
+		heaps[i].size = memory_properties.memoryHeaps[i].size;
+		heaps[i].device_local = (memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		heap_allocated[i] = 0;
+	}
+
+	// Without the extension, the budget is estimated from the heap sizes and the usage of the allocator
+	if (memory_budget)
+	{
+		get_memory_properties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vk->vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+
+		if (!get_memory_properties2)
+		{
+			log(WARNING, "Failed to get vkGetPhysicalDeviceMemoryProperties2KHR, the memory budget is estimated.");
+		}
+	}
+
+	query_budget();
+
+	VkPhysicalDeviceProperties properties;
+	vk->vkGetPhysicalDeviceProperties(physical_device, &properties);
+	buffer_image_granularity = properties.limits.bufferImageGranularity ? properties.limits.bufferImageGranularity : 1;
+
+	// The driver can only tell us its preference through the extension
+	if (dedicated_allocation)
+	{
+		get_buffer_memory_requirements2 = (PFN_vkGetBufferMemoryRequirements2KHR)vk->vkGetDeviceProcAddr(device, "vkGetBufferMemoryRequirements2KHR");
+		get_image_memory_requirements2 = (PFN_vkGetImageMemoryRequirements2KHR)vk->vkGetDeviceProcAddr(device, "vkGetImageMemoryRequirements2KHR");
+
+		if (!get_buffer_memory_requirements2 || !get_image_memory_requirements2)
+		{
+			log(WARNING, "Failed to get the memory requirements functions, dedicated allocations are only used for large resources.");
+			get_buffer_memory_requirements2 = nullptr;
+			get_image_memory_requirements2 = nullptr;
+		}
+	}
+
+	return true;
+}
+
+void ImGuiVulkanAllocator::destroy()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!device)
+	{
+		return;
+	}
+
+	for (u32 i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].memory)
+		{
+			if (blocks[i].allocation_count)
+			{
+				log(WARNING, "Freeing a memory block with %u allocations still alive.", blocks[i].allocation_count);
+			}
+
+			destroy_block(i);
+		}
+	}
+
+	blocks.clear();
+	chunks.clear();
+	unused_chunks.clear();
+	device = VK_NULL_HANDLE;
+}
+
+bool ImGuiVulkanAllocator::allocate_buffer_memory(VkBuffer buffer, VkMemoryPropertyFlags properties, ImGuiVulkanAllocation* allocation, ImGuiVulkanMemoryPurpose purpose)
+{
+	VkMemoryRequirements memory_requirements;
+	bool prefers_dedicated = false;
+
+	if (get_buffer_memory_requirements2)
+	{
+		VkMemoryDedicatedRequirementsKHR dedicated_requirements = {};
+		dedicated_requirements.pNext = nullptr;
+		dedicated_requirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR;
+
+		VkMemoryRequirements2KHR memory_requirements2 = {};
+		memory_requirements2.pNext = &dedicated_requirements;
+		memory_requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR;
+
+		VkBufferMemoryRequirementsInfo2KHR requirements_info = {};
+		requirements_info.pNext = nullptr;
+		requirements_info.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2_KHR;
+		requirements_info.buffer = buffer;
+
+		get_buffer_memory_requirements2(device, &requirements_info, &memory_requirements2);
+
+		memory_requirements = memory_requirements2.memoryRequirements;
+		prefers_dedicated = dedicated_requirements.prefersDedicatedAllocation || dedicated_requirements.requiresDedicatedAllocation;
+	}
+	else
+	{
+		vk->vkGetBufferMemoryRequirements(device, buffer, &memory_requirements);
+	}
+
+	// Buffers are linear resources
+	return allocate(memory_requirements, prefers_dedicated, properties, true, buffer, VK_NULL_HANDLE, purpose, allocation);
+}
+
+bool ImGuiVulkanAllocator::allocate_image_memory(VkImage image, VkMemoryPropertyFlags properties, bool linear, ImGuiVulkanAllocation* allocation, ImGuiVulkanMemoryPurpose purpose)
+{
+	VkMemoryRequirements memory_requirements;
+	bool prefers_dedicated = false;
+
+	if (get_image_memory_requirements2)
+	{
+		VkMemoryDedicatedRequirementsKHR dedicated_requirements = {};
+		dedicated_requirements.pNext = nullptr;
+		dedicated_requirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR;
+
+		VkMemoryRequirements2KHR memory_requirements2 = {};
+		memory_requirements2.pNext = &dedicated_requirements;
+		memory_requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR;
+
+		VkImageMemoryRequirementsInfo2KHR requirements_info = {};
+		requirements_info.pNext = nullptr;
+		requirements_info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2_KHR;
+		requirements_info.image = image;
+
+		get_image_memory_requirements2(device, &requirements_info, &memory_requirements2);
+
+		memory_requirements = memory_requirements2.memoryRequirements;
+		prefers_dedicated = dedicated_requirements.prefersDedicatedAllocation || dedicated_requirements.requiresDedicatedAllocation;
+	}
+	else
+	{
+		vk->vkGetImageMemoryRequirements(device, image, &memory_requirements);
+	}
+
+	return allocate(memory_requirements, prefers_dedicated, properties, linear, VK_NULL_HANDLE, image, purpose, allocation);
+}
+
+bool ImGuiVulkanAllocator::allocate(const VkMemoryRequirements& requirements, bool prefers_dedicated, VkMemoryPropertyFlags properties, bool linear, VkBuffer buffer, VkImage image, ImGuiVulkanMemoryPurpose purpose, ImGuiVulkanAllocation* allocation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	VkResult result;
+	u32 memory_type = get_memory_type(requirements.memoryTypeBits, properties);
+
+	if (memory_type == no_chunk)
+	{
+		log(ERROR, "Failed to get the memory type.");
+		return false;
+	}
+
+	if (prefers_dedicated || requirements.size > block_size / 2)
+	{
+		if (!allocate_dedicated(requirements, memory_type, prefers_dedicated ? buffer : VK_NULL_HANDLE, prefers_dedicated ? image : VK_NULL_HANDLE, allocation))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// Optimal images may not share a page of bufferImageGranularity with linear resources, so they get whole pages of their own
+		u64 alignment = requirements.alignment > minimum_alignment ? requirements.alignment : minimum_alignment;
+		u64 size = align_up(requirements.size, minimum_alignment);
+
+		if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			alignment = align_up(alignment, mapped_alignment);
+		}
+
+		if (!linear && buffer_image_granularity > minimum_alignment)
+		{
+			alignment = align_up(alignment, buffer_image_granularity);
+			size = align_up(size, buffer_image_granularity);
+		}
+
+		bool allocated = false;
+
+		for (u32 i = 0; i < blocks.size() && !allocated; i++)
+		{
+			if (blocks[i].memory && blocks[i].memory_type == memory_type)
+			{
+				allocated = allocate_from_block(i, size, alignment, allocation);
+			}
+		}
+
+		if (!allocated)
+		{
+			u32 block_index;
+
+			if (!create_block(memory_type, &block_index))
+			{
+				return false;
+			}
+
+			if (!allocate_from_block(block_index, size, alignment, allocation))
+			{
+				log(ERROR, "Failed to sub-allocate %llu bytes from a new memory block.", (unsigned long long)size);
+				return false;
+			}
+		}
+	}
+
+	// Track the usage of the heap, it is untracked again when freeing
+	ImGuiVulkanHeapBudget& heap = heaps[memory_properties.memoryTypes[memory_type].heapIndex];
+	allocation->heap = memory_properties.memoryTypes[memory_type].heapIndex;
+	allocation->purpose = purpose;
+	heap.usage += allocation->size;
+	heap.purpose_usage[(u32)purpose] += allocation->size;
+
+	if (heap.usage > heap.peak_usage)
+	{
+		heap.peak_usage = heap.usage;
+	}
+
+	if (buffer && (result = vk->vkBindBufferMemory(device, buffer, allocation->memory, allocation->offset)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to bind buffer memory. (%d)", result);
+		free_allocation(*allocation);
+		return false;
+	}
+
+	if (image && (result = vk->vkBindImageMemory(device, image, allocation->memory, allocation->offset)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to bind image memory. (%d)", result);
+		free_allocation(*allocation);
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanAllocator::allocate_dedicated(const VkMemoryRequirements& requirements, u32 memory_type, VkBuffer buffer, VkImage image, ImGuiVulkanAllocation* allocation)
+{
+	VkResult result;
+
+	// Only given, when the driver asked for a dedicated allocation
+	VkMemoryDedicatedAllocateInfoKHR dedicated_info = {};
+	dedicated_info.pNext = nullptr;
+	dedicated_info.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR;
+	dedicated_info.buffer = buffer;
+	dedicated_info.image = image;
+
+	VkMemoryAllocateInfo memory_allocation_info = {};
+	memory_allocation_info.pNext = (buffer || image) ? &dedicated_info : nullptr;
+	memory_allocation_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memory_allocation_info.allocationSize = requirements.size;
+	memory_allocation_info.memoryTypeIndex = memory_type;
+
+	*allocation = ImGuiVulkanAllocation();
+
+	if ((result = vk->vkAllocateMemory(device, &memory_allocation_info, allocation_callbacks, &allocation->memory)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate dedicated memory. (%d)", result);
+		return false;
+	}
+
+	allocation->size = requirements.size;
+	allocation->dedicated = true;
+
+	if (memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		if ((result = vk->vkMapMemory(device, allocation->memory, 0, VK_WHOLE_SIZE, 0, (void**)&allocation->mapped)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to map dedicated memory. (%d)", result);
+			vk->vkFreeMemory(device, allocation->memory, allocation_callbacks);
+			allocation->memory = VK_NULL_HANDLE;
+			return false;
+		}
+	}
+
+	dedicated_count++;
+	dedicated_bytes += requirements.size;
+	heap_allocated[memory_properties.memoryTypes[memory_type].heapIndex] += requirements.size;
+
+	return true;
+}
+
+bool ImGuiVulkanAllocator::allocate_from_block(u32 block_index, u64 size, u64 alignment, ImGuiVulkanAllocation* allocation)
+{
+	Block& block = blocks[block_index];
+
+	// Chunks are aligned to the minimum alignment, so the worst case padding is known up front
+	u64 search_size = size + alignment - minimum_alignment;
+
+	if (search_size > block.size)
+	{
+		return false;
+	}
+
+	// Round up to the next size class, so that any chunk in it is large enough
+	u32 first_level = find_last_set(search_size);
+
+	if (first_level > second_level_bits)
+	{
+		search_size += (1ull << (first_level - second_level_bits)) - 1;
+	}
+
+	u32 second_level;
+	mapping(search_size, &first_level, &second_level);
+
+	if (first_level >= first_levels)
+	{
+		return false;
+	}
+
+	u32 second_level_map = block.second_level_bitmap[first_level] & (~0u << second_level);
+
+	if (!second_level_map)
+	{
+		u64 first_level_map = first_level + 1 < first_levels ? block.first_level_bitmap & (~0ull << (first_level + 1)) : 0;
+
+		if (!first_level_map)
+		{
+			return false;
+		}
+
+		first_level = find_first_set(first_level_map);
+		second_level_map = block.second_level_bitmap[first_level];
+	}
+
+	second_level = find_first_set(second_level_map);
+
+	u32 chunk_index = block.free_lists[first_level][second_level];
+	remove_free_chunk(block, chunk_index);
+
+	u64 aligned_offset = align_up(chunks[chunk_index].offset, alignment);
+	u64 padding = aligned_offset - chunks[chunk_index].offset;
+
+	// Return the padding in front of the allocation to the free lists
+	if (padding)
+	{
+		u32 front = new_chunk();
+		Chunk& chunk = chunks[chunk_index];
+		Chunk& padding_chunk = chunks[front];
+
+		padding_chunk.offset = chunk.offset;
+		padding_chunk.size = padding;
+		padding_chunk.previous_physical = chunk.previous_physical;
+		padding_chunk.next_physical = chunk_index;
+
+		if (chunk.previous_physical != no_chunk)
+		{
+			chunks[chunk.previous_physical].next_physical = front;
+		}
+		else
+		{
+			block.first_chunk = front;
+		}
+
+		chunk.previous_physical = front;
+		chunk.offset += padding;
+		chunk.size -= padding;
+
+		insert_free_chunk(block, front);
+	}
+
+	// And the rest after it
+	if (chunks[chunk_index].size - size >= minimum_alignment)
+	{
+		u32 back = new_chunk();
+		Chunk& chunk = chunks[chunk_index];
+		Chunk& rest_chunk = chunks[back];
+
+		rest_chunk.offset = chunk.offset + size;
+		rest_chunk.size = chunk.size - size;
+		rest_chunk.previous_physical = chunk_index;
+		rest_chunk.next_physical = chunk.next_physical;
+
+		if (chunk.next_physical != no_chunk)
+		{
+			chunks[chunk.next_physical].previous_physical = back;
+		}
+
+		chunk.next_physical = back;
+		chunk.size = size;
+
+		insert_free_chunk(block, back);
+	}
+
+	Chunk& chunk = chunks[chunk_index];
+	chunk.free = false;
+
+	block.allocation_count++;
+	block.used += chunk.size;
+
+	allocation->memory = block.memory;
+	allocation->offset = chunk.offset;
+	allocation->size = chunk.size;
+	allocation->mapped = block.mapped ? block.mapped + chunk.offset : nullptr;
+	allocation->block = block_index;
+	allocation->chunk = chunk_index;
+	allocation->dedicated = false;
+
+	return true;
+}
+
+void ImGuiVulkanAllocator::free_memory(ImGuiVulkanAllocation& allocation)
+{
+	if (!allocation.memory)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	free_allocation(allocation);
+}
+
+void ImGuiVulkanAllocator::free_allocation(ImGuiVulkanAllocation& allocation)
+{
+	ImGuiVulkanHeapBudget& heap = heaps[allocation.heap];
+	heap.usage -= allocation.size;
+	heap.purpose_usage[(u32)allocation.purpose] -= allocation.size;
+
+	if (allocation.dedicated)
+	{
+		// Freeing memory implicitly unmaps it
+		vk->vkFreeMemory(device, allocation.memory, allocation_callbacks);
+
+		dedicated_count--;
+		dedicated_bytes -= allocation.size;
+		heap_allocated[allocation.heap] -= allocation.size;
+		allocation = ImGuiVulkanAllocation();
+		return;
+	}
+
+	Block& block = blocks[allocation.block];
+	u32 chunk_index = allocation.chunk;
+
+	block.allocation_count--;
+	block.used -= chunks[chunk_index].size;
+
+	// Merge with the free neighbours
+	u32 previous = chunks[chunk_index].previous_physical;
+
+	if (previous != no_chunk && chunks[previous].free)
+	{
+		remove_free_chunk(block, previous);
+
+		chunks[previous].size += chunks[chunk_index].size;
+		chunks[previous].next_physical = chunks[chunk_index].next_physical;
+
+		if (chunks[chunk_index].next_physical != no_chunk)
+		{
+			chunks[chunks[chunk_index].next_physical].previous_physical = previous;
+		}
+
+		unused_chunks.push_back(chunk_index);
+		chunk_index = previous;
+	}
+
+	u32 next = chunks[chunk_index].next_physical;
+
+	if (next != no_chunk && chunks[next].free)
+	{
+		remove_free_chunk(block, next);
+
+		chunks[chunk_index].size += chunks[next].size;
+		chunks[chunk_index].next_physical = chunks[next].next_physical;
+
+		if (chunks[next].next_physical != no_chunk)
+		{
+			chunks[chunks[next].next_physical].previous_physical = chunk_index;
+		}
+
+		unused_chunks.push_back(next);
+	}
+
+	insert_free_chunk(block, chunk_index);
+
+	// Keep one empty block per memory type around, so that a resource being recreated doesn't allocate again
+	if (!block.allocation_count)
+	{
+		for (u32 i = 0; i < blocks.size(); i++)
+		{
+			if (i != allocation.block && blocks[i].memory && blocks[i].memory_type == block.memory_type && !blocks[i].allocation_count)
+			{
+				destroy_block(allocation.block);
+				break;
+			}
+		}
+	}
+
+	allocation = ImGuiVulkanAllocation();
+}
+
+ImGuiVulkanAllocatorStats ImGuiVulkanAllocator::get_stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	ImGuiVulkanAllocatorStats stats = {};
+	u64 free_bytes = 0;
+
+	for (const Block& block : blocks)
+	{
+		if (!block.memory)
+		{
+			continue;
+		}
+
+		stats.block_count++;
+		stats.allocation_count += block.allocation_count;
+		stats.block_bytes += block.size;
+		stats.used_bytes += block.used;
+
+		for (u32 i = block.first_chunk; i != no_chunk; i = chunks[i].next_physical)
+		{
+			if (chunks[i].free)
+			{
+				stats.free_range_count++;
+				free_bytes += chunks[i].size;
+
+				if (chunks[i].size > stats.largest_free_range)
+				{
+					stats.largest_free_range = chunks[i].size;
+				}
+			}
+		}
+	}
+
+	stats.dedicated_count = dedicated_count;
+	stats.dedicated_bytes = dedicated_bytes;
+	stats.device_allocations = stats.block_count + dedicated_count;
+	stats.fragmentation = free_bytes ? 1.0f - (float)stats.largest_free_range / (float)free_bytes : 0.0f;
+
+	return stats;
+}
+
+bool ImGuiVulkanAllocator::create_block(u32 memory_type, u32* block_index)
+{
+	VkResult result;
+
+	VkMemoryAllocateInfo memory_allocation_info = {};
+	memory_allocation_info.pNext = nullptr;
+	memory_allocation_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memory_allocation_info.allocationSize = block_size;
+	memory_allocation_info.memoryTypeIndex = memory_type;
+
+	Block block;
+	block.size = block_size;
+	block.memory_type = memory_type;
+
+	if ((result = vk->vkAllocateMemory(device, &memory_allocation_info, allocation_callbacks, &block.memory)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate a memory block. (%d)", result);
+		return false;
+	}
+
+	// Host visible blocks stay mapped for their whole lifetime
+	if (memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		if ((result = vk->vkMapMemory(device, block.memory, 0, VK_WHOLE_SIZE, 0, (void**)&block.mapped)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to map a memory block. (%d)", result);
+			vk->vkFreeMemory(device, block.memory, allocation_callbacks);
+			return false;
+		}
+	}
+
+	for (u32 i = 0; i < first_levels; i++)
+	{
+		for (u32 j = 0; j < second_levels; j++)
+		{
+			block.free_lists[i][j] = no_chunk;
+		}
+	}
+
+	heap_allocated[memory_properties.memoryTypes[memory_type].heapIndex] += block_size;
+
+	// Reuse the slot of a destroyed block, since allocations refer to blocks by index
+	u32 index = 0;
+
+	while (index < blocks.size() && blocks[index].memory)
+	{
+		index++;
+	}
+
+	if (index == blocks.size())
+	{
+		blocks.push_back(block);
+	}
+	else
+	{
+		blocks[index] = block;
+	}
+
+	// The whole block starts out as one free chunk
+	u32 chunk_index = new_chunk();
+	chunks[chunk_index].offset = 0;
+	chunks[chunk_index].size = block_size;
+	blocks[index].first_chunk = chunk_index;
+	insert_free_chunk(blocks[index], chunk_index);
+
+	*block_index = index;
+
+	return true;
+}
+
+void ImGuiVulkanAllocator::destroy_block(u32 block_index)
+{
+	Block& block = blocks[block_index];
+
+	for (u32 i = block.first_chunk; i != no_chunk; i = chunks[i].next_physical)
+	{
+		unused_chunks.push_back(i);
+	}
+
+	vk->vkFreeMemory(device, block.memory, allocation_callbacks);
+	heap_allocated[memory_properties.memoryTypes[block.memory_type].heapIndex] -= block.size;
+	block = Block();
+}
+
+void ImGuiVulkanAllocator::update_budget()
+{
+	std::lock_guard<std::mutex> callback_lock(callback_mutex);
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (!device)
+	{
+		return;
+	}
+
+	query_budget();
+
+	u64 exceeded_heaps = 0;
+
+	for (u32 i = 0; i < heaps.size(); i++)
+	{
+		if (heaps[i].process_usage > heaps[i].budget * budget_threshold)
+		{
+			exceeded_heaps |= 1ull << i;
+		}
+	}
+
+	if (!exceeded_heaps)
+	{
+		return;
+	}
+
+	// The empty blocks are only kept around to be reused, so they go first
+	trim_blocks();
+
+	// The callbacks free memory, so they get a copy of the budgets
+	ImGuiVulkanHeapBudget budgets[VK_MAX_MEMORY_HEAPS];
+	std::copy(heaps.begin(), heaps.end(), budgets);
+	lock.unlock();
+
+	for (u32 i = 0; i < VK_MAX_MEMORY_HEAPS; i++)
+	{
+		if (!(exceeded_heaps & (1ull << i)))
+		{
+			continue;
+		}
+
+		for (u32 j = 0; j < budget_callbacks.size(); j++)
+		{
+			budget_callbacks[j].callback(i, budgets[i], budget_callbacks[j].user_data);
+		}
+	}
+}
+
+std::vector<ImGuiVulkanHeapBudget> ImGuiVulkanAllocator::get_heap_budgets() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return heaps;
+}
+
+void ImGuiVulkanAllocator::add_budget_callback(ImGuiVulkanBudgetCallback callback, void* user_data)
+{
+	std::lock_guard<std::mutex> lock(callback_mutex);
+	budget_callbacks.push_back({ callback, user_data });
+}
+
+void ImGuiVulkanAllocator::remove_budget_callback(ImGuiVulkanBudgetCallback callback, void* user_data)
+{
+	std::lock_guard<std::mutex> lock(callback_mutex);
+
+	for (u32 i = 0; i < budget_callbacks.size(); i++)
+	{
+		if (budget_callbacks[i].callback == callback && budget_callbacks[i].user_data == user_data)
+		{
+			budget_callbacks.erase(budget_callbacks.begin() + i);
+			return;
+		}
+	}
+}
+
+void ImGuiVulkanAllocator::query_budget()
+{
+	if (get_memory_properties2)
+	{
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties = {};
+		budget_properties.pNext = nullptr;
+		budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		VkPhysicalDeviceMemoryProperties2KHR memory_properties2 = {};
+		memory_properties2.pNext = &budget_properties;
+		memory_properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+
+		get_memory_properties2(physical_device, &memory_properties2);
+
+		for (u32 i = 0; i < heaps.size(); i++)
+		{
+			heaps[i].budget = budget_properties.heapBudget[i];
+			heaps[i].process_usage = budget_properties.heapUsage[i];
+		}
+
+		return;
+	}
+
+	// Leave some room for the rest of the system, like drivers tend to
+	for (u32 i = 0; i < heaps.size(); i++)
+	{
+		heaps[i].budget = heaps[i].size / 10 * 8;
+		heaps[i].process_usage = heap_allocated[i];
+	}
+}
+
+void ImGuiVulkanAllocator::trim_blocks()
+{
+	for (u32 i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].memory && !blocks[i].allocation_count)
+		{
+			destroy_block(i);
+		}
+	}
+}
+
+u32 ImGuiVulkanAllocator::get_memory_type(u32 type_bits, VkMemoryPropertyFlags properties) const
+{
+	for (u32 i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((type_bits & (1u << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			return i;
+		}
+	}
+
+	return no_chunk;
+}
+
+u32 ImGuiVulkanAllocator::new_chunk()
+{
+	u32 chunk_index;
+
+	if (unused_chunks.empty())
+	{
+		chunk_index = (u32)chunks.size();
+		chunks.push_back(Chunk());
+	}
+	else
+	{
+		chunk_index = unused_chunks.back();
+		unused_chunks.pop_back();
+	}
+
+	Chunk& chunk = chunks[chunk_index];
+	chunk.offset = 0;
+	chunk.size = 0;
+	chunk.previous_physical = no_chunk;
+	chunk.next_physical = no_chunk;
+	chunk.previous_free = no_chunk;
+	chunk.next_free = no_chunk;
+	chunk.free = false;
+
+	return chunk_index;
+}
+
+void ImGuiVulkanAllocator::insert_free_chunk(Block& block, u32 chunk_index)
+{
+	u32 first_level, second_level;
+	mapping(chunks[chunk_index].size, &first_level, &second_level);
+
+	Chunk& chunk = chunks[chunk_index];
+	u32 head = block.free_lists[first_level][second_level];
+
+	chunk.free = true;
+	chunk.previous_free = no_chunk;
+	chunk.next_free = head;
+
+	if (head != no_chunk)
+	{
+		chunks[head].previous_free = chunk_index;
+	}
+
+	block.free_lists[first_level][second_level] = chunk_index;
+	block.first_level_bitmap |= 1ull << first_level;
+	block.second_level_bitmap[first_level] |= 1u << second_level;
+}
+
+void ImGuiVulkanAllocator::remove_free_chunk(Block& block, u32 chunk_index)
+{
+	u32 first_level, second_level;
+	mapping(chunks[chunk_index].size, &first_level, &second_level);
+
+	Chunk& chunk = chunks[chunk_index];
+
+	if (chunk.previous_free != no_chunk)
+	{
+		chunks[chunk.previous_free].next_free = chunk.next_free;
+	}
+	else
+	{
+		block.free_lists[first_level][second_level] = chunk.next_free;
+	}
+
+	if (chunk.next_free != no_chunk)
+	{
+		chunks[chunk.next_free].previous_free = chunk.previous_free;
+	}
+
+	chunk.free = false;
+	chunk.previous_free = no_chunk;
+	chunk.next_free = no_chunk;
+
+	if (block.free_lists[first_level][second_level] == no_chunk)
+	{
+		block.second_level_bitmap[first_level] &= ~(1u << second_level);
+
+		if (!block.second_level_bitmap[first_level])
+		{
+			block.first_level_bitmap &= ~(1ull << first_level);
+		}
+	}
+}
+
+void ImGuiVulkanAllocator::mapping(u64 size, u32* first_level, u32* second_level)
+{
+	// Sizes are at least the minimum alignment, which is 1 << second_level_bits, so the second level is always well defined
+	*first_level = find_last_set(size);
+	*second_level = (u32)(size >> (*first_level - second_level_bits)) ^ second_levels;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+
+// Platform-specific includes and surface extension defines
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+
+// Headers
+#include "vulkan/vulkan.h"
+#include "VulkanDispatch.h"
+#include <mutex>
+
+// What the memory of a resource is used for, to split the usage of the heaps by
+enum class ImGuiVulkanMemoryPurpose : u8
+{
+	other,
+	font,    // Font atlas
+	upload,  // Vertex, index and staging buffers
+	texture, // Streamed textures
+	layer,   // Cached layers
+};
+
+const u32 imgui_vulkan_memory_purposes = 5;
+
+// A range of device memory, which a resource is bound to
+struct ImGuiVulkanAllocation
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	u64 offset = 0;
+	u64 size = 0;
+	u8* mapped = nullptr; // Pointer to the start of the range, if the memory is host visible
+	u32 block = 0;
+	u32 chunk = 0;
+	u32 heap = 0;
+	ImGuiVulkanMemoryPurpose purpose = ImGuiVulkanMemoryPurpose::other;
+	bool dedicated = false;
+};
+
+// Statistics of the device memory used by the renderer
+struct ImGuiVulkanAllocatorStats
+{
+	u32 device_allocations;  // Number of vkAllocateMemory allocations alive
+	u32 block_count;         // Number of blocks, which are sub-allocated from
+	u32 dedicated_count;     // Number of resources with a dedicated allocation
+	u32 allocation_count;    // Number of resources sub-allocated from blocks
+	u64 block_bytes;         // Memory allocated for blocks
+	u64 used_bytes;          // Memory of the blocks used by resources
+	u64 dedicated_bytes;     // Memory of the dedicated allocations
+	u32 free_range_count;    // Number of free ranges in the blocks
+	u64 largest_free_range;  // Size of the largest free range in the blocks
+	float fragmentation;     // 0 when all the free memory is in one range, approaching 1 when it is scattered
+};
+
+// Usage and budget of a memory heap
+struct ImGuiVulkanHeapBudget
+{
+	u64 size;           // Size of the heap
+	u64 budget;         // Memory of the heap the process can use, from VK_EXT_memory_budget or 80% of the size without it
+	u64 process_usage;  // Memory of the heap used by the whole process, from VK_EXT_memory_budget or the allocator's blocks without it
+	u64 usage;          // Memory of the heap used by the resources of the allocator
+	u64 peak_usage;     // Highest usage since the allocator was initialized
+	u64 purpose_usage[imgui_vulkan_memory_purposes]; // Usage split by ImGuiVulkanMemoryPurpose
+	bool device_local;
+};
+
+// Called for each heap, whose process usage is beyond the budget threshold, so that caches can be trimmed.
+// The resources of the frames in flight may still be in use, when it is called.
+typedef void (*ImGuiVulkanBudgetCallback)(u32 heap, const ImGuiVulkanHeapBudget& budget, void* user_data);
+
+// Sub-allocates resources from large blocks per memory type with a two-level segregated fit (TLSF) allocator.
+// Resources, which the driver prefers to be dedicated, or that are too large for a block get their own allocation.
+// Windows sharing a context, their render threads and the texture streamer may allocate and free concurrently.
+class ImGuiVulkanAllocator
+{
+public:
+	~ImGuiVulkanAllocator();
+
+	// Dedicated allocations are only considered with VK_KHR_get_memory_requirements2 and VK_KHR_dedicated_allocation enabled.
+	// The budget is only queried with VK_EXT_memory_budget and VK_KHR_get_physical_device_properties2 enabled.
+	bool initialize(const ImGuiVulkanDispatch* dispatch, const VkAllocationCallbacks* allocation_callbacks, VkInstance instance, VkPhysicalDevice physical_device, VkDevice device, bool dedicated_allocation, bool memory_budget);
+
+	// Frees all the blocks. Must be called before the device is destroyed.
+	void destroy();
+
+	// Allocate memory and bind it to the resource. Host visible memory stays mapped.
+	bool allocate_buffer_memory(VkBuffer buffer, VkMemoryPropertyFlags properties, ImGuiVulkanAllocation* allocation, ImGuiVulkanMemoryPurpose purpose = ImGuiVulkanMemoryPurpose::other);
+	bool allocate_image_memory(VkImage image, VkMemoryPropertyFlags properties, bool linear, ImGuiVulkanAllocation* allocation, ImGuiVulkanMemoryPurpose purpose = ImGuiVulkanMemoryPurpose::other);
+	void free_memory(ImGuiVulkanAllocation& allocation);
+
+	ImGuiVulkanAllocatorStats get_stats() const;
+
+	// Queries the budget of the heaps. Over the threshold, the empty blocks are freed and the callbacks are called.
+	// The renderer calls it once per frame.
+	void update_budget();
+	std::vector<ImGuiVulkanHeapBudget> get_heap_budgets() const;
+
+	void add_budget_callback(ImGuiVulkanBudgetCallback callback, void* user_data);
+	void remove_budget_callback(ImGuiVulkanBudgetCallback callback, void* user_data);
+
+	// Size of the blocks, which are sub-allocated from
+	u64 block_size = 16 * 1024 * 1024;
+
+	// Fraction of the budget, beyond which the callbacks are called
+	float budget_threshold = 0.9f;
+
+private:
+	static const u32 first_levels = 64;
+	static const u32 second_level_bits = 4;
+	static const u32 second_levels = 1 << second_level_bits;
+	static const u32 no_chunk = 0xFFFFFFFF;
+	static const u64 minimum_alignment = 16;
+
+	// Host visible allocations start on a cache line, so that uploads are streamed into whole lines
+	static const u64 mapped_alignment = 64;
+
+	// A range of a block, which is linked to its physical neighbours and, when free, to the other free chunks of its size class
+	struct Chunk
+	{
+		u64 offset;
+		u64 size;
+		u32 previous_physical;
+		u32 next_physical;
+		u32 previous_free;
+		u32 next_free;
+		bool free;
+	};
+
+	struct Block
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		u64 size = 0;
+		u8* mapped = nullptr;
+		u32 memory_type = 0;
+		u32 allocation_count = 0;
+		u64 used = 0;
+		u32 first_chunk = 0;
+
+		// Free lists of the size classes and bitmaps of the non-empty ones
+		u64 first_level_bitmap = 0;
+		u32 second_level_bitmap[first_levels] = {};
+		u32 free_lists[first_levels][second_levels];
+	};
+
+	// Vulkan
+	const ImGuiVulkanDispatch* vk = nullptr;
+	const VkAllocationCallbacks* allocation_callbacks = nullptr;
+	VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+	VkDevice device = VK_NULL_HANDLE;
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	u64 buffer_image_granularity = 1;
+	PFN_vkGetBufferMemoryRequirements2KHR get_buffer_memory_requirements2 = nullptr;
+	PFN_vkGetImageMemoryRequirements2KHR get_image_memory_requirements2 = nullptr;
+
+	// Blocks and their chunks. Slots of destroyed ones are reused.
+	std::vector<Block> blocks;
+	std::vector<Chunk> chunks;
+	std::vector<u32> unused_chunks;
+
+	// Dedicated allocations
+	u32 dedicated_count = 0;
+	u64 dedicated_bytes = 0;
+
+	// Heaps and the memory of the blocks and dedicated allocations on them
+	std::vector<ImGuiVulkanHeapBudget> heaps;
+	u64 heap_allocated[VK_MAX_MEMORY_HEAPS] = {};
+	PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties2 = nullptr;
+
+	struct BudgetCallback
+	{
+		ImGuiVulkanBudgetCallback callback;
+		void* user_data;
+	};
+
+	std::vector<BudgetCallback> budget_callbacks;
+
+	// The mutex guards the blocks, chunks and heaps. The callbacks have one of their own, which is held while they are called,
+	// so that they can free memory and aren't called anymore once they are removed.
+	mutable std::mutex mutex;
+	std::mutex callback_mutex;
+
+	// Internal functions for the allocator
+	bool allocate(const VkMemoryRequirements& requirements, bool prefers_dedicated, VkMemoryPropertyFlags properties, bool linear, VkBuffer buffer, VkImage image, ImGuiVulkanMemoryPurpose purpose, ImGuiVulkanAllocation* allocation);
+	bool allocate_dedicated(const VkMemoryRequirements& requirements, u32 memory_type, VkBuffer buffer, VkImage image, ImGuiVulkanAllocation* allocation);
+	bool allocate_from_block(u32 block_index, u64 size, u64 alignment, ImGuiVulkanAllocation* allocation);
+	void free_allocation(ImGuiVulkanAllocation& allocation);
+	bool create_block(u32 memory_type, u32* block_index);
+	void destroy_block(u32 block_index);
+	u32 get_memory_type(u32 type_bits, VkMemoryPropertyFlags properties) const;
+	void query_budget();
+	void trim_blocks();
+
+	// For the chunks and free lists
+	u32 new_chunk();
+	void insert_free_chunk(Block& block, u32 chunk_index);
+	void remove_free_chunk(Block& block, u32 chunk_index);
+	static void mapping(u64 size, u32* first_level, u32* second_level);
+};
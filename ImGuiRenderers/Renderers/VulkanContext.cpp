@@ -0,0 +1,1870 @@
+#include "VulkanRenderer.h"
+#include "VulkanShaders.h"
+#include "../BlockCompression.h"
+#include "../DistanceField.h"
+#include "../Hash.h"
+#include "../Trace.h"
+#include "../MappedFile.h"
+#include "../VertexPacking.h"
+
+std::map<std::pair<VkDevice, u64>, ImGuiVulkanContext::CachedShader> ImGuiVulkanContext::shader_cache;
+std::mutex ImGuiVulkanContext::shader_cache_mutex;
+
+ImGuiVulkanContext::~ImGuiVulkanContext()
+{
+	// The shim's state is shared, so it can't outlive the table
+	vk.remove_shim();
+
+	// Must wait to make sure that the objects can be safely destroyed
+	VkResult result;
+
+	if (device)
+	{
+		if ((result = vk.vkDeviceWaitIdle(device)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to wait for the device to become idle. (%d)", result);
+			return;
+		}
+
+		// We need to check if these objects exist, or else we'll crash
+		if (render_complete)
+		{
+			vk.vkDestroySemaphore(device, render_complete, allocation_callbacks);
+		}
+
+		if (font_sampler)
+		{
+			vk.vkDestroySampler(device, font_sampler, allocation_callbacks);
+		}
+
+		allocator.free_memory(font_memory);
+
+		if (font_image_view)
+		{
+			vk.vkDestroyImageView(device, font_image_view, allocation_callbacks);
+		}
+
+		if (font_image)
+		{
+			vk.vkDestroyImage(device, font_image, allocation_callbacks);
+		}
+
+		if (pipeline)
+		{
+			vk.vkDestroyPipeline(device, pipeline, allocation_callbacks);
+		}
+
+		if (layer_pipeline)
+		{
+			vk.vkDestroyPipeline(device, layer_pipeline, allocation_callbacks);
+		}
+
+		if (composite_pipeline)
+		{
+			vk.vkDestroyPipeline(device, composite_pipeline, allocation_callbacks);
+		}
+
+		if (indirect_pipeline)
+		{
+			vk.vkDestroyPipeline(device, indirect_pipeline, allocation_callbacks);
+		}
+
+		if (quad_pipeline)
+		{
+			vk.vkDestroyPipeline(device, quad_pipeline, allocation_callbacks);
+		}
+
+		if (layer_render_pass)
+		{
+			vk.vkDestroyRenderPass(device, layer_render_pass, allocation_callbacks);
+		}
+
+		if (layer_descriptor_pool)
+		{
+			vk.vkDestroyDescriptorPool(device, layer_descriptor_pool, allocation_callbacks);
+		}
+
+		if (pipeline_cache)
+		{
+			vk.vkDestroyPipelineCache(device, pipeline_cache, allocation_callbacks);
+		}
+
+		if (pipeline_layout)
+		{
+			vk.vkDestroyPipelineLayout(device, pipeline_layout, allocation_callbacks);
+		}
+
+		if (descriptor_set_layout)
+		{
+			vk.vkDestroyDescriptorSetLayout(device, descriptor_set_layout, allocation_callbacks);
+		}
+
+		if (descriptor_set)
+		{
+			vk.vkFreeDescriptorSets(device, descriptor_pool, 1, &descriptor_set);
+		}
+
+		if (descriptor_pool)
+		{
+			vk.vkDestroyDescriptorPool(device, descriptor_pool, allocation_callbacks);
+		}
+
+		if (render_pass && !external)
+		{
+			vk.vkDestroyRenderPass(device, render_pass, allocation_callbacks);
+		}
+
+		if (vertex_shader)
+		{
+			release_shader(vertex_shader);
+		}
+
+		if (fragment_shader)
+		{
+			release_shader(fragment_shader);
+		}
+
+		if (indirect_vertex_shader)
+		{
+			release_shader(indirect_vertex_shader);
+		}
+
+		if (indirect_fragment_shader)
+		{
+			release_shader(indirect_fragment_shader);
+		}
+
+		if (quad_vertex_shader)
+		{
+			release_shader(quad_vertex_shader);
+		}
+
+		if (distance_field_shader)
+		{
+			release_shader(distance_field_shader);
+		}
+
+		// Every resource has been destroyed by now, the windows included
+		allocator.destroy();
+
+		// The host engine destroys its own objects
+		if (external)
+		{
+			return;
+		}
+
+		vk.vkDestroyDevice(device, allocation_callbacks);
+	}
+
+	if (destroy_debug_report)
+	{
+		destroy_debug_report(instance, debug_callback_function, allocation_callbacks);
+	}
+
+	if (instance)
+	{
+		vk.vkDestroyInstance(instance, allocation_callbacks);
+	}
+}
+
+// Get the first device that supports graphics output and surfaces
+u32 ImGuiVulkanContext::get_graphics_family(VkPhysicalDevice adapter, VkSurfaceKHR window_surface)
+{
+	// Get the amount of family queues
+	u32 family_queue_count;
+	vk.vkGetPhysicalDeviceQueueFamilyProperties(adapter, &family_queue_count, nullptr);
+
+	// Get list of family queues
+	std::vector<VkQueueFamilyProperties> queues(family_queue_count);
+	vk.vkGetPhysicalDeviceQueueFamilyProperties(adapter, &family_queue_count, queues.data());
+
+	for (u32 i = 0; i < queues.size(); i++)
+	{
+		if (!(queues[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			continue;
+		}
+
+		VkBool32 supported;
+
+		if (vk.vkGetPhysicalDeviceSurfaceSupportKHR(adapter, i, window_surface, &supported) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to query surface support.");
+			return 0xBAD;
+		}
+
+		if (supported)
+		{
+			return i;
+		}
+	}
+
+	return 0xBAD;
+}
+
+// Get a family, which only supports transfers, so that uploads run alongside the rendering
+u32 ImGuiVulkanContext::get_transfer_family(VkPhysicalDevice adapter)
+{
+	u32 family_queue_count;
+	vk.vkGetPhysicalDeviceQueueFamilyProperties(adapter, &family_queue_count, nullptr);
+
+	std::vector<VkQueueFamilyProperties> queues(family_queue_count);
+	vk.vkGetPhysicalDeviceQueueFamilyProperties(adapter, &family_queue_count, queues.data());
+
+	for (u32 i = 0; i < queues.size(); i++)
+	{
+		if ((queues[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queues[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+		{
+			return i;
+		}
+	}
+
+	return 0xBAD;
+}
+
+// Scores a device for the selection, or returns -1 if it can't render to the window. The type of the device outweighs
+// the optional capabilities, which outweigh the amount of device local memory, unless the memory is preferred.
+s64 ImGuiVulkanContext::score_device(VkPhysicalDevice adapter, VkSurfaceKHR window_surface, ImGuiVulkanDeviceSelection selection)
+{
+	VkPhysicalDeviceProperties properties;
+	vk.vkGetPhysicalDeviceProperties(adapter, &properties);
+
+	// Rendering needs a graphics queue, which can present, and swapchains
+	u32 extension_count = 0;
+	vk.vkEnumerateDeviceExtensionProperties(adapter, nullptr, &extension_count, nullptr);
+
+	std::vector<VkExtensionProperties> extensions(extension_count);
+	vk.vkEnumerateDeviceExtensionProperties(adapter, nullptr, &extension_count, extensions.data());
+
+	bool swapchain = false;
+
+	for (const VkExtensionProperties& extension : extensions)
+	{
+		swapchain = swapchain || !strcmp(extension.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+
+	if (!swapchain || get_graphics_family(adapter, window_surface) == 0xBAD)
+	{
+		log(INFO, "Device %s can't present to the window.", properties.deviceName);
+		return -1;
+	}
+
+	// Optional capabilities
+	VkPhysicalDeviceFeatures features;
+	vk.vkGetPhysicalDeviceFeatures(adapter, &features);
+
+	s64 capabilities = get_transfer_family(adapter) != 0xBAD;
+	capabilities += indirect_drawing && features.multiDrawIndirect && features.drawIndirectFirstInstance;
+	capabilities += imgui_index_type == VK_INDEX_TYPE_UINT32 && features.fullDrawIndexUint32;
+
+	VkPhysicalDeviceMemoryProperties device_memory;
+	vk.vkGetPhysicalDeviceMemoryProperties(adapter, &device_memory);
+
+	u64 local_memory = 0;
+
+	for (u32 i = 0; i < device_memory.memoryHeapCount; i++)
+	{
+		if (device_memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			local_memory += device_memory.memoryHeaps[i].size;
+		}
+	}
+
+	s64 memory_score = static_cast<s64>(local_memory >> 20);
+	s64 type_score = 0;
+
+	switch (properties.deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+		type_score = selection == ImGuiVulkanDeviceSelection::integrated ? 2 : 3;
+		break;
+
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+		type_score = selection == ImGuiVulkanDeviceSelection::integrated ? 3 : 2;
+		break;
+
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+		type_score = 1;
+		break;
+
+	default:
+		type_score = 0;
+		break;
+	}
+
+	// Memory in MiB fits into 32 bits, the capabilities into 8 above it
+	s64 score = selection == ImGuiVulkanDeviceSelection::most_memory ? (memory_score << 8) + capabilities : (type_score << 40) + (capabilities << 32) + memory_score;
+
+	log(INFO, "Device %s: type %d, %d optional capabilities, %llu MiB of device local memory, score %lld.", properties.deviceName, properties.deviceType, (s32)capabilities, (unsigned long long)(local_memory >> 20), (long long)score);
+
+	return score;
+}
+
+VkBool32 ImGuiVulkanContext::get_memory_type(u32 typeBits, VkFlags properties, u32 *typeIndex)
+{
+	for (u8 i = 0; i < 32; i++)
+	{
+		if ((typeBits & 1) == 1)
+		{
+			if ((memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				*typeIndex = i;
+				return true;
+			}
+		}
+
+		typeBits >>= 1;
+	}
+
+	return false;
+}
+
+VkShaderModule ImGuiVulkanContext::load_shader(std::string file_name)
+{
+	// The file is mapped instead of read, so that the SPIR-V is handed to the driver without a copy
+	ImGuiMappedFile file;
+
+	if (!file.open(file_name))
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	// Mappings are page aligned, so the code is aligned for u32 access
+	if (!file.size() || file.size() % sizeof(u32))
+	{
+		log(ERROR, "Shader file %s isn't valid SPIR-V.", file_name.c_str());
+		return VK_NULL_HANDLE;
+	}
+
+	return load_shader((const u32*)file.data(), file.size());
+}
+
+VkShaderModule ImGuiVulkanContext::load_shader(const u32* code, u64 size)
+{
+	// Contexts on the same device share the modules with the same code
+	u64 hash = hash_bytes(code, size);
+	std::lock_guard<std::mutex> lock(shader_cache_mutex);
+	auto cached = shader_cache.find(std::make_pair(device, hash));
+
+	if (cached != shader_cache.end() && cached->second.size == size)
+	{
+		cached->second.references++;
+		return cached->second.module;
+	}
+
+	VkShaderModuleCreateInfo shader_module_info = {};
+	shader_module_info.pNext = nullptr;
+	shader_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shader_module_info.codeSize = size;
+	shader_module_info.pCode = code;
+
+	VkShaderModule shader_module;
+	VkResult result;
+
+	if ((result = vk.vkCreateShaderModule(device, &shader_module_info, allocation_callbacks, &shader_module)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a shader module. (%d)", result);
+		return VK_NULL_HANDLE;
+	}
+
+	// On a hash collision the module stays uncached
+	if (cached == shader_cache.end())
+	{
+		CachedShader& entry = shader_cache[std::make_pair(device, hash)];
+		entry.module = shader_module;
+		entry.size = size;
+		entry.references = 1;
+	}
+
+	return shader_module;
+}
+
+void ImGuiVulkanContext::release_shader(VkShaderModule shader_module)
+{
+	std::lock_guard<std::mutex> lock(shader_cache_mutex);
+
+	for (auto cached = shader_cache.begin(); cached != shader_cache.end(); cached++)
+	{
+		if (cached->first.first == device && cached->second.module == shader_module)
+		{
+			if (--cached->second.references == 0)
+			{
+				vk.vkDestroyShaderModule(device, shader_module, allocation_callbacks);
+				shader_cache.erase(cached);
+			}
+
+			return;
+		}
+	}
+
+	vk.vkDestroyShaderModule(device, shader_module, allocation_callbacks);
+}
+
+VkBool32 ImGuiVulkanContext::debug_callback(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT type, u64 src, u64 location, s32 msg_code, char* prefix, char* msg, void* user_data)
+{
+	if (flags & VK_DEBUG_REPORT_ERROR_BIT_EXT)
+	{
+		log(ERROR, "[%s]: %s", prefix, msg);
+	}
+	else if (flags & VK_DEBUG_REPORT_WARNING_BIT_EXT || flags & VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT)
+	{
+		log(WARNING, "[%s]: %s", prefix, msg);
+	}
+	else
+	{
+		log(WARNING, "[%s]: %s", prefix, msg);
+	}
+
+	return false;
+}
+
+void ImGuiVulkanFrameErrors::add(VkResult call_result, const char* call_name)
+{
+	if (vulkan_debug_build)
+	{
+		log(ERROR, "%s failed. (%d)", call_name, call_result);
+	}
+
+	if (count++ == 0)
+	{
+		result = call_result;
+		call = call_name;
+	}
+}
+
+bool ImGuiVulkanFrameErrors::flush()
+{
+	if (!vulkan_debug_build)
+	{
+		log(ERROR, "Failed to render the frame, %s failed. (%d, %u failures)", call, result, count);
+	}
+
+	result = VK_SUCCESS;
+	call = nullptr;
+	count = 0;
+
+	return false;
+}
+
+bool ImGuiVulkanContext::queue_window(ImGuiVulkanRenderer* renderer)
+{
+	std::lock_guard<std::mutex> lock(queue_mutex);
+
+	for (ImGuiVulkanRenderer* pending_window : pending_windows)
+	{
+		if (pending_window == renderer)
+		{
+			log(ERROR, "The window has already been rendered this frame.");
+			return false;
+		}
+	}
+
+	pending_windows.push_back(renderer);
+	return true;
+}
+
+bool ImGuiVulkanContext::submit_frame()
+{
+	// Windows with a render thread submit from it
+	std::lock_guard<std::mutex> lock(queue_mutex);
+
+	if (pending_windows.empty())
+	{
+		return true;
+	}
+
+	// Gather all the windows for a single submission and presentation
+	command_buffers.clear();
+	wait_semaphores.clear();
+	wait_stages.clear();
+	swapchains.clear();
+	image_indices.clear();
+
+	for (ImGuiVulkanRenderer* renderer : pending_windows)
+	{
+		command_buffers.push_back(renderer->command_buffer);
+		wait_semaphores.push_back(renderer->image_acquired);
+		wait_stages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		swapchains.push_back(renderer->swapchain);
+		image_indices.push_back(renderer->current_buffer);
+	}
+
+	VkResult result;
+	bool success = true;
+	bool submitted = true;
+
+	VkSubmitInfo submit_info = {};
+	submit_info.pNext = nullptr;
+	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.waitSemaphoreCount = (u32)wait_semaphores.size();
+	submit_info.pWaitSemaphores = wait_semaphores.data();
+	submit_info.pWaitDstStageMask = wait_stages.data();
+	submit_info.commandBufferCount = (u32)command_buffers.size();
+	submit_info.pCommandBuffers = command_buffers.data();
+	submit_info.signalSemaphoreCount = 1;
+	submit_info.pSignalSemaphores = &render_complete;
+
+	VkPresentInfoKHR present_info = {};
+	present_info.pNext = nullptr;
+	present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	present_info.waitSemaphoreCount = 1;
+	present_info.pWaitSemaphores = &render_complete;
+	present_info.swapchainCount = (u32)swapchains.size();
+	present_info.pSwapchains = swapchains.data();
+	present_info.pImageIndices = image_indices.data();
+
+	ImGuiTraceScope submit_trace("submit");
+
+	if ((result = vk.vkQueueSubmit(queue, 1, &submit_info, nullptr)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to submit to the queue. (%d)", result);
+		success = false;
+		submitted = false;
+	}
+
+	submit_trace.end();
+
+	if (success)
+	{
+		ImGuiTraceScope present_trace("present");
+
+		if ((result = vk.vkQueuePresentKHR(queue, &present_info)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to present swapchain images. (%d)", result);
+			success = false;
+		}
+	}
+
+	// We need to make sure everything has finished before destroying objects and freeing memory.
+	// Only the queue is waited for, so that textures keep streaming on the transfer queue.
+	ImGuiTraceScope wait_trace("wait idle");
+
+	if ((result = vk.vkQueueWaitIdle(queue)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to wait for the queue to become idle. (%d)", result);
+		success = false;
+	}
+
+	wait_trace.end();
+
+	for (ImGuiVulkanRenderer* renderer : pending_windows)
+	{
+		renderer->release_frame_resources(submitted);
+	}
+
+	pending_windows.clear();
+
+	return success;
+}
+
+bool ImGuiVulkanContext::initialize(const ImGuiVulkanOptions& options)
+{
+	// Set some internal values
+	device_number = options.device_number;
+	device_selection = options.device_selection;
+	validation_layers = options.validation_layers && vulkan_debug_build;
+	precompiled_shaders = options.use_precompiled_shaders;
+	compact_vertices = options.compact_vertices;
+	layer_cache = options.layer_cache && !options.host;
+	indirect_drawing = options.indirect_drawing;
+	instanced_quads = options.instanced_quads;
+	distance_field_font = options.distance_field_font;
+	distance_field_spread = options.distance_field_spread;
+	font_format = options.font_format;
+	shim_mode = options.dispatch_shim;
+	allocation_callbacks = options.host && options.host->allocation_callbacks ? options.host->allocation_callbacks : options.allocation_callbacks;
+
+	if (!options.vertex_shader.empty())
+	{
+		vertex_shader_path = options.vertex_shader;
+	}
+
+	if (!options.fragment_shader.empty())
+	{
+		fragment_shader_path = options.fragment_shader;
+	}
+
+	if (options.validation_layers && !vulkan_debug_build)
+	{
+		log(WARNING, "Validation layers aren't available in release builds.");
+	}
+
+	if (options.host)
+	{
+		return prepare_host(*options.host);
+	}
+
+	// The names of validation layers
+	const char* validation_layer_names[] =
+	{
+		"VK_LAYER_LUNARG_standard_validation", "VK_LAYER_GOOGLE_unique_objects",
+		"VK_LAYER_LUNARG_api_dump",
+	};
+
+	std::vector<const char*> instance_extensions = { VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME };
+	std::vector<const char*> layer_names;
+
+	if (!vk.load_loader())
+	{
+		return false;
+	}
+
+	// The memory budget is queried through the extended physical device properties
+	u32 extension_count = 0;
+	vk.vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, nullptr);
+
+	std::vector<VkExtensionProperties> extensions(extension_count);
+	vk.vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, extensions.data());
+
+	for (const VkExtensionProperties& extension : extensions)
+	{
+		if (!strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+		{
+			instance_extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+			memory_budget = true;
+		}
+	}
+
+	// Add all the validation layers (change to 3, to enable API call dumping). The debug report is only needed for their messages
+	if (validation_layers)
+	{
+		instance_extensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
+
+		for (u8 i = 0; i < 2; i++)
+		{
+			layer_names.push_back(validation_layer_names[i]);
+		}
+	}
+
+	// Set application info
+	VkApplicationInfo application_info = {};
+	application_info.pNext = nullptr;
+	application_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	application_info.pApplicationName = "NGEmu";
+	application_info.pEngineName = "NGEmu";
+	application_info.apiVersion = VK_MAKE_VERSION(1, 0, 4);
+
+	// Set Vulkan instance info and create the instance
+	VkInstanceCreateInfo instance_info = {};
+	instance_info.pNext = nullptr;
+	instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instance_info.pApplicationInfo = &application_info;
+	instance_info.enabledLayerCount = (u32)layer_names.size();
+	instance_info.ppEnabledLayerNames = layer_names.data();
+	instance_info.enabledExtensionCount = (u32)instance_extensions.size();
+	instance_info.ppEnabledExtensionNames = instance_extensions.data();
+
+	VkResult result;
+
+	if ((result = vk.vkCreateInstance(&instance_info, allocation_callbacks, &instance)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a Vulkan instance. (%d)", result);
+		return false;
+	}
+
+	if (!vk.load_instance(instance))
+	{
+		return false;
+	}
+
+	// Release builds compile the debug report out
+	if (!vulkan_debug_build || !validation_layers)
+	{
+		return true;
+	}
+
+	// Set up the debug callback
+	create_debug_report = (PFN_vkCreateDebugReportCallbackEXT)vk.vkGetInstanceProcAddr(instance, "vkCreateDebugReportCallbackEXT");
+	destroy_debug_report = (PFN_vkDestroyDebugReportCallbackEXT)vk.vkGetInstanceProcAddr(instance, "vkDestroyDebugReportCallbackEXT");
+
+	if (!create_debug_report || !destroy_debug_report)
+	{
+		log(ERROR, "Failed to obtain debug reporting function addresses.");
+		return false;
+	}
+
+	VkDebugReportFlagsEXT flags = {};
+	flags |= VK_DEBUG_REPORT_ERROR_BIT_EXT;
+	flags |= VK_DEBUG_REPORT_WARNING_BIT_EXT;
+	flags |= VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT;
+
+	VkDebugReportCallbackCreateInfoEXT debug_callback_info = {};
+	debug_callback_info.pNext = nullptr;
+	debug_callback_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+	debug_callback_info.pfnCallback = (PFN_vkDebugReportCallbackEXT)debug_callback;
+	debug_callback_info.flags = flags;
+
+	create_debug_report(instance, &debug_callback_info, allocation_callbacks, &debug_callback_function);
+
+	return true;
+}
+
+bool ImGuiVulkanContext::prepare_host(const ImGuiVulkanHost& host)
+{
+	if (!host.instance || !host.physical_device || !host.device || !host.queue || !host.render_pass)
+	{
+		log(ERROR, "The host engine has to supply an instance, physical device, device, queue and render pass.");
+		return false;
+	}
+
+	// Use the objects of the host engine
+	external = true;
+	instance = host.instance;
+	physical_device = host.physical_device;
+	device = host.device;
+	queue = host.queue;
+	queue_family = host.queue_family;
+	transfer_queue = host.transfer_queue ? host.transfer_queue : host.queue;
+	transfer_family = host.transfer_queue ? host.transfer_family : host.queue_family;
+	render_pass = host.render_pass;
+	subpass = host.subpass;
+	samples = host.samples;
+	frames_in_flight = host.frames_in_flight ? host.frames_in_flight : 1;
+
+	// Share the entry points of the host engine, or load them for its objects
+	if (host.dispatch)
+	{
+		vk = *host.dispatch;
+	}
+	else if (!vk.load_loader() || !vk.load_instance(instance) || !vk.load_device(device))
+	{
+		return false;
+	}
+
+	vk.install_shim(shim_mode);
+
+	if (indirect_drawing && !host.indirect_drawing_features)
+	{
+		log(WARNING, "Indirect drawing needs multiDrawIndirect and drawIndirectFirstInstance enabled by the host, draws are recorded one by one.");
+		indirect_drawing = false;
+	}
+
+	texture_compression_bc = host.texture_compression_bc;
+
+	// Get the memory properties
+	vk.vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+	if (!allocator.initialize(&vk, allocation_callbacks, instance, physical_device, device, host.dedicated_allocation, host.memory_budget))
+	{
+		log(ERROR, "Failed to initialize the memory allocator.");
+		return false;
+	}
+
+	if (!prepare_pipeline())
+	{
+		log(ERROR, "Failed to prepare the pipeline.");
+		return false;
+	}
+
+	if (!prepare_font())
+	{
+		log(ERROR, "Failed to prepare the font.");
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanContext::prepare_device(VkSurfaceKHR surface)
+{
+	VkResult result;
+
+	// Windows after the first one only have to be able to present from the existing queue
+	if (device)
+	{
+		VkBool32 supported;
+
+		if ((result = vk.vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, queue_family, surface, &supported)) != VK_SUCCESS || !supported)
+		{
+			log(ERROR, "The shared queue can't present to the window surface. (%d)", result);
+			return false;
+		}
+
+		return true;
+	}
+
+	// Find an appropriate device
+	u32 device_count;
+
+	if ((result = vk.vkEnumeratePhysicalDevices(instance, &device_count, nullptr)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain the number of devices. (%d)", result);
+		return false;
+	}
+
+	std::vector<VkPhysicalDevice> adapters(device_count);
+
+	if ((result = vk.vkEnumeratePhysicalDevices(instance, &device_count, adapters.data())) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain devices. (%d)", result);
+		return false;
+	}
+
+	// The requested device is only taken, if it exists and can present to the window
+	ImGuiVulkanDeviceSelection selection = device_selection;
+
+	if (selection == ImGuiVulkanDeviceSelection::device_number)
+	{
+		if (device_number < device_count && score_device(adapters[device_number], surface, ImGuiVulkanDeviceSelection::discrete) >= 0)
+		{
+			physical_device = adapters[device_number];
+		}
+		else
+		{
+			log(WARNING, "Device %u doesn't exist or can't present to the window, the best discrete device is used instead.", device_number);
+			selection = ImGuiVulkanDeviceSelection::discrete;
+		}
+	}
+
+	if (!physical_device)
+	{
+		s64 best_score = -1;
+
+		for (u32 i = 0; i < device_count; i++)
+		{
+			s64 score = score_device(adapters[i], surface, selection);
+
+			if (score > best_score)
+			{
+				best_score = score;
+				physical_device = adapters[i];
+			}
+		}
+
+		if (!physical_device)
+		{
+			log(ERROR, "None of the %u devices can present to the window.", device_count);
+			return false;
+		}
+	}
+
+	VkPhysicalDeviceProperties device_properties;
+	vk.vkGetPhysicalDeviceProperties(physical_device, &device_properties);
+	log(INFO, "Rendering with %s.", device_properties.deviceName);
+
+	// Get the first graphic family, that supports Vulkan
+	queue_family = get_graphics_family(physical_device, surface);
+
+	if (queue_family == 0xBAD)
+	{
+		log(ERROR, "Failed to obtain a graphics family, that supports Vulkan. (%d)", result);
+		return false;
+	}
+
+	// The frame traces measure the GPU time of the windows with timestamps on the queue
+	u32 family_count;
+	vk.vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+
+	std::vector<VkQueueFamilyProperties> family_properties(family_count);
+	vk.vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, family_properties.data());
+
+	timestamp_valid_bits = family_properties[queue_family].timestampValidBits;
+	timestamp_period = device_properties.limits.timestampPeriod;
+
+	// Create a Vulkan device
+	float queue_priority = 1;
+
+	VkDeviceQueueCreateInfo device_queue_info = {};
+	device_queue_info.pNext = nullptr;
+	device_queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	device_queue_info.queueFamilyIndex = queue_family;
+	device_queue_info.queueCount = 1;
+	device_queue_info.pQueuePriorities = &queue_priority;
+
+	// Textures are streamed on a queue of their own, if there is a family for transfers only
+	VkDeviceQueueCreateInfo queue_infos[2] = { device_queue_info, device_queue_info };
+	transfer_family = get_transfer_family(physical_device);
+
+	if (transfer_family != 0xBAD)
+	{
+		queue_infos[1].queueFamilyIndex = transfer_family;
+	}
+
+	std::vector<const char*> device_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+
+	// The driver tells which resources it prefers dedicated allocations for through these extensions
+	u32 extension_count;
+	vk.vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, nullptr);
+
+	std::vector<VkExtensionProperties> extensions(extension_count);
+	vk.vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, extensions.data());
+
+	u32 dedicated_extensions = 0;
+	bool budget_extension = false;
+
+	for (const VkExtensionProperties& extension : extensions)
+	{
+		if (!strcmp(extension.extensionName, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME) || !strcmp(extension.extensionName, VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME))
+		{
+			dedicated_extensions++;
+		}
+
+		budget_extension = budget_extension || !strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+
+	bool dedicated_allocation = dedicated_extensions == 2;
+
+	if (dedicated_allocation)
+	{
+		device_extensions.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
+		device_extensions.push_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+	}
+
+	// Reports how much of each heap the process may use, which is shared with the other processes on the GPU
+	memory_budget = memory_budget && budget_extension;
+
+	if (memory_budget)
+	{
+		device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+
+	// 32-bit indices can go past the guaranteed maximum index value of 2^24 - 1
+	VkPhysicalDeviceFeatures supported_features;
+	VkPhysicalDeviceFeatures enabled_features = {};
+	vk.vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+
+	if (imgui_index_type == VK_INDEX_TYPE_UINT32)
+	{
+		enabled_features.fullDrawIndexUint32 = supported_features.fullDrawIndexUint32;
+	}
+
+	// Indirect draws put the index of the draw into the first instance and draw many of them with a single call
+	if (indirect_drawing)
+	{
+		indirect_drawing = supported_features.multiDrawIndirect && supported_features.drawIndirectFirstInstance;
+		enabled_features.multiDrawIndirect = indirect_drawing;
+		enabled_features.drawIndirectFirstInstance = indirect_drawing;
+
+		if (!indirect_drawing)
+		{
+			log(WARNING, "The device doesn't support multiDrawIndirect and drawIndirectFirstInstance, draws are recorded one by one.");
+		}
+	}
+
+	// BC4 compresses the font atlas to half a byte per pixel
+	if (font_format == ImGuiVulkanFontFormat::bc4)
+	{
+		texture_compression_bc = supported_features.textureCompressionBC;
+		enabled_features.textureCompressionBC = texture_compression_bc;
+	}
+
+	// The validation layers
+	const char* validation_layer_names[] = { "VK_LAYER_LUNARG_standard_validation", "VK_LAYER_GOOGLE_unique_objects" };
+
+	VkDeviceCreateInfo device_info = {};
+	device_info.pNext = nullptr;
+	device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	device_info.pQueueCreateInfos = queue_infos;
+	device_info.queueCreateInfoCount = transfer_family != 0xBAD ? 2 : 1;
+	device_info.enabledLayerCount = validation_layers ? 2 : 0;
+	device_info.ppEnabledLayerNames = validation_layer_names;
+	device_info.enabledExtensionCount = (u32)device_extensions.size();
+	device_info.ppEnabledExtensionNames = device_extensions.data();
+	device_info.pEnabledFeatures = &enabled_features;
+
+	if ((result = vk.vkCreateDevice(physical_device, &device_info, allocation_callbacks, &device)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a Vulkan device handle. (%d)", result);
+		return false;
+	}
+
+	// The device functions are called directly from here on
+	if (!vk.load_device(device))
+	{
+		return false;
+	}
+
+	vk.install_shim(shim_mode);
+
+	// Get the queues
+	vk.vkGetDeviceQueue(device, queue_family, 0, &queue);
+
+	if (transfer_family != 0xBAD)
+	{
+		vk.vkGetDeviceQueue(device, transfer_family, 0, &transfer_queue);
+	}
+	else
+	{
+		transfer_queue = queue;
+		transfer_family = queue_family;
+	}
+
+	// Get the memory properties
+	vk.vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+	if (!allocator.initialize(&vk, allocation_callbacks, instance, physical_device, device, dedicated_allocation, memory_budget))
+	{
+		log(ERROR, "Failed to initialize the memory allocator.");
+		return false;
+	}
+
+	// The render pass is shared, so all the windows use the surface format of the first one
+	u32 format_count;
+
+	if ((result = vk.vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, nullptr)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain the number of device surface formats. (%d)", result);
+		return false;
+	}
+
+	std::vector<VkSurfaceFormatKHR> surface_formats(format_count);
+
+	if ((result = vk.vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, surface_formats.data())) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain the surface formats. (%d)", result);
+		return false;
+	}
+
+	surface_format = surface_formats[0];
+
+	if (surface_format.format == VK_FORMAT_UNDEFINED)
+	{
+		surface_format.format = VK_FORMAT_B8G8R8A8_UNORM;
+	}
+
+	// Signalled when all the windows have been rendered for presentation
+	VkSemaphoreCreateInfo semaphore_info = {};
+	semaphore_info.pNext = nullptr;
+	semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	if ((result = vk.vkCreateSemaphore(device, &semaphore_info, allocation_callbacks, &render_complete)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a semaphore. (%d)", result);
+		return false;
+	}
+
+	if (!prepare_pipeline())
+	{
+		log(ERROR, "Failed to prepare the pipeline.");
+		return false;
+	}
+
+	if (!prepare_font())
+	{
+		log(ERROR, "Failed to prepare the font.");
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanContext::prepare_pipeline()
+{
+	VkResult result;
+
+	// Create a render pass, unless the host engine supplied one
+	VkAttachmentDescription attachement_description = {};
+	attachement_description.format = surface_format.format;
+	attachement_description.samples = VK_SAMPLE_COUNT_1_BIT;
+	attachement_description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachement_description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachement_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachement_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachement_description.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	attachement_description.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference attachment_reference = {};
+	attachment_reference.attachment = 0;
+	attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass_description = {};
+	subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass_description.colorAttachmentCount = 1;
+	subpass_description.pColorAttachments = &attachment_reference;
+
+	VkRenderPassCreateInfo render_pass_info = {};
+	render_pass_info.pNext = nullptr;
+	render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	render_pass_info.subpassCount = 1;
+	render_pass_info.pSubpasses = &subpass_description;
+	render_pass_info.attachmentCount = 1;
+	render_pass_info.pAttachments = &attachement_description;
+
+	if (!render_pass && (result = vk.vkCreateRenderPass(device, &render_pass_info, allocation_callbacks, &render_pass)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a render pass. (%d)", result);
+		return false;
+	}
+
+	// Create a descriptor set layout
+	VkDescriptorSetLayoutBinding descriptor_set_layout_binding = {};
+	descriptor_set_layout_binding.binding = 0;
+	descriptor_set_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptor_set_layout_binding.descriptorCount = 1;
+	descriptor_set_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkDescriptorSetLayoutCreateInfo descriptor_set_layout_info = {};
+	descriptor_set_layout_info.pNext = nullptr;
+	descriptor_set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptor_set_layout_info.bindingCount = 1;
+	descriptor_set_layout_info.pBindings = &descriptor_set_layout_binding;
+
+	if ((result = vk.vkCreateDescriptorSetLayout(device, &descriptor_set_layout_info, allocation_callbacks, &descriptor_set_layout)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a descriptor set layout. (%d)", result);
+		return false;
+	}
+
+	// Create the pipeline layout
+	VkPushConstantRange push_constant_range;
+	push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	push_constant_range.size = sizeof(float) * 16;
+
+	VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+	pipeline_layout_info.pNext = nullptr;
+	pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipeline_layout_info.setLayoutCount = 1;
+	pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
+	pipeline_layout_info.pushConstantRangeCount = 1;
+	pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+	if ((result = vk.vkCreatePipelineLayout(device, &pipeline_layout_info, allocation_callbacks, &pipeline_layout)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a pipeline layout. (%d)", result);
+		return false;
+	}
+
+	// Prepare vertex input bindings
+	vertex_input_binding.binding = 0;
+	vertex_input_binding.stride = compact_vertices ? sizeof(ImDrawVertPacked) : sizeof(ImDrawVert);
+	vertex_input_binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	// Prepare vertex input attributes
+	vertex_input_attribute[0].location = 0;
+	vertex_input_attribute[0].binding = 0;
+	vertex_input_attribute[0].format = VK_FORMAT_R32G32_SFLOAT;
+	vertex_input_attribute[0].offset = offsetof(ImDrawVert, pos);
+
+	vertex_input_attribute[1].location = 1;
+	vertex_input_attribute[1].binding = 0;
+	vertex_input_attribute[1].format = VK_FORMAT_R32G32_SFLOAT;
+	vertex_input_attribute[1].offset = offsetof(ImDrawVert, uv);
+
+	vertex_input_attribute[2].location = 2;
+	vertex_input_attribute[2].binding = 0;
+	vertex_input_attribute[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+	vertex_input_attribute[2].offset = offsetof(ImDrawVert, col);
+
+	// The packed formats still arrive in the shader as floats, so the same shaders are used for both layouts
+	if (compact_vertices)
+	{
+		vertex_input_attribute[0].format = VK_FORMAT_R16G16_SNORM;
+		vertex_input_attribute[0].offset = offsetof(ImDrawVertPacked, pos);
+
+		vertex_input_attribute[1].format = VK_FORMAT_R16G16_UNORM;
+		vertex_input_attribute[1].offset = offsetof(ImDrawVertPacked, uv);
+
+		vertex_input_attribute[2].offset = offsetof(ImDrawVertPacked, col);
+	}
+
+	// Create a rendering pipeline
+	// Vertex input info
+	VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
+	vertex_input_info.pNext = nullptr;
+	vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertex_input_info.vertexAttributeDescriptionCount = 3;
+	vertex_input_info.pVertexAttributeDescriptions = vertex_input_attribute;
+	vertex_input_info.vertexBindingDescriptionCount = 1;
+	vertex_input_info.pVertexBindingDescriptions = &vertex_input_binding;
+
+	// Vertex input assembly
+	VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {};
+	input_assembly_info.pNext = nullptr;
+	input_assembly_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	input_assembly_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	// Viewport info
+	VkPipelineViewportStateCreateInfo viewport_info = {};
+	viewport_info.pNext = nullptr;
+	viewport_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewport_info.viewportCount = 1;
+	viewport_info.scissorCount = 1;
+
+	// Rasterization info
+	VkPipelineRasterizationStateCreateInfo rasterization_info = {};
+	rasterization_info.pNext = nullptr;
+	rasterization_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization_info.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization_info.cullMode = VK_CULL_MODE_NONE;
+	rasterization_info.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization_info.depthClampEnable = VK_FALSE;
+	rasterization_info.rasterizerDiscardEnable = VK_FALSE;
+	rasterization_info.depthBiasEnable = VK_FALSE;
+
+	// Multisampling info
+	VkPipelineMultisampleStateCreateInfo multisample_info = {};
+	multisample_info.pNext = nullptr;
+	multisample_info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample_info.rasterizationSamples = samples;
+
+	// Depth stencil info
+	VkPipelineDepthStencilStateCreateInfo depth_stencil_info = {};
+	depth_stencil_info.pNext = nullptr;
+	depth_stencil_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	// The UI is drawn on top of the host's scene, so its depth buffer is left alone
+	depth_stencil_info.depthTestEnable = external ? VK_FALSE : VK_TRUE;
+	depth_stencil_info.depthWriteEnable = external ? VK_FALSE : VK_TRUE;
+	depth_stencil_info.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depth_stencil_info.depthBoundsTestEnable = VK_FALSE;
+	depth_stencil_info.back.failOp = VK_STENCIL_OP_KEEP;
+	depth_stencil_info.back.passOp = VK_STENCIL_OP_KEEP;
+	depth_stencil_info.back.compareOp = VK_COMPARE_OP_ALWAYS;
+	depth_stencil_info.stencilTestEnable = VK_FALSE;
+	depth_stencil_info.front = depth_stencil_info.back;
+
+	// Color blending info
+	VkPipelineColorBlendAttachmentState color_blend_attachment = {};
+	color_blend_attachment.blendEnable = VK_TRUE;
+	color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+	color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	color_blend_attachment.colorWriteMask = 0xF;
+
+	VkPipelineColorBlendStateCreateInfo color_blend_info = {};
+	color_blend_info.pNext = nullptr;
+	color_blend_info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	color_blend_info.attachmentCount = 1;
+	color_blend_info.pAttachments = &color_blend_attachment;
+
+	// Dynamic states
+	std::vector<VkDynamicState> dynamic_states =
+	{
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamic_info;
+	dynamic_info.pNext = nullptr;
+	dynamic_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamic_info.dynamicStateCount = (u32)dynamic_states.size();
+	dynamic_info.pDynamicStates = dynamic_states.data();
+
+	// Shaders
+	if (precompiled_shaders)
+	{
+		vertex_shader = load_shader(vulkan_vertex, vulkan_vertex_size);
+		fragment_shader = load_shader(vulkan_fragment, vulkan_fragment_size);
+	}
+	else
+	{
+		vertex_shader = load_shader(vertex_shader_path);
+		fragment_shader = load_shader(fragment_shader_path);
+	}
+
+	if (!vertex_shader || !fragment_shader)
+	{
+		log(ERROR, "Failed to load the shaders.");
+		return false;
+	}
+
+	VkPipelineShaderStageCreateInfo shader_info[2] = {};
+	shader_info[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shader_info[0].module = vertex_shader;
+	shader_info[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	shader_info[0].pName = "main";
+
+	shader_info[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shader_info[1].module = fragment_shader;
+	shader_info[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	shader_info[1].pName = "main";
+
+	// The font atlas is baked into a distance field, so everything but the composite of the layers samples it with the distance field shader
+	if (distance_field_font && !vulkan_sdf_fragment_size)
+	{
+		log(WARNING, "The distance field shader wasn't compiled into the build, the font atlas is baked as coverage.");
+		distance_field_font = false;
+	}
+
+	if (distance_field_font && indirect_drawing)
+	{
+		log(WARNING, "Indirect drawing has no distance field shader, draws are recorded one by one.");
+		indirect_drawing = false;
+	}
+
+	if (distance_field_font)
+	{
+		distance_field_shader = load_shader(vulkan_sdf_fragment, vulkan_sdf_fragment_size);
+
+		if (!distance_field_shader)
+		{
+			log(ERROR, "Failed to load the distance field shader.");
+			return false;
+		}
+
+		shader_info[1].module = distance_field_shader;
+	}
+
+	// Create the pipeline cache
+	VkPipelineCacheCreateInfo pipeline_cache_info = {};
+	pipeline_cache_info.pNext = nullptr;
+	pipeline_cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+	if ((result = vk.vkCreatePipelineCache(device, &pipeline_cache_info, allocation_callbacks, &pipeline_cache)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a pipeline cache. (%d)", result);
+		return false;
+	}
+
+	VkGraphicsPipelineCreateInfo pipeline_info = {};
+	pipeline_info.pNext = nullptr;
+	pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipeline_info.stageCount = 2;
+	pipeline_info.pStages = shader_info;
+	pipeline_info.pVertexInputState = &vertex_input_info;
+	pipeline_info.pInputAssemblyState = &input_assembly_info;
+	pipeline_info.pViewportState = &viewport_info;
+	pipeline_info.pRasterizationState = &rasterization_info;
+	pipeline_info.pMultisampleState = &multisample_info;
+	pipeline_info.pDepthStencilState = &depth_stencil_info;
+	pipeline_info.pColorBlendState = &color_blend_info;
+	pipeline_info.pDynamicState = &dynamic_info;
+	pipeline_info.renderPass = render_pass;
+	pipeline_info.subpass = subpass;
+	pipeline_info.layout = pipeline_layout;
+
+	if ((result = vk.vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_info, allocation_callbacks, &pipeline)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a graphics pipeline. (%d)", result);
+		return false;
+	}
+
+	// The indirect pipeline reads the clip rectangle of the draw from a second, per-instance vertex buffer
+	if (indirect_drawing && (!vulkan_indirect_vertex_size || !vulkan_indirect_fragment_size))
+	{
+		log(WARNING, "The shaders for indirect drawing weren't compiled into the build, draws are recorded one by one.");
+		indirect_drawing = false;
+	}
+
+	if (indirect_drawing)
+	{
+		indirect_vertex_shader = load_shader(vulkan_indirect_vertex, vulkan_indirect_vertex_size);
+		indirect_fragment_shader = load_shader(vulkan_indirect_fragment, vulkan_indirect_fragment_size);
+
+		if (!indirect_vertex_shader || !indirect_fragment_shader)
+		{
+			log(ERROR, "Failed to load the shaders for indirect drawing.");
+			return false;
+		}
+
+		VkVertexInputBindingDescription indirect_bindings[2] = { vertex_input_binding, {} };
+		indirect_bindings[1].binding = 1;
+		indirect_bindings[1].stride = sizeof(float) * 4;
+		indirect_bindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		VkVertexInputAttributeDescription indirect_attributes[4] = { vertex_input_attribute[0], vertex_input_attribute[1], vertex_input_attribute[2], {} };
+		indirect_attributes[3].location = 3;
+		indirect_attributes[3].binding = 1;
+		indirect_attributes[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		indirect_attributes[3].offset = 0;
+
+		VkPipelineVertexInputStateCreateInfo indirect_input_info = vertex_input_info;
+		indirect_input_info.vertexAttributeDescriptionCount = 4;
+		indirect_input_info.pVertexAttributeDescriptions = indirect_attributes;
+		indirect_input_info.vertexBindingDescriptionCount = 2;
+		indirect_input_info.pVertexBindingDescriptions = indirect_bindings;
+
+		VkPipelineShaderStageCreateInfo indirect_shader_info[2] = { shader_info[0], shader_info[1] };
+		indirect_shader_info[0].module = indirect_vertex_shader;
+		indirect_shader_info[1].module = indirect_fragment_shader;
+
+		VkGraphicsPipelineCreateInfo indirect_pipeline_info = pipeline_info;
+		indirect_pipeline_info.pStages = indirect_shader_info;
+		indirect_pipeline_info.pVertexInputState = &indirect_input_info;
+
+		if ((result = vk.vkCreateGraphicsPipelines(device, pipeline_cache, 1, &indirect_pipeline_info, allocation_callbacks, &indirect_pipeline)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create a graphics pipeline for indirect drawing. (%d)", result);
+			return false;
+		}
+	}
+
+	// Quads are read per instance and share the fragment shader with the triangles
+	if (instanced_quads && !vulkan_quad_vertex_size)
+	{
+		log(WARNING, "The shader for instanced quads wasn't compiled into the build, quads are drawn as triangles.");
+		instanced_quads = false;
+	}
+
+	if (instanced_quads)
+	{
+		quad_vertex_shader = load_shader(vulkan_quad_vertex, vulkan_quad_vertex_size);
+
+		if (!quad_vertex_shader)
+		{
+			log(ERROR, "Failed to load the shader for instanced quads.");
+			return false;
+		}
+
+		VkVertexInputBindingDescription quad_binding = {};
+		quad_binding.binding = 0;
+		quad_binding.stride = compact_vertices ? sizeof(ImDrawQuadPacked) : sizeof(ImDrawQuad);
+		quad_binding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		VkVertexInputAttributeDescription quad_attributes[3] = {};
+		quad_attributes[0].location = 0;
+		quad_attributes[0].format = compact_vertices ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32A32_SFLOAT;
+		quad_attributes[0].offset = compact_vertices ? offsetof(ImDrawQuadPacked, pos) : offsetof(ImDrawQuad, pos);
+
+		quad_attributes[1].location = 1;
+		quad_attributes[1].format = compact_vertices ? VK_FORMAT_R16G16B16A16_UNORM : VK_FORMAT_R32G32B32A32_SFLOAT;
+		quad_attributes[1].offset = compact_vertices ? offsetof(ImDrawQuadPacked, uv) : offsetof(ImDrawQuad, uv);
+
+		quad_attributes[2].location = 2;
+		quad_attributes[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+		quad_attributes[2].offset = compact_vertices ? offsetof(ImDrawQuadPacked, col) : offsetof(ImDrawQuad, col);
+
+		VkPipelineVertexInputStateCreateInfo quad_input_info = vertex_input_info;
+		quad_input_info.vertexAttributeDescriptionCount = 3;
+		quad_input_info.pVertexAttributeDescriptions = quad_attributes;
+		quad_input_info.vertexBindingDescriptionCount = 1;
+		quad_input_info.pVertexBindingDescriptions = &quad_binding;
+
+		VkPipelineShaderStageCreateInfo quad_shader_info[2] = { shader_info[0], shader_info[1] };
+		quad_shader_info[0].module = quad_vertex_shader;
+
+		VkGraphicsPipelineCreateInfo quad_pipeline_info = pipeline_info;
+		quad_pipeline_info.pStages = quad_shader_info;
+		quad_pipeline_info.pVertexInputState = &quad_input_info;
+
+		if ((result = vk.vkCreateGraphicsPipelines(device, pipeline_cache, 1, &quad_pipeline_info, allocation_callbacks, &quad_pipeline)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create a graphics pipeline for instanced quads. (%d)", result);
+			return false;
+		}
+	}
+
+	if (layer_cache)
+	{
+		// Layers start out transparent and are sampled by the composite pass afterwards
+		attachement_description.format = VK_FORMAT_R8G8B8A8_UNORM;
+		attachement_description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachement_description.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkSubpassDependency subpass_dependency = {};
+		subpass_dependency.srcSubpass = 0;
+		subpass_dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+		subpass_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpass_dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		subpass_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpass_dependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		render_pass_info.dependencyCount = 1;
+		render_pass_info.pDependencies = &subpass_dependency;
+
+		if ((result = vk.vkCreateRenderPass(device, &render_pass_info, allocation_callbacks, &layer_render_pass)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create a render pass for layers. (%d)", result);
+			return false;
+		}
+
+		// The alpha of the layer accumulates coverage, so that the colour ends up premultiplied
+		color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipeline_info.renderPass = layer_render_pass;
+		pipeline_info.subpass = 0;
+
+		if ((result = vk.vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_info, allocation_callbacks, &layer_pipeline)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create a graphics pipeline for layers. (%d)", result);
+			return false;
+		}
+
+		// Premultiplied layers are blended with one instead of their alpha, and are colours instead of distances
+		color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipeline_info.renderPass = render_pass;
+		pipeline_info.subpass = subpass;
+		shader_info[1].module = fragment_shader;
+
+		if ((result = vk.vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_info, allocation_callbacks, &composite_pipeline)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create a graphics pipeline for compositing layers. (%d)", result);
+			return false;
+		}
+	}
+
+	// Setup a descriptor pool
+	VkDescriptorPoolSize descriptor_pool_size = {};
+	descriptor_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptor_pool_size.descriptorCount = 1;
+
+	VkDescriptorPoolCreateInfo descriptor_pool_info = {};
+	descriptor_pool_info.pNext = nullptr;
+	descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptor_pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	descriptor_pool_info.poolSizeCount = 1;
+	descriptor_pool_info.pPoolSizes = &descriptor_pool_size;
+	descriptor_pool_info.maxSets = 1;
+
+	if ((result = vk.vkCreateDescriptorPool(device, &descriptor_pool_info, allocation_callbacks, &descriptor_pool)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a descriptor pool. (%d)", result);
+		return false;
+	}
+
+	// Setup up the descriptor set
+	VkDescriptorSetAllocateInfo descriptor_set_info = {};
+	descriptor_set_info.pNext = nullptr;
+	descriptor_set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptor_set_info.descriptorPool = descriptor_pool;
+	descriptor_set_info.descriptorSetCount = 1;
+	descriptor_set_info.pSetLayouts = &descriptor_set_layout;
+
+	if ((result = vk.vkAllocateDescriptorSets(device, &descriptor_set_info, &descriptor_set)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate a descriptor set. (%d)", result);
+		return false;
+	}
+
+	// Every layer samples its own image
+	if (layer_cache)
+	{
+		descriptor_pool_size.descriptorCount = max_layers;
+		descriptor_pool_info.maxSets = max_layers;
+
+		if ((result = vk.vkCreateDescriptorPool(device, &descriptor_pool_info, allocation_callbacks, &layer_descriptor_pool)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create a descriptor pool for layers. (%d)", result);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanContext::prepare_font()
+{
+	ImGuiIO& io = ImGui::GetIO();
+	VkResult result;
+
+	u8* pixels;
+	s32 width, height;
+	std::vector<u8> data;
+
+	if (distance_field_font)
+	{
+		// The distance field is baked once at the size of the atlas and only sampled differently when the scale changes
+		set_glyph_padding(*io.Fonts, (s32)distance_field_spread, 0);
+		io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+		data.resize((size_t)width * height);
+		build_distance_field(data.data(), pixels, (u32)width, (u32)height, distance_field_spread);
+		pixels = data.data();
+	}
+	else if (font_format != ImGuiVulkanFontFormat::rgba)
+	{
+		io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+	}
+	else
+	{
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	}
+
+	// Single channel atlases are read as the alpha of white through the view, so the shaders don't change. Distance fields are filtered
+	const VkFormatFeatureFlags required_features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | (distance_field_font ? (VkFormatFeatureFlags)VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT : 0);
+	const bool single_channel = distance_field_font || font_format != ImGuiVulkanFontFormat::rgba;
+	VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+	VkImageTiling tiling = VK_IMAGE_TILING_LINEAR;
+
+	if (single_channel && font_format == ImGuiVulkanFontFormat::bc4)
+	{
+		VkFormatProperties format_properties = {};
+		vk.vkGetPhysicalDeviceFormatProperties(physical_device, VK_FORMAT_BC4_UNORM_BLOCK, &format_properties);
+
+		if (texture_compression_bc && (format_properties.optimalTilingFeatures & required_features) == required_features)
+		{
+			format = VK_FORMAT_BC4_UNORM_BLOCK;
+			tiling = VK_IMAGE_TILING_OPTIMAL;
+		}
+		else
+		{
+			log(WARNING, "The device can't sample BC4 images, the font atlas is uploaded uncompressed.");
+		}
+	}
+
+	if (single_channel && format != VK_FORMAT_BC4_UNORM_BLOCK)
+	{
+		VkFormatProperties format_properties = {};
+		vk.vkGetPhysicalDeviceFormatProperties(physical_device, VK_FORMAT_R8_UNORM, &format_properties);
+
+		if ((format_properties.linearTilingFeatures & required_features) == required_features)
+		{
+			format = VK_FORMAT_R8_UNORM;
+		}
+		else
+		{
+			std::vector<u8> rgba((size_t)width * height * 4, 255);
+
+			for (size_t i = 0; i < (size_t)width * height; i++)
+			{
+				rgba[i * 4 + 3] = pixels[i];
+			}
+
+			data.swap(rgba);
+			pixels = data.data();
+		}
+	}
+
+	// Prepare font texture
+	VkImageCreateInfo image_info = {};
+	image_info.pNext = nullptr;
+	image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	image_info.imageType = VK_IMAGE_TYPE_2D;
+	image_info.format = format;
+	image_info.extent = { (u32)width, (u32)height, 1 };
+	image_info.mipLevels = 1;
+	image_info.arrayLayers = 1;
+	image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	image_info.tiling = tiling;
+	image_info.usage = tiling == VK_IMAGE_TILING_OPTIMAL ? VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT : VK_IMAGE_USAGE_SAMPLED_BIT;
+	image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	image_info.initialLayout = tiling == VK_IMAGE_TILING_OPTIMAL ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	if ((result = vk.vkCreateImage(device, &image_info, allocation_callbacks, &font_image)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a font image. (%d)", result);
+		return false;
+	}
+
+	// Linear images are written directly and coherent, so that the upload needs no flush. Compressed ones are copied into device local memory
+	VkMemoryPropertyFlags memory_flags = tiling == VK_IMAGE_TILING_OPTIMAL ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	if (!allocator.allocate_image_memory(font_image, memory_flags, tiling == VK_IMAGE_TILING_LINEAR, &font_memory, ImGuiVulkanMemoryPurpose::font))
+	{
+		log(ERROR, "Failed to allocate memory for font texture.");
+		return false;
+	}
+
+	VkImageViewCreateInfo image_view_info = {};
+	image_view_info.pNext = nullptr;
+	image_view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	image_view_info.image = font_image;
+	image_view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	image_view_info.format = format;
+	image_view_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	if (format == VK_FORMAT_R8G8B8A8_UNORM)
+	{
+		image_view_info.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+	}
+	else
+	{
+		image_view_info.components = { VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_R };
+	}
+
+	if ((result = vk.vkCreateImageView(device, &image_view_info, allocation_callbacks, &font_image_view)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create image view for font texture. (%d)", result);
+		return false;
+	}
+
+	// Distances are interpolated between the texels, which is what keeps the edges sharp when magnified
+	VkSamplerCreateInfo sampler_info;
+	sampler_info.pNext = nullptr;
+	sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	sampler_info.magFilter = distance_field_font ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+	sampler_info.minFilter = distance_field_font ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+	sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.anisotropyEnable = VK_FALSE;
+	sampler_info.maxAnisotropy = 1.0f;
+	sampler_info.compareOp = VK_COMPARE_OP_NEVER;
+	sampler_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	sampler_info.unnormalizedCoordinates = VK_FALSE;
+
+	if ((result = vk.vkCreateSampler(device, &sampler_info, allocation_callbacks, &font_sampler)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a sampler for font texture. (%d)", result);
+		return false;
+	}
+
+	// Update descriptors
+	VkDescriptorImageInfo descriptor_image_info = {};
+	descriptor_image_info.imageLayout = tiling == VK_IMAGE_TILING_OPTIMAL ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+	descriptor_image_info.sampler = font_sampler;
+	descriptor_image_info.imageView = font_image_view;
+
+	VkWriteDescriptorSet write_descriptor_set = {};
+	write_descriptor_set.pNext = nullptr;
+	write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write_descriptor_set.dstSet = descriptor_set;
+	write_descriptor_set.descriptorCount = 1;
+	write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write_descriptor_set.pImageInfo = &descriptor_image_info;
+
+	vk.vkUpdateDescriptorSets(device, 1, &write_descriptor_set, 0, nullptr);
+
+	// Upload the image to the GPU
+	if (format == VK_FORMAT_BC4_UNORM_BLOCK)
+	{
+		std::vector<u8> blocks(get_bc4_size((u32)width, (u32)height));
+		compress_bc4(blocks.data(), pixels, (u32)width, (u32)height);
+
+		return upload_font(blocks.data(), blocks.size(), (u32)width, (u32)height);
+	}
+
+	VkImageSubresource image_subresource = {};
+	image_subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+
+	VkSubresourceLayout subresource_layout = {};
+	vk.vkGetImageSubresourceLayout(device, font_image, &image_subresource, &subresource_layout);
+
+	// The memory stays mapped, its rows may be padded
+	const u32 pixel_size = format == VK_FORMAT_R8_UNORM ? 1 : 4;
+
+	for (s32 y = 0; y < height; y++)
+	{
+		memcpy(font_memory.mapped + subresource_layout.offset + y * subresource_layout.rowPitch, pixels + (size_t)y * width * pixel_size, (size_t)width * pixel_size);
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanContext::upload_font(const u8* data, u64 size, u32 width, u32 height)
+{
+	VkResult result;
+
+	// Only done once, so the queue is simply waited for and everything is destroyed again
+	VkBuffer staging = VK_NULL_HANDLE;
+	ImGuiVulkanAllocation staging_memory;
+	VkCommandPool command_pool = VK_NULL_HANDLE;
+	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+	bool success = false;
+
+	auto finish = [&]()
+	{
+		if (command_pool)
+		{
+			vk.vkDestroyCommandPool(device, command_pool, allocation_callbacks);
+		}
+
+		if (staging)
+		{
+			vk.vkDestroyBuffer(device, staging, allocation_callbacks);
+			allocator.free_memory(staging_memory);
+		}
+
+		return success;
+	};
+
+	VkBufferCreateInfo buffer_info = {};
+	buffer_info.pNext = nullptr;
+	buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_info.size = size;
+	buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if ((result = vk.vkCreateBuffer(device, &buffer_info, allocation_callbacks, &staging)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a staging buffer for the font texture. (%d)", result);
+		return finish();
+	}
+
+	if (!allocator.allocate_buffer_memory(staging, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &staging_memory, ImGuiVulkanMemoryPurpose::upload))
+	{
+		log(ERROR, "Failed to allocate memory for the staging buffer of the font texture.");
+		vk.vkDestroyBuffer(device, staging, allocation_callbacks);
+		staging = VK_NULL_HANDLE;
+		return finish();
+	}
+
+	memcpy(staging_memory.mapped, data, size);
+
+	VkCommandPoolCreateInfo command_pool_info = {};
+	command_pool_info.pNext = nullptr;
+	command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	command_pool_info.queueFamilyIndex = queue_family;
+
+	if ((result = vk.vkCreateCommandPool(device, &command_pool_info, allocation_callbacks, &command_pool)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a command pool for the font upload. (%d)", result);
+		return finish();
+	}
+
+	VkCommandBufferAllocateInfo command_buffer_allocate_info = {};
+	command_buffer_allocate_info.pNext = nullptr;
+	command_buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	command_buffer_allocate_info.commandPool = command_pool;
+	command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	command_buffer_allocate_info.commandBufferCount = 1;
+
+	if ((result = vk.vkAllocateCommandBuffers(device, &command_buffer_allocate_info, &command_buffer)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate a command buffer for the font upload. (%d)", result);
+		return finish();
+	}
+
+	VkCommandBufferBeginInfo begin_info = {};
+	begin_info.pNext = nullptr;
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if ((result = vk.vkBeginCommandBuffer(command_buffer, &begin_info)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to begin the command buffer of the font upload. (%d)", result);
+		return finish();
+	}
+
+	VkImageMemoryBarrier barrier = {};
+	barrier.pNext = nullptr;
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = font_image;
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+	vk.vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkBufferImageCopy copy = {};
+	copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	copy.imageExtent = { width, height, 1 };
+
+	vk.vkCmdCopyBufferToImage(command_buffer, staging, font_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	vk.vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	if ((result = vk.vkEndCommandBuffer(command_buffer)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to end the command buffer of the font upload. (%d)", result);
+		return finish();
+	}
+
+	VkSubmitInfo submit_info = {};
+	submit_info.pNext = nullptr;
+	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &command_buffer;
+
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+
+		if ((result = vk.vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to submit the font upload. (%d)", result);
+			return finish();
+		}
+
+		if ((result = vk.vkQueueWaitIdle(queue)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to wait for the font upload. (%d)", result);
+			return finish();
+		}
+	}
+
+	success = true;
+	return finish();
+}
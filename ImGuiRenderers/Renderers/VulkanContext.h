@@ -0,0 +1,314 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+
+// Platform-specific includes and surface extension defines
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+
+// Headers
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "vulkan/vulkan.h"
+#include "VulkanAllocator.h"
+
+// The index type is derived from ImDrawIdx, which ImGui allows to be redefined as a 32-bit type
+template<size_t Size> struct VulkanIndexType;
+template<> struct VulkanIndexType<2> { static const VkIndexType value = VK_INDEX_TYPE_UINT16; };
+template<> struct VulkanIndexType<4> { static const VkIndexType value = VK_INDEX_TYPE_UINT32; };
+const VkIndexType imgui_index_type = VulkanIndexType<sizeof(ImDrawIdx)>::value;
+
+// Release builds, with IMGUI_RENDERERS_RELEASE defined, leave out the debug report and the validation layers, and only
+// log the first failure of the render loop once per frame
+#ifdef IMGUI_RENDERERS_RELEASE
+const bool vulkan_debug_build = false;
+#else
+const bool vulkan_debug_build = true;
+#endif
+
+class ImGuiVulkanContext;
+class ImGuiVulkanRenderer;
+
+// Vulkan objects of a host engine, which the renderer is embedded into. They stay owned by the host.
+struct ImGuiVulkanHost
+{
+	VkInstance instance;
+	VkPhysicalDevice physical_device;
+	VkDevice device;
+	VkQueue queue;
+	u32 queue_family;
+	VkRenderPass render_pass;                            // Render pass, which the draws are recorded into
+	u32 subpass = 0;                                     // Subpass of the render pass, which the draws are recorded into
+	VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT; // Sample count of the colour attachment
+	u32 frames_in_flight = 2;                            // Number of frames the host may have in flight, before the buffers of a frame are reused
+	bool dedicated_allocation = false;                   // Whether VK_KHR_get_memory_requirements2 and VK_KHR_dedicated_allocation are enabled on the device
+	bool indirect_drawing_features = false;              // Whether the multiDrawIndirect and drawIndirectFirstInstance features are enabled on the device
+	VkQueue transfer_queue = VK_NULL_HANDLE;             // Queue of a transfer family, which streams the textures. Without one they are uploaded on the queue
+	u32 transfer_family = 0;
+	bool memory_budget = false;                          // Whether VK_EXT_memory_budget is enabled on the device and VK_KHR_get_physical_device_properties2 on the instance
+	bool texture_compression_bc = false;                 // Whether the textureCompressionBC feature is enabled on the device, for ImGuiVulkanFontFormat::bc4
+	const ImGuiVulkanDispatch* dispatch = nullptr;       // Entry points of the host engine, which are copied. nullptr loads them from the Vulkan loader
+	const VkAllocationCallbacks* allocation_callbacks = nullptr; // Host memory callbacks of the host engine for the objects of the renderer. nullptr uses the ones in the options
+};
+
+// How the device is chosen among the ones, which can present to the window
+enum class ImGuiVulkanDeviceSelection : u8
+{
+	device_number, // The device with device_number, or the best discrete one if it can't present to the window
+	discrete,      // Prefers discrete GPUs for performance
+	integrated,    // Prefers integrated GPUs to save power
+	most_memory,   // Prefers the most device local memory
+};
+
+// Format of the font atlas image. The single channel formats are read as the alpha of white through the view.
+enum class ImGuiVulkanFontFormat : u8
+{
+	rgba,  // RGBA8, the default, which keeps coloured pixels written into the RGBA32 data
+	alpha, // R8, a quarter of the memory of RGBA8
+	bc4,   // BC4 compressed on the CPU, an eighth of the memory of RGBA8. R8 if the device can't sample it
+};
+
+// Stores the options for the renderer, which are passed during initialization.
+struct ImGuiVulkanOptions
+{
+	VkClearValue clear_value;     // Colour, which to clear the screen to every frame
+	u8 device_number;             // Number of the device, which to use for rendering
+	ImGuiVulkanDeviceSelection device_selection = ImGuiVulkanDeviceSelection::device_number; // How to choose the device for rendering
+	bool validation_layers;       // Whether to enable Vulkan validation layers or not
+	bool use_precompiled_shaders; // Whether to use included precompiled shaders or not
+	std::string vertex_shader;    // Vertex shader path.   Default path: "../shaders/imgui.vert.spv"
+	std::string fragment_shader;  // Fragment shader path. Default path: "../shaders/imgui.frag.spv"
+	bool compact_vertices = false; // Whether to upload vertices in the packed 12 byte format instead of the 20 byte ImDrawVert
+	ImGuiVulkanContext* shared_context = nullptr; // Context to share the device with other windows. nullptr creates one for this window only
+	bool defer_submission = false; // Whether to leave submitting and presenting to ImGuiVulkanContext::submit_frame
+	const ImGuiVulkanHost* host = nullptr; // Objects of the host engine. No window is created and draws are only recorded with ImGuiVulkanRenderer::record
+	bool layer_cache = false;      // Whether to cache draw lists, which stay unchanged, in offscreen layers. Not available with a host engine
+	u64 layer_cache_budget = 64 * 1024 * 1024; // Memory budget of the layers of a window in bytes
+	u32 upload_thread_count = 1;   // Threads, which copy the uploads of large frames into mapped memory. 1 copies on the rendering thread only
+	u64 parallel_upload_bytes = 4 * 1024 * 1024; // Uploads of a frame, from which on the copy is split across the upload threads
+	bool indirect_drawing = false; // Whether to draw the whole frame with indirect draws, which are clipped in the fragment shader. Replaces the layer cache
+	bool instanced_quads = false;  // Whether to upload runs of axis-aligned quads, like glyphs, as one instance each instead of 4 vertices and 6 indices. Not used for layers and indirect drawing
+	bool render_thread = false;    // Whether to upload, record, submit and present on a thread of its own, while ImGui builds the next frame. Not available with a host engine or deferred submission
+	ImGuiVulkanShimMode dispatch_shim = ImGuiVulkanShimMode::none; // Whether to count or time the calls of the device functions, see ImGuiVulkanDispatch::get_call_stats
+	bool distance_field_font = false; // Whether to bake the font atlas into a distance field once, so text stays sharp at any scale. Not available with descriptor sets as textures or indirect drawing
+	u32 distance_field_spread = 4;   // Pixels, over which the distance field falls off around the edges of the glyphs
+	ImGuiVulkanFontFormat font_format = ImGuiVulkanFontFormat::rgba; // Format of the font atlas image. R8 and BC4 are opt-in. Distance fields are never RGBA8
+	const VkAllocationCallbacks* allocation_callbacks = nullptr; // Host memory callbacks, which every Vulkan object and allocation is created and destroyed with. nullptr uses the driver's. Must outlive the context
+};
+
+// Statistics of the last rendered frame
+struct ImGuiVulkanStats
+{
+	u64 vertex_count;       // Number of vertices uploaded
+	u64 vertex_bytes;       // Bytes of vertex data uploaded
+	u64 index_bytes;        // Bytes of index data uploaded
+	u64 vertex_bytes_saved; // Bytes of vertex data saved by the compact vertex format
+	u64 layer_hits;         // Draw lists composited from their cached layer
+	u64 layer_misses;       // Draw lists, which had to be rasterized
+	u64 layer_bytes;        // Memory used by the cached layers
+	u64 copied_bytes;       // Bytes copied into mapped memory with streaming stores, packed vertices aren't copied
+	u64 copy_nanoseconds;   // Time spent on the copies, copied_bytes / copy_nanoseconds is the copy bandwidth
+	u64 draw_calls;         // Draw calls recorded, a single indirect draw counts once
+	u64 quad_count;         // Quads uploaded as instances
+	u64 quad_bytes;         // Bytes of the quad instances
+	u64 frame_nanoseconds;  // CPU time of the frame, from acquiring the image or the start of record until the draws are recorded
+};
+
+// Collects the results of the Vulkan calls in the render loop, so that a frame is checked at a few points instead of
+// after every call. Debug builds also log each failure where it happens.
+struct ImGuiVulkanFrameErrors
+{
+	VkResult result = VK_SUCCESS; // First failure of the frame
+	const char* call = nullptr;   // Name of the call, which failed first
+	u32 count = 0;                // Failures in the frame
+
+	// Returns whether the call succeeded, for the calls depending on it
+	bool check(VkResult call_result, const char* call_name)
+	{
+		if (call_result == VK_SUCCESS)
+		{
+			return true;
+		}
+
+		add(call_result, call_name);
+		return false;
+	}
+
+	// Logs the failures of the frame and clears them. Returns whether there were none
+	bool report()
+	{
+		return count == 0 || flush();
+	}
+
+private:
+	void add(VkResult call_result, const char* call_name);
+	bool flush();
+};
+
+// Statistics of the render thread
+struct ImGuiVulkanRenderThreadStats
+{
+	u32 queue_depth;         // Frames handed off and not rendered yet, including the one being rendered
+	u64 handoff_nanoseconds; // Time from the handoff of the last frame until the render thread started on it
+	u64 wait_nanoseconds;    // Time the UI thread waited for a free snapshot at the last handoff
+	u64 frames_rendered;
+};
+
+// Statistics of the cached layer of a draw list
+struct ImGuiVulkanLayerStats
+{
+	const ImDrawList* draw_list;
+	const char* name; // Name of the window owning the draw list, if ImGui provides it
+	u64 hits;         // Frames composited from the cached layer
+	u64 misses;       // Frames, in which the draw list had to be rasterized
+	u64 bytes;        // Memory used by the layer
+};
+
+// Holds everything, which is shared between the windows rendering on the same device:
+// the instance, device, queue, pipeline and font atlas. Windows are lightweight in comparison.
+class ImGuiVulkanContext
+{
+public:
+	~ImGuiVulkanContext();
+
+	// Creates the instance. The device is created with the first window, as the queue has to be able to present to it.
+	// With host objects in the options, those are used instead and only the pipeline and font are created.
+	bool initialize(const ImGuiVulkanOptions& options);
+
+	// Submits all the windows rendered since the last call in a single submission and presents them
+	bool submit_frame();
+
+	// Vulkan
+	ImGuiVulkanDispatch vk; // Entry points, which all the Vulkan calls go through
+	VkInstance instance = VK_NULL_HANDLE;
+	VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+	VkDevice device = VK_NULL_HANDLE;
+	const VkAllocationCallbacks* allocation_callbacks = nullptr; // Passed to every create, allocate, destroy and free call
+	VkQueue queue = VK_NULL_HANDLE;
+	u32 queue_family = 0;
+	VkQueue transfer_queue = VK_NULL_HANDLE; // Queue of a transfer-only family if the device has one, otherwise the queue
+	u32 transfer_family = 0;
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	VkSurfaceFormatKHR surface_format;
+	float timestamp_period = 0; // Nanoseconds per timestamp tick
+	u32 timestamp_valid_bits = 0; // Valid bits of the timestamps of the queue, 0 if it can't write any
+	std::mutex queue_mutex; // Serializes the submissions of the windows, their render threads and the texture streamer
+
+	// Rendering
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+	VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+	VkVertexInputAttributeDescription vertex_input_attribute[3];
+	VkVertexInputBindingDescription vertex_input_binding;
+	VkRenderPass render_pass = VK_NULL_HANDLE;
+	VkShaderModule vertex_shader = VK_NULL_HANDLE;
+	VkShaderModule fragment_shader = VK_NULL_HANDLE;
+	bool compact_vertices = false;
+
+	// Whether the instance, device and render pass belong to a host engine
+	bool external = false;
+	u32 frames_in_flight = 2;
+
+	// Layers are rendered with premultiplied alpha into their own render pass and composited with it
+	VkRenderPass layer_render_pass = VK_NULL_HANDLE;
+	VkPipeline layer_pipeline = VK_NULL_HANDLE;
+	VkPipeline composite_pipeline = VK_NULL_HANDLE;
+	VkDescriptorPool layer_descriptor_pool = VK_NULL_HANDLE;
+	bool layer_cache = false;
+	static const u32 max_layers = 256;
+
+	// Draws the frame with indirect draws, whose first instance selects the clip rectangle of the draw
+	VkPipeline indirect_pipeline = VK_NULL_HANDLE;
+	VkShaderModule indirect_vertex_shader = VK_NULL_HANDLE;
+	VkShaderModule indirect_fragment_shader = VK_NULL_HANDLE;
+	bool indirect_drawing = false;
+
+	// Draws runs of quads as instances, which the vertex shader expands into two triangles
+	VkPipeline quad_pipeline = VK_NULL_HANDLE;
+	VkShaderModule quad_vertex_shader = VK_NULL_HANDLE;
+	bool instanced_quads = false;
+
+	// The font atlas is a distance field, which the fragment shader turns back into coverage
+	VkShaderModule distance_field_shader = VK_NULL_HANDLE;
+	bool distance_field_font = false;
+	u32 distance_field_spread = 4;
+
+	// Device memory of all the resources is sub-allocated from here
+	ImGuiVulkanAllocator allocator;
+
+	// For convenience
+	VkBool32 get_memory_type(u32 typeBits, VkFlags properties, u32 *typeIndex);
+
+private:
+	friend class ImGuiVulkanRenderer;
+
+	// For debug output
+	PFN_vkCreateDebugReportCallbackEXT create_debug_report = nullptr;
+	PFN_vkDestroyDebugReportCallbackEXT destroy_debug_report = nullptr;
+	VkDebugReportCallbackEXT debug_callback_function = VK_NULL_HANDLE;
+	static VkBool32 debug_callback(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT type, u64 src, u64 location, s32 msg_code, char* prefix, char* msg, void* user_data);
+
+	// For font
+	VkImage font_image = VK_NULL_HANDLE;
+	VkImageView font_image_view = VK_NULL_HANDLE;
+	VkSampler font_sampler = VK_NULL_HANDLE; // Also samples the streamed textures
+	ImGuiVulkanAllocation font_memory;
+	ImGuiVulkanFontFormat font_format = ImGuiVulkanFontFormat::rgba;
+	bool texture_compression_bc = false; // Whether the textureCompressionBC feature is enabled
+
+	// Windows, which have been rendered and are waiting for submission
+	std::vector<ImGuiVulkanRenderer*> pending_windows;
+	VkSemaphore render_complete = VK_NULL_HANDLE;
+
+	// Arrays of the submission, which keep their capacity between frames
+	std::vector<VkCommandBuffer> command_buffers;
+	std::vector<VkSemaphore> wait_semaphores;
+	std::vector<VkPipelineStageFlags> wait_stages;
+	std::vector<VkSwapchainKHR> swapchains;
+	std::vector<u32> image_indices;
+
+	// For convenience
+	u32 get_graphics_family(VkPhysicalDevice adapter, VkSurfaceKHR window_surface);
+	u32 get_transfer_family(VkPhysicalDevice adapter);
+	s64 score_device(VkPhysicalDevice adapter, VkSurfaceKHR window_surface, ImGuiVulkanDeviceSelection selection);
+	VkShaderModule load_shader(std::string file_name);
+	VkShaderModule load_shader(const u32* code, u64 size);
+	void release_shader(VkShaderModule shader_module);
+
+	// Shader modules are shared between the contexts on the same device and found by the hash of their code
+	struct CachedShader
+	{
+		VkShaderModule module;
+		u64 size;
+		u32 references;
+	};
+
+	static std::map<std::pair<VkDevice, u64>, CachedShader> shader_cache;
+	static std::mutex shader_cache_mutex;
+
+	// Internal functions for the context
+	bool prepare_device(VkSurfaceKHR surface);
+	bool prepare_host(const ImGuiVulkanHost& host);
+	bool prepare_pipeline();
+	bool prepare_font();
+	bool upload_font(const u8* data, u64 size, u32 width, u32 height);
+	bool queue_window(ImGuiVulkanRenderer* renderer);
+
+	// Internal values
+	u8 device_number;
+	ImGuiVulkanDeviceSelection device_selection = ImGuiVulkanDeviceSelection::device_number;
+	bool validation_layers;
+	bool precompiled_shaders;
+	bool memory_budget = false; // Whether VK_KHR_get_physical_device_properties2 is enabled, and after creating the device VK_EXT_memory_budget too
+	ImGuiVulkanShimMode shim_mode = ImGuiVulkanShimMode::none;
+	u32 subpass = 0;
+	VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+	std::string vertex_shader_path = "../shaders/imgui.vert.spv";
+	std::string fragment_shader_path = "../shaders/imgui.frag.spv";
+};
@@ -0,0 +1,219 @@
+#include "VulkanRenderer.h"
+
+#include <atomic>
+#include <chrono>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+// Indices of the device functions, for the state of the shim
+enum ImGuiVulkanDeviceFunction : u32
+{
+#define IMGUI_VULKAN_FUNCTION_INDEX(name) function_##name,
+	IMGUI_VULKAN_DEVICE_FUNCTIONS(IMGUI_VULKAN_FUNCTION_INDEX)
+#undef IMGUI_VULKAN_FUNCTION_INDEX
+	device_function_count
+};
+
+static const char* device_function_names[device_function_count] =
+{
+#define IMGUI_VULKAN_FUNCTION_NAME(name) #name,
+	IMGUI_VULKAN_DEVICE_FUNCTIONS(IMGUI_VULKAN_FUNCTION_NAME)
+#undef IMGUI_VULKAN_FUNCTION_NAME
+};
+
+// State of the shim, shared by the wrappers
+static PFN_vkVoidFunction shim_functions[device_function_count];
+static std::atomic<u64> shim_calls[device_function_count];
+static std::atomic<u64> shim_nanoseconds[device_function_count];
+static ImGuiVulkanShimMode shim_mode = ImGuiVulkanShimMode::none;
+static ImGuiVulkanDispatch* shim_table = nullptr;
+
+// Records a call, when it goes out of scope
+struct ImGuiVulkanShimScope
+{
+	u32 index;
+	std::chrono::steady_clock::time_point start;
+
+	ImGuiVulkanShimScope(u32 function_index) : index(function_index)
+	{
+		if (shim_mode == ImGuiVulkanShimMode::timing)
+		{
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~ImGuiVulkanShimScope()
+	{
+		shim_calls[index].fetch_add(1, std::memory_order_relaxed);
+
+		if (shim_mode == ImGuiVulkanShimMode::timing)
+		{
+			u64 nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			shim_nanoseconds[index].fetch_add(nanoseconds, std::memory_order_relaxed);
+		}
+	}
+};
+
+// A wrapper with the signature of the function, which calls the function it replaced
+template<u32 Index, typename Function> struct ImGuiVulkanShim;
+
+template<u32 Index, typename Result, typename... Arguments>
+struct ImGuiVulkanShim<Index, Result (VKAPI_PTR*)(Arguments...)>
+{
+	static Result VKAPI_PTR call(Arguments... arguments)
+	{
+		ImGuiVulkanShimScope scope(Index);
+		return reinterpret_cast<Result (VKAPI_PTR*)(Arguments...)>(shim_functions[Index])(arguments...);
+	}
+};
+
+bool ImGuiVulkanDispatch::load_loader(PFN_vkGetInstanceProcAddr get_instance_proc_addr)
+{
+	vkGetInstanceProcAddr = get_instance_proc_addr;
+
+	// The library stays loaded for the lifetime of the process
+	if (!vkGetInstanceProcAddr)
+	{
+#ifdef _WIN32
+		HMODULE library = LoadLibraryA("vulkan-1.dll");
+
+		if (library)
+		{
+			vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)GetProcAddress(library, "vkGetInstanceProcAddr");
+		}
+#else
+		void* library = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+
+		if (library)
+		{
+			vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)dlsym(library, "vkGetInstanceProcAddr");
+		}
+#endif
+	}
+
+	if (!vkGetInstanceProcAddr)
+	{
+		log(ERROR, "Failed to load the Vulkan loader.");
+		return false;
+	}
+
+#define IMGUI_VULKAN_LOAD_GLOBAL(name) name = (PFN_##name)vkGetInstanceProcAddr(VK_NULL_HANDLE, #name);
+	IMGUI_VULKAN_GLOBAL_FUNCTIONS(IMGUI_VULKAN_LOAD_GLOBAL)
+#undef IMGUI_VULKAN_LOAD_GLOBAL
+
+	if (!vkCreateInstance || !vkEnumerateInstanceExtensionProperties)
+	{
+		log(ERROR, "Failed to get the global Vulkan functions.");
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanDispatch::load_instance(VkInstance instance)
+{
+	bool loaded = true;
+
+#define IMGUI_VULKAN_LOAD_INSTANCE(name) name = (PFN_##name)vkGetInstanceProcAddr(instance, #name); loaded = loaded && name;
+	IMGUI_VULKAN_INSTANCE_FUNCTIONS(IMGUI_VULKAN_LOAD_INSTANCE)
+#undef IMGUI_VULKAN_LOAD_INSTANCE
+
+	if (!loaded)
+	{
+		log(ERROR, "Failed to get the Vulkan instance functions.");
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanDispatch::load_device(VkDevice device)
+{
+	bool loaded = true;
+
+#define IMGUI_VULKAN_LOAD_DEVICE(name) name = (PFN_##name)vkGetDeviceProcAddr(device, #name); loaded = loaded && name;
+	IMGUI_VULKAN_DEVICE_FUNCTIONS(IMGUI_VULKAN_LOAD_DEVICE)
+#undef IMGUI_VULKAN_LOAD_DEVICE
+
+	if (!loaded)
+	{
+		log(ERROR, "Failed to get the Vulkan device functions.");
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanDispatch::install_shim(ImGuiVulkanShimMode mode)
+{
+	if (mode == ImGuiVulkanShimMode::none)
+	{
+		remove_shim();
+		return true;
+	}
+
+	if (shim_table && shim_table != this)
+	{
+		log(WARNING, "The Vulkan shim is already installed on another dispatch table.");
+		return false;
+	}
+
+	if (!shim_table)
+	{
+#define IMGUI_VULKAN_INSTALL_SHIM(name) \
+		shim_functions[function_##name] = (PFN_vkVoidFunction)name; \
+		name = &ImGuiVulkanShim<function_##name, PFN_##name>::call;
+		IMGUI_VULKAN_DEVICE_FUNCTIONS(IMGUI_VULKAN_INSTALL_SHIM)
+#undef IMGUI_VULKAN_INSTALL_SHIM
+
+		shim_table = this;
+		reset_call_stats();
+	}
+
+	shim_mode = mode;
+
+	return true;
+}
+
+void ImGuiVulkanDispatch::remove_shim()
+{
+	if (shim_table != this)
+	{
+		return;
+	}
+
+#define IMGUI_VULKAN_REMOVE_SHIM(name) name = (PFN_##name)shim_functions[function_##name];
+	IMGUI_VULKAN_DEVICE_FUNCTIONS(IMGUI_VULKAN_REMOVE_SHIM)
+#undef IMGUI_VULKAN_REMOVE_SHIM
+
+	shim_table = nullptr;
+	shim_mode = ImGuiVulkanShimMode::none;
+}
+
+std::vector<ImGuiVulkanCallStats> ImGuiVulkanDispatch::get_call_stats()
+{
+	std::vector<ImGuiVulkanCallStats> stats;
+
+	for (u32 i = 0; i < device_function_count; i++)
+	{
+		u64 calls = shim_calls[i].load(std::memory_order_relaxed);
+
+		if (calls)
+		{
+			stats.push_back({ device_function_names[i], calls, shim_nanoseconds[i].load(std::memory_order_relaxed) });
+		}
+	}
+
+	return stats;
+}
+
+void ImGuiVulkanDispatch::reset_call_stats()
+{
+	for (u32 i = 0; i < device_function_count; i++)
+	{
+		shim_calls[i].store(0, std::memory_order_relaxed);
+		shim_nanoseconds[i].store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+
+// Platform-specific includes and surface extension defines
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+
+// Headers
+#include "vulkan/vulkan.h"
+
+// Functions, which are loaded without an instance
+#define IMGUI_VULKAN_GLOBAL_FUNCTIONS(X) \
+	X(vkCreateInstance) \
+	X(vkEnumerateInstanceExtensionProperties)
+
+#ifdef _WIN32
+#define IMGUI_VULKAN_SURFACE_FUNCTIONS(X) X(vkCreateWin32SurfaceKHR)
+#else
+#define IMGUI_VULKAN_SURFACE_FUNCTIONS(X)
+#endif
+
+// Functions of the instance and its physical devices
+#define IMGUI_VULKAN_INSTANCE_FUNCTIONS(X) \
+	X(vkDestroyInstance) \
+	X(vkEnumeratePhysicalDevices) \
+	X(vkEnumerateDeviceExtensionProperties) \
+	X(vkGetPhysicalDeviceProperties) \
+	X(vkGetPhysicalDeviceFeatures) \
+	X(vkGetPhysicalDeviceFormatProperties) \
+	X(vkGetPhysicalDeviceQueueFamilyProperties) \
+	X(vkGetPhysicalDeviceMemoryProperties) \
+	X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+	X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+	X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+	X(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+	X(vkDestroySurfaceKHR) \
+	X(vkCreateDevice) \
+	X(vkGetDeviceProcAddr) \
+	IMGUI_VULKAN_SURFACE_FUNCTIONS(X)
+
+// Functions of the device, its queues and command buffers
+#define IMGUI_VULKAN_DEVICE_FUNCTIONS(X) \
+	X(vkDestroyDevice) \
+	X(vkGetDeviceQueue) \
+	X(vkDeviceWaitIdle) \
+	X(vkQueueSubmit) \
+	X(vkQueueWaitIdle) \
+	X(vkQueuePresentKHR) \
+	X(vkCreateSwapchainKHR) \
+	X(vkDestroySwapchainKHR) \
+	X(vkGetSwapchainImagesKHR) \
+	X(vkAcquireNextImageKHR) \
+	X(vkAllocateMemory) \
+	X(vkFreeMemory) \
+	X(vkMapMemory) \
+	X(vkBindBufferMemory) \
+	X(vkBindImageMemory) \
+	X(vkGetBufferMemoryRequirements) \
+	X(vkGetImageMemoryRequirements) \
+	X(vkGetImageSubresourceLayout) \
+	X(vkCreateBuffer) \
+	X(vkDestroyBuffer) \
+	X(vkCreateImage) \
+	X(vkDestroyImage) \
+	X(vkCreateImageView) \
+	X(vkDestroyImageView) \
+	X(vkCreateSampler) \
+	X(vkDestroySampler) \
+	X(vkCreateFence) \
+	X(vkDestroyFence) \
+	X(vkResetFences) \
+	X(vkGetFenceStatus) \
+	X(vkWaitForFences) \
+	X(vkCreateSemaphore) \
+	X(vkDestroySemaphore) \
+	X(vkCreateFramebuffer) \
+	X(vkDestroyFramebuffer) \
+	X(vkCreateRenderPass) \
+	X(vkDestroyRenderPass) \
+	X(vkCreateShaderModule) \
+	X(vkDestroyShaderModule) \
+	X(vkCreatePipelineCache) \
+	X(vkDestroyPipelineCache) \
+	X(vkCreatePipelineLayout) \
+	X(vkDestroyPipelineLayout) \
+	X(vkCreateGraphicsPipelines) \
+	X(vkDestroyPipeline) \
+	X(vkCreateDescriptorSetLayout) \
+	X(vkDestroyDescriptorSetLayout) \
+	X(vkCreateDescriptorPool) \
+	X(vkDestroyDescriptorPool) \
+	X(vkAllocateDescriptorSets) \
+	X(vkFreeDescriptorSets) \
+	X(vkUpdateDescriptorSets) \
+	X(vkCreateCommandPool) \
+	X(vkDestroyCommandPool) \
+	X(vkAllocateCommandBuffers) \
+	X(vkFreeCommandBuffers) \
+	X(vkBeginCommandBuffer) \
+	X(vkEndCommandBuffer) \
+	X(vkCmdBeginRenderPass) \
+	X(vkCmdEndRenderPass) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdBindVertexBuffers) \
+	X(vkCmdBindIndexBuffer) \
+	X(vkCmdSetViewport) \
+	X(vkCmdSetScissor) \
+	X(vkCmdPushConstants) \
+	X(vkCmdDraw) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawIndexedIndirect) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdCopyBufferToImage) \
+	X(vkCreateQueryPool) \
+	X(vkDestroyQueryPool) \
+	X(vkGetQueryPoolResults) \
+	X(vkCmdResetQueryPool) \
+	X(vkCmdWriteTimestamp)
+
+// What the shim records around each device function
+enum class ImGuiVulkanShimMode : u8
+{
+	none,     // The functions are called directly
+	counting, // Counts the calls
+	timing,   // Counts and times the calls
+};
+
+// Calls of a device function since the shim was installed or the statistics were reset
+struct ImGuiVulkanCallStats
+{
+	const char* name;
+	u64 calls;
+	u64 nanoseconds; // Only measured in the timing mode
+};
+
+// Vulkan entry points, which are loaded at runtime instead of being linked against the loader. The device functions
+// come from vkGetDeviceProcAddr, so that they are called without the dispatch of the loader's trampolines.
+// The table can be shared with a host engine through ImGuiVulkanHost, or copied from ImGuiVulkanContext::vk.
+struct ImGuiVulkanDispatch
+{
+	PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+
+#define IMGUI_VULKAN_DECLARE_FUNCTION(name) PFN_##name name = nullptr;
+	IMGUI_VULKAN_GLOBAL_FUNCTIONS(IMGUI_VULKAN_DECLARE_FUNCTION)
+	IMGUI_VULKAN_INSTANCE_FUNCTIONS(IMGUI_VULKAN_DECLARE_FUNCTION)
+	IMGUI_VULKAN_DEVICE_FUNCTIONS(IMGUI_VULKAN_DECLARE_FUNCTION)
+#undef IMGUI_VULKAN_DECLARE_FUNCTION
+
+	// Loads vkGetInstanceProcAddr from the Vulkan loader library, unless one is given, and the global functions
+	bool load_loader(PFN_vkGetInstanceProcAddr get_instance_proc_addr = nullptr);
+	bool load_instance(VkInstance instance);
+	bool load_device(VkDevice device);
+
+	// Routes the device functions of this table through wrappers, which record their calls. The wrappers share their
+	// state, so only one table can have the shim at a time.
+	bool install_shim(ImGuiVulkanShimMode mode);
+	void remove_shim();
+
+	// Statistics of the functions, which have been called
+	static std::vector<ImGuiVulkanCallStats> get_call_stats();
+	static void reset_call_stats();
+};
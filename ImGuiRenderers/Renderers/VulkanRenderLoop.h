@@ -0,0 +1,663 @@
+#pragma once
+
+#include "../ImGuiRenderers.h"
+#include "../Trace.h"
+#include "../UploadCopy.h"
+#include "../VertexPacking.h"
+
+// Headers
+#include <algorithm>
+#include <float.h>
+#include <string.h>
+
+// A Vulkan renderer, whose render loop is specialized for the traits. The options are adjusted to what the traits allow,
+// so for example validation layers can't be enabled without debug checks.
+template<typename Traits>
+class ImGuiVulkanRendererT : public ImGuiVulkanRenderer
+{
+public:
+	bool initialize(void* handle, void* instance, void* renderer_options)
+	{
+		ImGuiVulkanOptions options = *(ImGuiVulkanOptions*)renderer_options;
+
+		if (Traits::vertex_format != ImGuiVulkanVertexFormat::runtime)
+		{
+			options.compact_vertices = Traits::vertex_format == ImGuiVulkanVertexFormat::compact;
+		}
+
+		options.layer_cache = options.layer_cache && Traits::layer_cache;
+		options.validation_layers = options.validation_layers && Traits::debug_checks;
+
+		// Streamed textures are sampled with the same pipeline as the font, so they would be read as distances
+		if (Traits::texture_mode == ImGuiVulkanTextureMode::descriptor_sets && options.distance_field_font)
+		{
+			log(WARNING, "The distance field font isn't available with descriptor sets as textures.");
+			options.distance_field_font = false;
+		}
+
+		record_function = &ImGuiVulkanRenderer::record_draw_lists<Traits>;
+		upload_function = &ImGuiVulkanRenderer::upload_draw_list<Traits>;
+		draw_function = &ImGuiVulkanRenderer::draw_draw_list<Traits>;
+
+		if (!ImGuiVulkanRenderer::initialize(handle, instance, &options))
+		{
+			return false;
+		}
+
+		// A shared context may have been created with the other vertex format
+		if (Traits::vertex_format != ImGuiVulkanVertexFormat::runtime && context->compact_vertices != options.compact_vertices)
+		{
+			log(ERROR, "The vertex format of the shared context doesn't match the traits.");
+			return false;
+		}
+
+		return true;
+	}
+};
+
+template<typename Traits>
+void ImGuiVulkanRenderer::record_draw_lists(VkCommandBuffer command_buffer, ImDrawData* draw_data)
+{
+	const bool compact = Traits::vertex_format == ImGuiVulkanVertexFormat::runtime ? context->compact_vertices : Traits::vertex_format == ImGuiVulkanVertexFormat::compact;
+
+	VkViewport viewport = {};
+	viewport.width = display_size.x;
+	viewport.height = display_size.y;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	vk->vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+	vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &context->descriptor_set, 0, nullptr);
+	push_projection(command_buffer, 0.0f, 0.0f, display_size.x, display_size.y);
+
+	if (context->indirect_drawing)
+	{
+		record_indirect<Traits>(command_buffer, draw_data);
+		return;
+	}
+
+	vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline);
+
+	// The last buffer holds the quads of the cached layers
+	render_buffers.resize(draw_data->CmdListsCount + 1, VK_NULL_HANDLE);
+	buffer_offsets.resize(draw_data->CmdListsCount + 1, 0);
+
+	s32 quad = 0;
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+
+		// Unchanged draw lists are composited from their layer with a single quad
+		if (Traits::layer_cache && i < (s32)list_layers.size() && list_layers[i])
+		{
+			Layer& layer = *list_layers[i];
+
+			u64 offset = buffer_offsets.back() + 6 * sizeof(ImDrawIdx);
+			vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->composite_pipeline);
+			vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &layer.descriptor_set, 0, nullptr);
+			vk->vkCmdBindVertexBuffers(command_buffer, 0, 1, &render_buffers.back(), &offset);
+			vk->vkCmdBindIndexBuffer(command_buffer, render_buffers.back(), buffer_offsets.back(), imgui_index_type);
+
+			if (compact)
+			{
+				push_packing(command_buffer, list_packings.back());
+			}
+
+			VkRect2D scissor;
+			scissor.offset.x = layer.x;
+			scissor.offset.y = layer.y;
+			scissor.extent.width = layer.width;
+			scissor.extent.height = layer.height;
+
+			vk->vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+			vk->vkCmdDrawIndexed(command_buffer, 6, 1, 0, quad * 4, 0);
+			stats.draw_calls++;
+
+			vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline);
+			vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &context->descriptor_set, 0, nullptr);
+
+			quad++;
+			continue;
+		}
+
+		if (!render_buffers[i] && !upload_draw_list<Traits>(i, draw_list))
+		{
+			if (Traits::debug_checks)
+			{
+				log(ERROR, "Failed to upload draw list %d.", i);
+			}
+
+			uploader->flush();
+			return;
+		}
+
+		draw_draw_list<Traits>(command_buffer, draw_list, i, 0, 0);
+	}
+
+	list_layers.clear();
+
+	// The GPU only reads the uploads once the command buffer is submitted, so all of them are copied at once
+	ImGuiTraceScope flush_trace("upload flush");
+	uploader->flush();
+	stats.copied_bytes = uploader->copied_bytes;
+	stats.copy_nanoseconds = uploader->copy_nanoseconds;
+}
+
+template<typename Traits>
+bool ImGuiVulkanRenderer::upload_draw_list(u32 index, ImDrawList* draw_list)
+{
+	ImGuiTraceScope trace("upload");
+
+	// Folded into a constant, unless the vertex format is chosen at runtime
+	const bool compact = Traits::vertex_format == ImGuiVulkanVertexFormat::runtime ? context->compact_vertices : Traits::vertex_format == ImGuiVulkanVertexFormat::compact;
+	const u64 vertex_size = compact ? sizeof(ImDrawVertPacked) : sizeof(ImDrawVert);
+	u64 vertex_bytes = draw_list->VtxBuffer.size() * vertex_size;
+	u64 index_bytes = draw_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+	u64 index_buffer_offset = (vertex_bytes + upload_alignment - 1) & ~(upload_alignment - 1);
+
+	if (list_quads.size() <= index)
+	{
+		list_quads.resize(index + 1);
+	}
+
+	if (list_packings.size() <= index)
+	{
+		list_packings.resize(index + 1);
+	}
+
+	list_quads[index].active = false;
+
+	// Empty buffers can't be created, but the draw list may still have callbacks
+	if (vertex_bytes == 0 || index_bytes == 0)
+	{
+		return true;
+	}
+
+	// Each draw list is packed around its own origin, which is pushed with the projection when it's drawn
+	if (compact)
+	{
+		float bounds[4];
+		get_vertex_bounds(&draw_list->VtxBuffer.front(), draw_list->VtxBuffer.size(), bounds);
+		list_packings[index] = get_vertex_packing(bounds);
+	}
+
+	if (context->instanced_quads && !layer_pass && prepare_quads(index, draw_list))
+	{
+		return upload_quads<Traits>(index);
+	}
+
+	void* data = create_upload_buffer(index, index_buffer_offset + index_bytes);
+
+	if (!data)
+	{
+		return false;
+	}
+
+	if (compact)
+	{
+		pack_vertices((ImDrawVertPacked*)data, &draw_list->VtxBuffer.front(), draw_list->VtxBuffer.size(), list_packings[index]);
+	}
+	else
+	{
+		uploader->add(data, &draw_list->VtxBuffer.front(), vertex_bytes);
+	}
+
+	// Indices start on their own cache line, so that both copies are streamed from the start
+	uploader->add((u8*)data + index_buffer_offset, &draw_list->IdxBuffer.front(), index_bytes);
+
+	stats.vertex_count += draw_list->VtxBuffer.size();
+	stats.vertex_bytes += vertex_bytes;
+	stats.index_bytes += index_bytes;
+	stats.vertex_bytes_saved += draw_list->VtxBuffer.size() * sizeof(ImDrawVert) - vertex_bytes;
+
+	return true;
+}
+
+template<typename Traits>
+bool ImGuiVulkanRenderer::upload_quads(u32 index)
+{
+	const bool compact = Traits::vertex_format == ImGuiVulkanVertexFormat::runtime ? context->compact_vertices : Traits::vertex_format == ImGuiVulkanVertexFormat::compact;
+	const u64 vertex_size = compact ? sizeof(ImDrawVertPacked) : sizeof(ImDrawVert);
+	const u64 quad_size = compact ? sizeof(ImDrawQuadPacked) : sizeof(ImDrawQuad);
+	QuadList& list = list_quads[index];
+
+	// The remaining triangles, their indices and the quads each start on their own cache line
+	u64 vertex_bytes = quad_vertices.size() * vertex_size;
+	u64 index_bytes = quad_indices.size() * sizeof(ImDrawIdx);
+	u64 quad_count = quad_corners.size() / 2;
+	list.index_buffer_offset = (vertex_bytes + upload_alignment - 1) & ~(upload_alignment - 1);
+	list.quad_offset = (list.index_buffer_offset + index_bytes + upload_alignment - 1) & ~(upload_alignment - 1);
+
+	u8* data = (u8*)create_upload_buffer(index, list.quad_offset + quad_count * quad_size);
+
+	if (!data)
+	{
+		return false;
+	}
+
+	// The scratch buffers are reused by the next draw list, so they are copied right away
+	if (compact && vertex_bytes)
+	{
+		pack_vertices((ImDrawVertPacked*)data, &quad_vertices.front(), quad_vertices.size(), list_packings[index]);
+	}
+	else if (vertex_bytes)
+	{
+		stream_copy(data, &quad_vertices.front(), vertex_bytes);
+	}
+
+	if (index_bytes)
+	{
+		stream_copy(data + list.index_buffer_offset, &quad_indices.front(), index_bytes);
+	}
+
+	for (u64 i = 0; i < quad_count; i++)
+	{
+		const ImDrawVert& top_left = quad_corners[i * 2];
+		const ImDrawVert& bottom_right = quad_corners[i * 2 + 1];
+
+		if (compact)
+		{
+			pack_quad((ImDrawQuadPacked*)(data + list.quad_offset) + i, top_left, bottom_right, list_packings[index]);
+		}
+		else
+		{
+			ImDrawQuad quad;
+			quad.pos[0] = top_left.pos.x;
+			quad.pos[1] = top_left.pos.y;
+			quad.pos[2] = bottom_right.pos.x;
+			quad.pos[3] = bottom_right.pos.y;
+			quad.uv[0] = top_left.uv.x;
+			quad.uv[1] = top_left.uv.y;
+			quad.uv[2] = bottom_right.uv.x;
+			quad.uv[3] = bottom_right.uv.y;
+			quad.col = top_left.col;
+			((ImDrawQuad*)(data + list.quad_offset))[i] = quad;
+		}
+	}
+
+	list.active = true;
+
+	stats.vertex_count += quad_vertices.size();
+	stats.vertex_bytes += vertex_bytes;
+	stats.index_bytes += index_bytes;
+	stats.vertex_bytes_saved += quad_vertices.size() * sizeof(ImDrawVert) - vertex_bytes;
+	stats.quad_count += quad_count;
+	stats.quad_bytes += quad_count * quad_size;
+
+	return true;
+}
+
+template<typename Traits>
+void ImGuiVulkanRenderer::draw_quads(VkCommandBuffer command_buffer, ImDrawList* draw_list, u32 index)
+{
+	const QuadList& list = list_quads[index];
+	VkDeviceSize offsets[2] = { buffer_offsets[index], buffer_offsets[index] + list.quad_offset };
+	vk->vkCmdBindVertexBuffers(command_buffer, 0, 1, &render_buffers[index], &offsets[0]);
+	vk->vkCmdBindIndexBuffer(command_buffer, render_buffers[index], buffer_offsets[index] + list.index_buffer_offset, imgui_index_type);
+
+	VkDescriptorSet bound_set = context->descriptor_set;
+	bool quads_bound = false;
+	u32 batch = 0;
+
+	for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+	{
+		ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+
+		if (draw_cmd->UserCallback)
+		{
+			draw_cmd->UserCallback(draw_list, draw_cmd);
+			continue;
+		}
+
+		if (batch == list.batches.size() || list.batches[batch].command != (u32)j)
+		{
+			continue;
+		}
+
+		if (Traits::texture_mode == ImGuiVulkanTextureMode::descriptor_sets)
+		{
+			VkDescriptorSet descriptor_set = draw_cmd->TextureId ? (VkDescriptorSet)(uintptr_t)draw_cmd->TextureId : context->descriptor_set;
+
+			if (descriptor_set != bound_set)
+			{
+				vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+				bound_set = descriptor_set;
+			}
+		}
+
+		VkRect2D scissor;
+		scissor.offset.x = std::max(static_cast<s32>(draw_cmd->ClipRect.x), 0);
+		scissor.offset.y = std::max(static_cast<s32>(draw_cmd->ClipRect.y), 0);
+		scissor.extent.width = std::max(static_cast<s32>(draw_cmd->ClipRect.z) - scissor.offset.x, 0);
+		scissor.extent.height = std::max(static_cast<s32>(draw_cmd->ClipRect.w) - scissor.offset.y, 0);
+
+		vk->vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+		// The batches alternate between the pipelines in the order of the original indices, so the overlap stays the same
+		for (; batch < list.batches.size() && list.batches[batch].command == (u32)j; batch++)
+		{
+			const QuadBatch& quad_batch = list.batches[batch];
+
+			if (quad_batch.quads != quads_bound)
+			{
+				vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, quad_batch.quads ? context->quad_pipeline : context->pipeline);
+				vk->vkCmdBindVertexBuffers(command_buffer, 0, 1, &render_buffers[index], &offsets[quad_batch.quads]);
+				quads_bound = quad_batch.quads;
+			}
+
+			if (quad_batch.quads)
+			{
+				vk->vkCmdDraw(command_buffer, 6, quad_batch.count, 0, quad_batch.first);
+			}
+			else
+			{
+				vk->vkCmdDrawIndexed(command_buffer, quad_batch.count, 1, quad_batch.first, 0, 0);
+			}
+
+			stats.draw_calls++;
+		}
+	}
+
+	if (quads_bound)
+	{
+		vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline);
+	}
+
+	if (Traits::texture_mode == ImGuiVulkanTextureMode::descriptor_sets && bound_set != context->descriptor_set)
+	{
+		vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &context->descriptor_set, 0, nullptr);
+	}
+}
+
+template<typename Traits>
+void ImGuiVulkanRenderer::draw_draw_list(VkCommandBuffer command_buffer, ImDrawList* draw_list, u32 index, s32 x, s32 y)
+{
+	const bool compact = Traits::vertex_format == ImGuiVulkanVertexFormat::runtime ? context->compact_vertices : Traits::vertex_format == ImGuiVulkanVertexFormat::compact;
+	const u64 vertex_size = compact ? sizeof(ImDrawVertPacked) : sizeof(ImDrawVert);
+	u64 index_buffer_offset = (draw_list->VtxBuffer.size() * vertex_size + upload_alignment - 1) & ~(upload_alignment - 1);
+
+	if (compact && render_buffers[index])
+	{
+		push_packing(command_buffer, list_packings[index]);
+	}
+
+	if (render_buffers[index] && index < list_quads.size() && list_quads[index].active)
+	{
+		draw_quads<Traits>(command_buffer, draw_list, index);
+		return;
+	}
+
+	if (render_buffers[index])
+	{
+		u64 offset = buffer_offsets[index];
+		vk->vkCmdBindVertexBuffers(command_buffer, 0, 1, &render_buffers[index], &offset);
+		vk->vkCmdBindIndexBuffer(command_buffer, render_buffers[index], offset + index_buffer_offset, imgui_index_type);
+	}
+
+	// The font atlas is bound, when a draw list is drawn
+	VkDescriptorSet bound_set = context->descriptor_set;
+	u32 index_offset = 0;
+
+	for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+	{
+		ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+
+		if (Traits::debug_checks && index_offset + draw_cmd->ElemCount > (u32)draw_list->IdxBuffer.size())
+		{
+			log(ERROR, "Draw command %d reads past the end of the index buffer.", j);
+			break;
+		}
+
+		if (draw_cmd->UserCallback)
+		{
+			draw_cmd->UserCallback(draw_list, draw_cmd);
+		}
+		else if (render_buffers[index])
+		{
+			if (Traits::texture_mode == ImGuiVulkanTextureMode::descriptor_sets)
+			{
+				VkDescriptorSet descriptor_set = draw_cmd->TextureId ? (VkDescriptorSet)(uintptr_t)draw_cmd->TextureId : context->descriptor_set;
+
+				if (descriptor_set != bound_set)
+				{
+					vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+					bound_set = descriptor_set;
+				}
+			}
+
+			// The scissor is relative to the render target, which for layers starts at their position
+			VkRect2D scissor;
+			scissor.offset.x = std::max(static_cast<s32>(draw_cmd->ClipRect.x) - x, 0);
+			scissor.offset.y = std::max(static_cast<s32>(draw_cmd->ClipRect.y) - y, 0);
+			scissor.extent.width = std::max(static_cast<s32>(draw_cmd->ClipRect.z) - x - scissor.offset.x, 0);
+			scissor.extent.height = std::max(static_cast<s32>(draw_cmd->ClipRect.w) - y - scissor.offset.y, 0);
+
+			vk->vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+			vk->vkCmdDrawIndexed(command_buffer, draw_cmd->ElemCount, 1, index_offset, 0, 0);
+			stats.draw_calls++;
+		}
+
+		index_offset += draw_cmd->ElemCount;
+	}
+
+	// The next draw list expects the font atlas again
+	if (Traits::texture_mode == ImGuiVulkanTextureMode::descriptor_sets && bound_set != context->descriptor_set)
+	{
+		vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &context->descriptor_set, 0, nullptr);
+	}
+}
+
+template<typename Traits>
+void ImGuiVulkanRenderer::record_indirect(VkCommandBuffer command_buffer, ImDrawData* draw_data)
+{
+	const bool compact = Traits::vertex_format == ImGuiVulkanVertexFormat::runtime ? context->compact_vertices : Traits::vertex_format == ImGuiVulkanVertexFormat::compact;
+	const u64 vertex_size = compact ? sizeof(ImDrawVertPacked) : sizeof(ImDrawVert);
+
+	// The smallest maxDrawIndirectCount of the devices with multiDrawIndirect
+	const u32 max_indirect_draws = 65535;
+
+	u64 vertex_count = 0;
+	u64 index_count = 0;
+	u32 draw_count = 0;
+
+	// The frame is drawn with one projection, so all draw lists are packed around the origin of the whole frame
+	float frame_bounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+		vertex_count += draw_list->VtxBuffer.size();
+		index_count += draw_list->IdxBuffer.size();
+
+		if (compact && !draw_list->VtxBuffer.empty())
+		{
+			float bounds[4];
+			get_vertex_bounds(&draw_list->VtxBuffer.front(), draw_list->VtxBuffer.size(), bounds);
+			frame_bounds[0] = std::min(frame_bounds[0], bounds[0]);
+			frame_bounds[1] = std::min(frame_bounds[1], bounds[1]);
+			frame_bounds[2] = std::max(frame_bounds[2], bounds[2]);
+			frame_bounds[3] = std::max(frame_bounds[3], bounds[3]);
+		}
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			draw_count += !draw_list->CmdBuffer[j].UserCallback && draw_list->CmdBuffer[j].ElemCount;
+		}
+	}
+
+	// The whole frame goes into one buffer: the vertices, indices, indirect draws and the clip rectangle of each draw
+	u64 index_buffer_offset = (vertex_count * vertex_size + upload_alignment - 1) & ~(upload_alignment - 1);
+	u64 draw_offset = (index_buffer_offset + index_count * sizeof(ImDrawIdx) + upload_alignment - 1) & ~(upload_alignment - 1);
+	u64 clip_offset = (draw_offset + draw_count * sizeof(VkDrawIndexedIndirectCommand) + upload_alignment - 1) & ~(upload_alignment - 1);
+
+	render_buffers.resize(1, VK_NULL_HANDLE);
+	buffer_offsets.resize(1, 0);
+
+	u8* data = draw_count ? (u8*)create_upload_buffer(0, clip_offset + draw_count * sizeof(float) * 4) : nullptr;
+
+	if (draw_count && !data)
+	{
+		if (Traits::debug_checks)
+		{
+			log(ERROR, "Failed to upload the frame for indirect drawing.");
+		}
+
+		return;
+	}
+
+	ImDrawVertPacking packing = compact && vertex_count ? get_vertex_packing(frame_bounds) : ImDrawVertPacking();
+	VkDrawIndexedIndirectCommand* draws = (VkDrawIndexedIndirectCommand*)(data + draw_offset);
+	float* clip_rects = (float*)(data + clip_offset);
+	u32 base_vertex = 0;
+	u32 base_index = 0;
+	u32 draw = 0;
+
+	for (s32 i = 0; i < draw_data->CmdListsCount && data; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+		u64 vertex_bytes = draw_list->VtxBuffer.size() * vertex_size;
+		u64 index_bytes = draw_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+
+		if (vertex_bytes && compact)
+		{
+			pack_vertices((ImDrawVertPacked*)(data + base_vertex * vertex_size), &draw_list->VtxBuffer.front(), draw_list->VtxBuffer.size(), packing);
+		}
+		else if (vertex_bytes)
+		{
+			uploader->add(data + base_vertex * vertex_size, &draw_list->VtxBuffer.front(), vertex_bytes);
+		}
+
+		if (index_bytes)
+		{
+			uploader->add(data + index_buffer_offset + base_index * sizeof(ImDrawIdx), &draw_list->IdxBuffer.front(), index_bytes);
+		}
+
+		u32 index_offset = 0;
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			const ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+
+			// The draws are already counted, so the frame is dropped instead of skipping the rest of the list
+			if (Traits::debug_checks && index_offset + draw_cmd->ElemCount > (u32)draw_list->IdxBuffer.size())
+			{
+				log(ERROR, "Draw command %d reads past the end of the index buffer.", j);
+				uploader->flush();
+				return;
+			}
+
+			// The first instance selects the clip rectangle, which is rounded like the scissor would be
+			if (!draw_cmd->UserCallback && draw_cmd->ElemCount)
+			{
+				VkDrawIndexedIndirectCommand indirect_draw;
+				indirect_draw.indexCount = draw_cmd->ElemCount;
+				indirect_draw.instanceCount = 1;
+				indirect_draw.firstIndex = base_index + index_offset;
+				indirect_draw.vertexOffset = base_vertex;
+				indirect_draw.firstInstance = draw;
+				draws[draw] = indirect_draw;
+
+				clip_rects[draw * 4 + 0] = static_cast<float>(std::max(static_cast<s32>(draw_cmd->ClipRect.x), 0));
+				clip_rects[draw * 4 + 1] = static_cast<float>(std::max(static_cast<s32>(draw_cmd->ClipRect.y), 0));
+				clip_rects[draw * 4 + 2] = static_cast<float>(static_cast<s32>(draw_cmd->ClipRect.z));
+				clip_rects[draw * 4 + 3] = static_cast<float>(static_cast<s32>(draw_cmd->ClipRect.w));
+				draw++;
+			}
+
+			index_offset += draw_cmd->ElemCount;
+		}
+
+		base_vertex += draw_list->VtxBuffer.size();
+		base_index += draw_list->IdxBuffer.size();
+
+		stats.vertex_count += draw_list->VtxBuffer.size();
+		stats.vertex_bytes += vertex_bytes;
+		stats.index_bytes += index_bytes;
+		stats.vertex_bytes_saved += draw_list->VtxBuffer.size() * sizeof(ImDrawVert) - vertex_bytes;
+	}
+
+	// Clipping happens in the fragment shader, so the scissor covers the whole framebuffer
+	VkRect2D scissor = {};
+	scissor.extent.width = static_cast<u32>(display_size.x * framebuffer_scale.x);
+	scissor.extent.height = static_cast<u32>(display_size.y * framebuffer_scale.y);
+
+	vk->vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+	vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->indirect_pipeline);
+
+	if (compact)
+	{
+		push_packing(command_buffer, packing);
+	}
+
+	if (data)
+	{
+		VkBuffer buffers[2] = { render_buffers[0], render_buffers[0] };
+		VkDeviceSize offsets[2] = { buffer_offsets[0], buffer_offsets[0] + clip_offset };
+		vk->vkCmdBindVertexBuffers(command_buffer, 0, 2, buffers, offsets);
+		vk->vkCmdBindIndexBuffer(command_buffer, render_buffers[0], buffer_offsets[0] + index_buffer_offset, imgui_index_type);
+	}
+
+	// Consecutive draws go into a single indirect draw, only callbacks and texture changes split them
+	VkDescriptorSet bound_set = context->descriptor_set;
+	u32 first_draw = 0;
+	draw = 0;
+
+	auto draw_indirect = [&](u32 end)
+	{
+		if (end > first_draw)
+		{
+			vk->vkCmdDrawIndexedIndirect(command_buffer, render_buffers[0], buffer_offsets[0] + draw_offset + first_draw * sizeof(VkDrawIndexedIndirectCommand), end - first_draw, sizeof(VkDrawIndexedIndirectCommand));
+			stats.draw_calls++;
+		}
+
+		first_draw = end;
+	};
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+
+			if (draw_cmd->UserCallback)
+			{
+				draw_indirect(draw);
+				draw_cmd->UserCallback(draw_list, draw_cmd);
+				continue;
+			}
+
+			if (!draw_cmd->ElemCount)
+			{
+				continue;
+			}
+
+			if (Traits::texture_mode == ImGuiVulkanTextureMode::descriptor_sets)
+			{
+				VkDescriptorSet descriptor_set = draw_cmd->TextureId ? (VkDescriptorSet)(uintptr_t)draw_cmd->TextureId : context->descriptor_set;
+
+				if (descriptor_set != bound_set)
+				{
+					draw_indirect(draw);
+					vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+					bound_set = descriptor_set;
+				}
+			}
+
+			if (++draw - first_draw == max_indirect_draws)
+			{
+				draw_indirect(draw);
+			}
+		}
+	}
+
+	draw_indirect(draw);
+
+	ImGuiTraceScope flush_trace("upload flush");
+	uploader->flush();
+	stats.copied_bytes = uploader->copied_bytes;
+	stats.copy_nanoseconds = uploader->copy_nanoseconds;
+}
@@ -1,118 +1,120 @@
 #include "VulkanRenderer.h"
+#include "VulkanRenderLoop.h"
+#include "../DrawDataCapture.h"
+#include "../DrawDataRemote.h"
+#include "../DrawDataSnapshot.h"
+#include "../Hash.h"
+#include "../Trace.h"
+#include "../UploadCopy.h"
+#include "../VertexPacking.h"
+
+#include <algorithm>
+#include <math.h>
+
+// The default render loop is instantiated here, renderers with other traits instantiate theirs from VulkanRenderLoop.h
+template void ImGuiVulkanRenderer::record_draw_lists<ImGuiVulkanDefaultTraits>(VkCommandBuffer command_buffer, ImDrawData* draw_data);
+template bool ImGuiVulkanRenderer::upload_draw_list<ImGuiVulkanDefaultTraits>(u32 index, ImDrawList* draw_list);
+template void ImGuiVulkanRenderer::draw_draw_list<ImGuiVulkanDefaultTraits>(VkCommandBuffer command_buffer, ImDrawList* draw_list, u32 index, s32 x, s32 y);
 
 ImGuiVulkanRenderer::~ImGuiVulkanRenderer()
 {
-	// Must wait to make sure that the objects can be safely destroyed
-	VkResult result;
-
-	if (device)
+	// The render thread drops the frames, which it hasn't started yet
+	if (render_worker.joinable())
 	{
-		if ((result = vkDeviceWaitIdle(device)) != VK_SUCCESS)
-		{
-			log(ERROR, "Failed to wait for the device to become idle. (%d)", result);
-			return;
-		}
-
-		// We need to check if these objects exist, or else we'll crash
-		if (font_sampler)
-		{
-			vkDestroySampler(device, font_sampler, nullptr);
-		}
-
-		if (font_memory)
 		{
-			vkFreeMemory(device, font_memory, nullptr);
+			std::lock_guard<std::mutex> lock(render_mutex);
+			render_exiting = true;
 		}
 
-		if (font_image_view)
-		{
-			vkDestroyImageView(device, font_image_view, nullptr);
-		}
-
-		if (font_image)
-		{
-			vkDestroyImage(device, font_image, nullptr);
-		}
+		render_wake.notify_one();
+		render_worker.join();
+	}
 
-		if (pipeline)
-		{
-			vkDestroyPipeline(device, pipeline, nullptr);
-		}
+	// Must wait to make sure that the objects can be safely destroyed
+	VkResult result;
 
-		if (pipeline_cache)
-		{
-			vkDestroyPipelineCache(device, pipeline_cache, nullptr);
-		}
+	if (context)
+	{
+		context->allocator.remove_budget_callback(budget_callback, this);
+	}
 
-		if (pipeline_layout)
-		{
-			vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
-		}
+	if (context && context->device)
+	{
+		// Waiting for the device uses all its queues, which the other windows and the texture streamer may be submitting to
+		std::unique_lock<std::mutex> lock(context->queue_mutex);
 
-		if (descriptor_set_layout)
+		if ((result = vk->vkDeviceWaitIdle(context->device)) != VK_SUCCESS)
 		{
-			vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+			log(ERROR, "Failed to wait for the device to become idle. (%d)", result);
+			return;
 		}
 
-		if (descriptor_set)
+		// The window can't be submitted anymore, if it was waiting for it
+		if (frame_pending)
 		{
-			vkFreeDescriptorSets(device, descriptor_pool, 1, &descriptor_set);
-		}
+			for (u32 i = 0; i < context->pending_windows.size(); i++)
+			{
+				if (context->pending_windows[i] == this)
+				{
+					context->pending_windows.erase(context->pending_windows.begin() + i);
+					break;
+				}
+			}
 
-		if (descriptor_pool)
-		{
-			vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
+			release_frame_resources(false);
 		}
 
-		if (render_pass)
+		for (UploadArena& arena : upload_arenas)
 		{
-			vkDestroyRenderPass(device, render_pass, nullptr);
+			for (UploadBlock& block : arena.blocks)
+			{
+				destroy_upload_block(block);
+			}
 		}
 
-		if (vertex_shader)
+		if (image_acquired)
 		{
-			vkDestroyShaderModule(device, vertex_shader, nullptr);
+			vk->vkDestroySemaphore(context->device, image_acquired, context->allocation_callbacks);
 		}
 
-		if (fragment_shader)
+		for (auto& entry : layers)
 		{
-			vkDestroyShaderModule(device, fragment_shader, nullptr);
+			destroy_layer(entry.second);
 		}
 
+		// We need to check if these objects exist, or else we'll crash
 		for (u8 i = 0; i < 2; i++)
 		{
+			if (framebuffers[i])
+			{
+				vk->vkDestroyFramebuffer(context->device, framebuffers[i], context->allocation_callbacks);
+			}
+
 			if (swapchain_image_views[i])
 			{
-				vkDestroyImageView(device, swapchain_image_views[i], nullptr);
+				vk->vkDestroyImageView(context->device, swapchain_image_views[i], context->allocation_callbacks);
 			}
 		}
 
 		if (command_pool)
 		{
-			vkDestroyCommandPool(device, command_pool, nullptr);
+			vk->vkDestroyCommandPool(context->device, command_pool, context->allocation_callbacks);
 		}
 
-		if (swapchain)
+		if (timestamp_pool)
 		{
-			vkDestroySwapchainKHR(device, swapchain, nullptr);
+			vk->vkDestroyQueryPool(context->device, timestamp_pool, context->allocation_callbacks);
 		}
 
-		vkDestroyDevice(device, nullptr);
-	}
-
-	if (surface)
-	{
-		vkDestroySurfaceKHR(instance, surface, nullptr);
-	}
-
-	if (destroy_debug_report)
-	{
-		destroy_debug_report(instance, debug_callback_function, nullptr);
+		if (swapchain)
+		{
+			vk->vkDestroySwapchainKHR(context->device, swapchain, context->allocation_callbacks);
+		}
 	}
 
-	if (instance)
+	if (context && surface)
 	{
-		vkDestroyInstance(instance, nullptr);
+		vk->vkDestroySurfaceKHR(context->instance, surface, context->allocation_callbacks);
 	}
 }
 
@@ -126,7 +128,7 @@ bool ImGuiVulkanRenderer::create_swapchain_image_views()
 	command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-	if ((result = vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info)) != VK_SUCCESS)
+	if ((result = vk->vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info)) != VK_SUCCESS)
 	{
 		log(ERROR, "Failed to begin a command buffer. (%d)", result);
 		return false;
@@ -145,25 +147,25 @@ bool ImGuiVulkanRenderer::create_swapchain_image_views()
 		swapchain_barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 		swapchain_barrier.image = swapchain_images[i];
 
-		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &swapchain_barrier);
+		vk->vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &swapchain_barrier);
 
 		VkImageViewCreateInfo swap_chain_image_view = {};
 		swap_chain_image_view.pNext = nullptr;
 		swap_chain_image_view.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		swap_chain_image_view.format = surface_format.format;
+		swap_chain_image_view.format = context->surface_format.format;
 		swap_chain_image_view.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
 		swap_chain_image_view.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 		swap_chain_image_view.viewType = VK_IMAGE_VIEW_TYPE_2D;
 		swap_chain_image_view.image = swapchain_images[i];
 
-		if ((result = vkCreateImageView(device, &swap_chain_image_view, nullptr, &swapchain_image_views[i])) != VK_SUCCESS)
+		if ((result = vk->vkCreateImageView(context->device, &swap_chain_image_view, context->allocation_callbacks, &swapchain_image_views[i])) != VK_SUCCESS)
 		{
 			log(ERROR, "Failed to create swapchain image view. (%d)", result);
 			return false;
 		}
 	}
 
-	if ((result = vkEndCommandBuffer(command_buffer)) != VK_SUCCESS)
+	if ((result = vk->vkEndCommandBuffer(command_buffer)) != VK_SUCCESS)
 	{
 		log(ERROR, "Failed to end the command buffer. (%d)", result);
 		return false;
@@ -172,153 +174,47 @@ bool ImGuiVulkanRenderer::create_swapchain_image_views()
 	return true;
 }
 
-// Get the first device that supports graphics output and surfaces
-u32 ImGuiVulkanRenderer::get_graphics_family(VkPhysicalDevice adapter, VkSurfaceKHR window_surface)
+void ImGuiVulkanRenderer::new_frame()
 {
-	// Get the amount of family queues
-	u32 family_queue_count;
-	vkGetPhysicalDeviceQueueFamilyProperties(adapter, &family_queue_count, nullptr);
-
-	// Get list of family queues
-	std::vector<VkQueueFamilyProperties> queues(family_queue_count);
-	vkGetPhysicalDeviceQueueFamilyProperties(adapter, &family_queue_count, queues.data());
+	ImGuiTraceScope trace("new_frame");
+	ImGuiIO& io = ImGui::GetIO();
 
-	for (u32 i = 0; i < queues.size(); i++)
+	// The host engine owns the swapchain, so only the display size of its window, if any, is followed
+	if (context->external)
 	{
-		if (!(queues[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
-		{
-			continue;
-		}
-
-		VkBool32 supported;
-
-		if (vkGetPhysicalDeviceSurfaceSupportKHR(adapter, i, window_surface, &supported) != VK_SUCCESS)
+		if (window_handle)
 		{
-			log(ERROR, "Failed to query surface support.");
-			return 0xBAD;
-		}
+			ImGuiRenderer::new_frame();
 
-		if (supported)
-		{
-			return i;
+			io.DisplaySize.x = width;
+			io.DisplaySize.y = height;
 		}
-	}
-
-	return 0xBAD;
-}
-
-VkBool32 ImGuiVulkanRenderer::get_memory_type(u32 typeBits, VkFlags properties, u32 *typeIndex)
-{
-	for (u8 i = 0; i < 32; i++)
-	{
-		if ((typeBits & 1) == 1)
+		else
 		{
-			if ((memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
-			{
-				*typeIndex = i;
-				return true;
-			}
+			s64 current_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			io.DeltaTime = time ? (float)(current_time - time) / 1000000.0f : 1.0f / 60.0f;
+			time = current_time;
 		}
 
-		typeBits >>= 1;
-	}
-
-	return false;
-}
-
-VkShaderModule ImGuiVulkanRenderer::load_shader(std::string file_name)
-{
-	std::ifstream stream(file_name, std::ios::binary);
-
-	if (!stream)
-	{
-		log(ERROR, "Failed to open shader file.");
-		return nullptr;
-	}
-
-	stream.seekg(0, std::ios::end);
-	u64 size = stream.tellg();
-	stream.seekg(0, std::ios::beg);
-
-	char* shader_code = (char*)malloc(size);
-
-	if (shader_code == nullptr)
-	{
-		log(ERROR, "Failed to allocate memory for shader.");
-	}
-
-	stream.read(shader_code, size);
-
-	VkShaderModuleCreateInfo shader_module_info = {};
-	shader_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	shader_module_info.codeSize = size;
-	shader_module_info.pCode = (u32*)shader_code;
-
-	VkShaderModule shader_module;
-	VkResult result;
-
-	if ((result = vkCreateShaderModule(device, &shader_module_info, nullptr, &shader_module)) != VK_SUCCESS)
-	{
-		log(ERROR, "Failed to create a shader module. (%d)", result);
-		return nullptr;
-	}
-
-	free(shader_code);
-
-	return shader_module;
-}
-
-VkShaderModule ImGuiVulkanRenderer::load_shader(const u8* shader, u64 size)
-{
-	VkShaderModuleCreateInfo shader_module_info = {};
-	shader_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	shader_module_info.codeSize = size;
-	shader_module_info.pCode = (u32*)shader;
-
-	VkShaderModule shader_module;
-	VkResult result;
-
-	if ((result = vkCreateShaderModule(device, &shader_module_info, nullptr, &shader_module)) != VK_SUCCESS)
-	{
-		log(ERROR, "Failed to create a shader module. (%d)", result);
-		return nullptr;
-	}
-
-	return shader_module;
-}
-
-VkBool32 ImGuiVulkanRenderer::debug_callback(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT type, u64 src, u64 location, s32 msg_code, char* prefix, char* msg, void* user_data)
-{
-	if (flags & VK_DEBUG_REPORT_ERROR_BIT_EXT)
-	{
-		log(ERROR, "[%s]: %s", prefix, msg);
-	}
-	else if (flags & VK_DEBUG_REPORT_WARNING_BIT_EXT || flags & VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT)
-	{
-		log(WARNING, "[%s]: %s", prefix, msg);
-	}
-	else
-	{
-		log(WARNING, "[%s]: %s", prefix, msg);
+		ImGui::NewFrame();
+		return;
 	}
 
-	return false;
-}
-
-void ImGuiVulkanRenderer::new_frame()
-{
 	ImGuiRenderer::new_frame();
-	ImGuiIO& io = ImGui::GetIO();
 
 	// The swapchain needs to be recreated, when the window is resized or else bad things happen
 	if ((io.DisplaySize.x != width || io.DisplaySize.y != height) && width != 0 && height != 0)
 	{
 		VkResult result;
+		ImGuiTraceScope recreate_trace("recreate swapchain");
+
+		// The render thread may still be presenting to the swapchain
+		wait_for_render_thread();
 
 		// Get the surface capabilities
 		VkSurfaceCapabilitiesKHR surface_capabilities;
 
-		if ((result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &surface_capabilities)) != VK_SUCCESS)
+		if ((result = vk->vkGetPhysicalDeviceSurfaceCapabilitiesKHR(context->physical_device, surface, &surface_capabilities)) != VK_SUCCESS)
 		{
 			log(ERROR, "Failed to obtain the device surface capabilities. (%d)", result);
 			return;
@@ -334,41 +230,48 @@ void ImGuiVulkanRenderer::new_frame()
 		swapchain_info.oldSwapchain = swapchain;
 		swapchain_info.imageArrayLayers = 1;
 		swapchain_info.imageExtent = surface_capabilities.currentExtent;
-		swapchain_info.imageFormat = surface_format.format;
+		swapchain_info.imageFormat = context->surface_format.format;
+		swapchain_info.imageColorSpace = context->surface_format.colorSpace;
 		swapchain_info.presentMode = present_mode;
 		swapchain_info.minImageCount = 2;
 		swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 		swapchain_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 
-		if ((result = vkCreateSwapchainKHR(device, &swapchain_info, nullptr, &swapchain)) != VK_SUCCESS)
+		if ((result = vk->vkCreateSwapchainKHR(context->device, &swapchain_info, context->allocation_callbacks, &swapchain)) != VK_SUCCESS)
 		{
 			log(ERROR, "Failed to recreate the swapchain. (%d)", result);
 			return;
 		}
 
 		// We still have to destroy the old swapchain to free all the associated memory
-		vkDestroySwapchainKHR(device, old_swapchain, nullptr);
+		vk->vkDestroySwapchainKHR(context->device, old_swapchain, context->allocation_callbacks);
 
 		// Get the new swapchain images
 		u32 swapchain_image_count;
 
-		if ((result = vkGetSwapchainImagesKHR(device, swapchain, &swapchain_image_count, nullptr)) != VK_SUCCESS)
+		if ((result = vk->vkGetSwapchainImagesKHR(context->device, swapchain, &swapchain_image_count, nullptr)) != VK_SUCCESS)
 		{
 			log(ERROR, "Failed to obtain the number of swapchain images. (%d)", result);
 			return;
 		}
 
-		if ((result = vkGetSwapchainImagesKHR(device, swapchain, &swapchain_image_count, swapchain_images)) != VK_SUCCESS)
+		if ((result = vk->vkGetSwapchainImagesKHR(context->device, swapchain, &swapchain_image_count, swapchain_images)) != VK_SUCCESS)
 		{
 			log(ERROR, "Failed to obtain the number of swapchain images. (%d)", result);
 			return;
 		}
 
-		// Destroy the previous swapchain image views
+		// Destroy the previous swapchain image views and their framebuffers
 		for (u8 i = 0; i < 2; i++)
 		{
-			vkDestroyImageView(device, swapchain_image_views[i], nullptr);
+			if (framebuffers[i])
+			{
+				vk->vkDestroyFramebuffer(context->device, framebuffers[i], context->allocation_callbacks);
+				framebuffers[i] = VK_NULL_HANDLE;
+			}
+
+			vk->vkDestroyImageView(context->device, swapchain_image_views[i], context->allocation_callbacks);
 		}
 
 		// Recreate the swapchain image views
@@ -385,185 +288,221 @@ void ImGuiVulkanRenderer::new_frame()
 	ImGui::NewFrame();
 }
 
-void ImGuiVulkanRenderer::imgui_render(ImDrawData* draw_data)
+void ImGuiVulkanRenderer::render(ImDrawData* draw_data)
 {
-	ImGuiVulkanRenderer& renderer = *(ImGuiVulkanRenderer*)ImGui::GetIO().UserData;
 	ImGuiIO& io = ImGui::GetIO();
 
-	u32 width = static_cast<u32>(io.DisplaySize.x);
-	u32 height = static_cast<u32>(io.DisplaySize.y);
-	draw_data->ScaleClipRects(io.DisplayFramebufferScale);
-
-	VkResult result;
-	u32 current_buffer;
-
-	VkSemaphoreCreateInfo semaphore_info = {};
-	semaphore_info.pNext = nullptr;
-	semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-	VkSemaphore semaphore;
-
-	if ((result = vkCreateSemaphore(renderer.device, &semaphore_info, nullptr, &semaphore)) != VK_SUCCESS)
+	if (context->external)
 	{
-		log(ERROR, "Failed to create a semaphore. (%d)", result);
+		log(ERROR, "Draws have to be recorded with record, when embedded into a host engine.");
 		return;
 	}
 
-	if ((result = vkAcquireNextImageKHR(renderer.device, renderer.swapchain, UINT64_MAX, semaphore, nullptr, &current_buffer)) != VK_SUCCESS)
+	if (render_worker.joinable())
 	{
-		log(ERROR, "Failed to obtain the index of the next image in the chain. (%d)", result);
+		queue_frame(draw_data);
 		return;
 	}
 
-	VkCommandBufferBeginInfo command_buffer_begin = {};
-	command_buffer_begin.pNext = nullptr;
-	command_buffer_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	command_buffer_begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-	if ((result = vkBeginCommandBuffer(renderer.command_buffer, &command_buffer_begin)) != VK_SUCCESS)
+	if (frame_pending)
 	{
-		log(ERROR, "Failed to begin the command buffer. (%d)", result);
+		log(ERROR, "The previous frame of the window hasn't been submitted yet.");
 		return;
 	}
 
-	VkFramebufferCreateInfo framebuffer_info = {};
-	framebuffer_info.pNext = nullptr;
-	framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-	framebuffer_info.width = width;
-	framebuffer_info.height = height;
-	framebuffer_info.renderPass = renderer.render_pass;
-	framebuffer_info.attachmentCount = 1;
-	framebuffer_info.layers = 1;
-	framebuffer_info.pAttachments = &renderer.swapchain_image_views[current_buffer];
-
-	VkFramebuffer framebuffer;
+	display_size = io.DisplaySize;
+	framebuffer_scale = io.DisplayFramebufferScale;
+	render_frame(draw_data);
+}
 
-	if ((result = vkCreateFramebuffer(renderer.device, &framebuffer_info, nullptr, &framebuffer)) != VK_SUCCESS)
+void ImGuiVulkanRenderer::wait_for_render_thread()
+{
+	if (!render_worker.joinable())
 	{
-		log(ERROR, "Failed to create a framebuffer. (%d)", result);
 		return;
 	}
 
-	VkRenderPassBeginInfo render_pass_begin_info = {};
-	render_pass_begin_info.pNext = nullptr;
-	render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	render_pass_begin_info.framebuffer = framebuffer;
-	render_pass_begin_info.renderPass = renderer.render_pass;
-	render_pass_begin_info.renderArea.offset.x = 0;
-	render_pass_begin_info.renderArea.offset.y = 0;
-	render_pass_begin_info.renderArea.extent.width = width;
-	render_pass_begin_info.renderArea.extent.height = height;
-	render_pass_begin_info.clearValueCount = 1;
-	render_pass_begin_info.pClearValues = &renderer.clear_value;
+	std::unique_lock<std::mutex> lock(render_mutex);
+	render_idle.wait(lock, [&] { return !snapshot_queued && !rendering; });
+}
 
-	vkCmdBeginRenderPass(renderer.command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+ImGuiVulkanRenderThreadStats ImGuiVulkanRenderer::get_render_thread_stats()
+{
+	std::lock_guard<std::mutex> lock(render_mutex);
+	return render_thread_stats;
+}
 
-	VkViewport viewport = {};
-	viewport.width = io.DisplaySize.x;
-	viewport.height = io.DisplaySize.y;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
+void ImGuiVulkanRenderer::queue_frame(ImDrawData* draw_data)
+{
+	auto start = std::chrono::steady_clock::now();
 
-	vkCmdSetViewport(renderer.command_buffer, 0, 1, &viewport);
+	// The snapshot, which isn't being rendered, is free once the render thread has taken the last queued frame
+	u32 free_snapshot;
 
-	// Projection matrix
-	const float ortho_projection[4][4] =
 	{
-		{ 2.0f / io.DisplaySize.x,  0.0f, 0.0f, 0.0f },
-		{ 0.0f, 2.0f / -io.DisplaySize.y, 0.0f, 0.0f },
-		{ 0.0f, 0.0f, -1.0f, 0.0f },
-		{ -1.0f, 1.0f,  0.0f, 1.0f },
-	};
-
-	vkCmdBindDescriptorSets(renderer.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderer.pipeline_layout, 0, 1, &renderer.descriptor_set, 0, nullptr);
-	vkCmdPushConstants(renderer.command_buffer, renderer.pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float) * 16, &ortho_projection);
-	vkCmdBindPipeline(renderer.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderer.pipeline);
+		ImGuiTraceScope trace("wait for render thread");
+		std::unique_lock<std::mutex> lock(render_mutex);
+		render_idle.wait(lock, [&] { return !snapshot_queued; });
+		free_snapshot = 1 - rendering_snapshot;
+	}
 
-	std::vector<VkDeviceMemory> buffer_memory(draw_data->CmdListsCount);
-	std::vector<VkBuffer> render_buffer(draw_data->CmdListsCount);
+	auto copy_start = std::chrono::steady_clock::now();
+	snapshots[free_snapshot]->copy(draw_data);
 
-	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
 	{
-		ImDrawList* draw_list = draw_data->CmdLists[i];
+		std::lock_guard<std::mutex> lock(render_mutex);
+		snapshot_queued = true;
+		handoff_time = std::chrono::steady_clock::now();
+		render_thread_stats.queue_depth = rendering ? 2 : 1;
+		render_thread_stats.wait_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(copy_start - start).count();
+	}
+
+	render_wake.notify_one();
+}
 
-		VkBufferCreateInfo render_buffer_info = {};
-		render_buffer_info.pNext = nullptr;
-		render_buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		render_buffer_info.size = draw_list->IdxBuffer.size() * sizeof(ImDrawIdx) + draw_list->VtxBuffer.size() * sizeof(ImDrawVert);
-		render_buffer_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+void ImGuiVulkanRenderer::render_loop()
+{
+	while (true)
+	{
+		ImGuiDrawDataSnapshot* snapshot;
 
-		if ((result = vkCreateBuffer(renderer.device, &render_buffer_info, nullptr, &render_buffer[i])) != VK_SUCCESS)
 		{
-			log(ERROR, "Failed to create a buffer for rendering. (%d)", result);
-			return;
-		}
+			std::unique_lock<std::mutex> lock(render_mutex);
+			render_wake.wait(lock, [&] { return render_exiting || snapshot_queued; });
+
+			if (render_exiting)
+			{
+				return;
+			}
 
-		VkMemoryRequirements buffer_memory_requirements;
-		vkGetBufferMemoryRequirements(renderer.device, render_buffer[i], &buffer_memory_requirements);
+			rendering_snapshot = 1 - rendering_snapshot;
+			snapshot_queued = false;
+			rendering = true;
+			render_thread_stats.handoff_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - handoff_time).count();
+			snapshot = snapshots[rendering_snapshot].get();
+		}
 
-		VkMemoryAllocateInfo memory_allocation_info = {};
-		memory_allocation_info.pNext = nullptr;
-		memory_allocation_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memory_allocation_info.allocationSize = buffer_memory_requirements.size;
+		// The UI thread can fill the other snapshot now
+		render_idle.notify_all();
 
-		renderer.get_memory_type(buffer_memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &memory_allocation_info.memoryTypeIndex);
+		display_size = snapshot->display_size;
+		framebuffer_scale = snapshot->framebuffer_scale;
+		render_frame(snapshot->get_draw_data());
 
-		if ((result = vkAllocateMemory(renderer.device, &memory_allocation_info, nullptr, &buffer_memory[i])) != VK_SUCCESS)
 		{
-			log(ERROR, "Failed to allocate memory for rendering. (%d)", result);
-			return;
+			std::lock_guard<std::mutex> lock(render_mutex);
+			rendering = false;
+			render_thread_stats.frames_rendered++;
 		}
 
-		void* data;
+		render_idle.notify_all();
+	}
+}
 
-		if ((result = vkMapMemory(renderer.device, buffer_memory[i], 0, memory_allocation_info.allocationSize, 0, &data)) != VK_SUCCESS)
-		{
-			log(ERROR, "Failed to map memory for rendering buffer. (%d)", result);
-			return;
-		}
+void ImGuiVulkanRenderer::render_frame(ImDrawData* draw_data)
+{
+	u32 width = static_cast<u32>(display_size.x);
+	u32 height = static_cast<u32>(display_size.y);
+	draw_data->ScaleClipRects(framebuffer_scale);
 
-		memcpy(data, &draw_list->VtxBuffer.front(), draw_list->VtxBuffer.size() * sizeof(ImDrawVert));
-		memcpy((u8*)data + draw_list->VtxBuffer.size() * sizeof(ImDrawVert), &draw_list->IdxBuffer.front(), draw_list->IdxBuffer.size() * sizeof(ImDrawIdx));
+	auto start = std::chrono::steady_clock::now();
+	ImGuiTraceScope trace("render");
 
-		vkUnmapMemory(renderer.device, buffer_memory[i]);
+	// Lets the caches know, when the heaps are running out
+	context->allocator.update_budget();
 
-		if ((result = vkBindBufferMemory(renderer.device, render_buffer[i], buffer_memory[i], 0)) != VK_SUCCESS)
-		{
-			log(ERROR, "Failed to bind memory for rendering buffer. (%d)", result);
-			return;
-		}
+	// The previous frame has been waited for, so its uploads can be overwritten
+	reset_upload_arena(0, draw_data->CmdListsCount + 1);
+
+	VkCommandBufferBeginInfo command_buffer_begin = {};
+	command_buffer_begin.pNext = nullptr;
+	command_buffer_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	command_buffer_begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-		u64 offset = 0;
-		vkCmdBindVertexBuffers(renderer.command_buffer, 0, 1, &render_buffer[i], &offset);
-		vkCmdBindIndexBuffer(renderer.command_buffer, render_buffer[i], draw_list->VtxBuffer.size() * sizeof(ImDrawVert), VK_INDEX_TYPE_UINT16);
+	// The results are only checked before the render pass and after recording
+	if (!image_acquired)
+	{
+		VkSemaphoreCreateInfo semaphore_info = {};
+		semaphore_info.pNext = nullptr;
+		semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		u32 index_offset = 0;
+		errors.check(vk->vkCreateSemaphore(context->device, &semaphore_info, context->allocation_callbacks, &image_acquired), "vkCreateSemaphore");
+	}
 
-		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
-		{
-			ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+	if (image_acquired)
+	{
+		ImGuiTraceScope acquire_trace("acquire");
+		errors.check(vk->vkAcquireNextImageKHR(context->device, swapchain, UINT64_MAX, image_acquired, nullptr, &current_buffer), "vkAcquireNextImageKHR");
+	}
 
-			if (draw_cmd->UserCallback)
-			{
-				draw_cmd->UserCallback(draw_list, draw_cmd);
-			}
-			else
+	errors.check(vk->vkBeginCommandBuffer(command_buffer, &command_buffer_begin), "vkBeginCommandBuffer");
+	begin_gpu_trace();
+
+	// The framebuffers of the swapchain images are kept, until the size of the frames changes
+	if (framebuffer_extent.width != width || framebuffer_extent.height != height)
+	{
+		for (u8 i = 0; i < 2; i++)
+		{
+			if (framebuffers[i])
 			{
-				VkRect2D scissor;
-				scissor.offset.x = static_cast<s32>(draw_cmd->ClipRect.x);
-				scissor.offset.y = static_cast<s32>(draw_cmd->ClipRect.y);
-				scissor.extent.width = static_cast<s32>(draw_cmd->ClipRect.z - draw_cmd->ClipRect.x);
-				scissor.extent.height = static_cast<s32>(draw_cmd->ClipRect.w - draw_cmd->ClipRect.y);
-
-				vkCmdSetScissor(renderer.command_buffer, 0, 1, &scissor);
-				vkCmdDrawIndexed(renderer.command_buffer, draw_cmd->ElemCount, 1, index_offset, 0, 0);
+				vk->vkDestroyFramebuffer(context->device, framebuffers[i], context->allocation_callbacks);
+				framebuffers[i] = VK_NULL_HANDLE;
 			}
-
-			index_offset += draw_cmd->ElemCount;
 		}
+
+		framebuffer_extent.width = width;
+		framebuffer_extent.height = height;
+	}
+
+	if (!framebuffers[current_buffer])
+	{
+		VkFramebufferCreateInfo framebuffer_info = {};
+		framebuffer_info.pNext = nullptr;
+		framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebuffer_info.width = width;
+		framebuffer_info.height = height;
+		framebuffer_info.renderPass = context->render_pass;
+		framebuffer_info.attachmentCount = 1;
+		framebuffer_info.layers = 1;
+		framebuffer_info.pAttachments = &swapchain_image_views[current_buffer];
+
+		errors.check(vk->vkCreateFramebuffer(context->device, &framebuffer_info, context->allocation_callbacks, &framebuffers[current_buffer]), "vkCreateFramebuffer");
+	}
+
+	if (!errors.report())
+	{
+		release_frame_resources(false);
+		return;
+	}
+
+	stats = {};
+
+	// Layers, which need to be rasterized again, are rendered before the render pass of the window
+	if (layer_cache && !context->indirect_drawing)
+	{
+		prepare_layers(command_buffer, draw_data);
+	}
+
+	VkRenderPassBeginInfo render_pass_begin_info = {};
+	render_pass_begin_info.pNext = nullptr;
+	render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	render_pass_begin_info.framebuffer = framebuffers[current_buffer];
+	render_pass_begin_info.renderPass = context->render_pass;
+	render_pass_begin_info.renderArea.offset.x = 0;
+	render_pass_begin_info.renderArea.offset.y = 0;
+	render_pass_begin_info.renderArea.extent.width = width;
+	render_pass_begin_info.renderArea.extent.height = height;
+	render_pass_begin_info.clearValueCount = 1;
+	render_pass_begin_info.pClearValues = &clear_value;
+
+	vk->vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+	{
+		ImGuiTraceScope record_trace("record");
+		(this->*record_function)(command_buffer, draw_data);
 	}
 
-	vkCmdEndRenderPass(renderer.command_buffer);
+	vk->vkCmdEndRenderPass(command_buffer);
 
 	// Post present image memory barrier
 	VkImageMemoryBarrier post_present_barrier = {};
@@ -576,708 +515,1062 @@ void ImGuiVulkanRenderer::imgui_render(ImDrawData* draw_data)
 	post_present_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	post_present_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	post_present_barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-	post_present_barrier.image = renderer.swapchain_images[current_buffer];
+	post_present_barrier.image = swapchain_images[current_buffer];
+
+	vk->vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &post_present_barrier);
+	end_gpu_trace();
 
-	vkCmdPipelineBarrier(renderer.command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &post_present_barrier);
+	errors.check(vk->vkEndCommandBuffer(command_buffer), "vkEndCommandBuffer");
 
-	if ((result = vkEndCommandBuffer(renderer.command_buffer)) != VK_SUCCESS)
+	if (!errors.report())
 	{
-		log(ERROR, "Failed to end the command buffer. (%d)", result);
+		release_frame_resources(false);
 		return;
 	}
 
-	VkSubmitInfo submit_info = {};
-	submit_info.pNext = nullptr;
-	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submit_info.waitSemaphoreCount = 1;
-	submit_info.pWaitSemaphores = &semaphore;
-	submit_info.commandBufferCount = 1;
-	submit_info.pCommandBuffers = &renderer.command_buffer;
+	stats.frame_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	trace.end();
 
-	if ((result = vkQueueSubmit(renderer.queue, 1, &submit_info, nullptr)) != VK_SUCCESS)
+	// The context submits and presents all the rendered windows at once
+	if (!context->queue_window(this))
 	{
-		log(ERROR, "Failed to submit to the queue. (%d)", result);
+		release_frame_resources(false);
 		return;
 	}
 
-	VkPresentInfoKHR present_info = {};
-	present_info.pNext = nullptr;
-	present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	present_info.swapchainCount = 1;
-	present_info.pSwapchains = &renderer.swapchain;
-	present_info.pImageIndices = &current_buffer;
+	frame_pending = true;
 
-	if ((result = vkQueuePresentKHR(renderer.queue, &present_info)) != VK_SUCCESS)
+	if (!defer_submission)
 	{
-		log(ERROR, "Failed to present swapchain image. (%d)", result);
-		return;
+		context->submit_frame();
 	}
+}
 
-	// We need to make sure everything has finished before destroying destroying objects and freeing memory
-	if ((result = vkDeviceWaitIdle(renderer.device)) != VK_SUCCESS)
+void ImGuiVulkanRenderer::begin_gpu_trace()
+{
+	if (!ImGuiTracer::is_enabled() || !context->timestamp_valid_bits)
 	{
-		log(ERROR, "Failed to wait for the device to become idle. (%d)", result);
+		timestamps_written = false;
 		return;
 	}
 
-	vkDestroyFramebuffer(renderer.device, framebuffer, nullptr);
-	vkDestroySemaphore(renderer.device, semaphore, nullptr);
+	VkResult result;
 
-	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
+	if (!timestamp_pool)
 	{
-		vkDestroyBuffer(renderer.device, render_buffer[i], nullptr);
-		vkFreeMemory(renderer.device, buffer_memory[i], nullptr);
+		VkQueryPoolCreateInfo query_pool_info = {};
+		query_pool_info.pNext = nullptr;
+		query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		query_pool_info.queryCount = 2;
+
+		if ((result = vk->vkCreateQueryPool(context->device, &query_pool_info, context->allocation_callbacks, &timestamp_pool)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to create the timestamp query pool. (%d)", result);
+			context->timestamp_valid_bits = 0;
+			return;
+		}
 	}
-}
 
-bool ImGuiVulkanRenderer::prepare_vulkan(u8 device_num, bool validation_layers)
-{
-	// The names of validation layers
-	const char* validation_layer_names[] =
+	// The previous frame has been waited for with the submission, so its timestamps don't stall
+	u64 timestamps[2];
+
+	if (timestamps_written && vk->vkGetQueryPoolResults(context->device, timestamp_pool, 0, 2, sizeof(timestamps), timestamps, sizeof(u64), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
 	{
-		"VK_LAYER_LUNARG_standard_validation", "VK_LAYER_GOOGLE_unique_objects",
-		"VK_LAYER_LUNARG_api_dump",
-	};
+		u64 mask = context->timestamp_valid_bits >= 64 ? ~0ull : (1ull << context->timestamp_valid_bits) - 1;
+		u64 start = (u64)((timestamps[0] & mask) * (double)context->timestamp_period);
+		u64 duration = (u64)(((timestamps[1] - timestamps[0]) & mask) * (double)context->timestamp_period);
 
-	std::vector<const char*> instance_extensions = { VK_EXT_DEBUG_REPORT_EXTENSION_NAME, VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME };
-	std::vector<const char*> layer_names;
+		// The GPU can't have started the frame before it was recorded, so the largest gap is the closest estimate
+		s64 offset = (s64)(timestamps_recorded - start);
 
-	// Add all the validation layers (change to 3, to enable API call dumping)
-	if (validation_layers)
-	{
-		for (u8 i = 0; i < 2; i++)
+		if (!gpu_clock_known || offset > gpu_clock_offset)
 		{
-			layer_names.push_back(validation_layer_names[i]);
+			gpu_clock_offset = offset;
+			gpu_clock_known = true;
 		}
+
+		ImGuiTracer::add_gpu_span("GPU frame", start + gpu_clock_offset, start + gpu_clock_offset + duration);
 	}
 
-	// Set application info
-	VkApplicationInfo application_info = {};
-	application_info.pNext = nullptr;
-	application_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-	application_info.pApplicationName = "NGEmu";
-	application_info.pEngineName = "NGEmu";
-	application_info.apiVersion = VK_MAKE_VERSION(1, 0, 4);
-
-	// Set Vulkan instance info and create the instance
-	VkInstanceCreateInfo instance_info = {};
-	instance_info.pNext = nullptr;
-	instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-	instance_info.pApplicationInfo = &application_info;
-	instance_info.enabledLayerCount = (u32)layer_names.size();
-	instance_info.ppEnabledLayerNames = layer_names.data();
-	instance_info.enabledExtensionCount = (u32)instance_extensions.size();
-	instance_info.ppEnabledExtensionNames = instance_extensions.data();
+	vk->vkCmdResetQueryPool(command_buffer, timestamp_pool, 0, 2);
+	vk->vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_pool, 0);
+	timestamps_written = true;
+}
 
-	VkResult result;
+void ImGuiVulkanRenderer::end_gpu_trace()
+{
+	if (timestamps_written)
+	{
+		vk->vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_pool, 1);
+		timestamps_recorded = ImGuiTracer::now();
+	}
+}
 
-	if ((result = vkCreateInstance(&instance_info, nullptr, &instance)) != VK_SUCCESS)
+void ImGuiVulkanRenderer::record(VkCommandBuffer command_buffer, ImDrawData* draw_data)
+{
+	if (!context->external)
 	{
-		log(ERROR, "Failed to create a Vulkan instance. (%d)", result);
-		return false;
+		log(ERROR, "Draws can only be recorded, when embedded into a host engine.");
+		return;
 	}
 
-	// Set up the debug callback
-	create_debug_report = (PFN_vkCreateDebugReportCallbackEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugReportCallbackEXT");
-	destroy_debug_report = (PFN_vkDestroyDebugReportCallbackEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugReportCallbackEXT");
+	if (!draw_data)
+	{
+		draw_data = host_draw_data;
+	}
 
-	if (!create_debug_report || !destroy_debug_report)
+	if (!draw_data)
 	{
-		log(ERROR, "Failed to obtain debug reporting function addresses. (%d)", result);
-		return false;
+		return;
 	}
 
-	VkDebugReportFlagsEXT flags = {};
-	flags |= VK_DEBUG_REPORT_ERROR_BIT_EXT;
-	flags |= VK_DEBUG_REPORT_WARNING_BIT_EXT;
-	flags |= VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT;
+	ImGuiIO& io = ImGui::GetIO();
+	display_size = io.DisplaySize;
+	framebuffer_scale = io.DisplayFramebufferScale;
+	draw_data->ScaleClipRects(framebuffer_scale);
 
-	VkDebugReportCallbackCreateInfoEXT debug_callback_info = {};
-	debug_callback_info.pNext = nullptr;
-	debug_callback_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
-	debug_callback_info.pfnCallback = (PFN_vkDebugReportCallbackEXT)debug_callback;
-	debug_callback_info.flags = flags;
+	// The host engine has waited for the frame, which last used this slot
+	frame_slot = (frame_slot + 1) % upload_arenas.size();
+	reset_upload_arena(frame_slot, draw_data->CmdListsCount + 1);
 
-	create_debug_report(instance, &debug_callback_info, nullptr, &debug_callback_function);
+	auto start = std::chrono::steady_clock::now();
+	ImGuiTraceScope trace("record");
+	context->allocator.update_budget();
 
-	// Find an appropriate device
-	u32 device_count;
+	stats = {};
+	(this->*record_function)(command_buffer, draw_data);
+	stats.frame_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 
-	if ((result = vkEnumeratePhysicalDevices(instance, &device_count, nullptr)) != VK_SUCCESS)
-	{
-		log(ERROR, "Failed to obtain the number of devices. (%d)", result);
-		return false;
-	}
+	host_draw_data = nullptr;
+}
 
-	std::vector<VkPhysicalDevice> adapters(device_count);
+void* ImGuiVulkanRenderer::create_upload_buffer(u32 index, u64 size)
+{
+	UploadArena& arena = upload_arenas[frame_slot];
+	u64 offset = (arena.used + upload_alignment - 1) & ~(upload_alignment - 1);
 
-	if ((result = vkEnumeratePhysicalDevices(instance, &device_count, adapters.data())) != VK_SUCCESS)
+	// Only frames larger than any before them need another block
+	if (arena.blocks.empty() || offset + size > arena.blocks.back().size)
 	{
-		log(ERROR, "Failed to obtain devices. (%d)", result);
-		return false;
+		u64 block_size = std::max(size, arena.blocks.empty() ? minimum_upload_block : arena.blocks.back().size * 2);
+		UploadBlock block;
+
+		if (!create_upload_block(block, block_size))
+		{
+			return nullptr;
+		}
+
+		arena.blocks.push_back(block);
+		offset = 0;
 	}
 
-	physical_device = adapters[device_num];
+	arena.used = offset + size;
+	render_buffers[index] = arena.blocks.back().buffer;
+	buffer_offsets[index] = offset;
 
-	// Create a window surface depending on the platform
-#ifdef _WIN32
-	VkWin32SurfaceCreateInfoKHR window_surface_info = {};
-	window_surface_info.pNext = nullptr;
-	window_surface_info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
-	window_surface_info.hwnd = static_cast<HWND>(window_handle);
-	window_surface_info.hinstance = static_cast<HINSTANCE>(window_instance);
+	return arena.blocks.back().memory.mapped + offset;
+}
+
+void ImGuiVulkanRenderer::reset_upload_arena(u32 slot, u32 buffer_count)
+{
+	frame_slot = slot;
 
-	if ((result = vkCreateWin32SurfaceKHR(instance, &window_surface_info, nullptr, &surface)) != VK_SUCCESS)
+	// Buffers, which stay null, haven't been uploaded this frame
+	render_buffers.assign(buffer_count, VK_NULL_HANDLE);
+	buffer_offsets.assign(buffer_count, 0);
+
+	UploadArena& arena = upload_arenas[slot];
+	arena.used = 0;
+
+	if (arena.blocks.size() <= 1)
 	{
-		log(ERROR, "Failed to create window surface. (%d)", result);
-		return false;
+		return;
 	}
-#else
-	// TODO: Unix version
-#endif
 
-	// Get the first graphic family, that supports Vulkan
-	u32 queue_family = get_graphics_family(physical_device, surface);
+	// The frame didn't fit into one block, so the next ones get a block as large as all of them
+	u64 size = 0;
 
-	if (queue_family == 0xBAD)
+	for (UploadBlock& block : arena.blocks)
 	{
-		log(ERROR, "Failed to obtain a graphics family, that supports Vulkan. (%d)", result);
-		return false;
+		size += block.size;
+		destroy_upload_block(block);
 	}
 
-	// Create a Vulkan device
-	float queue_priority = 1;
+	arena.blocks.clear();
+	UploadBlock block;
 
-	VkDeviceQueueCreateInfo device_queue_info = {};
-	device_queue_info.pNext = nullptr;
-	device_queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	device_queue_info.queueFamilyIndex = queue_family;
-	device_queue_info.queueCount = 1;
-	device_queue_info.pQueuePriorities = &queue_priority;
+	if (create_upload_block(block, size))
+	{
+		arena.blocks.push_back(block);
+	}
+}
 
-	std::vector<const char*> device_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+bool ImGuiVulkanRenderer::create_upload_block(UploadBlock& block, u64 size)
+{
+	VkResult result;
 
-	VkDeviceCreateInfo device_info = {};
-	device_info.pNext = nullptr;
-	device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	device_info.pQueueCreateInfos = &device_queue_info;
-	device_info.queueCreateInfoCount = 1;
-	device_info.enabledLayerCount = (u32)layer_names.size();
-	device_info.ppEnabledLayerNames = layer_names.data();
-	device_info.enabledExtensionCount = (u32)device_extensions.size();
-	device_info.ppEnabledExtensionNames = device_extensions.data();
+	VkBufferCreateInfo render_buffer_info = {};
+	render_buffer_info.pNext = nullptr;
+	render_buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	render_buffer_info.size = size;
+	render_buffer_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
-	if ((result = vkCreateDevice(physical_device, &device_info, nullptr, &device)) != VK_SUCCESS)
+	if ((result = vk->vkCreateBuffer(context->device, &render_buffer_info, context->allocation_callbacks, &block.buffer)) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to create a Vulkan device handle. (%d)", result);
+		log(ERROR, "Failed to create a buffer for rendering. (%d)", result);
 		return false;
 	}
 
-	// Get the queue
-	vkGetDeviceQueue(device, queue_family, 0, &queue);
+	// Coherent, so that the writes need no flush
+	if (!context->allocator.allocate_buffer_memory(block.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &block.memory, ImGuiVulkanMemoryPurpose::upload))
+	{
+		log(ERROR, "Failed to allocate memory for rendering.");
+		destroy_upload_block(block);
+		return false;
+	}
 
-	// Get the memory properties
-	vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+	block.size = size;
 
-	// Get surface capabilities, formats and presentation modes
-	u32 format_count;
-	u32 present_mode_count;
+	return true;
+}
 
-	if ((vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, nullptr)) != VK_SUCCESS)
+void ImGuiVulkanRenderer::destroy_upload_block(UploadBlock& block)
+{
+	if (block.buffer)
 	{
-		log(ERROR, "Failed to obtain the number of device surface formats. (%d)", result);
-		return false;
+		vk->vkDestroyBuffer(context->device, block.buffer, context->allocation_callbacks);
 	}
 
-	if ((result = vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &present_mode_count, nullptr)) != VK_SUCCESS)
+	context->allocator.free_memory(block.memory);
+	block = UploadBlock();
+}
+
+void ImGuiVulkanRenderer::push_projection(VkCommandBuffer command_buffer, float x, float y, float width, float height)
+{
+	projection_rect[0] = x;
+	projection_rect[1] = y;
+	projection_rect[2] = width;
+	projection_rect[3] = height;
+
+	push_packing(command_buffer, ImDrawVertPacking());
+}
+
+void ImGuiVulkanRenderer::push_packing(VkCommandBuffer command_buffer, const ImDrawVertPacking& packing)
+{
+	// Projection matrix. Packed positions are fixed-point SNORM values relative to their origin, so their scale and
+	// origin are folded into the matrix.
+	const bool compact = context->compact_vertices;
+	const float position_scale = compact ? 32767.0f / packing.scale : 1.0f;
+	const float x = projection_rect[0] - (compact ? packing.origin[0] : 0.0f);
+	const float y = projection_rect[1] - (compact ? packing.origin[1] : 0.0f);
+	const float width = projection_rect[2];
+	const float height = projection_rect[3];
+
+	const float ortho_projection[4][4] =
 	{
-		log(ERROR, "Failed to obtain the number of device surface present modes. (%d)", result);
-		return false;
+		{ 2.0f * position_scale / width,  0.0f, 0.0f, 0.0f },
+		{ 0.0f, 2.0f * position_scale / -height, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, -1.0f, 0.0f },
+		{ -1.0f - 2.0f * x / width, 1.0f + 2.0f * y / height,  0.0f, 1.0f },
+	};
+
+	vk->vkCmdPushConstants(command_buffer, context->pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, &ortho_projection);
+}
+
+void ImGuiVulkanRenderer::prepare_layers(VkCommandBuffer command_buffer, ImDrawData* draw_data)
+{
+	// Over the memory budget, only the layers drawn by the last frame are kept
+	if (over_budget.exchange(false))
+	{
+		for (auto& entry : layers)
+		{
+			if (entry.second.image && entry.second.last_used != frame_number)
+			{
+				destroy_layer(entry.second);
+			}
+		}
 	}
 
-	std::vector<VkSurfaceFormatKHR> surface_formats(format_count);
-	std::vector<VkPresentModeKHR> present_modes(present_mode_count);
+	frame_number++;
+	list_layers.assign(draw_data->CmdListsCount, nullptr);
+	render_buffers.resize(draw_data->CmdListsCount + 1, VK_NULL_HANDLE);
+	buffer_offsets.resize(draw_data->CmdListsCount + 1, 0);
+
+	u32 quad_count = 0;
 
-	if ((result = vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, surface_formats.data())) != VK_SUCCESS)
+	// Layers are drawn with their own pipeline, which has no counterpart for instanced quads
+	layer_pass = true;
+
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
 	{
-		log(ERROR, "Failed to obtain the surface formats. (%d)", result);
-		return false;
+		ImDrawList* draw_list = draw_data->CmdLists[i];
+
+		if (draw_list->VtxBuffer.size() == 0 || draw_list->IdxBuffer.size() == 0)
+		{
+			continue;
+		}
+
+		// The hash covers everything, which affects the rasterized result
+		u64 hash = hash_bytes(&draw_list->VtxBuffer.front(), draw_list->VtxBuffer.size() * sizeof(ImDrawVert));
+		hash = hash_bytes(&draw_list->IdxBuffer.front(), draw_list->IdxBuffer.size() * sizeof(ImDrawIdx), hash);
+
+		// The layer covers the union of the clip rectangles, as nothing is drawn outside of them
+		float min_x = display_size.x, min_y = display_size.y, max_x = 0.0f, max_y = 0.0f;
+		bool cacheable = true;
+
+		for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+		{
+			const ImDrawCmd& draw_cmd = draw_list->CmdBuffer[j];
+
+			// Callbacks may draw anything, so they have to run every frame
+			if (draw_cmd.UserCallback)
+			{
+				cacheable = false;
+				break;
+			}
+
+			struct
+			{
+				float clip_rect[4];
+				ImTextureID texture;
+				u32 element_count;
+			} command;
+
+			memset(&command, 0, sizeof(command));
+			command.clip_rect[0] = draw_cmd.ClipRect.x;
+			command.clip_rect[1] = draw_cmd.ClipRect.y;
+			command.clip_rect[2] = draw_cmd.ClipRect.z;
+			command.clip_rect[3] = draw_cmd.ClipRect.w;
+			command.texture = draw_cmd.TextureId;
+			command.element_count = draw_cmd.ElemCount;
+
+			hash = hash_bytes(&command, sizeof(command), hash);
+
+			min_x = std::min(min_x, draw_cmd.ClipRect.x);
+			min_y = std::min(min_y, draw_cmd.ClipRect.y);
+			max_x = std::max(max_x, draw_cmd.ClipRect.z);
+			max_y = std::max(max_y, draw_cmd.ClipRect.w);
+		}
+
+		s32 x = static_cast<s32>(std::max(floorf(min_x), 0.0f));
+		s32 y = static_cast<s32>(std::max(floorf(min_y), 0.0f));
+		s32 layer_width = static_cast<s32>(std::min(ceilf(max_x), display_size.x)) - x;
+		s32 layer_height = static_cast<s32>(std::min(ceilf(max_y), display_size.y)) - y;
+
+		if (!cacheable || layer_width <= 0 || layer_height <= 0)
+		{
+			continue;
+		}
+
+		Layer& layer = layers[draw_list];
+		layer.last_used = frame_number;
+		layer.name = get_owner_name(*draw_list, 0);
+
+		// The extent is clamped to the display, so a resized display changes it without changing the draw list
+		if (layer.valid && layer.hash == hash && layer.x == x && layer.y == y && layer.width == (u32)layer_width && layer.height == (u32)layer_height)
+		{
+			layer.hits++;
+			stats.layer_hits++;
+			list_layers[i] = &layer;
+			quad_count++;
+			continue;
+		}
+
+		layer.misses++;
+		stats.layer_misses++;
+
+		// Only draw lists, which stayed the same since the last frame, are worth rendering into a layer
+		bool stable = layer.hash == hash;
+		layer.hash = hash;
+		layer.valid = false;
+
+		if (!stable)
+		{
+			continue;
+		}
+
+		if (!layer.image || layer.width != (u32)layer_width || layer.height != (u32)layer_height)
+		{
+			destroy_layer(layer);
+
+			// When the budget is exhausted, the draw list is drawn directly
+			if (!create_layer(layer, layer_width, layer_height))
+			{
+				continue;
+			}
+		}
+
+		if (!(this->*upload_function)(i, draw_list))
+		{
+			continue;
+		}
+
+		layer.x = x;
+		layer.y = y;
+
+		// Rasterize the draw list into the layer
+		VkClearValue transparent = {};
+
+		VkRenderPassBeginInfo render_pass_begin_info = {};
+		render_pass_begin_info.pNext = nullptr;
+		render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		render_pass_begin_info.framebuffer = layer.framebuffer;
+		render_pass_begin_info.renderPass = context->layer_render_pass;
+		render_pass_begin_info.renderArea.extent.width = layer.width;
+		render_pass_begin_info.renderArea.extent.height = layer.height;
+		render_pass_begin_info.clearValueCount = 1;
+		render_pass_begin_info.pClearValues = &transparent;
+
+		vk->vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+		VkViewport viewport = {};
+		viewport.width = static_cast<float>(layer.width);
+		viewport.height = static_cast<float>(layer.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		vk->vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+		vk->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->layer_pipeline);
+		vk->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline_layout, 0, 1, &context->descriptor_set, 0, nullptr);
+		push_projection(command_buffer, static_cast<float>(x), static_cast<float>(y), viewport.width, viewport.height);
+
+		(this->*draw_function)(command_buffer, draw_list, i, x, y);
+
+		vk->vkCmdEndRenderPass(command_buffer);
+
+		layer.valid = true;
+		list_layers[i] = &layer;
+		quad_count++;
 	}
 
-	if ((result = vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &present_mode_count, present_modes.data())) != VK_SUCCESS)
+	layer_pass = false;
+
+	// Forget the draw lists, which weren't drawn this frame and have no layer to keep
+	for (auto entry = layers.begin(); entry != layers.end();)
 	{
-		log(ERROR, "Failed to obtain the surface present modes. (%d)", result);
-		return false;
+		if (entry->second.last_used != frame_number && !entry->second.image)
+		{
+			entry = layers.erase(entry);
+		}
+		else
+		{
+			entry++;
+		}
 	}
 
-	VkSurfaceCapabilitiesKHR surface_capabilities;
+	stats.layer_bytes = layer_bytes;
 
-	if ((result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &surface_capabilities)) != VK_SUCCESS)
+	if (quad_count == 0)
 	{
-		log(ERROR, "Failed to obtain the device surface capabilities. (%d)", result);
-		return false;
+		return;
 	}
 
-	surface_format = surface_formats[0];
-	present_mode = present_modes[0];
+	// The quads share the indices, which come first in the buffer
+	const u64 vertex_size = context->compact_vertices ? sizeof(ImDrawVertPacked) : sizeof(ImDrawVert);
+	const u64 index_bytes = 6 * sizeof(ImDrawIdx);
+	void* data = create_upload_buffer(draw_data->CmdListsCount, index_bytes + quad_count * 4 * vertex_size);
 
-	// Create a swapchain
-	VkSwapchainCreateInfoKHR swapchain_info = {};
-	swapchain_info.pNext = nullptr;
-	swapchain_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-	swapchain_info.surface = surface;
-	swapchain_info.imageArrayLayers = 1;
-	swapchain_info.imageExtent = surface_capabilities.currentExtent;
-	swapchain_info.imageFormat = surface_format.format;
-	swapchain_info.presentMode = present_mode;
-	swapchain_info.minImageCount = 2;
-	swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-	swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-	swapchain_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+	if (!data)
+	{
+		// Without the quads, the layers can't be composited
+		list_layers.assign(draw_data->CmdListsCount, nullptr);
+		return;
+	}
+
+	const ImDrawIdx indices[6] = { 0, 1, 2, 0, 2, 3 };
+	memcpy(data, indices, index_bytes);
+
+	composite_quads.clear();
 
-	if ((result = vkCreateSwapchainKHR(device, &swapchain_info, nullptr, &swapchain)) != VK_SUCCESS)
+	for (s32 i = 0; i < draw_data->CmdListsCount; i++)
 	{
-		log(ERROR, "Failed to create a swapchain. (%d)", result);
-		return false;
+		if (!list_layers[i])
+		{
+			continue;
+		}
+
+		const Layer& layer = *list_layers[i];
+		const float left = static_cast<float>(layer.x);
+		const float top = static_cast<float>(layer.y);
+		const float right = static_cast<float>(layer.x + layer.width);
+		const float bottom = static_cast<float>(layer.y + layer.height);
+
+		ImDrawVert quad[4];
+		quad[0].pos = ImVec2(left, top);
+		quad[0].uv = ImVec2(0.0f, 0.0f);
+		quad[1].pos = ImVec2(right, top);
+		quad[1].uv = ImVec2(1.0f, 0.0f);
+		quad[2].pos = ImVec2(right, bottom);
+		quad[2].uv = ImVec2(1.0f, 1.0f);
+		quad[3].pos = ImVec2(left, bottom);
+		quad[3].uv = ImVec2(0.0f, 1.0f);
+
+		for (u8 j = 0; j < 4; j++)
+		{
+			quad[j].col = 0xFFFFFFFF;
+			composite_quads.push_back(quad[j]);
+		}
 	}
 
-	u32 swapchain_image_count;
+	void* vertices = (u8*)data + index_bytes;
 
-	if ((result = vkGetSwapchainImagesKHR(device, swapchain, &swapchain_image_count, nullptr)) != VK_SUCCESS)
+	if (context->compact_vertices)
 	{
-		log(ERROR, "Failed to obtain the number of swapchain images. (%d)", result);
-		return false;
+		float bounds[4];
+		get_vertex_bounds(composite_quads.data(), composite_quads.size(), bounds);
+		list_packings.resize(draw_data->CmdListsCount + 1);
+		list_packings.back() = get_vertex_packing(bounds);
+		pack_vertices((ImDrawVertPacked*)vertices, composite_quads.data(), composite_quads.size(), list_packings.back());
+	}
+	else
+	{
+		memcpy(vertices, composite_quads.data(), composite_quads.size() * sizeof(ImDrawVert));
 	}
+}
+
+bool ImGuiVulkanRenderer::prepare_quads(u32 index, ImDrawList* draw_list)
+{
+	// Shorter runs of quads are left as triangles, as every run costs a pipeline switch and a draw
+	const u32 min_quad_run = 8;
+
+	const ImDrawVert* vertices = &draw_list->VtxBuffer.front();
+	const ImDrawIdx* indices = &draw_list->IdxBuffer.front();
+	const u32 vertex_count = draw_list->VtxBuffer.size();
 
-	if ((result = vkGetSwapchainImagesKHR(device, swapchain, &swapchain_image_count, swapchain_images)) != VK_SUCCESS)
+	QuadList& list = list_quads[index];
+	list.batches.clear();
+	quad_vertices.clear();
+	quad_indices.clear();
+	quad_corners.clear();
+	quad_remap.assign(vertex_count, ~0u);
+
+	// The two triangles of an ImGui rectangle share the top left and bottom right corner
+	auto is_quad = [&](const ImDrawIdx* quad)
 	{
-		log(ERROR, "Failed to obtain the number of swapchain images. (%d)", result);
-		return false;
+		if (quad[3] != quad[0] || quad[4] != quad[2])
+		{
+			return false;
+		}
+
+		u32 corners[4] = { quad[0], quad[1], quad[2], quad[5] };
+
+		if (corners[0] >= vertex_count || corners[1] >= vertex_count || corners[2] >= vertex_count || corners[3] >= vertex_count)
+		{
+			return false;
+		}
+
+		const ImDrawVert& a = vertices[corners[0]];
+		const ImDrawVert& b = vertices[corners[1]];
+		const ImDrawVert& c = vertices[corners[2]];
+		const ImDrawVert& d = vertices[corners[3]];
+
+		return a.pos.y == b.pos.y && b.pos.x == c.pos.x && c.pos.y == d.pos.y && d.pos.x == a.pos.x &&
+			a.uv.y == b.uv.y && b.uv.x == c.uv.x && c.uv.y == d.uv.y && d.uv.x == a.uv.x &&
+			a.col == b.col && a.col == c.col && a.col == d.col;
+	};
+
+	u32 index_offset = 0;
+	bool has_quads = false;
+
+	for (s32 j = 0; j < draw_list->CmdBuffer.size(); j++)
+	{
+		const ImDrawCmd* draw_cmd = &draw_list->CmdBuffer[j];
+		u32 end = index_offset + draw_cmd->ElemCount;
+
+		if (end > (u32)draw_list->IdxBuffer.size())
+		{
+			return false;
+		}
+
+		if (draw_cmd->UserCallback)
+		{
+			index_offset = end;
+			continue;
+		}
+
+		u32 position = index_offset;
+
+		while (position < end)
+		{
+			u32 run = 0;
+
+			while (position + (run + 1) * 6 <= end && is_quad(indices + position + run * 6))
+			{
+				run++;
+			}
+
+			if (run >= min_quad_run)
+			{
+				QuadBatch batch;
+				batch.command = j;
+				batch.first = static_cast<u32>(quad_corners.size() / 2);
+				batch.count = run;
+				batch.quads = true;
+				list.batches.push_back(batch);
+
+				for (u32 k = 0; k < run; k++)
+				{
+					const ImDrawIdx* quad = indices + position + k * 6;
+					quad_corners.push_back(vertices[quad[0]]);
+					quad_corners.push_back(vertices[quad[2]]);
+				}
+
+				position += run * 6;
+				has_quads = true;
+				continue;
+			}
+
+			// The triangles keep their vertices, which are renumbered into the smaller vertex buffer
+			u32 triangle_end = std::min(position + std::max(run * 6, 3u), end);
+
+			if (list.batches.empty() || list.batches.back().quads || list.batches.back().command != (u32)j)
+			{
+				QuadBatch batch;
+				batch.command = j;
+				batch.first = static_cast<u32>(quad_indices.size());
+				batch.count = 0;
+				batch.quads = false;
+				list.batches.push_back(batch);
+			}
+
+			for (; position < triangle_end; position++)
+			{
+				u32 vertex = indices[position];
+
+				if (vertex >= vertex_count)
+				{
+					return false;
+				}
+
+				if (quad_remap[vertex] == ~0u)
+				{
+					// Falls back to the whole draw list, if the remaining vertices don't fit the index type
+					if (quad_vertices.size() > (u64)(ImDrawIdx)~0)
+					{
+						return false;
+					}
+
+					quad_remap[vertex] = static_cast<u32>(quad_vertices.size());
+					quad_vertices.push_back(vertices[vertex]);
+				}
+
+				quad_indices.push_back(static_cast<ImDrawIdx>(quad_remap[vertex]));
+				list.batches.back().count++;
+			}
+		}
+
+		index_offset = end;
 	}
 
-	// Set the ImGui size values
-	ImGuiIO io = ImGui::GetIO();
-	io.DisplaySize.x = static_cast<float>(surface_capabilities.currentExtent.width);
-	io.DisplaySize.y = static_cast<float>(surface_capabilities.currentExtent.height);
+	return has_quads;
+}
 
-	// Create a command pool
-	VkCommandPoolCreateInfo command_pool_info = {};
-	command_pool_info.pNext = nullptr;
-	command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	command_pool_info.queueFamilyIndex = get_graphics_family(physical_device, surface);;
-	command_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+bool ImGuiVulkanRenderer::create_layer(Layer& layer, u32 layer_width, u32 layer_height)
+{
+	VkResult result;
 
-	if ((result = vkCreateCommandPool(device, &command_pool_info, nullptr, &command_pool)) != VK_SUCCESS)
+	// Make room by evicting the least recently used layers, which aren't needed for this frame
+	const u64 bytes = (u64)layer_width * layer_height * 4;
+
+	while (layer_bytes + bytes > layer_budget)
 	{
-		log(ERROR, "Failed to create a command pool. (%d)", result);
-		return false;
+		Layer* oldest = nullptr;
+
+		for (auto& entry : layers)
+		{
+			if (entry.second.image && entry.second.last_used != frame_number && (!oldest || entry.second.last_used < oldest->last_used))
+			{
+				oldest = &entry.second;
+			}
+		}
+
+		if (!oldest)
+		{
+			return false;
+		}
+
+		destroy_layer(*oldest);
 	}
 
-	// Allocate a command buffer
-	VkCommandBufferAllocateInfo command_buffer_allocate_info = {};
-	command_buffer_allocate_info.pNext = nullptr;
-	command_buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	command_buffer_allocate_info.commandPool = command_pool;
-	command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	command_buffer_allocate_info.commandBufferCount = 1;
+	VkImageCreateInfo image_info = {};
+	image_info.pNext = nullptr;
+	image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	image_info.imageType = VK_IMAGE_TYPE_2D;
+	image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	image_info.extent = { layer_width, layer_height, 1 };
+	image_info.mipLevels = 1;
+	image_info.arrayLayers = 1;
+	image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+	image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-	if ((result = vkAllocateCommandBuffers(device, &command_buffer_allocate_info, &command_buffer)) != VK_SUCCESS)
+	if ((result = vk->vkCreateImage(context->device, &image_info, context->allocation_callbacks, &layer.image)) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to allocate a command buffer. (%d)", result);
+		log(ERROR, "Failed to create a layer image. (%d)", result);
+		destroy_layer(layer);
 		return false;
 	}
 
-	if (!create_swapchain_image_views())
+	if (!context->allocator.allocate_image_memory(layer.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, &layer.memory, ImGuiVulkanMemoryPurpose::layer))
 	{
-		log(ERROR, "Failed to create swapchain image views.");
+		log(ERROR, "Failed to allocate memory for a layer.");
+		destroy_layer(layer);
 		return false;
 	}
 
-	// Create a render pass
-	VkAttachmentDescription attachement_description = {};
-	attachement_description.format = VK_FORMAT_R8G8B8A8_UNORM;
-	attachement_description.samples = VK_SAMPLE_COUNT_1_BIT;
-	attachement_description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachement_description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	attachement_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	attachement_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	attachement_description.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	attachement_description.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkAttachmentReference attachment_reference = {};
-	attachment_reference.attachment = 0;
-	attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkSubpassDescription subpass_description = {};
-	subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpass_description.colorAttachmentCount = 1;
-	subpass_description.pColorAttachments = &attachment_reference;
-
-	VkRenderPassCreateInfo render_pass_info = {};
-	render_pass_info.pNext = nullptr;
-	render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	render_pass_info.subpassCount = 1;
-	render_pass_info.pSubpasses = &subpass_description;
-	render_pass_info.attachmentCount = 1;
-	render_pass_info.pAttachments = &attachement_description;
-
-	if ((result = vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass)) != VK_SUCCESS)
-	{
-		log(ERROR, "Failed to create a render pass. (%d)", result);
+	layer.bytes = layer.memory.size;
+	layer.width = layer_width;
+	layer.height = layer_height;
+	layer_bytes += layer.bytes;
+
+	VkImageViewCreateInfo image_view_info = {};
+	image_view_info.pNext = nullptr;
+	image_view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	image_view_info.image = layer.image;
+	image_view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	image_view_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	image_view_info.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+	image_view_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	if ((result = vk->vkCreateImageView(context->device, &image_view_info, context->allocation_callbacks, &layer.view)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create an image view for a layer. (%d)", result);
+		destroy_layer(layer);
 		return false;
 	}
 
-	// Create a descriptor set layout
-	VkDescriptorSetLayoutBinding descriptor_set_layout_binding = {};
-	descriptor_set_layout_binding.binding = 0;
-	descriptor_set_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	descriptor_set_layout_binding.descriptorCount = 1;
-	descriptor_set_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	VkFramebufferCreateInfo framebuffer_info = {};
+	framebuffer_info.pNext = nullptr;
+	framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebuffer_info.width = layer_width;
+	framebuffer_info.height = layer_height;
+	framebuffer_info.renderPass = context->layer_render_pass;
+	framebuffer_info.attachmentCount = 1;
+	framebuffer_info.layers = 1;
+	framebuffer_info.pAttachments = &layer.view;
 
-	VkDescriptorSetLayoutCreateInfo descriptor_set_layout_info = {};
-	descriptor_set_layout_info.pNext = nullptr;
-	descriptor_set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descriptor_set_layout_info.bindingCount = 1;
-	descriptor_set_layout_info.pBindings = &descriptor_set_layout_binding;
+	if ((result = vk->vkCreateFramebuffer(context->device, &framebuffer_info, context->allocation_callbacks, &layer.framebuffer)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a framebuffer for a layer. (%d)", result);
+		destroy_layer(layer);
+		return false;
+	}
 
-	if ((result = vkCreateDescriptorSetLayout(device, &descriptor_set_layout_info, nullptr, &descriptor_set_layout)) != VK_SUCCESS)
+	// The descriptor pool is shared by all the windows of the context, so it may run out
+	VkDescriptorSetAllocateInfo descriptor_set_info = {};
+	descriptor_set_info.pNext = nullptr;
+	descriptor_set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptor_set_info.descriptorPool = context->layer_descriptor_pool;
+	descriptor_set_info.descriptorSetCount = 1;
+	descriptor_set_info.pSetLayouts = &context->descriptor_set_layout;
+
+	if (vk->vkAllocateDescriptorSets(context->device, &descriptor_set_info, &layer.descriptor_set) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to create a descriptor set layout. (%d)", result);
+		layer.descriptor_set = VK_NULL_HANDLE;
+		destroy_layer(layer);
 		return false;
 	}
 
-	// Create the pipeline layout
-	VkPushConstantRange push_constant_range;
-	push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-	push_constant_range.size = sizeof(float) * 16;
+	VkDescriptorImageInfo descriptor_image_info = {};
+	descriptor_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	descriptor_image_info.sampler = context->font_sampler;
+	descriptor_image_info.imageView = layer.view;
 
-	VkPipelineLayoutCreateInfo pipeline_layout_info = {};
-	pipeline_layout_info.pNext = nullptr;
-	pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipeline_layout_info.setLayoutCount = 1;
-	pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
-	pipeline_layout_info.pushConstantRangeCount = 1;
-	pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+	VkWriteDescriptorSet write_descriptor_set = {};
+	write_descriptor_set.pNext = nullptr;
+	write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write_descriptor_set.dstSet = layer.descriptor_set;
+	write_descriptor_set.descriptorCount = 1;
+	write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write_descriptor_set.pImageInfo = &descriptor_image_info;
 
-	if ((result = vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &pipeline_layout)) != VK_SUCCESS)
+	vk->vkUpdateDescriptorSets(context->device, 1, &write_descriptor_set, 0, nullptr);
+
+	return true;
+}
+
+void ImGuiVulkanRenderer::budget_callback(u32 heap, const ImGuiVulkanHeapBudget& budget, void* user_data)
+{
+	// May be called by the other windows of the context, so the layers are trimmed with the next frame
+	if (budget.purpose_usage[(u32)ImGuiVulkanMemoryPurpose::layer])
 	{
-		log(ERROR, "Failed to create a pipeline layout. (%d)", result);
-		return false;
+		static_cast<ImGuiVulkanRenderer*>(user_data)->over_budget = true;
 	}
+}
 
-	// Prepare vertex input bindings
-	vertex_input_binding.binding = 0;
-	vertex_input_binding.stride = sizeof(ImDrawVert);
-	vertex_input_binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-	// Prepare vertex input attributes
-	vertex_input_attribute[0].location = 0;
-	vertex_input_attribute[0].format = VK_FORMAT_R32G32_SFLOAT;
-	vertex_input_attribute[0].offset = offsetof(ImDrawVert, pos);
-
-	vertex_input_attribute[1].location = 1;
-	vertex_input_attribute[1].format = VK_FORMAT_R32G32_SFLOAT;
-	vertex_input_attribute[1].offset = offsetof(ImDrawVert, uv);
-
-	vertex_input_attribute[2].location = 2;
-	vertex_input_attribute[2].format = VK_FORMAT_R8G8B8A8_UNORM;
-	vertex_input_attribute[2].offset = offsetof(ImDrawVert, col);
-
-	// Create a rendering pipeline
-	// Vertex input info
-	VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
-	vertex_input_info.pNext = nullptr;
-	vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertex_input_info.vertexAttributeDescriptionCount = 3;
-	vertex_input_info.pVertexAttributeDescriptions = vertex_input_attribute;
-	vertex_input_info.vertexBindingDescriptionCount = 1;
-	vertex_input_info.pVertexBindingDescriptions = &vertex_input_binding;
-
-	// Vertex input assembly
-	VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {};
-	input_assembly_info.pNext = nullptr;
-	input_assembly_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	input_assembly_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-
-	// Viewport info
-	VkPipelineViewportStateCreateInfo viewport_info = {};
-	viewport_info.pNext = nullptr;
-	viewport_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewport_info.viewportCount = 1;
-	viewport_info.scissorCount = 1;
-
-	// Rasterization info
-	VkPipelineRasterizationStateCreateInfo rasterization_info = {};
-	rasterization_info.pNext = nullptr;
-	rasterization_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterization_info.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterization_info.cullMode = VK_CULL_MODE_NONE;
-	rasterization_info.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	rasterization_info.depthClampEnable = VK_FALSE;
-	rasterization_info.rasterizerDiscardEnable = VK_FALSE;
-	rasterization_info.depthBiasEnable = VK_FALSE;
-
-	// Multisampling info
-	VkPipelineMultisampleStateCreateInfo multisample_info = {};
-	multisample_info.pNext = nullptr;
-	multisample_info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisample_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-	// Depth stencil info
-	VkPipelineDepthStencilStateCreateInfo depth_stencil_info = {};
-	depth_stencil_info.pNext = nullptr;
-	depth_stencil_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depth_stencil_info.depthTestEnable = VK_TRUE;
-	depth_stencil_info.depthWriteEnable = VK_TRUE;
-	depth_stencil_info.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-	depth_stencil_info.depthBoundsTestEnable = VK_FALSE;
-	depth_stencil_info.back.failOp = VK_STENCIL_OP_KEEP;
-	depth_stencil_info.back.passOp = VK_STENCIL_OP_KEEP;
-	depth_stencil_info.back.compareOp = VK_COMPARE_OP_ALWAYS;
-	depth_stencil_info.stencilTestEnable = VK_FALSE;
-	depth_stencil_info.front = depth_stencil_info.back;
-
-	// Color blending info
-	VkPipelineColorBlendAttachmentState color_blend_attachment = {};
-	color_blend_attachment.blendEnable = VK_TRUE;
-	color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-	color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-	color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
-	color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
-	color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-	color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-	color_blend_attachment.colorWriteMask = 0xF;
-
-	VkPipelineColorBlendStateCreateInfo color_blend_info = {};
-	color_blend_info.pNext = nullptr;
-	color_blend_info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	color_blend_info.attachmentCount = 1;
-	color_blend_info.pAttachments = &color_blend_attachment;
-
-	// Dynamic states
-	std::vector<VkDynamicState> dynamic_states =
-	{
-		VK_DYNAMIC_STATE_VIEWPORT,
-		VK_DYNAMIC_STATE_SCISSOR
-	};
+void ImGuiVulkanRenderer::destroy_layer(Layer& layer)
+{
+	if (layer.descriptor_set)
+	{
+		vk->vkFreeDescriptorSets(context->device, context->layer_descriptor_pool, 1, &layer.descriptor_set);
+	}
 
-	VkPipelineDynamicStateCreateInfo dynamic_info;
-	dynamic_info.pNext = nullptr;
-	dynamic_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamic_info.dynamicStateCount = (u32)dynamic_states.size();
-	dynamic_info.pDynamicStates = dynamic_states.data();
+	if (layer.framebuffer)
+	{
+		vk->vkDestroyFramebuffer(context->device, layer.framebuffer, context->allocation_callbacks);
+	}
 
-	// Shaders
-	if (precompiled_shaders)
+	if (layer.view)
 	{
-		vertex_shader = load_shader(vulkan_vertex.data(), vulkan_vertex.size());
-		fragment_shader = load_shader(vulkan_fragment.data(), vulkan_fragment.size());
+		vk->vkDestroyImageView(context->device, layer.view, context->allocation_callbacks);
 	}
-	else
+
+	if (layer.image)
 	{
-		vertex_shader = load_shader(vertex_shader_path);
-		fragment_shader = load_shader(fragment_shader_path);
+		vk->vkDestroyImage(context->device, layer.image, context->allocation_callbacks);
 	}
 
-	VkPipelineShaderStageCreateInfo shader_info[2] = {};
-	shader_info[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	shader_info[0].module = vertex_shader;
-	shader_info[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-	shader_info[0].pName = "main";
+	context->allocator.free_memory(layer.memory);
+
+	layer_bytes -= layer.bytes;
 
-	shader_info[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	shader_info[1].module = fragment_shader;
-	shader_info[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	shader_info[1].pName = "main";
+	layer.descriptor_set = VK_NULL_HANDLE;
+	layer.framebuffer = VK_NULL_HANDLE;
+	layer.view = VK_NULL_HANDLE;
+	layer.image = VK_NULL_HANDLE;
+	layer.bytes = 0;
+	layer.width = 0;
+	layer.height = 0;
+	layer.valid = false;
+}
 
-	// Create the pipeline cache
-	VkPipelineCacheCreateInfo pipeline_cache_info = {};
-	pipeline_cache_info.pNext = nullptr;
-	pipeline_cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+bool ImGuiVulkanRenderer::start_capture(const std::string& file_name, bool compress)
+{
+	capture.reset(new ImGuiDrawDataWriter());
 
-	if ((result = vkCreatePipelineCache(device, &pipeline_cache_info, nullptr, &pipeline_cache)) != VK_SUCCESS)
+	if (!capture->open(file_name, ImGui::GetIO().Fonts, compress))
 	{
-		log(ERROR, "Failed to create a pipeline cache. (%d)", result);
+		capture.reset();
 		return false;
 	}
 
-	VkGraphicsPipelineCreateInfo pipeline_info = {};
-	pipeline_info.pNext = nullptr;
-	pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipeline_info.stageCount = 2;
-	pipeline_info.pStages = shader_info;
-	pipeline_info.pVertexInputState = &vertex_input_info;
-	pipeline_info.pInputAssemblyState = &input_assembly_info;
-	pipeline_info.pViewportState = &viewport_info;
-	pipeline_info.pRasterizationState = &rasterization_info;
-	pipeline_info.pMultisampleState = &multisample_info;
-	pipeline_info.pDepthStencilState = &depth_stencil_info;
-	pipeline_info.pColorBlendState = &color_blend_info;
-	pipeline_info.pDynamicState = &dynamic_info;
-	pipeline_info.renderPass = render_pass;
-	pipeline_info.layout = pipeline_layout;
-
-	if ((result = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_info, nullptr, &pipeline)) != VK_SUCCESS)
-	{
-		log(ERROR, "Failed to create a graphics pipeline. (%d)", result);
+	return true;
+}
+
+void ImGuiVulkanRenderer::stop_capture()
+{
+	if (capture)
+	{
+		log(INFO, "Captured %llu bytes of draw data into %llu bytes.", (unsigned long long)capture->captured_bytes, (unsigned long long)capture->written_bytes);
+		capture.reset();
+	}
+}
+
+bool ImGuiVulkanRenderer::start_streaming(const std::string& address, u16 port, bool compress)
+{
+	stream_server.reset(new ImGuiDrawDataServer());
+
+	if (!stream_server->listen(address, port, ImGui::GetIO().Fonts, compress))
+	{
+		stream_server.reset();
 		return false;
 	}
 
-	// Setup a descriptor pool
-	VkDescriptorPoolSize descriptor_pool_size = {};
-	descriptor_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	descriptor_pool_size.descriptorCount = 1;
+	return true;
+}
 
-	VkDescriptorPoolCreateInfo descriptor_pool_info = {};
-	descriptor_pool_info.pNext = nullptr;
-	descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	descriptor_pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-	descriptor_pool_info.poolSizeCount = 1;
-	descriptor_pool_info.pPoolSizes = &descriptor_pool_size;
-	descriptor_pool_info.maxSets = 1;
+void ImGuiVulkanRenderer::stop_streaming()
+{
+	if (stream_server)
+	{
+		log(INFO, "Streamed %llu frames in %llu bytes, %llu frames were dropped.", (unsigned long long)stream_server->sent_frames,
+			(unsigned long long)stream_server->sent_bytes, (unsigned long long)stream_server->dropped_frames);
+		stream_server.reset();
+	}
+}
 
-	if ((result = vkCreateDescriptorPool(device, &descriptor_pool_info, nullptr, &descriptor_pool)) != VK_SUCCESS)
+std::vector<ImGuiVulkanLayerStats> ImGuiVulkanRenderer::get_layer_stats() const
+{
+	std::vector<ImGuiVulkanLayerStats> layer_stats;
+
+	for (const auto& entry : layers)
 	{
-		log(ERROR, "Failed to create a descriptor pool. (%d)", result);
-		return false;
+		ImGuiVulkanLayerStats layer = {};
+		layer.draw_list = entry.first;
+		layer.name = entry.second.name;
+		layer.hits = entry.second.hits;
+		layer.misses = entry.second.misses;
+		layer.bytes = entry.second.bytes;
+		layer_stats.push_back(layer);
 	}
 
-	// Setup up the descriptor set
-	VkDescriptorSetAllocateInfo descriptor_set_info = {};
-	descriptor_set_info.pNext = nullptr;
-	descriptor_set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	descriptor_set_info.descriptorPool = descriptor_pool;
-	descriptor_set_info.descriptorSetCount = 1;
-	descriptor_set_info.pSetLayouts = &descriptor_set_layout;
+	return layer_stats;
+}
 
-	if ((result = vkAllocateDescriptorSets(device, &descriptor_set_info, &descriptor_set)) != VK_SUCCESS)
+void ImGuiVulkanRenderer::release_frame_resources(bool submitted)
+{
+	// A semaphore, which was signaled but never waited on, can't be used again
+	if (!submitted && image_acquired)
 	{
-		log(ERROR, "Failed to allocate a descriptor set. (%d)", result);
-		return false;
+		vk->vkDestroySemaphore(context->device, image_acquired, context->allocation_callbacks);
+		image_acquired = VK_NULL_HANDLE;
 	}
 
-	u8* pixels;
-	s32 width, height;
+	// Copies, which weren't flushed because the frame failed, would write into the reused buffers
+	if (uploader)
+	{
+		uploader->discard();
+	}
 
-	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	frame_pending = false;
+}
 
-	// Prepare font texture
-	VkImageCreateInfo image_info = {};
-	image_info.pNext = nullptr;
-	image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-	image_info.imageType = VK_IMAGE_TYPE_2D;
-	image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
-	image_info.extent = { (u32)width, (u32)height, 1 };
-	image_info.mipLevels = 1;
-	image_info.arrayLayers = 1;
-	image_info.samples = VK_SAMPLE_COUNT_1_BIT;
-	image_info.tiling = VK_IMAGE_TILING_LINEAR;
-	image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
-	image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	image_info.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+void ImGuiVulkanRenderer::imgui_render(ImDrawData* draw_data)
+{
+	ImGuiVulkanRenderer& renderer = *(ImGuiVulkanRenderer*)ImGui::GetIO().UserData;
 
-	if ((result = vkCreateImage(device, &image_info, nullptr, &font_image)) != VK_SUCCESS)
+	if (renderer.capture && !renderer.capture->write_frame(draw_data))
 	{
-		log(ERROR, "Failed to create a font image. (%d)", result);
-		return false;
+		log(ERROR, "Failed to capture the frame, the capture is stopped.");
+		renderer.capture.reset();
+	}
+
+	if (renderer.stream_server && !renderer.stream_server->write_frame(draw_data))
+	{
+		log(ERROR, "Failed to stream the frame, the stream is stopped.");
+		renderer.stream_server.reset();
 	}
 
-	VkMemoryRequirements memory_requirements;
-	vkGetImageMemoryRequirements(device, font_image, &memory_requirements);
+	// The host engine records the draws into its own command buffer later on
+	if (renderer.context->external)
+	{
+		renderer.host_draw_data = draw_data;
+		return;
+	}
 
-	VkMemoryAllocateInfo memory_allocation_info = {};
-	memory_allocation_info.pNext = nullptr;
-	memory_allocation_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memory_allocation_info.allocationSize = memory_requirements.size;
+	renderer.render(draw_data);
+}
+
+bool ImGuiVulkanRenderer::prepare_window()
+{
+	VkResult result;
 
-	if (!get_memory_type(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &memory_allocation_info.memoryTypeIndex))
+	// Create a window surface depending on the platform
+#ifdef _WIN32
+	VkWin32SurfaceCreateInfoKHR window_surface_info = {};
+	window_surface_info.pNext = nullptr;
+	window_surface_info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+	window_surface_info.hwnd = static_cast<HWND>(window_handle);
+	window_surface_info.hinstance = static_cast<HINSTANCE>(window_instance);
+
+	if ((result = vk->vkCreateWin32SurfaceKHR(context->instance, &window_surface_info, context->allocation_callbacks, &surface)) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to get the memory type. (%d)", result);
+		log(ERROR, "Failed to create window surface. (%d)", result);
 		return false;
 	}
+#else
+	// TODO: Unix version
+#endif
 
-	if ((result = vkAllocateMemory(device, &memory_allocation_info, nullptr, &font_memory)) != VK_SUCCESS)
+	// The device is created with the first window of the context
+	if (!context->prepare_device(surface))
 	{
-		log(ERROR, "Failed to allocate memory for font texture. (%d)", result);
+		log(ERROR, "Failed to prepare the device.");
 		return false;
 	}
 
-	if ((result = vkBindImageMemory(device, font_image, font_memory, 0)) != VK_SUCCESS)
+	// Get surface capabilities and presentation modes
+	u32 present_mode_count;
+
+	if ((result = vk->vkGetPhysicalDeviceSurfacePresentModesKHR(context->physical_device, surface, &present_mode_count, nullptr)) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to bind memory for font texture. (%d)", result);
+		log(ERROR, "Failed to obtain the number of device surface present modes. (%d)", result);
 		return false;
 	}
 
-	VkImageViewCreateInfo image_view_info;
-	image_view_info.pNext = nullptr;
-	image_view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-	image_view_info.image = font_image;
-	image_view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-	image_view_info.format = VK_FORMAT_R8G8B8A8_UNORM;
-	image_view_info.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
-	image_view_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	std::vector<VkPresentModeKHR> present_modes(present_mode_count);
 
-	if ((result = vkCreateImageView(device, &image_view_info, nullptr, &font_image_view)) != VK_SUCCESS)
+	if ((result = vk->vkGetPhysicalDeviceSurfacePresentModesKHR(context->physical_device, surface, &present_mode_count, present_modes.data())) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to create image view for font texture. (%d)", result);
+		log(ERROR, "Failed to obtain the surface present modes. (%d)", result);
 		return false;
 	}
 
-	VkSamplerCreateInfo sampler_info;
-	sampler_info.pNext = nullptr;
-	sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-	sampler_info.magFilter = VK_FILTER_NEAREST;
-	sampler_info.minFilter = VK_FILTER_NEAREST;
-	sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-	sampler_info.anisotropyEnable = VK_FALSE;
-	sampler_info.maxAnisotropy = 1.0f;
-	sampler_info.compareOp = VK_COMPARE_OP_NEVER;
-	sampler_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-	sampler_info.unnormalizedCoordinates = VK_FALSE;
-
-	if ((result = vkCreateSampler(device, &sampler_info, nullptr, &font_sampler)) != VK_SUCCESS)
-	{
-		log(ERROR, "Failed to create a sampler for font texture. (%d)", result);
+	VkSurfaceCapabilitiesKHR surface_capabilities;
+
+	if ((result = vk->vkGetPhysicalDeviceSurfaceCapabilitiesKHR(context->physical_device, surface, &surface_capabilities)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain the device surface capabilities. (%d)", result);
 		return false;
 	}
 
-	// Update descriptors
-	VkDescriptorImageInfo descriptor_image_info = {};
-	descriptor_image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	descriptor_image_info.sampler = font_sampler;
-	descriptor_image_info.imageView = font_image_view;
+	present_mode = present_modes[0];
 
-	VkWriteDescriptorSet write_descriptor_set = {};
-	write_descriptor_set.pNext = nullptr;
-	write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write_descriptor_set.dstSet = descriptor_set;
-	write_descriptor_set.descriptorCount = 1;
-	write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	write_descriptor_set.pImageInfo = &descriptor_image_info;
+	// Create a swapchain
+	VkSwapchainCreateInfoKHR swapchain_info = {};
+	swapchain_info.pNext = nullptr;
+	swapchain_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	swapchain_info.surface = surface;
+	swapchain_info.imageArrayLayers = 1;
+	swapchain_info.imageExtent = surface_capabilities.currentExtent;
+	swapchain_info.imageFormat = context->surface_format.format;
+	swapchain_info.imageColorSpace = context->surface_format.colorSpace;
+	swapchain_info.presentMode = present_mode;
+	swapchain_info.minImageCount = 2;
+	swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	swapchain_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 
-	vkUpdateDescriptorSets(device, 1, &write_descriptor_set, 0, nullptr);
+	if ((result = vk->vkCreateSwapchainKHR(context->device, &swapchain_info, context->allocation_callbacks, &swapchain)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a swapchain. (%d)", result);
+		return false;
+	}
 
-	// Upload the image to the GPU
-	VkImageSubresource image_subresource = {};
-	image_subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	u32 swapchain_image_count;
 
-	VkSubresourceLayout subresource_layout = {};
-	vkGetImageSubresourceLayout(device, font_image, &image_subresource, &subresource_layout);
+	if ((result = vk->vkGetSwapchainImagesKHR(context->device, swapchain, &swapchain_image_count, nullptr)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain the number of swapchain images. (%d)", result);
+		return false;
+	}
 
-	void* data;
+	if ((result = vk->vkGetSwapchainImagesKHR(context->device, swapchain, &swapchain_image_count, swapchain_images)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to obtain the number of swapchain images. (%d)", result);
+		return false;
+	}
+
+	// Set the ImGui size values
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize.x = static_cast<float>(surface_capabilities.currentExtent.width);
+	io.DisplaySize.y = static_cast<float>(surface_capabilities.currentExtent.height);
 
-	if ((result = vkMapMemory(device, font_memory, 0, subresource_layout.size, 0, &data)) != VK_SUCCESS)
+	// Create a command pool
+	VkCommandPoolCreateInfo command_pool_info = {};
+	command_pool_info.pNext = nullptr;
+	command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_info.queueFamilyIndex = context->queue_family;
+	command_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	if ((result = vk->vkCreateCommandPool(context->device, &command_pool_info, context->allocation_callbacks, &command_pool)) != VK_SUCCESS)
 	{
-		log(ERROR, "Failed to map memory for font texture upload. (%d)", result);
+		log(ERROR, "Failed to create a command pool. (%d)", result);
 		return false;
 	}
 
-	memcpy(data, pixels, subresource_layout.size);
+	// Allocate a command buffer
+	VkCommandBufferAllocateInfo command_buffer_allocate_info = {};
+	command_buffer_allocate_info.pNext = nullptr;
+	command_buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	command_buffer_allocate_info.commandPool = command_pool;
+	command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	command_buffer_allocate_info.commandBufferCount = 1;
+
+	if ((result = vk->vkAllocateCommandBuffers(context->device, &command_buffer_allocate_info, &command_buffer)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate a command buffer. (%d)", result);
+		return false;
+	}
 
-	vkUnmapMemory(device, font_memory);
+	if (!create_swapchain_image_views())
+	{
+		log(ERROR, "Failed to create swapchain image views.");
+		return false;
+	}
 
 	return true;
 }
@@ -1294,23 +1587,81 @@ bool ImGuiVulkanRenderer::initialize(void* handle, void* instance, void* rendere
 
 	// Set some internal values
 	clear_value = options.clear_value;
-	precompiled_shaders = options.use_precompiled_shaders;
+	defer_submission = options.defer_submission;
+	layer_budget = options.layer_cache_budget;
+
+	uploader.reset(new ImGuiUploadCopier());
+	uploader->initialize(options.upload_thread_count, options.parallel_upload_bytes);
 
-	if (!options.vertex_shader.empty())
+	// Windows either share a context, or create their own
+	if (options.shared_context)
 	{
-		vertex_shader_path = options.vertex_shader;
+		context = options.shared_context;
+		vk = &context->vk;
 	}
+	else
+	{
+		owned_context.reset(new ImGuiVulkanContext());
+		context = owned_context.get();
+		vk = &context->vk;
 
-	if (!options.fragment_shader.empty())
+		if (!context->initialize(options))
+		{
+			log(ERROR, "Failed to initialize Vulkan context.");
+			return false;
+		}
+	}
+
+	// Layers need their pipelines in the context, which can't be created with a host engine
+	layer_cache = options.layer_cache && context->layer_cache;
+
+	if (options.layer_cache && !layer_cache)
 	{
-		fragment_shader_path = options.fragment_shader;
+		log(WARNING, "The layer cache isn't available with this context.");
 	}
 
-	if (!prepare_vulkan(options.device_number, options.validation_layers))
+	if (layer_cache)
+	{
+		context->allocator.add_budget_callback(budget_callback, this);
+	}
+
+	// Embedded renderers have no window of their own to prepare
+	if (context->external)
+	{
+		// Without a window the delta time is measured independently of the window timer
+		if (!handle)
+		{
+			time = 0;
+		}
+
+		if (options.render_thread)
+		{
+			log(WARNING, "The render thread isn't available with a host engine, which records the draws itself.");
+		}
+
+		upload_arenas.resize(context->frames_in_flight);
+		return true;
+	}
+
+	upload_arenas.resize(1);
+
+	if (!prepare_window())
 	{
 		log(ERROR, "Failed to initialize Vulkan renderer.");
 		return false;
 	}
 
+	// Deferred submission happens on the thread, which calls submit_frame, so it can't be moved to a render thread
+	if (options.render_thread && defer_submission)
+	{
+		log(WARNING, "The render thread isn't available with deferred submission, frames are rendered by ImGui::Render.");
+	}
+	else if (options.render_thread)
+	{
+		snapshots[0].reset(new ImGuiDrawDataSnapshot());
+		snapshots[1].reset(new ImGuiDrawDataSnapshot());
+		render_worker = std::thread(&ImGuiVulkanRenderer::render_loop, this);
+	}
+
 	return true;
-}
\ No newline at end of file
+}
@@ -1,25 +1,42 @@
 #pragma once
 
-#include "../ImGuiRenderers.h"
-
-// Platform-specific includes and surface extension defines
-#ifdef _WIN32
-#define VK_USE_PLATFORM_WIN32_KHR
-#endif
+#include "VulkanContext.h"
 
 // Headers
-#include <fstream>
-#include "vulkan/vulkan.h"
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+
+class ImGuiDrawDataServer;
+class ImGuiDrawDataSnapshot;
+class ImGuiDrawDataWriter;
+class ImGuiUploadCopier;
+struct ImDrawVertPacking;
+
+// Vertex format, which the draw lists are uploaded in
+enum class ImGuiVulkanVertexFormat : u8
+{
+	runtime, // Chosen with compact_vertices in the options
+	full,    // ImDrawVert
+	compact, // ImDrawVertPacked
+};
 
-// Stores the options for the renderer, which are passed during initialization.
-struct ImGuiVulkanOptions
+// Textures, which the draw commands sample
+enum class ImGuiVulkanTextureMode : u8
 {
-	VkClearValue clear_value;     // Colour, which to clear the screen to every frame
-	u8 device_number;             // Number of the device, which to use for rendering
-	bool validation_layers;       // Whether to enable Vulkan validation layers or not
-	bool use_precompiled_shaders; // Whether to use included precompiled shaders or not
-	std::string vertex_shader;    // Vertex shader path.   Default path: "../shaders/imgui.vert.spv"
-	std::string fragment_shader;  // Fragment shader path. Default path: "../shaders/imgui.frag.spv"
+	font_atlas,      // Only the font atlas, TextureId is ignored
+	descriptor_sets, // TextureId is a VkDescriptorSet compatible with the pipeline layout, or null for the font atlas
+};
+
+// Compile-time configuration of the render loop. ImGuiVulkanRendererT in VulkanRenderLoop.h takes a struct like this one,
+// and the branches it rules out are compiled out. The index type always follows ImDrawIdx.
+struct ImGuiVulkanDefaultTraits
+{
+	static const ImGuiVulkanVertexFormat vertex_format = ImGuiVulkanVertexFormat::runtime;
+	static const ImGuiVulkanTextureMode texture_mode = ImGuiVulkanTextureMode::font_atlas;
+	static const bool layer_cache = true;  // Whether the layer cache may be enabled in the options
+	static const bool debug_checks = true; // Whether validation layers and the checks of the render loop are available
 };
 
 class ImGuiVulkanRenderer : public ImGuiRenderer
@@ -29,265 +46,218 @@ public:
 	bool initialize(void* handle, void* instance, void* renderer_options);
 	void new_frame();
 
-	// TODO: These shouldn't probably be public. Maybe use a struct with needed handles for rendering?
+	// Renders the draw data into the window. Submission is left to the context, if it was deferred in the options.
+	// With a render thread, the draw data is copied and handed off to it instead.
+	void render(ImDrawData* draw_data);
+
+	// Returns once the render thread has rendered all the frames handed off to it
+	void wait_for_render_thread();
+
+	// Only records the draws into a command buffer of the host engine, inside its render pass.
+	// Without draw data, the draw data of the last ImGui::Render call is used.
+	void record(VkCommandBuffer command_buffer, ImDrawData* draw_data = nullptr);
+
+	// For convenience
+	const ImGuiVulkanStats& get_stats() const { return stats; } // With a render thread, only valid after wait_for_render_thread
+	ImGuiVulkanRenderThreadStats get_render_thread_stats();
+	std::vector<ImGuiVulkanLayerStats> get_layer_stats() const;
+
+	// Captures the draw data of every rendered frame and the font atlas into a file, which ImGuiDrawDataReader replays
+	bool start_capture(const std::string& file_name, bool compress = false);
+	void stop_capture();
+
+	// Streams the draw data of every rendered frame to a viewer, which connects to the address and TCP port, or a Unix socket
+	// at the address when the port is 0. The viewer renders it with ImGuiDrawDataClient. See DrawDataRemote.h.
+	bool start_streaming(const std::string& address, u16 port, bool compress = false);
+	void stop_streaming();
+	ImGuiDrawDataServer* get_stream_server() { return stream_server.get(); } // For registering textures
+
+	// Shared between all the windows using the same context
+	ImGuiVulkanContext* context = nullptr;
+
 	// Vulkan
-	VkInstance instance;
-	VkPhysicalDevice physical_device;
-	VkDevice device;
-	VkQueue queue;
-	VkSurfaceKHR surface;
-	VkSwapchainKHR swapchain;
-	VkCommandPool command_pool;
-	VkCommandBuffer command_buffer;
-	VkPhysicalDeviceMemoryProperties memory_properties;
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+	VkCommandPool command_pool = VK_NULL_HANDLE;
+	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
 
 	// Rendering
-	VkImage swapchain_images[2];
-	VkImageView swapchain_image_views[2];
-	VkPipeline pipeline;
-	VkPipelineCache pipeline_cache;
-	VkPipelineLayout pipeline_layout;
-	VkDescriptorSet descriptor_set;
-	VkDescriptorSetLayout descriptor_set_layout;
-	VkDescriptorPool descriptor_pool;
-	VkVertexInputAttributeDescription vertex_input_attribute[3];
-	VkVertexInputBindingDescription vertex_input_binding;
-	VkRenderPass render_pass;
+	VkImage swapchain_images[2] = {};
+	VkImageView swapchain_image_views[2] = {};
+	VkFramebuffer framebuffers[2] = {}; // Kept until the size of the frames or the swapchain changes
+	VkExtent2D framebuffer_extent = {};
 	VkClearValue clear_value;
-	VkShaderModule vertex_shader;
-	VkShaderModule fragment_shader;
-
-	// For convenience
-	VkBool32 get_memory_type(u32 typeBits, VkFlags properties, u32 *typeIndex);
 
 private:
-	// For debug output
-	PFN_vkCreateDebugReportCallbackEXT create_debug_report;
-	PFN_vkDestroyDebugReportCallbackEXT destroy_debug_report;
-	VkDebugReportCallbackEXT debug_callback_function;
-	static VkBool32 debug_callback(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT type, u64 src, u64 location, s32 msg_code, char* prefix, char* msg, void* user_data);
+	friend class ImGuiVulkanContext;
+	template<typename Traits> friend class ImGuiVulkanRendererT;
+
+	// A draw list, which is composited from an offscreen layer as long as its content doesn't change
+	struct Layer
+	{
+		u64 hash = 0;
+		u64 last_used = 0;
+		bool valid = false; // Whether the layer contains the draw list with the hash
+
+		VkImage image = VK_NULL_HANDLE;
+		ImGuiVulkanAllocation memory;
+		VkImageView view = VK_NULL_HANDLE;
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+		u64 bytes = 0;
+
+		// Area of the screen covered by the layer
+		s32 x = 0;
+		s32 y = 0;
+		u32 width = 0;
+		u32 height = 0;
+
+		const char* name = nullptr;
+		u64 hits = 0;
+		u64 misses = 0;
+	};
+
+	// Part of a draw command, which is either drawn from the remaining triangles or as instanced quads
+	struct QuadBatch
+	{
+		u32 command;
+		u32 first; // First index of the triangles, or first instance of the quads
+		u32 count;
+		bool quads;
+	};
+
+	// Layout of a draw list, whose runs of quads are uploaded as instances
+	struct QuadList
+	{
+		std::vector<QuadBatch> batches;
+		u64 index_buffer_offset = 0;
+		u64 quad_offset = 0;
+		bool active = false;
+	};
 
 	// Vulkan
-	VkSurfaceFormatKHR surface_format;
 	VkPresentModeKHR present_mode;
 
-	// For font
-	VkImage font_image;
-	VkImageView font_image_view;
-	VkSampler font_sampler;
-	VkDeviceMemory font_memory;
+	// Reused by every frame, as the queue is idle after each submission. Only recreated after a frame failed
+	VkSemaphore image_acquired = VK_NULL_HANDLE;
+	u32 current_buffer = 0;
+
+	// Buffer and offset of the upload of each draw list of the frame, the last one holds the quads of the layers
+	std::vector<VkBuffer> render_buffers;
+	std::vector<VkDeviceSize> buffer_offsets;
+
+	// Upload memory of a frame, which the draw lists are sub-allocated from in order. It grows by further blocks,
+	// which are merged into one once the frame is done, so that the frames after it fit into a single block.
+	struct UploadBlock
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		ImGuiVulkanAllocation memory;
+		u64 size = 0;
+	};
+
+	struct UploadArena
+	{
+		std::vector<UploadBlock> blocks;
+		u64 used = 0; // Bytes used of the last block
+	};
+
+	// One arena per frame, which the host engine may still be rendering. A window waits for each frame, so it only needs one
+	std::vector<UploadArena> upload_arenas;
+	u32 frame_slot = 0;
+	static const u64 minimum_upload_block = 256 * 1024;
+	ImDrawData* host_draw_data = nullptr;
+	float projection_rect[4] = {}; // Area of the render target, which the last projection mapped to
+	std::vector<ImDrawVertPacking> list_packings; // Of the compact vertices of each draw list, the last one of the layer quads
+
+	// Layer cache
+	std::unordered_map<const ImDrawList*, Layer> layers;
+	std::vector<Layer*> list_layers; // Layer, which each draw list of the frame is composited from
+	u64 layer_bytes = 0;
+	u64 layer_budget = 0;
+	bool layer_cache = false;
+	u64 frame_number = 0;
+	std::atomic<bool> over_budget{ false }; // Set by the budget callback of the allocator
+	bool layer_pass = false; // Whether the draw lists are uploaded for their layers
+	std::vector<ImDrawVert> composite_quads; // Corners of the quads, which composite the layers
+
+	// Instanced quads, the scratch buffers hold the draw list being uploaded
+	std::vector<QuadList> list_quads;
+	std::vector<ImDrawVert> quad_vertices;
+	std::vector<ImDrawIdx> quad_indices;
+	std::vector<ImDrawVert> quad_corners;
+	std::vector<u32> quad_remap;
+
+	// Render thread, which renders the snapshots handed off by the UI thread
+	std::thread render_worker;
+	std::mutex render_mutex;
+	std::condition_variable render_wake;
+	std::condition_variable render_idle;
+	std::unique_ptr<ImGuiDrawDataSnapshot> snapshots[2];
+	u32 rendering_snapshot = 0; // Snapshot, which the render thread renders. The UI thread fills the other one
+	bool snapshot_queued = false;
+	bool rendering = false;
+	bool render_exiting = false;
+	std::chrono::steady_clock::time_point handoff_time;
+	ImGuiVulkanRenderThreadStats render_thread_stats = {};
+
+	// Display size and framebuffer scale of the frame being rendered, which ImGui may already have changed on a render thread
+	ImVec2 display_size;
+	ImVec2 framebuffer_scale;
 
 	// For convenience
-	u32 get_graphics_family(VkPhysicalDevice adapter, VkSurfaceKHR window_surface);
-	VkShaderModule load_shader(std::string file_name);
-	VkShaderModule load_shader(const u8* shader, u64 size);
 	bool create_swapchain_image_views();
 
 	// Internal functions for the renderer
-	bool prepare_vulkan(u8 device_num, bool validation_layers);
+	bool prepare_window();
+	void render_frame(ImDrawData* draw_data);
+	void queue_frame(ImDrawData* draw_data);
+	void render_loop();
+	void* create_upload_buffer(u32 index, u64 size);
+	void push_projection(VkCommandBuffer command_buffer, float x, float y, float width, float height);
+	void push_packing(VkCommandBuffer command_buffer, const ImDrawVertPacking& packing);
+	void prepare_layers(VkCommandBuffer command_buffer, ImDrawData* draw_data);
+	bool prepare_quads(u32 index, ImDrawList* draw_list);
+	bool create_layer(Layer& layer, u32 width, u32 height);
+	void destroy_layer(Layer& layer);
+	static void budget_callback(u32 heap, const ImGuiVulkanHeapBudget& budget, void* user_data);
+	void release_frame_resources(bool submitted);
+	void reset_upload_arena(u32 slot, u32 buffer_count);
+	bool create_upload_block(UploadBlock& block, u64 size);
+	void destroy_upload_block(UploadBlock& block);
 	static void imgui_render(ImDrawData* draw_data);
 
+	// The render loop, specialized for the traits in VulkanRenderLoop.h
+	template<typename Traits> void record_draw_lists(VkCommandBuffer command_buffer, ImDrawData* draw_data);
+	template<typename Traits> bool upload_draw_list(u32 index, ImDrawList* draw_list);
+	template<typename Traits> void draw_draw_list(VkCommandBuffer command_buffer, ImDrawList* draw_list, u32 index, s32 x, s32 y);
+	template<typename Traits> bool upload_quads(u32 index);
+	template<typename Traits> void draw_quads(VkCommandBuffer command_buffer, ImDrawList* draw_list, u32 index);
+	template<typename Traits> void record_indirect(VkCommandBuffer command_buffer, ImDrawData* draw_data);
+
+	// The instantiations of the render loop, which the renderer uses
+	void (ImGuiVulkanRenderer::*record_function)(VkCommandBuffer command_buffer, ImDrawData* draw_data) = &ImGuiVulkanRenderer::record_draw_lists<ImGuiVulkanDefaultTraits>;
+	bool (ImGuiVulkanRenderer::*upload_function)(u32 index, ImDrawList* draw_list) = &ImGuiVulkanRenderer::upload_draw_list<ImGuiVulkanDefaultTraits>;
+	void (ImGuiVulkanRenderer::*draw_function)(VkCommandBuffer command_buffer, ImDrawList* draw_list, u32 index, s32 x, s32 y) = &ImGuiVulkanRenderer::draw_draw_list<ImGuiVulkanDefaultTraits>;
+
 	// Internal values
-	bool precompiled_shaders;
-	std::string vertex_shader_path = "../shaders/imgui.vert.spv";
-	std::string fragment_shader_path = "../shaders/imgui.frag.spv";
-};
+	std::unique_ptr<ImGuiVulkanContext> owned_context;
+	const ImGuiVulkanDispatch* vk = nullptr; // Entry points of the context
+	bool defer_submission = false;
+	bool frame_pending = false;
+	ImGuiVulkanStats stats = {};
+	ImGuiVulkanFrameErrors errors;
 
-const std::vector<u8> vulkan_vertex = {
-	0x03, 0x02, 0x23, 0x07, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x08, 0x00,
-	0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x02, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x11, 0x00, 0x02, 0x00, 0x20, 0x00, 0x00, 0x00,
-	0x11, 0x00, 0x02, 0x00, 0x21, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x06, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x47, 0x4C, 0x53, 0x4C, 0x2E, 0x73, 0x74, 0x64,
-	0x2E, 0x34, 0x35, 0x30, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x03, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x0B, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x6D, 0x61, 0x69, 0x6E,
-	0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00,
-	0x0F, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
-	0x22, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00, 0x02, 0x00, 0x00, 0x00,
-	0xC2, 0x01, 0x00, 0x00, 0x04, 0x00, 0x09, 0x00, 0x47, 0x4C, 0x5F, 0x41,
-	0x52, 0x42, 0x5F, 0x73, 0x65, 0x70, 0x61, 0x72, 0x61, 0x74, 0x65, 0x5F,
-	0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x5F, 0x6F, 0x62, 0x6A, 0x65, 0x63,
-	0x74, 0x73, 0x00, 0x00, 0x04, 0x00, 0x09, 0x00, 0x47, 0x4C, 0x5F, 0x41,
-	0x52, 0x42, 0x5F, 0x73, 0x68, 0x61, 0x64, 0x69, 0x6E, 0x67, 0x5F, 0x6C,
-	0x61, 0x6E, 0x67, 0x75, 0x61, 0x67, 0x65, 0x5F, 0x34, 0x32, 0x30, 0x70,
-	0x61, 0x63, 0x6B, 0x00, 0x05, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00,
-	0x6D, 0x61, 0x69, 0x6E, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x04, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x6F, 0x75, 0x74, 0x5F, 0x55, 0x56, 0x00, 0x00,
-	0x05, 0x00, 0x04, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x69, 0x6E, 0x5F, 0x55,
-	0x56, 0x00, 0x00, 0x00, 0x05, 0x00, 0x05, 0x00, 0x0F, 0x00, 0x00, 0x00,
-	0x6F, 0x75, 0x74, 0x5F, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x00, 0x00, 0x00,
-	0x05, 0x00, 0x05, 0x00, 0x11, 0x00, 0x00, 0x00, 0x69, 0x6E, 0x5F, 0x63,
-	0x6F, 0x6C, 0x6F, 0x72, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x06, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x67, 0x6C, 0x5F, 0x50, 0x65, 0x72, 0x56, 0x65,
-	0x72, 0x74, 0x65, 0x78, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x06, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x67, 0x6C, 0x5F, 0x50,
-	0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x00, 0x06, 0x00, 0x07, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x67, 0x6C, 0x5F, 0x50,
-	0x6F, 0x69, 0x6E, 0x74, 0x53, 0x69, 0x7A, 0x65, 0x00, 0x00, 0x00, 0x00,
-	0x06, 0x00, 0x07, 0x00, 0x16, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-	0x67, 0x6C, 0x5F, 0x43, 0x6C, 0x69, 0x70, 0x44, 0x69, 0x73, 0x74, 0x61,
-	0x6E, 0x63, 0x65, 0x00, 0x06, 0x00, 0x07, 0x00, 0x16, 0x00, 0x00, 0x00,
-	0x03, 0x00, 0x00, 0x00, 0x67, 0x6C, 0x5F, 0x43, 0x75, 0x6C, 0x6C, 0x44,
-	0x69, 0x73, 0x74, 0x61, 0x6E, 0x63, 0x65, 0x00, 0x05, 0x00, 0x03, 0x00,
-	0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x03, 0x00,
-	0x1C, 0x00, 0x00, 0x00, 0x55, 0x42, 0x4F, 0x00, 0x06, 0x00, 0x08, 0x00,
-	0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x72, 0x6F, 0x6A,
-	0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x5F, 0x6D, 0x61, 0x74, 0x72, 0x69,
-	0x78, 0x00, 0x00, 0x00, 0x05, 0x00, 0x03, 0x00, 0x1E, 0x00, 0x00, 0x00,
-	0x75, 0x62, 0x6F, 0x00, 0x05, 0x00, 0x04, 0x00, 0x22, 0x00, 0x00, 0x00,
-	0x69, 0x6E, 0x5F, 0x70, 0x6F, 0x73, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x47, 0x00, 0x04, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x0F, 0x00, 0x00, 0x00,
-	0x1E, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
-	0x11, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-	0x48, 0x00, 0x05, 0x00, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x00, 0x05, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x48, 0x00, 0x05, 0x00, 0x16, 0x00, 0x00, 0x00,
-	0x02, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
-	0x48, 0x00, 0x05, 0x00, 0x16, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
-	0x0B, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x47, 0x00, 0x03, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x48, 0x00, 0x04, 0x00,
-	0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
-	0x48, 0x00, 0x05, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x00, 0x05, 0x00,
-	0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-	0x10, 0x00, 0x00, 0x00, 0x47, 0x00, 0x03, 0x00, 0x1C, 0x00, 0x00, 0x00,
-	0x02, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x1E, 0x00, 0x00, 0x00,
-	0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
-	0x22, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x13, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x21, 0x00, 0x03, 0x00,
-	0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x16, 0x00, 0x03, 0x00,
-	0x06, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x17, 0x00, 0x04, 0x00,
-	0x07, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-	0x20, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
-	0x07, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
-	0x0A, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-	0x3B, 0x00, 0x04, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x17, 0x00, 0x04, 0x00, 0x0D, 0x00, 0x00, 0x00,
-	0x06, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
-	0x0E, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00,
-	0x3B, 0x00, 0x04, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00,
-	0x03, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x10, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00,
-	0x10, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-	0x15, 0x00, 0x04, 0x00, 0x13, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x2B, 0x00, 0x04, 0x00, 0x13, 0x00, 0x00, 0x00,
-	0x14, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x04, 0x00,
-	0x15, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
-	0x1E, 0x00, 0x06, 0x00, 0x16, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00,
-	0x06, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00,
-	0x20, 0x00, 0x04, 0x00, 0x17, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00, 0x17, 0x00, 0x00, 0x00,
-	0x18, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x15, 0x00, 0x04, 0x00,
-	0x19, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-	0x2B, 0x00, 0x04, 0x00, 0x19, 0x00, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x04, 0x00, 0x1B, 0x00, 0x00, 0x00,
-	0x0D, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x03, 0x00,
-	0x1C, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
-	0x1D, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,
-	0x3B, 0x00, 0x04, 0x00, 0x1D, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x1F, 0x00, 0x00, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00,
-	0x0A, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-	0x2B, 0x00, 0x04, 0x00, 0x06, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x2B, 0x00, 0x04, 0x00, 0x06, 0x00, 0x00, 0x00,
-	0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x20, 0x00, 0x04, 0x00,
-	0x2B, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
-	0x36, 0x00, 0x05, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x02, 0x00,
-	0x05, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x04, 0x00, 0x07, 0x00, 0x00, 0x00,
-	0x0C, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x03, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x04, 0x00,
-	0x0D, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00,
-	0x3E, 0x00, 0x03, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
-	0x41, 0x00, 0x05, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
-	0x1E, 0x00, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x04, 0x00,
-	0x1B, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
-	0x3D, 0x00, 0x04, 0x00, 0x07, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00,
-	0x22, 0x00, 0x00, 0x00, 0x51, 0x00, 0x05, 0x00, 0x06, 0x00, 0x00, 0x00,
-	0x26, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x51, 0x00, 0x05, 0x00, 0x06, 0x00, 0x00, 0x00, 0x27, 0x00, 0x00, 0x00,
-	0x23, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x50, 0x00, 0x07, 0x00,
-	0x0D, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x26, 0x00, 0x00, 0x00,
-	0x27, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00,
-	0x91, 0x00, 0x05, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00,
-	0x21, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x41, 0x00, 0x05, 0x00,
-	0x0E, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
-	0x1A, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x03, 0x00, 0x2A, 0x00, 0x00, 0x00,
-	0x29, 0x00, 0x00, 0x00, 0x41, 0x00, 0x06, 0x00, 0x2B, 0x00, 0x00, 0x00,
-	0x2C, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00,
-	0x14, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x04, 0x00, 0x06, 0x00, 0x00, 0x00,
-	0x2D, 0x00, 0x00, 0x00, 0x2C, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x04, 0x00,
-	0x06, 0x00, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x2D, 0x00, 0x00, 0x00,
-	0x41, 0x00, 0x06, 0x00, 0x2B, 0x00, 0x00, 0x00, 0x2F, 0x00, 0x00, 0x00,
-	0x18, 0x00, 0x00, 0x00, 0x1A, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
-	0x3E, 0x00, 0x03, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00,
-	0xFD, 0x00, 0x01, 0x00, 0x38, 0x00, 0x01, 0x00, };
-
-const std::vector<u8> vulkan_fragment = {
-	0x03, 0x02, 0x23, 0x07, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x08, 0x00,
-	0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x02, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x06, 0x00, 0x01, 0x00, 0x00, 0x00,
-	0x47, 0x4C, 0x53, 0x4C, 0x2E, 0x73, 0x74, 0x64, 0x2E, 0x34, 0x35, 0x30,
-	0x00, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x08, 0x00, 0x04, 0x00, 0x00, 0x00,
-	0x04, 0x00, 0x00, 0x00, 0x6D, 0x61, 0x69, 0x6E, 0x00, 0x00, 0x00, 0x00,
-	0x09, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
-	0x10, 0x00, 0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
-	0x03, 0x00, 0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0xC2, 0x01, 0x00, 0x00,
-	0x04, 0x00, 0x09, 0x00, 0x47, 0x4C, 0x5F, 0x41, 0x52, 0x42, 0x5F, 0x73,
-	0x65, 0x70, 0x61, 0x72, 0x61, 0x74, 0x65, 0x5F, 0x73, 0x68, 0x61, 0x64,
-	0x65, 0x72, 0x5F, 0x6F, 0x62, 0x6A, 0x65, 0x63, 0x74, 0x73, 0x00, 0x00,
-	0x04, 0x00, 0x09, 0x00, 0x47, 0x4C, 0x5F, 0x41, 0x52, 0x42, 0x5F, 0x73,
-	0x68, 0x61, 0x64, 0x69, 0x6E, 0x67, 0x5F, 0x6C, 0x61, 0x6E, 0x67, 0x75,
-	0x61, 0x67, 0x65, 0x5F, 0x34, 0x32, 0x30, 0x70, 0x61, 0x63, 0x6B, 0x00,
-	0x05, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 0x6D, 0x61, 0x69, 0x6E,
-	0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x05, 0x00, 0x09, 0x00, 0x00, 0x00,
-	0x6F, 0x75, 0x74, 0x5F, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x00, 0x00, 0x00,
-	0x05, 0x00, 0x05, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x69, 0x6E, 0x5F, 0x63,
-	0x6F, 0x6C, 0x6F, 0x72, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x06, 0x00,
-	0x10, 0x00, 0x00, 0x00, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x5F,
-	0x73, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x72, 0x00, 0x05, 0x00, 0x04, 0x00,
-	0x14, 0x00, 0x00, 0x00, 0x69, 0x6E, 0x5F, 0x55, 0x56, 0x00, 0x00, 0x00,
-	0x47, 0x00, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x0B, 0x00, 0x00, 0x00,
-	0x1E, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
-	0x10, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x47, 0x00, 0x04, 0x00, 0x10, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x14, 0x00, 0x00, 0x00,
-	0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x00, 0x02, 0x00,
-	0x02, 0x00, 0x00, 0x00, 0x21, 0x00, 0x03, 0x00, 0x03, 0x00, 0x00, 0x00,
-	0x02, 0x00, 0x00, 0x00, 0x16, 0x00, 0x03, 0x00, 0x06, 0x00, 0x00, 0x00,
-	0x20, 0x00, 0x00, 0x00, 0x17, 0x00, 0x04, 0x00, 0x07, 0x00, 0x00, 0x00,
-	0x06, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
-	0x08, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-	0x3B, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
-	0x03, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x0A, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00,
-	0x0A, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-	0x19, 0x00, 0x09, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
-	0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x1B, 0x00, 0x03, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00,
-	0x20, 0x00, 0x04, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x0E, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00, 0x0F, 0x00, 0x00, 0x00,
-	0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x17, 0x00, 0x04, 0x00,
-	0x12, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-	0x20, 0x00, 0x04, 0x00, 0x13, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-	0x12, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x04, 0x00, 0x13, 0x00, 0x00, 0x00,
-	0x14, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x36, 0x00, 0x05, 0x00,
-	0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x03, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x02, 0x00, 0x05, 0x00, 0x00, 0x00,
-	0x3D, 0x00, 0x04, 0x00, 0x07, 0x00, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x00,
-	0x0B, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x04, 0x00, 0x0E, 0x00, 0x00, 0x00,
-	0x11, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x04, 0x00,
-	0x12, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
-	0x57, 0x00, 0x05, 0x00, 0x07, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00,
-	0x11, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x85, 0x00, 0x05, 0x00,
-	0x07, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x00,
-	0x16, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x03, 0x00, 0x09, 0x00, 0x00, 0x00,
-	0x17, 0x00, 0x00, 0x00, 0xFD, 0x00, 0x01, 0x00, 0x38, 0x00, 0x01, 0x00, };
\ No newline at end of file
+	// Timestamps of the last frame, which the GPU span of the trace is read back from with the next frame. Without
+	// calibrated timestamps, the GPU clock is placed on the CPU timeline by the earliest a frame could have started.
+	VkQueryPool timestamp_pool = VK_NULL_HANDLE;
+	bool timestamps_written = false;
+	u64 timestamps_recorded = 0; // CPU time, when the frame with the timestamps was recorded
+	s64 gpu_clock_offset = 0;
+	bool gpu_clock_known = false;
+	void begin_gpu_trace();
+	void end_gpu_trace();
+
+	std::unique_ptr<ImGuiDrawDataWriter> capture;
+	std::unique_ptr<ImGuiDrawDataServer> stream_server;
+	std::unique_ptr<ImGuiUploadCopier> uploader;
+};
@@ -0,0 +1,302 @@
+// Generated by shaders/embed_shaders.py from the shaders in the shaders directory, don't edit.
+
+#include "VulkanShaders.h"
+
+alignas(4) const u32 vulkan_fragment[186] = {
+	0x07230203, 0x00010000, 0x00080001, 0x00000018, 0x00000000, 0x00020011, 0x00000001, 0x0006000B,
+	0x00000001, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000, 0x0003000E, 0x00000000, 0x00000001,
+	0x0008000F, 0x00000004, 0x00000004, 0x6E69616D, 0x00000000, 0x00000009, 0x0000000B, 0x00000014,
+	0x00030010, 0x00000004, 0x00000008, 0x00030003, 0x00000002, 0x000001C2, 0x00090004, 0x415F4C47,
+	0x735F4252, 0x72617065, 0x5F657461, 0x64616873, 0x6F5F7265, 0x63656A62, 0x00007374, 0x00090004,
+	0x415F4C47, 0x735F4252, 0x69646168, 0x6C5F676E, 0x75676E61, 0x5F656761, 0x70303234, 0x006B6361,
+	0x00040005, 0x00000004, 0x6E69616D, 0x00000000, 0x00050005, 0x00000009, 0x5F74756F, 0x6F6C6F63,
+	0x00000072, 0x00050005, 0x0000000B, 0x635F6E69, 0x726F6C6F, 0x00000000, 0x00060005, 0x00000010,
+	0x74786574, 0x5F657275, 0x706D6173, 0x0072656C, 0x00040005, 0x00000014, 0x555F6E69, 0x00000056,
+	0x00040047, 0x00000009, 0x0000001E, 0x00000000, 0x00040047, 0x0000000B, 0x0000001E, 0x00000001,
+	0x00040047, 0x00000010, 0x00000022, 0x00000000, 0x00040047, 0x00000010, 0x00000021, 0x00000000,
+	0x00040047, 0x00000014, 0x0000001E, 0x00000000, 0x00020013, 0x00000002, 0x00030021, 0x00000003,
+	0x00000002, 0x00030016, 0x00000006, 0x00000020, 0x00040017, 0x00000007, 0x00000006, 0x00000004,
+	0x00040020, 0x00000008, 0x00000003, 0x00000007, 0x0004003B, 0x00000008, 0x00000009, 0x00000003,
+	0x00040020, 0x0000000A, 0x00000001, 0x00000007, 0x0004003B, 0x0000000A, 0x0000000B, 0x00000001,
+	0x00090019, 0x0000000D, 0x00000006, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000001,
+	0x00000000, 0x0003001B, 0x0000000E, 0x0000000D, 0x00040020, 0x0000000F, 0x00000000, 0x0000000E,
+	0x0004003B, 0x0000000F, 0x00000010, 0x00000000, 0x00040017, 0x00000012, 0x00000006, 0x00000002,
+	0x00040020, 0x00000013, 0x00000001, 0x00000012, 0x0004003B, 0x00000013, 0x00000014, 0x00000001,
+	0x00050036, 0x00000002, 0x00000004, 0x00000000, 0x00000003, 0x000200F8, 0x00000005, 0x0004003D,
+	0x00000007, 0x0000000C, 0x0000000B, 0x0004003D, 0x0000000E, 0x00000011, 0x00000010, 0x0004003D,
+	0x00000012, 0x00000015, 0x00000014, 0x00050057, 0x00000007, 0x00000016, 0x00000011, 0x00000015,
+	0x00050085, 0x00000007, 0x00000017, 0x0000000C, 0x00000016, 0x0003003E, 0x00000009, 0x00000017,
+	0x000100FD, 0x00010038,
+};
+const u64 vulkan_fragment_size = sizeof(vulkan_fragment);
+
+alignas(4) const u32 vulkan_vertex[398] = {
+	0x07230203, 0x00010000, 0x00080001, 0x00000030, 0x00000000, 0x00020011, 0x00000001, 0x00020011,
+	0x00000020, 0x00020011, 0x00000021, 0x0006000B, 0x00000001, 0x4C534C47, 0x6474732E, 0x3035342E,
+	0x00000000, 0x0003000E, 0x00000000, 0x00000001, 0x000B000F, 0x00000000, 0x00000004, 0x6E69616D,
+	0x00000000, 0x00000009, 0x0000000B, 0x0000000F, 0x00000011, 0x00000018, 0x00000022, 0x00030003,
+	0x00000002, 0x000001C2, 0x00090004, 0x415F4C47, 0x735F4252, 0x72617065, 0x5F657461, 0x64616873,
+	0x6F5F7265, 0x63656A62, 0x00007374, 0x00090004, 0x415F4C47, 0x735F4252, 0x69646168, 0x6C5F676E,
+	0x75676E61, 0x5F656761, 0x70303234, 0x006B6361, 0x00040005, 0x00000004, 0x6E69616D, 0x00000000,
+	0x00040005, 0x00000009, 0x5F74756F, 0x00005655, 0x00040005, 0x0000000B, 0x555F6E69, 0x00000056,
+	0x00050005, 0x0000000F, 0x5F74756F, 0x6F6C6F63, 0x00000072, 0x00050005, 0x00000011, 0x635F6E69,
+	0x726F6C6F, 0x00000000, 0x00060005, 0x00000016, 0x505F6C67, 0x65567265, 0x78657472, 0x00000000,
+	0x00060006, 0x00000016, 0x00000000, 0x505F6C67, 0x7469736F, 0x006E6F69, 0x00070006, 0x00000016,
+	0x00000001, 0x505F6C67, 0x746E696F, 0x657A6953, 0x00000000, 0x00070006, 0x00000016, 0x00000002,
+	0x435F6C67, 0x4470696C, 0x61747369, 0x0065636E, 0x00070006, 0x00000016, 0x00000003, 0x435F6C67,
+	0x446C6C75, 0x61747369, 0x0065636E, 0x00030005, 0x00000018, 0x00000000, 0x00030005, 0x0000001C,
+	0x004F4255, 0x00080006, 0x0000001C, 0x00000000, 0x6A6F7270, 0x69746365, 0x6D5F6E6F, 0x69727461,
+	0x00000078, 0x00030005, 0x0000001E, 0x006F6275, 0x00040005, 0x00000022, 0x705F6E69, 0x0000736F,
+	0x00040047, 0x00000009, 0x0000001E, 0x00000000, 0x00040047, 0x0000000B, 0x0000001E, 0x00000001,
+	0x00040047, 0x0000000F, 0x0000001E, 0x00000001, 0x00040047, 0x00000011, 0x0000001E, 0x00000002,
+	0x00050048, 0x00000016, 0x00000000, 0x0000000B, 0x00000000, 0x00050048, 0x00000016, 0x00000001,
+	0x0000000B, 0x00000001, 0x00050048, 0x00000016, 0x00000002, 0x0000000B, 0x00000003, 0x00050048,
+	0x00000016, 0x00000003, 0x0000000B, 0x00000004, 0x00030047, 0x00000016, 0x00000002, 0x00040048,
+	0x0000001C, 0x00000000, 0x00000005, 0x00050048, 0x0000001C, 0x00000000, 0x00000023, 0x00000000,
+	0x00050048, 0x0000001C, 0x00000000, 0x00000007, 0x00000010, 0x00030047, 0x0000001C, 0x00000002,
+	0x00040047, 0x0000001E, 0x00000022, 0x00000000, 0x00040047, 0x00000022, 0x0000001E, 0x00000000,
+	0x00020013, 0x00000002, 0x00030021, 0x00000003, 0x00000002, 0x00030016, 0x00000006, 0x00000020,
+	0x00040017, 0x00000007, 0x00000006, 0x00000002, 0x00040020, 0x00000008, 0x00000003, 0x00000007,
+	0x0004003B, 0x00000008, 0x00000009, 0x00000003, 0x00040020, 0x0000000A, 0x00000001, 0x00000007,
+	0x0004003B, 0x0000000A, 0x0000000B, 0x00000001, 0x00040017, 0x0000000D, 0x00000006, 0x00000004,
+	0x00040020, 0x0000000E, 0x00000003, 0x0000000D, 0x0004003B, 0x0000000E, 0x0000000F, 0x00000003,
+	0x00040020, 0x00000010, 0x00000001, 0x0000000D, 0x0004003B, 0x00000010, 0x00000011, 0x00000001,
+	0x00040015, 0x00000013, 0x00000020, 0x00000000, 0x0004002B, 0x00000013, 0x00000014, 0x00000001,
+	0x0004001C, 0x00000015, 0x00000006, 0x00000014, 0x0006001E, 0x00000016, 0x0000000D, 0x00000006,
+	0x00000015, 0x00000015, 0x00040020, 0x00000017, 0x00000003, 0x00000016, 0x0004003B, 0x00000017,
+	0x00000018, 0x00000003, 0x00040015, 0x00000019, 0x00000020, 0x00000001, 0x0004002B, 0x00000019,
+	0x0000001A, 0x00000000, 0x00040018, 0x0000001B, 0x0000000D, 0x00000004, 0x0003001E, 0x0000001C,
+	0x0000001B, 0x00040020, 0x0000001D, 0x00000009, 0x0000001C, 0x0004003B, 0x0000001D, 0x0000001E,
+	0x00000009, 0x00040020, 0x0000001F, 0x00000009, 0x0000001B, 0x0004003B, 0x0000000A, 0x00000022,
+	0x00000001, 0x0004002B, 0x00000006, 0x00000024, 0x00000000, 0x0004002B, 0x00000006, 0x00000025,
+	0x3F800000, 0x00040020, 0x0000002B, 0x00000003, 0x00000006, 0x00050036, 0x00000002, 0x00000004,
+	0x00000000, 0x00000003, 0x000200F8, 0x00000005, 0x0004003D, 0x00000007, 0x0000000C, 0x0000000B,
+	0x0003003E, 0x00000009, 0x0000000C, 0x0004003D, 0x0000000D, 0x00000012, 0x00000011, 0x0003003E,
+	0x0000000F, 0x00000012, 0x00050041, 0x0000001F, 0x00000020, 0x0000001E, 0x0000001A, 0x0004003D,
+	0x0000001B, 0x00000021, 0x00000020, 0x0004003D, 0x00000007, 0x00000023, 0x00000022, 0x00050051,
+	0x00000006, 0x00000026, 0x00000023, 0x00000000, 0x00050051, 0x00000006, 0x00000027, 0x00000023,
+	0x00000001, 0x00070050, 0x0000000D, 0x00000028, 0x00000026, 0x00000027, 0x00000024, 0x00000025,
+	0x00050091, 0x0000000D, 0x00000029, 0x00000021, 0x00000028, 0x00050041, 0x0000000E, 0x0000002A,
+	0x00000018, 0x0000001A, 0x0003003E, 0x0000002A, 0x00000029, 0x00060041, 0x0000002B, 0x0000002C,
+	0x00000018, 0x0000001A, 0x00000014, 0x0004003D, 0x00000006, 0x0000002D, 0x0000002C, 0x0004007F,
+	0x00000006, 0x0000002E, 0x0000002D, 0x00060041, 0x0000002B, 0x0000002F, 0x00000018, 0x0000001A,
+	0x00000014, 0x0003003E, 0x0000002F, 0x0000002E, 0x000100FD, 0x00010038,
+};
+const u64 vulkan_vertex_size = sizeof(vulkan_vertex);
+
+alignas(4) const u32 vulkan_indirect_fragment[306] = {
+	0x07230203, 0x00010000, 0x00000000, 0x0000002C, 0x00000000, 0x00020011, 0x00000001, 0x0006000B,
+	0x00000001, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000, 0x0003000E, 0x00000000, 0x00000001,
+	0x000A000F, 0x00000004, 0x00000002, 0x6E69616D, 0x00000000, 0x00000003, 0x00000004, 0x00000005,
+	0x00000006, 0x00000007, 0x00030010, 0x00000002, 0x00000007, 0x00030003, 0x00000002, 0x000001C2,
+	0x00090004, 0x415F4C47, 0x735F4252, 0x72617065, 0x5F657461, 0x64616873, 0x6F5F7265, 0x63656A62,
+	0x00007374, 0x00090004, 0x415F4C47, 0x735F4252, 0x69646168, 0x6C5F676E, 0x75676E61, 0x5F656761,
+	0x70303234, 0x006B6361, 0x00040005, 0x00000002, 0x6E69616D, 0x00000000, 0x00050005, 0x00000005,
+	0x5F74756F, 0x6F6C6F63, 0x00000072, 0x00050005, 0x00000006, 0x635F6E69, 0x726F6C6F, 0x00000000,
+	0x00060005, 0x00000008, 0x74786574, 0x5F657275, 0x706D6173, 0x0072656C, 0x00040005, 0x00000007,
+	0x555F6E69, 0x00000056, 0x00060005, 0x00000003, 0x465F6C67, 0x43676172, 0x64726F6F, 0x00000000,
+	0x00060005, 0x00000004, 0x635F6E69, 0x5F70696C, 0x74636572, 0x00000000, 0x00040047, 0x00000005,
+	0x0000001E, 0x00000000, 0x00040047, 0x00000006, 0x0000001E, 0x00000001, 0x00040047, 0x00000008,
+	0x00000022, 0x00000000, 0x00040047, 0x00000008, 0x00000021, 0x00000000, 0x00040047, 0x00000007,
+	0x0000001E, 0x00000000, 0x00040047, 0x00000003, 0x0000000B, 0x0000000F, 0x00030047, 0x00000004,
+	0x0000000E, 0x00040047, 0x00000004, 0x0000001E, 0x00000002, 0x00020013, 0x00000009, 0x00030021,
+	0x0000000A, 0x00000009, 0x00030016, 0x0000000B, 0x00000020, 0x00040017, 0x0000000C, 0x0000000B,
+	0x00000002, 0x00040017, 0x0000000D, 0x0000000B, 0x00000004, 0x00040020, 0x0000000E, 0x00000003,
+	0x0000000D, 0x00040020, 0x0000000F, 0x00000001, 0x0000000D, 0x00040020, 0x00000010, 0x00000001,
+	0x0000000C, 0x00090019, 0x00000011, 0x0000000B, 0x00000001, 0x00000000, 0x00000000, 0x00000000,
+	0x00000001, 0x00000000, 0x0003001B, 0x00000012, 0x00000011, 0x00040020, 0x00000013, 0x00000000,
+	0x00000012, 0x0004003B, 0x00000013, 0x00000008, 0x00000000, 0x0004003B, 0x0000000E, 0x00000005,
+	0x00000003, 0x0004003B, 0x00000010, 0x00000007, 0x00000001, 0x0004003B, 0x0000000F, 0x00000006,
+	0x00000001, 0x00020014, 0x00000014, 0x0004003B, 0x0000000F, 0x00000003, 0x00000001, 0x0004003B,
+	0x0000000F, 0x00000004, 0x00000001, 0x00050036, 0x00000009, 0x00000002, 0x00000000, 0x0000000A,
+	0x000200F8, 0x00000015, 0x0004003D, 0x0000000D, 0x00000016, 0x00000003, 0x0004003D, 0x0000000D,
+	0x00000017, 0x00000004, 0x00050051, 0x0000000B, 0x00000018, 0x00000016, 0x00000000, 0x00050051,
+	0x0000000B, 0x00000019, 0x00000016, 0x00000001, 0x00050051, 0x0000000B, 0x0000001A, 0x00000017,
+	0x00000000, 0x00050051, 0x0000000B, 0x0000001B, 0x00000017, 0x00000001, 0x00050051, 0x0000000B,
+	0x0000001C, 0x00000017, 0x00000002, 0x00050051, 0x0000000B, 0x0000001D, 0x00000017, 0x00000003,
+	0x000500B8, 0x00000014, 0x0000001E, 0x00000018, 0x0000001A, 0x000500B8, 0x00000014, 0x0000001F,
+	0x00000019, 0x0000001B, 0x000500BE, 0x00000014, 0x00000020, 0x00000018, 0x0000001C, 0x000500BE,
+	0x00000014, 0x00000021, 0x00000019, 0x0000001D, 0x000500A6, 0x00000014, 0x00000022, 0x0000001E,
+	0x0000001F, 0x000500A6, 0x00000014, 0x00000023, 0x00000022, 0x00000020, 0x000500A6, 0x00000014,
+	0x00000024, 0x00000023, 0x00000021, 0x000300F7, 0x00000025, 0x00000000, 0x000400FA, 0x00000024,
+	0x00000026, 0x00000025, 0x000200F8, 0x00000026, 0x000100FC, 0x000200F8, 0x00000025, 0x0004003D,
+	0x0000000D, 0x00000027, 0x00000006, 0x0004003D, 0x00000012, 0x00000028, 0x00000008, 0x0004003D,
+	0x0000000C, 0x00000029, 0x00000007, 0x00050057, 0x0000000D, 0x0000002A, 0x00000028, 0x00000029,
+	0x00050085, 0x0000000D, 0x0000002B, 0x00000027, 0x0000002A, 0x0003003E, 0x00000005, 0x0000002B,
+	0x000100FD, 0x00010038,
+};
+const u64 vulkan_indirect_fragment_size = sizeof(vulkan_indirect_fragment);
+
+alignas(4) const u32 vulkan_indirect_vertex[400] = {
+	0x07230203, 0x00010000, 0x00000000, 0x00000032, 0x00000000, 0x00020011, 0x00000001, 0x0006000B,
+	0x00000001, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000, 0x0003000E, 0x00000000, 0x00000001,
+	0x000D000F, 0x00000000, 0x00000002, 0x6E69616D, 0x00000000, 0x00000003, 0x00000004, 0x00000005,
+	0x00000006, 0x00000007, 0x00000008, 0x00000009, 0x0000000A, 0x00030003, 0x00000002, 0x000001C2,
+	0x00090004, 0x415F4C47, 0x735F4252, 0x72617065, 0x5F657461, 0x64616873, 0x6F5F7265, 0x63656A62,
+	0x00007374, 0x00090004, 0x415F4C47, 0x735F4252, 0x69646168, 0x6C5F676E, 0x75676E61, 0x5F656761,
+	0x70303234, 0x006B6361, 0x00040005, 0x00000002, 0x6E69616D, 0x00000000, 0x00040005, 0x00000003,
+	0x5F74756F, 0x00005655, 0x00040005, 0x00000004, 0x555F6E69, 0x00000056, 0x00050005, 0x00000005,
+	0x5F74756F, 0x6F6C6F63, 0x00000072, 0x00050005, 0x00000006, 0x635F6E69, 0x726F6C6F, 0x00000000,
+	0x00060005, 0x00000007, 0x5F74756F, 0x70696C63, 0x6365725F, 0x00000074, 0x00060005, 0x00000008,
+	0x635F6E69, 0x5F70696C, 0x74636572, 0x00000000, 0x00060005, 0x0000000B, 0x505F6C67, 0x65567265,
+	0x78657472, 0x00000000, 0x00060006, 0x0000000B, 0x00000000, 0x505F6C67, 0x7469736F, 0x006E6F69,
+	0x00070006, 0x0000000B, 0x00000001, 0x505F6C67, 0x746E696F, 0x657A6953, 0x00000000, 0x00030005,
+	0x00000009, 0x00000000, 0x00030005, 0x0000000C, 0x004F4255, 0x00080006, 0x0000000C, 0x00000000,
+	0x6A6F7270, 0x69746365, 0x6D5F6E6F, 0x69727461, 0x00000078, 0x00030005, 0x0000000D, 0x006F6275,
+	0x00040005, 0x0000000A, 0x705F6E69, 0x0000736F, 0x00040047, 0x00000003, 0x0000001E, 0x00000000,
+	0x00040047, 0x00000004, 0x0000001E, 0x00000001, 0x00040047, 0x00000005, 0x0000001E, 0x00000001,
+	0x00040047, 0x00000006, 0x0000001E, 0x00000002, 0x00030047, 0x00000007, 0x0000000E, 0x00040047,
+	0x00000007, 0x0000001E, 0x00000002, 0x00040047, 0x00000008, 0x0000001E, 0x00000003, 0x00050048,
+	0x0000000B, 0x00000000, 0x0000000B, 0x00000000, 0x00050048, 0x0000000B, 0x00000001, 0x0000000B,
+	0x00000001, 0x00030047, 0x0000000B, 0x00000002, 0x00040048, 0x0000000C, 0x00000000, 0x00000005,
+	0x00050048, 0x0000000C, 0x00000000, 0x00000023, 0x00000000, 0x00050048, 0x0000000C, 0x00000000,
+	0x00000007, 0x00000010, 0x00030047, 0x0000000C, 0x00000002, 0x00040047, 0x0000000A, 0x0000001E,
+	0x00000000, 0x00020013, 0x0000000E, 0x00030021, 0x0000000F, 0x0000000E, 0x00030016, 0x00000010,
+	0x00000020, 0x00040017, 0x00000011, 0x00000010, 0x00000002, 0x00040017, 0x00000012, 0x00000010,
+	0x00000004, 0x00040015, 0x00000013, 0x00000020, 0x00000000, 0x00040015, 0x00000014, 0x00000020,
+	0x00000001, 0x0004002B, 0x00000013, 0x00000015, 0x00000001, 0x0004002B, 0x00000014, 0x00000016,
+	0x00000000, 0x0004002B, 0x00000010, 0x00000017, 0x00000000, 0x0004002B, 0x00000010, 0x00000018,
+	0x3F800000, 0x0004001E, 0x0000000B, 0x00000012, 0x00000010, 0x00040020, 0x00000019, 0x00000003,
+	0x0000000B, 0x0004003B, 0x00000019, 0x00000009, 0x00000003, 0x00040018, 0x0000001A, 0x00000012,
+	0x00000004, 0x0003001E, 0x0000000C, 0x0000001A, 0x00040020, 0x0000001B, 0x00000009, 0x0000000C,
+	0x0004003B, 0x0000001B, 0x0000000D, 0x00000009, 0x00040020, 0x0000001C, 0x00000009, 0x0000001A,
+	0x00040020, 0x0000001D, 0x00000003, 0x00000012, 0x00040020, 0x0000001E, 0x00000003, 0x00000010,
+	0x00040020, 0x0000001F, 0x00000003, 0x00000011, 0x00040020, 0x00000020, 0x00000001, 0x00000011,
+	0x00040020, 0x00000021, 0x00000001, 0x00000012, 0x0004003B, 0x0000001F, 0x00000003, 0x00000003,
+	0x0004003B, 0x00000020, 0x00000004, 0x00000001, 0x0004003B, 0x0000001D, 0x00000005, 0x00000003,
+	0x0004003B, 0x00000021, 0x00000006, 0x00000001, 0x0004003B, 0x0000001D, 0x00000007, 0x00000003,
+	0x0004003B, 0x00000021, 0x00000008, 0x00000001, 0x0004003B, 0x00000020, 0x0000000A, 0x00000001,
+	0x00050036, 0x0000000E, 0x00000002, 0x00000000, 0x0000000F, 0x000200F8, 0x00000022, 0x0004003D,
+	0x00000011, 0x00000023, 0x00000004, 0x0003003E, 0x00000003, 0x00000023, 0x0004003D, 0x00000012,
+	0x00000024, 0x00000006, 0x0003003E, 0x00000005, 0x00000024, 0x0004003D, 0x00000012, 0x00000025,
+	0x00000008, 0x0003003E, 0x00000007, 0x00000025, 0x0004003D, 0x00000011, 0x00000026, 0x0000000A,
+	0x00050041, 0x0000001C, 0x00000027, 0x0000000D, 0x00000016, 0x0004003D, 0x0000001A, 0x00000028,
+	0x00000027, 0x00050051, 0x00000010, 0x00000029, 0x00000026, 0x00000000, 0x00050051, 0x00000010,
+	0x0000002A, 0x00000026, 0x00000001, 0x00070050, 0x00000012, 0x0000002B, 0x00000029, 0x0000002A,
+	0x00000017, 0x00000018, 0x00050091, 0x00000012, 0x0000002C, 0x00000028, 0x0000002B, 0x00050041,
+	0x0000001D, 0x0000002D, 0x00000009, 0x00000016, 0x0003003E, 0x0000002D, 0x0000002C, 0x00060041,
+	0x0000001E, 0x0000002E, 0x00000009, 0x00000016, 0x00000015, 0x0004003D, 0x00000010, 0x0000002F,
+	0x0000002E, 0x0004007F, 0x00000010, 0x00000030, 0x0000002F, 0x00060041, 0x0000001E, 0x00000031,
+	0x00000009, 0x00000016, 0x00000015, 0x0003003E, 0x00000031, 0x00000030, 0x000100FD, 0x00010038,
+};
+const u64 vulkan_indirect_vertex_size = sizeof(vulkan_indirect_vertex);
+
+alignas(4) const u32 vulkan_quad_vertex[571] = {
+	0x07230203, 0x00010000, 0x00000000, 0x00000053, 0x00000000, 0x00020011, 0x00000001, 0x0006000B,
+	0x00000001, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000, 0x0003000E, 0x00000000, 0x00000001,
+	0x000C000F, 0x00000000, 0x00000002, 0x6E69616D, 0x00000000, 0x00000003, 0x00000004, 0x00000005,
+	0x00000006, 0x00000007, 0x00000008, 0x00000009, 0x00030003, 0x00000002, 0x000001C2, 0x00090004,
+	0x415F4C47, 0x735F4252, 0x72617065, 0x5F657461, 0x64616873, 0x6F5F7265, 0x63656A62, 0x00007374,
+	0x00090004, 0x415F4C47, 0x735F4252, 0x69646168, 0x6C5F676E, 0x75676E61, 0x5F656761, 0x70303234,
+	0x006B6361, 0x00040005, 0x00000002, 0x6E69616D, 0x00000000, 0x00040005, 0x0000000A, 0x6E726F63,
+	0x00007265, 0x00060005, 0x00000003, 0x565F6C67, 0x65747265, 0x646E4978, 0x00007865, 0x00050005,
+	0x0000000B, 0x65646E69, 0x6C626178, 0x00000065, 0x00040005, 0x0000000C, 0x67696577, 0x00007468,
+	0x00040005, 0x00000004, 0x5F74756F, 0x00005655, 0x00050005, 0x00000005, 0x555F6E69, 0x65725F56,
+	0x00007463, 0x00050005, 0x00000006, 0x5F74756F, 0x6F6C6F63, 0x00000072, 0x00050005, 0x00000007,
+	0x635F6E69, 0x726F6C6F, 0x00000000, 0x00060005, 0x0000000D, 0x505F6C67, 0x65567265, 0x78657472,
+	0x00000000, 0x00060006, 0x0000000D, 0x00000000, 0x505F6C67, 0x7469736F, 0x006E6F69, 0x00070006,
+	0x0000000D, 0x00000001, 0x505F6C67, 0x746E696F, 0x657A6953, 0x00000000, 0x00030005, 0x00000008,
+	0x00000000, 0x00030005, 0x0000000E, 0x004F4255, 0x00080006, 0x0000000E, 0x00000000, 0x6A6F7270,
+	0x69746365, 0x6D5F6E6F, 0x69727461, 0x00000078, 0x00030005, 0x0000000F, 0x006F6275, 0x00040005,
+	0x00000009, 0x725F6E69, 0x00746365, 0x00040047, 0x00000003, 0x0000000B, 0x0000002A, 0x00040047,
+	0x00000004, 0x0000001E, 0x00000000, 0x00040047, 0x00000005, 0x0000001E, 0x00000001, 0x00040047,
+	0x00000006, 0x0000001E, 0x00000001, 0x00040047, 0x00000007, 0x0000001E, 0x00000002, 0x00050048,
+	0x0000000D, 0x00000000, 0x0000000B, 0x00000000, 0x00050048, 0x0000000D, 0x00000001, 0x0000000B,
+	0x00000001, 0x00030047, 0x0000000D, 0x00000002, 0x00040048, 0x0000000E, 0x00000000, 0x00000005,
+	0x00050048, 0x0000000E, 0x00000000, 0x00000023, 0x00000000, 0x00050048, 0x0000000E, 0x00000000,
+	0x00000007, 0x00000010, 0x00030047, 0x0000000E, 0x00000002, 0x00040047, 0x00000009, 0x0000001E,
+	0x00000000, 0x00020013, 0x00000010, 0x00030021, 0x00000011, 0x00000010, 0x00030016, 0x00000012,
+	0x00000020, 0x00040017, 0x00000013, 0x00000012, 0x00000002, 0x00040017, 0x00000014, 0x00000012,
+	0x00000004, 0x00040015, 0x00000015, 0x00000020, 0x00000000, 0x00040015, 0x00000016, 0x00000020,
+	0x00000001, 0x0004002B, 0x00000015, 0x00000017, 0x00000001, 0x0004002B, 0x00000016, 0x00000018,
+	0x00000000, 0x0004002B, 0x00000012, 0x00000019, 0x00000000, 0x0004002B, 0x00000012, 0x0000001A,
+	0x3F800000, 0x0004001E, 0x0000000D, 0x00000014, 0x00000012, 0x00040020, 0x0000001B, 0x00000003,
+	0x0000000D, 0x0004003B, 0x0000001B, 0x00000008, 0x00000003, 0x00040018, 0x0000001C, 0x00000014,
+	0x00000004, 0x0003001E, 0x0000000E, 0x0000001C, 0x00040020, 0x0000001D, 0x00000009, 0x0000000E,
+	0x0004003B, 0x0000001D, 0x0000000F, 0x00000009, 0x00040020, 0x0000001E, 0x00000009, 0x0000001C,
+	0x00040020, 0x0000001F, 0x00000003, 0x00000014, 0x00040020, 0x00000020, 0x00000003, 0x00000012,
+	0x00040020, 0x00000021, 0x00000003, 0x00000013, 0x00040020, 0x00000022, 0x00000001, 0x00000013,
+	0x00040020, 0x00000023, 0x00000001, 0x00000014, 0x00020014, 0x00000024, 0x0004002B, 0x00000015,
+	0x00000025, 0x00000006, 0x0004001C, 0x00000026, 0x00000016, 0x00000025, 0x0004002B, 0x00000016,
+	0x00000027, 0x00000001, 0x0004002B, 0x00000016, 0x00000028, 0x00000002, 0x0004002B, 0x00000016,
+	0x00000029, 0x00000003, 0x0009002C, 0x00000026, 0x0000002A, 0x00000018, 0x00000027, 0x00000028,
+	0x00000018, 0x00000028, 0x00000029, 0x00040020, 0x0000002B, 0x00000007, 0x00000016, 0x00040020,
+	0x0000002C, 0x00000007, 0x00000026, 0x00040020, 0x0000002D, 0x00000007, 0x00000013, 0x00040020,
+	0x0000002E, 0x00000001, 0x00000016, 0x0004003B, 0x0000002E, 0x00000003, 0x00000001, 0x0004003B,
+	0x00000021, 0x00000004, 0x00000003, 0x0004003B, 0x00000023, 0x00000005, 0x00000001, 0x0004003B,
+	0x0000001F, 0x00000006, 0x00000003, 0x0004003B, 0x00000023, 0x00000007, 0x00000001, 0x0004003B,
+	0x00000023, 0x00000009, 0x00000001, 0x00050036, 0x00000010, 0x00000002, 0x00000000, 0x00000011,
+	0x000200F8, 0x0000002F, 0x0004003B, 0x0000002B, 0x0000000A, 0x00000007, 0x0004003B, 0x0000002C,
+	0x0000000B, 0x00000007, 0x0004003B, 0x0000002D, 0x0000000C, 0x00000007, 0x0004003D, 0x00000016,
+	0x00000030, 0x00000003, 0x0003003E, 0x0000000B, 0x0000002A, 0x00050041, 0x0000002B, 0x00000031,
+	0x0000000B, 0x00000030, 0x0004003D, 0x00000016, 0x00000032, 0x00000031, 0x0003003E, 0x0000000A,
+	0x00000032, 0x0004003D, 0x00000016, 0x00000033, 0x0000000A, 0x000500AA, 0x00000024, 0x00000034,
+	0x00000033, 0x00000027, 0x0004003D, 0x00000016, 0x00000035, 0x0000000A, 0x000500AA, 0x00000024,
+	0x00000036, 0x00000035, 0x00000028, 0x000500A6, 0x00000024, 0x00000037, 0x00000034, 0x00000036,
+	0x000600A9, 0x00000012, 0x00000038, 0x00000037, 0x0000001A, 0x00000019, 0x0004003D, 0x00000016,
+	0x00000039, 0x0000000A, 0x000500AF, 0x00000024, 0x0000003A, 0x00000039, 0x00000028, 0x000600A9,
+	0x00000012, 0x0000003B, 0x0000003A, 0x0000001A, 0x00000019, 0x00050050, 0x00000013, 0x0000003C,
+	0x00000038, 0x0000003B, 0x0003003E, 0x0000000C, 0x0000003C, 0x0004003D, 0x00000014, 0x0000003D,
+	0x00000005, 0x0007004F, 0x00000013, 0x0000003E, 0x0000003D, 0x0000003D, 0x00000000, 0x00000001,
+	0x0007004F, 0x00000013, 0x0000003F, 0x0000003D, 0x0000003D, 0x00000002, 0x00000003, 0x0004003D,
+	0x00000013, 0x00000040, 0x0000000C, 0x0008000C, 0x00000013, 0x00000041, 0x00000001, 0x0000002E,
+	0x0000003E, 0x0000003F, 0x00000040, 0x0003003E, 0x00000004, 0x00000041, 0x0004003D, 0x00000014,
+	0x00000042, 0x00000007, 0x0003003E, 0x00000006, 0x00000042, 0x0004003D, 0x00000014, 0x00000043,
+	0x00000009, 0x0007004F, 0x00000013, 0x00000044, 0x00000043, 0x00000043, 0x00000000, 0x00000001,
+	0x0007004F, 0x00000013, 0x00000045, 0x00000043, 0x00000043, 0x00000002, 0x00000003, 0x0004003D,
+	0x00000013, 0x00000046, 0x0000000C, 0x0008000C, 0x00000013, 0x00000047, 0x00000001, 0x0000002E,
+	0x00000044, 0x00000045, 0x00000046, 0x00050041, 0x0000001E, 0x00000048, 0x0000000F, 0x00000018,
+	0x0004003D, 0x0000001C, 0x00000049, 0x00000048, 0x00050051, 0x00000012, 0x0000004A, 0x00000047,
+	0x00000000, 0x00050051, 0x00000012, 0x0000004B, 0x00000047, 0x00000001, 0x00070050, 0x00000014,
+	0x0000004C, 0x0000004A, 0x0000004B, 0x00000019, 0x0000001A, 0x00050091, 0x00000014, 0x0000004D,
+	0x00000049, 0x0000004C, 0x00050041, 0x0000001F, 0x0000004E, 0x00000008, 0x00000018, 0x0003003E,
+	0x0000004E, 0x0000004D, 0x00060041, 0x00000020, 0x0000004F, 0x00000008, 0x00000018, 0x00000017,
+	0x0004003D, 0x00000012, 0x00000050, 0x0000004F, 0x0004007F, 0x00000012, 0x00000051, 0x00000050,
+	0x00060041, 0x00000020, 0x00000052, 0x00000008, 0x00000018, 0x00000017, 0x0003003E, 0x00000052,
+	0x00000051, 0x000100FD, 0x00010038,
+};
+const u64 vulkan_quad_vertex_size = sizeof(vulkan_quad_vertex);
+
+alignas(4) const u32 vulkan_sdf_fragment[320] = {
+	0x07230203, 0x00010000, 0x00000000, 0x0000002F, 0x00000000, 0x00020011, 0x00000001, 0x0006000B,
+	0x00000001, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000, 0x0003000E, 0x00000000, 0x00000001,
+	0x0008000F, 0x00000004, 0x00000002, 0x6E69616D, 0x00000000, 0x00000003, 0x00000004, 0x00000005,
+	0x00030010, 0x00000002, 0x00000007, 0x00030003, 0x00000002, 0x000001C2, 0x00090004, 0x415F4C47,
+	0x735F4252, 0x72617065, 0x5F657461, 0x64616873, 0x6F5F7265, 0x63656A62, 0x00007374, 0x00090004,
+	0x415F4C47, 0x735F4252, 0x69646168, 0x6C5F676E, 0x75676E61, 0x5F656761, 0x70303234, 0x006B6361,
+	0x00040005, 0x00000002, 0x6E69616D, 0x00000000, 0x00050005, 0x00000006, 0x74736964, 0x65636E61,
+	0x00000000, 0x00050005, 0x00000007, 0x6F6F6D73, 0x6E696874, 0x00000067, 0x00050005, 0x00000008,
+	0x65766F63, 0x65676172, 0x00000000, 0x00050005, 0x00000003, 0x5F74756F, 0x6F6C6F63, 0x00000072,
+	0x00050005, 0x00000004, 0x635F6E69, 0x726F6C6F, 0x00000000, 0x00060005, 0x00000009, 0x74786574,
+	0x5F657275, 0x706D6173, 0x0072656C, 0x00040005, 0x00000005, 0x555F6E69, 0x00000056, 0x00040047,
+	0x00000003, 0x0000001E, 0x00000000, 0x00040047, 0x00000004, 0x0000001E, 0x00000001, 0x00040047,
+	0x00000009, 0x00000022, 0x00000000, 0x00040047, 0x00000009, 0x00000021, 0x00000000, 0x00040047,
+	0x00000005, 0x0000001E, 0x00000000, 0x00020013, 0x0000000A, 0x00030021, 0x0000000B, 0x0000000A,
+	0x00030016, 0x0000000C, 0x00000020, 0x00040017, 0x0000000D, 0x0000000C, 0x00000002, 0x00040017,
+	0x0000000E, 0x0000000C, 0x00000004, 0x00040020, 0x0000000F, 0x00000003, 0x0000000E, 0x00040020,
+	0x00000010, 0x00000001, 0x0000000E, 0x00040020, 0x00000011, 0x00000001, 0x0000000D, 0x00090019,
+	0x00000012, 0x0000000C, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0x00000000,
+	0x0003001B, 0x00000013, 0x00000012, 0x00040020, 0x00000014, 0x00000000, 0x00000013, 0x0004003B,
+	0x00000014, 0x00000009, 0x00000000, 0x0004003B, 0x0000000F, 0x00000003, 0x00000003, 0x0004003B,
+	0x00000011, 0x00000005, 0x00000001, 0x0004003B, 0x00000010, 0x00000004, 0x00000001, 0x00040020,
+	0x00000015, 0x00000007, 0x0000000C, 0x0004002B, 0x0000000C, 0x00000016, 0x3F000000, 0x0004002B,
+	0x0000000C, 0x00000017, 0x3B000000, 0x00050036, 0x0000000A, 0x00000002, 0x00000000, 0x0000000B,
+	0x000200F8, 0x00000018, 0x0004003B, 0x00000015, 0x00000006, 0x00000007, 0x0004003B, 0x00000015,
+	0x00000007, 0x00000007, 0x0004003B, 0x00000015, 0x00000008, 0x00000007, 0x0004003D, 0x00000013,
+	0x00000019, 0x00000009, 0x0004003D, 0x0000000D, 0x0000001A, 0x00000005, 0x00050057, 0x0000000E,
+	0x0000001B, 0x00000019, 0x0000001A, 0x00050051, 0x0000000C, 0x0000001C, 0x0000001B, 0x00000003,
+	0x0003003E, 0x00000006, 0x0000001C, 0x0004003D, 0x0000000C, 0x0000001D, 0x00000006, 0x000400D1,
+	0x0000000C, 0x0000001E, 0x0000001D, 0x00050085, 0x0000000C, 0x0000001F, 0x0000001E, 0x00000016,
+	0x0007000C, 0x0000000C, 0x00000020, 0x00000001, 0x00000028, 0x0000001F, 0x00000017, 0x0003003E,
+	0x00000007, 0x00000020, 0x0004003D, 0x0000000C, 0x00000021, 0x00000007, 0x00050083, 0x0000000C,
+	0x00000022, 0x00000016, 0x00000021, 0x0004003D, 0x0000000C, 0x00000023, 0x00000007, 0x00050081,
+	0x0000000C, 0x00000024, 0x00000016, 0x00000023, 0x0004003D, 0x0000000C, 0x00000025, 0x00000006,
+	0x0008000C, 0x0000000C, 0x00000026, 0x00000001, 0x00000031, 0x00000022, 0x00000024, 0x00000025,
+	0x0003003E, 0x00000008, 0x00000026, 0x0004003D, 0x0000000E, 0x00000027, 0x00000004, 0x00050051,
+	0x0000000C, 0x00000028, 0x00000027, 0x00000000, 0x00050051, 0x0000000C, 0x00000029, 0x00000027,
+	0x00000001, 0x00050051, 0x0000000C, 0x0000002A, 0x00000027, 0x00000002, 0x00050051, 0x0000000C,
+	0x0000002B, 0x00000027, 0x00000003, 0x0004003D, 0x0000000C, 0x0000002C, 0x00000008, 0x00050085,
+	0x0000000C, 0x0000002D, 0x0000002B, 0x0000002C, 0x00070050, 0x0000000E, 0x0000002E, 0x00000028,
+	0x00000029, 0x0000002A, 0x0000002D, 0x0003003E, 0x00000003, 0x0000002E, 0x000100FD, 0x00010038,
+};
+const u64 vulkan_sdf_fragment_size = sizeof(vulkan_sdf_fragment);
@@ -0,0 +1,18 @@
+#pragma once
+
+// Generated by shaders/embed_shaders.py from the shaders in the shaders directory, don't edit.
+
+#include "../ImGuiRenderers.h"
+
+extern const u32 vulkan_fragment[186];
+extern const u64 vulkan_fragment_size; // In bytes
+extern const u32 vulkan_vertex[398];
+extern const u64 vulkan_vertex_size; // In bytes
+extern const u32 vulkan_indirect_fragment[306];
+extern const u64 vulkan_indirect_fragment_size; // In bytes
+extern const u32 vulkan_indirect_vertex[400];
+extern const u64 vulkan_indirect_vertex_size; // In bytes
+extern const u32 vulkan_quad_vertex[571];
+extern const u64 vulkan_quad_vertex_size; // In bytes
+extern const u32 vulkan_sdf_fragment[320];
+extern const u64 vulkan_sdf_fragment_size; // In bytes
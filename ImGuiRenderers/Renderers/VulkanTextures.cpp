@@ -0,0 +1,803 @@
+#include "VulkanRenderer.h"
+#include "VulkanTextures.h"
+#include "../Trace.h"
+#include "../UploadCopy.h"
+
+#include <algorithm>
+#include <string.h>
+
+ImGuiVulkanTextureStreamer::~ImGuiVulkanTextureStreamer()
+{
+	if (!context || !context->device)
+	{
+		return;
+	}
+
+	context->allocator.remove_budget_callback(budget_callback, this);
+
+	// The renderer may still be drawing the textures, so wait for everything. Waiting uses all the queues of the device.
+	VkResult result;
+	std::unique_lock<std::mutex> lock(context->queue_mutex);
+
+	if ((result = vk->vkDeviceWaitIdle(context->device)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to wait for the device to become idle. (%d)", result);
+		return;
+	}
+
+	lock.unlock();
+
+	for (Texture& texture : textures)
+	{
+		destroy_image(texture);
+	}
+
+	for (RetiredTexture& retired_texture : retired)
+	{
+		Texture texture;
+		texture.image = retired_texture.image;
+		texture.memory = retired_texture.memory;
+		texture.view = retired_texture.view;
+		texture.descriptor_set = retired_texture.descriptor_set;
+		destroy_image(texture);
+	}
+
+	for (Batch& batch : batches)
+	{
+		destroy_batch(batch);
+	}
+
+	if (sampler)
+	{
+		vk->vkDestroySampler(context->device, sampler, context->allocation_callbacks);
+	}
+
+	if (descriptor_pool)
+	{
+		vk->vkDestroyDescriptorPool(context->device, descriptor_pool, context->allocation_callbacks);
+	}
+
+	if (command_pool)
+	{
+		vk->vkDestroyCommandPool(context->device, command_pool, context->allocation_callbacks);
+	}
+}
+
+bool ImGuiVulkanTextureStreamer::initialize(ImGuiVulkanContext* vulkan_context, const ImGuiVulkanTextureOptions& texture_options)
+{
+	VkResult result;
+
+	context = vulkan_context;
+	options = texture_options;
+
+	if (!context || !context->device)
+	{
+		log(ERROR, "The texture streamer needs an initialized context.");
+		return false;
+	}
+
+	vk = &context->vk;
+
+	// The command buffers are recorded for the transfer queue
+	VkCommandPoolCreateInfo command_pool_info = {};
+	command_pool_info.pNext = nullptr;
+	command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_info.queueFamilyIndex = context->transfer_family;
+	command_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	if ((result = vk->vkCreateCommandPool(context->device, &command_pool_info, context->allocation_callbacks, &command_pool)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a command pool. (%d)", result);
+		return false;
+	}
+
+	// Every texture has its own descriptor set, which is its TextureId
+	VkDescriptorPoolSize descriptor_pool_size = {};
+	descriptor_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptor_pool_size.descriptorCount = options.max_textures;
+
+	VkDescriptorPoolCreateInfo descriptor_pool_info = {};
+	descriptor_pool_info.pNext = nullptr;
+	descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptor_pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	descriptor_pool_info.poolSizeCount = 1;
+	descriptor_pool_info.pPoolSizes = &descriptor_pool_size;
+	descriptor_pool_info.maxSets = options.max_textures;
+
+	if ((result = vk->vkCreateDescriptorPool(context->device, &descriptor_pool_info, context->allocation_callbacks, &descriptor_pool)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a descriptor pool for the textures. (%d)", result);
+		return false;
+	}
+
+	// Images are usually drawn scaled, unlike the font
+	VkSamplerCreateInfo sampler_info = {};
+	sampler_info.pNext = nullptr;
+	sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	sampler_info.magFilter = VK_FILTER_LINEAR;
+	sampler_info.minFilter = VK_FILTER_LINEAR;
+	sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.anisotropyEnable = VK_FALSE;
+	sampler_info.maxAnisotropy = 1.0f;
+	sampler_info.compareOp = VK_COMPARE_OP_NEVER;
+	sampler_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	sampler_info.unnormalizedCoordinates = VK_FALSE;
+
+	if ((result = vk->vkCreateSampler(context->device, &sampler_info, context->allocation_callbacks, &sampler)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a sampler for the textures. (%d)", result);
+		return false;
+	}
+
+	context->allocator.add_budget_callback(budget_callback, this);
+
+	// The placeholder is uploaded right away, so that it can be drawn from the first frame on
+	placeholder = upload(&options.placeholder_color, 1, 1);
+
+	if (!placeholder)
+	{
+		log(ERROR, "Failed to create the placeholder texture.");
+		return false;
+	}
+
+	update();
+
+	Texture* placeholder_texture = get_texture(placeholder);
+
+	if (placeholder_texture->batch != no_batch)
+	{
+		ImGuiTraceScope trace("texture fence wait");
+
+		if ((result = vk->vkWaitForFences(context->device, 1, &batches[placeholder_texture->batch].fence, VK_TRUE, UINT64_MAX)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to wait for the upload of the placeholder texture. (%d)", result);
+			return false;
+		}
+
+		complete_batches();
+	}
+
+	if (placeholder_texture->state != ImGuiVulkanTextureState::ready)
+	{
+		log(ERROR, "Failed to upload the placeholder texture.");
+		return false;
+	}
+
+	return true;
+}
+
+u32 ImGuiVulkanTextureStreamer::upload(const void* pixels, u32 width, u32 height, u32 texture)
+{
+	if (!pixels || !width || !height)
+	{
+		log(ERROR, "Textures need pixels and a size.");
+		return 0;
+	}
+
+	u32 slot;
+
+	if (texture)
+	{
+		Texture* existing = get_texture(texture);
+
+		if (!existing || (existing->state != ImGuiVulkanTextureState::evicted && existing->state != ImGuiVulkanTextureState::failed))
+		{
+			log(ERROR, "Only evicted textures can be uploaded again.");
+			return 0;
+		}
+
+		slot = texture - 1;
+	}
+	else if (!free_textures.empty())
+	{
+		slot = free_textures.back();
+		free_textures.pop_back();
+	}
+	else if (textures.size() < options.max_textures)
+	{
+		slot = (u32)textures.size();
+		textures.emplace_back();
+	}
+	else
+	{
+		log(ERROR, "Failed to create a texture, all %u are in use.", options.max_textures);
+		return 0;
+	}
+
+	Texture& new_texture = textures[slot];
+	const u8* bytes = (const u8*)pixels;
+
+	new_texture.width = width;
+	new_texture.height = height;
+	new_texture.pixels.assign(bytes, bytes + (u64)width * height * 4);
+	new_texture.last_used = frame_number;
+	new_texture.state = ImGuiVulkanTextureState::pending;
+	new_texture.used = true;
+
+	upload_queue.push_back(slot);
+
+	return slot + 1;
+}
+
+ImTextureID ImGuiVulkanTextureStreamer::get_texture_id(u32 texture)
+{
+	Texture* found = get_texture(texture);
+
+	if (found && found->state == ImGuiVulkanTextureState::ready)
+	{
+		found->last_used = frame_number;
+		return (ImTextureID)(uintptr_t)found->descriptor_set;
+	}
+
+	return (ImTextureID)(uintptr_t)textures[placeholder - 1].descriptor_set;
+}
+
+ImGuiVulkanTextureState ImGuiVulkanTextureStreamer::get_state(u32 texture) const
+{
+	const Texture* found = get_texture(texture);
+	return found ? found->state : ImGuiVulkanTextureState::failed;
+}
+
+void ImGuiVulkanTextureStreamer::release(u32 texture)
+{
+	Texture* found = get_texture(texture);
+
+	if (!found || texture == placeholder)
+	{
+		return;
+	}
+
+	// Textures, whose upload is running, are retired once it is done
+	if (found->batch != no_batch)
+	{
+		found->released = true;
+		std::vector<u8>().swap(found->pixels);
+		return;
+	}
+
+	upload_queue.erase(std::remove(upload_queue.begin(), upload_queue.end(), texture - 1), upload_queue.end());
+	retire(*found);
+}
+
+void ImGuiVulkanTextureStreamer::update()
+{
+	frame_number++;
+	stats.uploaded_bytes = 0;
+	stats.evictions = 0;
+
+	complete_batches();
+
+	// Released textures are destroyed, once no frame in flight draws them anymore
+	for (u32 i = 0; i < retired.size();)
+	{
+		if (retired[i].last_used + context->frames_in_flight < frame_number)
+		{
+			Texture texture;
+			texture.image = retired[i].image;
+			texture.memory = retired[i].memory;
+			texture.view = retired[i].view;
+			texture.descriptor_set = retired[i].descriptor_set;
+			destroy_image(texture);
+
+			free_textures.push_back(retired[i].slot);
+			retired[i] = retired.back();
+			retired.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// The heap is running out, so the textures, which no frame in flight draws, are evicted regardless of the budget
+	if (over_budget.exchange(false))
+	{
+		evict(options.budget);
+	}
+
+	submit_batch();
+
+	stats.texture_count = 0;
+	stats.ready_count = 0;
+	stats.pending_count = 0;
+	stats.resident_bytes = resident_bytes;
+
+	for (const Texture& texture : textures)
+	{
+		stats.texture_count += texture.used;
+		stats.ready_count += texture.used && texture.state == ImGuiVulkanTextureState::ready;
+		stats.pending_count += texture.used && texture.state == ImGuiVulkanTextureState::pending;
+	}
+}
+
+void ImGuiVulkanTextureStreamer::budget_callback(u32 heap, const ImGuiVulkanHeapBudget& budget, void* user_data)
+{
+	// May be called by the other windows of the context, so the eviction waits for the next update
+	if (budget.purpose_usage[(u32)ImGuiVulkanMemoryPurpose::texture])
+	{
+		static_cast<ImGuiVulkanTextureStreamer*>(user_data)->over_budget = true;
+	}
+}
+
+void ImGuiVulkanTextureStreamer::complete_batches()
+{
+	for (u32 i = 0; i < batches.size(); i++)
+	{
+		Batch& batch = batches[i];
+
+		if (!batch.submitted || vk->vkGetFenceStatus(context->device, batch.fence) != VK_SUCCESS)
+		{
+			continue;
+		}
+
+		for (u32 slot : batch.textures)
+		{
+			Texture& texture = textures[slot];
+			texture.batch = no_batch;
+
+			if (texture.released)
+			{
+				retire(texture);
+			}
+			else if (texture.state == ImGuiVulkanTextureState::pending)
+			{
+				texture.state = ImGuiVulkanTextureState::ready;
+			}
+		}
+
+		batch.textures.clear();
+		batch.submitted = false;
+	}
+}
+
+void ImGuiVulkanTextureStreamer::submit_batch()
+{
+	VkResult result;
+
+	if (upload_queue.empty())
+	{
+		return;
+	}
+
+	// A batch is only reused once its fence is signalled, so the frame never waits for an upload
+	u32 batch_index = no_batch;
+
+	for (u32 i = 0; i < batches.size() && batch_index == no_batch; i++)
+	{
+		if (!batches[i].submitted)
+		{
+			batch_index = i;
+		}
+	}
+
+	if (batch_index == no_batch && batches.size() < max_batches)
+	{
+		batches.emplace_back();
+
+		if (!create_batch(batches.back()))
+		{
+			destroy_batch(batches.back());
+			batches.pop_back();
+			return;
+		}
+
+		batch_index = (u32)batches.size() - 1;
+	}
+
+	if (batch_index == no_batch)
+	{
+		return;
+	}
+
+	// Take the queued textures up to the bytes per frame, each starting on a texel aligned offset
+	u64 staging_bytes = 0;
+	u32 count = 0;
+
+	for (; count < upload_queue.size(); count++)
+	{
+		u64 size = (textures[upload_queue[count]].pixels.size() + 15) & ~15ull;
+
+		if (count && staging_bytes + size > options.upload_bytes_per_frame)
+		{
+			break;
+		}
+
+		staging_bytes += size;
+	}
+
+	Batch& batch = batches[batch_index];
+
+	if (!prepare_staging(batch, staging_bytes))
+	{
+		return;
+	}
+
+	evict(staging_bytes);
+
+	VkCommandBufferBeginInfo begin_info = {};
+	begin_info.pNext = nullptr;
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if ((result = vk->vkBeginCommandBuffer(batch.command_buffer, &begin_info)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to begin a command buffer for the texture uploads. (%d)", result);
+		return;
+	}
+
+	std::vector<VkImageMemoryBarrier> transfer_barriers;
+	std::vector<VkImageMemoryBarrier> read_barriers;
+	std::vector<VkBufferImageCopy> copies;
+	u64 offset = 0;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		u32 slot = upload_queue[i];
+		Texture& texture = textures[slot];
+
+		if (!create_image(texture))
+		{
+			destroy_image(texture);
+			texture.state = ImGuiVulkanTextureState::failed;
+			std::vector<u8>().swap(texture.pixels);
+			continue;
+		}
+
+		stream_copy(batch.staging_memory.mapped + offset, texture.pixels.data(), texture.pixels.size());
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.pNext = nullptr;
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = texture.image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		transfer_barriers.push_back(barrier);
+
+		// The graphics queue only draws the texture after the fence is signalled, which makes the writes available
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		read_barriers.push_back(barrier);
+
+		VkBufferImageCopy copy = {};
+		copy.bufferOffset = offset;
+		copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copy.imageExtent = { texture.width, texture.height, 1 };
+		copies.push_back(copy);
+
+		offset += (texture.pixels.size() + 15) & ~15ull;
+		stats.uploaded_bytes += texture.pixels.size();
+		std::vector<u8>().swap(texture.pixels);
+
+		texture.batch = batch_index;
+		batch.textures.push_back(slot);
+	}
+
+	upload_queue.erase(upload_queue.begin(), upload_queue.begin() + count);
+
+	if (!copies.empty())
+	{
+		vk->vkCmdPipelineBarrier(batch.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, (u32)transfer_barriers.size(), transfer_barriers.data());
+
+		for (u32 i = 0; i < copies.size(); i++)
+		{
+			vk->vkCmdCopyBufferToImage(batch.command_buffer, batch.staging, transfer_barriers[i].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copies[i]);
+		}
+
+		vk->vkCmdPipelineBarrier(batch.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, (u32)read_barriers.size(), read_barriers.data());
+	}
+
+	if ((result = vk->vkEndCommandBuffer(batch.command_buffer)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to end the command buffer of the texture uploads. (%d)", result);
+		return;
+	}
+
+	if ((result = vk->vkResetFences(context->device, 1, &batch.fence)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to reset the fence of the texture uploads. (%d)", result);
+		return;
+	}
+
+	VkSubmitInfo submit_info = {};
+	submit_info.pNext = nullptr;
+	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &batch.command_buffer;
+
+	// Without a transfer family the uploads share the queue with the render threads
+	{
+		std::lock_guard<std::mutex> lock(context->queue_mutex);
+
+		if ((result = vk->vkQueueSubmit(context->transfer_queue, 1, &submit_info, batch.fence)) != VK_SUCCESS)
+		{
+			log(ERROR, "Failed to submit the texture uploads. (%d)", result);
+			return;
+		}
+	}
+
+	batch.submitted = true;
+}
+
+void ImGuiVulkanTextureStreamer::evict(u64 needed_bytes)
+{
+	if (resident_bytes + needed_bytes <= options.budget)
+	{
+		return;
+	}
+
+	// Only textures, which no frame in flight draws anymore, can be evicted, the least recently drawn first
+	std::vector<u32> candidates;
+
+	for (u32 i = 0; i < textures.size(); i++)
+	{
+		const Texture& texture = textures[i];
+
+		if (texture.used && texture.state == ImGuiVulkanTextureState::ready && i != placeholder - 1 && texture.last_used + context->frames_in_flight < frame_number)
+		{
+			candidates.push_back(i);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [&](u32 a, u32 b) { return textures[a].last_used < textures[b].last_used; });
+
+	for (u32 i = 0; i < candidates.size() && resident_bytes + needed_bytes > options.budget; i++)
+	{
+		Texture& texture = textures[candidates[i]];
+		destroy_image(texture);
+		texture.state = ImGuiVulkanTextureState::evicted;
+		stats.evictions++;
+	}
+}
+
+bool ImGuiVulkanTextureStreamer::create_image(Texture& texture)
+{
+	VkResult result;
+
+	// Both queues access the image, so it is shared instead of transferring its ownership
+	u32 families[2] = { context->queue_family, context->transfer_family };
+
+	VkImageCreateInfo image_info = {};
+	image_info.pNext = nullptr;
+	image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	image_info.imageType = VK_IMAGE_TYPE_2D;
+	image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	image_info.extent = { texture.width, texture.height, 1 };
+	image_info.mipLevels = 1;
+	image_info.arrayLayers = 1;
+	image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+	image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	image_info.sharingMode = families[0] != families[1] ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	image_info.queueFamilyIndexCount = families[0] != families[1] ? 2 : 0;
+	image_info.pQueueFamilyIndices = families;
+	image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	if ((result = vk->vkCreateImage(context->device, &image_info, context->allocation_callbacks, &texture.image)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a texture image. (%d)", result);
+		return false;
+	}
+
+	if (!context->allocator.allocate_image_memory(texture.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, &texture.memory, ImGuiVulkanMemoryPurpose::texture))
+	{
+		log(ERROR, "Failed to allocate memory for a texture.");
+		return false;
+	}
+
+	resident_bytes += texture.memory.size;
+
+	VkImageViewCreateInfo image_view_info = {};
+	image_view_info.pNext = nullptr;
+	image_view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	image_view_info.image = texture.image;
+	image_view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	image_view_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	image_view_info.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+	image_view_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	if ((result = vk->vkCreateImageView(context->device, &image_view_info, context->allocation_callbacks, &texture.view)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create an image view for a texture. (%d)", result);
+		return false;
+	}
+
+	VkDescriptorSetAllocateInfo descriptor_set_info = {};
+	descriptor_set_info.pNext = nullptr;
+	descriptor_set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptor_set_info.descriptorPool = descriptor_pool;
+	descriptor_set_info.descriptorSetCount = 1;
+	descriptor_set_info.pSetLayouts = &context->descriptor_set_layout;
+
+	if ((result = vk->vkAllocateDescriptorSets(context->device, &descriptor_set_info, &texture.descriptor_set)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate a descriptor set for a texture. (%d)", result);
+		return false;
+	}
+
+	VkDescriptorImageInfo descriptor_image_info = {};
+	descriptor_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	descriptor_image_info.sampler = sampler;
+	descriptor_image_info.imageView = texture.view;
+
+	VkWriteDescriptorSet write_descriptor_set = {};
+	write_descriptor_set.pNext = nullptr;
+	write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write_descriptor_set.dstSet = texture.descriptor_set;
+	write_descriptor_set.descriptorCount = 1;
+	write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write_descriptor_set.pImageInfo = &descriptor_image_info;
+
+	vk->vkUpdateDescriptorSets(context->device, 1, &write_descriptor_set, 0, nullptr);
+
+	return true;
+}
+
+void ImGuiVulkanTextureStreamer::destroy_image(Texture& texture)
+{
+	if (texture.descriptor_set)
+	{
+		vk->vkFreeDescriptorSets(context->device, descriptor_pool, 1, &texture.descriptor_set);
+		texture.descriptor_set = VK_NULL_HANDLE;
+	}
+
+	if (texture.view)
+	{
+		vk->vkDestroyImageView(context->device, texture.view, context->allocation_callbacks);
+		texture.view = VK_NULL_HANDLE;
+	}
+
+	if (texture.image)
+	{
+		vk->vkDestroyImage(context->device, texture.image, context->allocation_callbacks);
+		texture.image = VK_NULL_HANDLE;
+	}
+
+	if (texture.memory.memory)
+	{
+		resident_bytes -= texture.memory.size;
+		context->allocator.free_memory(texture.memory);
+		texture.memory = ImGuiVulkanAllocation();
+	}
+}
+
+void ImGuiVulkanTextureStreamer::retire(Texture& texture)
+{
+	u32 slot = (u32)(&texture - textures.data());
+
+	// The slot stays taken until the descriptor set is freed, so that the pool never runs out
+	if (texture.image || texture.descriptor_set)
+	{
+		RetiredTexture retired_texture;
+		retired_texture.image = texture.image;
+		retired_texture.memory = texture.memory;
+		retired_texture.view = texture.view;
+		retired_texture.descriptor_set = texture.descriptor_set;
+		retired_texture.last_used = texture.last_used;
+		retired_texture.slot = slot;
+		retired.push_back(retired_texture);
+	}
+	else
+	{
+		free_textures.push_back(slot);
+	}
+
+	texture = Texture();
+}
+
+bool ImGuiVulkanTextureStreamer::create_batch(Batch& batch)
+{
+	VkResult result;
+
+	VkCommandBufferAllocateInfo command_buffer_allocate_info = {};
+	command_buffer_allocate_info.pNext = nullptr;
+	command_buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	command_buffer_allocate_info.commandPool = command_pool;
+	command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	command_buffer_allocate_info.commandBufferCount = 1;
+
+	if ((result = vk->vkAllocateCommandBuffers(context->device, &command_buffer_allocate_info, &batch.command_buffer)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to allocate a command buffer for the texture uploads. (%d)", result);
+		return false;
+	}
+
+	VkFenceCreateInfo fence_info = {};
+	fence_info.pNext = nullptr;
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	if ((result = vk->vkCreateFence(context->device, &fence_info, context->allocation_callbacks, &batch.fence)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a fence for the texture uploads. (%d)", result);
+		return false;
+	}
+
+	return true;
+}
+
+bool ImGuiVulkanTextureStreamer::prepare_staging(Batch& batch, u64 size)
+{
+	VkResult result;
+
+	if (batch.staging_size >= size)
+	{
+		return true;
+	}
+
+	// Grows to fit textures larger than the bytes per frame
+	if (batch.staging)
+	{
+		vk->vkDestroyBuffer(context->device, batch.staging, context->allocation_callbacks);
+		context->allocator.free_memory(batch.staging_memory);
+		batch.staging = VK_NULL_HANDLE;
+		batch.staging_size = 0;
+	}
+
+	size = std::max(size, options.upload_bytes_per_frame);
+
+	VkBufferCreateInfo buffer_info = {};
+	buffer_info.pNext = nullptr;
+	buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_info.size = size;
+	buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if ((result = vk->vkCreateBuffer(context->device, &buffer_info, context->allocation_callbacks, &batch.staging)) != VK_SUCCESS)
+	{
+		log(ERROR, "Failed to create a staging buffer for the texture uploads. (%d)", result);
+		return false;
+	}
+
+	// Coherent, so that the copies need no flush
+	if (!context->allocator.allocate_buffer_memory(batch.staging, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &batch.staging_memory, ImGuiVulkanMemoryPurpose::upload))
+	{
+		log(ERROR, "Failed to allocate memory for a staging buffer.");
+		vk->vkDestroyBuffer(context->device, batch.staging, context->allocation_callbacks);
+		batch.staging = VK_NULL_HANDLE;
+		return false;
+	}
+
+	batch.staging_size = size;
+
+	return true;
+}
+
+void ImGuiVulkanTextureStreamer::destroy_batch(Batch& batch)
+{
+	if (batch.staging)
+	{
+		vk->vkDestroyBuffer(context->device, batch.staging, context->allocation_callbacks);
+		context->allocator.free_memory(batch.staging_memory);
+	}
+
+	if (batch.fence)
+	{
+		vk->vkDestroyFence(context->device, batch.fence, context->allocation_callbacks);
+	}
+
+	if (batch.command_buffer)
+	{
+		vk->vkFreeCommandBuffers(context->device, command_pool, 1, &batch.command_buffer);
+	}
+
+	batch = Batch();
+}
+
+ImGuiVulkanTextureStreamer::Texture* ImGuiVulkanTextureStreamer::get_texture(u32 texture)
+{
+	return texture && texture <= textures.size() && textures[texture - 1].used ? &textures[texture - 1] : nullptr;
+}
+
+const ImGuiVulkanTextureStreamer::Texture* ImGuiVulkanTextureStreamer::get_texture(u32 texture) const
+{
+	return texture && texture <= textures.size() && textures[texture - 1].used ? &textures[texture - 1] : nullptr;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "VulkanContext.h"
+
+// Headers
+#include <atomic>
+#include <vector>
+
+// State of a streamed texture
+enum class ImGuiVulkanTextureState : u8
+{
+	pending, // Waiting for its upload, the placeholder is drawn instead
+	ready,   // Uploaded and drawn
+	evicted, // Evicted to stay within the budget, upload it again to draw it
+	failed,  // The image couldn't be created
+};
+
+// Options of the texture streamer
+struct ImGuiVulkanTextureOptions
+{
+	u64 budget = 256 * 1024 * 1024;              // Device memory of the textures, beyond which the least recently drawn ones are evicted
+	u64 upload_bytes_per_frame = 8 * 1024 * 1024; // Bytes uploaded per frame, the rest waits for the next frames. At least one texture is uploaded
+	u32 max_textures = 4096;                     // Number of textures, which may exist at once
+	u32 placeholder_color = 0x40808080;          // RGBA8 colour drawn until a texture is ready
+};
+
+// Statistics of the texture streamer
+struct ImGuiVulkanTextureStats
+{
+	u32 texture_count;  // Textures created and not released
+	u32 ready_count;    // Textures, which are drawn
+	u32 pending_count;  // Textures waiting for their upload
+	u64 resident_bytes; // Device memory of the textures
+	u64 uploaded_bytes; // Bytes uploaded by the last update
+	u32 evictions;      // Textures evicted by the last update
+};
+
+// Streams RGBA8 images into textures, which are sampled with the TextureId of a draw command. The copies are recorded
+// on the transfer queue of the context and the renderer keeps drawing while they run, so the render loop has to use
+// ImGuiVulkanTextureMode::descriptor_sets. Must be used on the thread, which renders with the context.
+class ImGuiVulkanTextureStreamer
+{
+public:
+	~ImGuiVulkanTextureStreamer();
+
+	// The context has to outlive the streamer. Uploads the placeholder before returning.
+	bool initialize(ImGuiVulkanContext* context, const ImGuiVulkanTextureOptions& options = ImGuiVulkanTextureOptions());
+
+	// Copies the pixels and queues their upload. Passing an evicted texture uploads it again with the same handle.
+	// Returns 0 when there is no slot left for the texture.
+	u32 upload(const void* pixels, u32 width, u32 height, u32 texture = 0);
+
+	// The TextureId to draw the texture with, or the one of the placeholder while it isn't ready. Counts as a use for the eviction.
+	ImTextureID get_texture_id(u32 texture);
+	ImGuiVulkanTextureState get_state(u32 texture) const;
+
+	// The texture is destroyed once the frames, which may still draw it, are done
+	void release(u32 texture);
+
+	// Must be called once per frame before rendering: completes the finished uploads, submits the queued ones and evicts
+	// the least recently drawn textures over the budget
+	void update();
+
+	const ImGuiVulkanTextureStats& get_stats() const { return stats; }
+
+private:
+	struct Texture
+	{
+		VkImage image = VK_NULL_HANDLE;
+		ImGuiVulkanAllocation memory;
+		VkImageView view = VK_NULL_HANDLE;
+		VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+		u32 width = 0;
+		u32 height = 0;
+		u64 last_used = 0;
+		u32 batch = no_batch; // Batch, which uploads the texture
+		ImGuiVulkanTextureState state = ImGuiVulkanTextureState::pending;
+		std::vector<u8> pixels; // Kept until the upload is recorded
+		bool used = false;
+		bool released = false;
+	};
+
+	// Resources of released textures, which the frames in flight may still draw
+	struct RetiredTexture
+	{
+		VkImage image;
+		ImGuiVulkanAllocation memory;
+		VkImageView view;
+		VkDescriptorSet descriptor_set;
+		u64 last_used;
+		u32 slot;
+	};
+
+	// The uploads submitted together, with their own staging buffer and fence
+	struct Batch
+	{
+		VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		VkBuffer staging = VK_NULL_HANDLE;
+		ImGuiVulkanAllocation staging_memory;
+		u64 staging_size = 0;
+		std::vector<u32> textures;
+		bool submitted = false;
+	};
+
+	static const u32 no_batch = 0xFFFFFFFF;
+	static const u32 max_batches = 4;
+
+	ImGuiVulkanContext* context = nullptr;
+	const ImGuiVulkanDispatch* vk = nullptr;
+	ImGuiVulkanTextureOptions options;
+	VkCommandPool command_pool = VK_NULL_HANDLE;
+	VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+	VkSampler sampler = VK_NULL_HANDLE;
+	u32 placeholder = 0;
+
+	std::vector<Texture> textures;
+	std::vector<u32> free_textures;
+	std::vector<u32> upload_queue;
+	std::vector<RetiredTexture> retired;
+	std::vector<Batch> batches;
+	u64 frame_number = 0;
+	u64 resident_bytes = 0;
+	std::atomic<bool> over_budget{ false }; // Set by the budget callback of the allocator
+	ImGuiVulkanTextureStats stats = {};
+
+	// Internal functions for the streamer
+	bool create_image(Texture& texture);
+	void destroy_image(Texture& texture);
+	void retire(Texture& texture);
+	void complete_batches();
+	void submit_batch();
+	void evict(u64 needed_bytes);
+	bool create_batch(Batch& batch);
+	bool prepare_staging(Batch& batch, u64 size);
+	void destroy_batch(Batch& batch);
+	Texture* get_texture(u32 texture);
+	const Texture* get_texture(u32 texture) const;
+	static void budget_callback(u32 heap, const ImGuiVulkanHeapBudget& budget, void* user_data);
+};
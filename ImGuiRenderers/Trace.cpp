@@ -0,0 +1,356 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+
+// A span in the ring buffer. The sequence is the index of the span plus one once it's complete, and 0 while the
+// owning thread overwrites it, so a reader keeps its copy only when the sequence is the same before and after.
+struct ImGuiTraceSlot
+{
+	std::atomic<u64> sequence;
+	std::atomic<const char*> name;
+	std::atomic<u64> start;
+	std::atomic<u64> duration;
+	std::atomic<u32> track;
+};
+
+// Ring buffer of the spans of a thread, which only the owning thread writes
+struct ImGuiTraceBuffer
+{
+	std::unique_ptr<ImGuiTraceSlot[]> slots;
+	u64 size = 0;
+	std::atomic<u64> written{ 0 };
+	u32 track;
+};
+
+std::atomic<bool> ImGuiTracer::enabled{ false };
+std::atomic<u32> ImGuiTracer::capacity{ 64 * 1024 };
+
+// The buffers outlive their threads, so that the spans of exited threads can still be written
+static std::mutex buffers_mutex;
+static std::vector<std::unique_ptr<ImGuiTraceBuffer>> buffers;
+static thread_local ImGuiTraceBuffer* thread_buffer = nullptr;
+
+void ImGuiTracer::set_enabled(bool enable, u32 events_per_thread)
+{
+	capacity = events_per_thread ? events_per_thread : 1;
+	enabled = enable;
+}
+
+u64 ImGuiTracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ImGuiTracer::add_span(const char* name, u64 start, u64 end)
+{
+	add_event(name, start, end, false);
+}
+
+void ImGuiTracer::add_gpu_span(const char* name, u64 start, u64 end)
+{
+	add_event(name, start, end, true);
+}
+
+void ImGuiTracer::add_event(const char* name, u64 start, u64 end, bool gpu)
+{
+	if (!is_enabled())
+	{
+		return;
+	}
+
+	// The lock is only taken once per thread
+	if (!thread_buffer)
+	{
+		std::unique_ptr<ImGuiTraceBuffer> buffer(new ImGuiTraceBuffer());
+		buffer->size = capacity;
+		buffer->slots.reset(new ImGuiTraceSlot[buffer->size]);
+
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		buffer->track = (u32)buffers.size() + 1;
+		thread_buffer = buffer.get();
+		buffers.push_back(std::move(buffer));
+	}
+
+	u64 written = thread_buffer->written.load(std::memory_order_relaxed);
+
+	// The fence keeps the span from being written before its slot is marked as being overwritten
+	ImGuiTraceSlot& slot = thread_buffer->slots[written % thread_buffer->size];
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start.store(start, std::memory_order_relaxed);
+	slot.duration.store(end > start ? end - start : 0, std::memory_order_relaxed);
+	slot.track.store(gpu ? gpu_track : thread_buffer->track, std::memory_order_relaxed);
+
+	slot.sequence.store(written + 1, std::memory_order_release);
+	thread_buffer->written.store(written + 1, std::memory_order_release);
+}
+
+std::vector<ImGuiTraceEvent> ImGuiTracer::get_events(double seconds)
+{
+	std::vector<ImGuiTraceEvent> events;
+	const u64 end_time = now();
+	const u64 window = (u64)(seconds * 1000000000.0);
+	const u64 start_time = end_time > window ? end_time - window : 0;
+
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+
+	for (const std::unique_ptr<ImGuiTraceBuffer>& buffer : buffers)
+	{
+		const u64 size = buffer->size;
+		const u64 written = buffer->written.load(std::memory_order_acquire);
+		const u64 first = written > size ? written - size : 0;
+
+		for (u64 i = first; i < written; i++)
+		{
+			const ImGuiTraceSlot& slot = buffer->slots[i % size];
+			const u64 sequence = slot.sequence.load(std::memory_order_acquire);
+
+			ImGuiTraceEvent event;
+			event.name = slot.name.load(std::memory_order_relaxed);
+			event.start = slot.start.load(std::memory_order_relaxed);
+			event.duration = slot.duration.load(std::memory_order_relaxed);
+			event.track = slot.track.load(std::memory_order_relaxed);
+
+			// Spans, which the thread has started to overwrite during the copy, may be torn
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (sequence != i + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence)
+			{
+				continue;
+			}
+
+			if (event.start + event.duration >= start_time)
+			{
+				events.push_back(event);
+			}
+		}
+	}
+
+	std::sort(events.begin(), events.end(), [](const ImGuiTraceEvent& a, const ImGuiTraceEvent& b)
+	{
+		return a.start < b.start || (a.start == b.start && a.duration > b.duration);
+	});
+
+	return events;
+}
+
+// Names of the tracks, the GPU and the threads in the order of their first span
+static std::string get_track_name(u32 track)
+{
+	return track == ImGuiTracer::gpu_track ? "GPU" : "Thread " + std::to_string(track);
+}
+
+static void write_json_string(std::string& json, const char* value)
+{
+	json += '"';
+
+	for (const char* c = value; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			json += '\\';
+		}
+
+		if ((u8)*c >= 0x20)
+		{
+			json += *c;
+		}
+	}
+
+	json += '"';
+}
+
+static bool write_file(const std::string& file_name, const std::string& contents)
+{
+	FILE* file = fopen(file_name.c_str(), "wb");
+
+	if (!file)
+	{
+		log(ERROR, "Failed to open %s for writing the trace.", file_name.c_str());
+		return false;
+	}
+
+	bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+	fclose(file);
+
+	if (!written)
+	{
+		log(ERROR, "Failed to write the trace to %s.", file_name.c_str());
+	}
+
+	return written;
+}
+
+bool ImGuiTracer::write_chrome_trace(const std::string& file_name, double seconds)
+{
+	std::vector<ImGuiTraceEvent> events = get_events(seconds);
+	std::vector<u32> tracks;
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	char buffer[128];
+
+	// Timestamps are microseconds since the first span
+	const u64 origin = events.empty() ? 0 : events.front().start;
+
+	for (const ImGuiTraceEvent& event : events)
+	{
+		if (std::find(tracks.begin(), tracks.end(), event.track) == tracks.end())
+		{
+			tracks.push_back(event.track);
+		}
+
+		json += "{\"name\":";
+		write_json_string(json, event.name);
+		snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},", event.track, (event.start - origin) / 1000.0, event.duration / 1000.0);
+		json += buffer;
+	}
+
+	for (u32 track : tracks)
+	{
+		snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},", track, get_track_name(track).c_str());
+		json += buffer;
+	}
+
+	if (json.back() == ',')
+	{
+		json.pop_back();
+	}
+
+	json += "]}\n";
+
+	return write_file(file_name, json);
+}
+
+// Protobuf encoding of the few fields of perfetto.protos.Trace, which the spans need
+static void write_varint(std::string& data, u64 value)
+{
+	while (value >= 0x80)
+	{
+		data += (char)((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+
+	data += (char)value;
+}
+
+static void write_varint_field(std::string& data, u32 field, u64 value)
+{
+	write_varint(data, (u64)field << 3);
+	write_varint(data, value);
+}
+
+static void write_bytes_field(std::string& data, u32 field, const std::string& value)
+{
+	write_varint(data, ((u64)field << 3) | 2);
+	write_varint(data, value.size());
+	data += value;
+}
+
+// Field numbers of the messages
+enum PerfettoField : u32
+{
+	TRACE_PACKET = 1,
+	PACKET_TIMESTAMP = 8,
+	PACKET_SEQUENCE_ID = 10,
+	PACKET_TRACK_EVENT = 11,
+	PACKET_TRACK_DESCRIPTOR = 60,
+	DESCRIPTOR_UUID = 1,
+	DESCRIPTOR_NAME = 2,
+	EVENT_TYPE = 9,
+	EVENT_TRACK_UUID = 11,
+	EVENT_NAME = 23,
+};
+
+enum PerfettoEventType : u32
+{
+	SLICE_BEGIN = 1,
+	SLICE_END = 2,
+};
+
+static void write_slice(std::string& trace, u32 type, u64 timestamp, u32 track, const char* name)
+{
+	std::string event;
+	write_varint_field(event, EVENT_TYPE, type);
+	write_varint_field(event, EVENT_TRACK_UUID, track + 1);
+
+	if (name)
+	{
+		write_bytes_field(event, EVENT_NAME, name);
+	}
+
+	std::string packet;
+	write_varint_field(packet, PACKET_TIMESTAMP, timestamp);
+	write_varint_field(packet, PACKET_SEQUENCE_ID, 1);
+	write_bytes_field(packet, PACKET_TRACK_EVENT, event);
+	write_bytes_field(trace, TRACE_PACKET, packet);
+}
+
+bool ImGuiTracer::write_perfetto_trace(const std::string& file_name, double seconds)
+{
+	std::vector<ImGuiTraceEvent> events = get_events(seconds);
+	std::vector<u32> tracks;
+	std::string trace;
+
+	for (const ImGuiTraceEvent& event : events)
+	{
+		if (std::find(tracks.begin(), tracks.end(), event.track) == tracks.end())
+		{
+			tracks.push_back(event.track);
+		}
+	}
+
+	for (u32 track : tracks)
+	{
+		std::string descriptor;
+		write_varint_field(descriptor, DESCRIPTOR_UUID, track + 1);
+		write_bytes_field(descriptor, DESCRIPTOR_NAME, get_track_name(track));
+
+		std::string packet;
+		write_bytes_field(packet, PACKET_TRACK_DESCRIPTOR, descriptor);
+		write_bytes_field(trace, TRACE_PACKET, packet);
+	}
+
+	// Slices of a track have to be nested, so each track closes the slices, which end before the next one starts
+	for (u32 track : tracks)
+	{
+		std::vector<u64> open_ends;
+
+		for (const ImGuiTraceEvent& event : events)
+		{
+			if (event.track != track)
+			{
+				continue;
+			}
+
+			while (!open_ends.empty() && open_ends.back() <= event.start)
+			{
+				write_slice(trace, SLICE_END, open_ends.back(), track, nullptr);
+				open_ends.pop_back();
+			}
+
+			// Spans, which overlap without nesting, like the GPU frames of several windows, are cut at their parent's end
+			u64 end = event.start + event.duration;
+
+			if (!open_ends.empty() && end > open_ends.back())
+			{
+				end = open_ends.back();
+			}
+
+			write_slice(trace, SLICE_BEGIN, event.start, track, event.name);
+			open_ends.push_back(end);
+		}
+
+		while (!open_ends.empty())
+		{
+			write_slice(trace, SLICE_END, open_ends.back(), track, nullptr);
+			open_ends.pop_back();
+		}
+	}
+
+	return write_file(file_name, trace);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// Headers
+#include <atomic>
+
+// A span on the timeline of a thread or of the GPU
+struct ImGuiTraceEvent
+{
+	const char* name; // Has to stay valid until the trace is written, like a string literal
+	u64 start;        // Nanoseconds of the steady clock
+	u64 duration;     // In nanoseconds
+	u32 track;        // Thread, which recorded the span, or gpu_track
+};
+
+// Records the spans of each thread into a ring buffer of its own, which only that thread writes, so recording takes
+// no lock. The spans of the last seconds can be written as a Chrome trace, which chrome://tracing and Perfetto open,
+// or as a Perfetto protobuf trace. While disabled, a span only costs a relaxed load.
+class ImGuiTracer
+{
+public:
+	static const u32 gpu_track = 0;
+
+	// The buffers of the threads are allocated on their first span with the capacity, which was set at that time
+	static void set_enabled(bool enable, u32 events_per_thread = 64 * 1024);
+	static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+	static u64 now();
+
+	// Adds a span to the track of the calling thread, or to the GPU track with a start in steady clock nanoseconds
+	static void add_span(const char* name, u64 start, u64 end);
+	static void add_gpu_span(const char* name, u64 start, u64 end);
+
+	// Writes the spans, which ended in the last seconds
+	static bool write_chrome_trace(const std::string& file_name, double seconds);
+	static bool write_perfetto_trace(const std::string& file_name, double seconds);
+
+	// Copies the spans, which ended in the last seconds, sorted by their start
+	static std::vector<ImGuiTraceEvent> get_events(double seconds);
+
+private:
+	static std::atomic<bool> enabled;
+	static std::atomic<u32> capacity;
+
+	static void add_event(const char* name, u64 start, u64 end, bool gpu);
+};
+
+// Records a span from its construction until it goes out of scope, or until end is called
+class ImGuiTraceScope
+{
+public:
+	explicit ImGuiTraceScope(const char* name) : name(ImGuiTracer::is_enabled() ? name : nullptr), start(this->name ? ImGuiTracer::now() : 0) {}
+	~ImGuiTraceScope() { end(); }
+
+	void end()
+	{
+		if (name)
+		{
+			ImGuiTracer::add_span(name, start, ImGuiTracer::now());
+			name = nullptr;
+		}
+	}
+
+private:
+	const char* name;
+	u64 start;
+};
@@ -0,0 +1,211 @@
+#include "UploadCopy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+// Pick the widest available SIMD instruction set for the streaming stores
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UPLOAD_COPY_AVX2
+#elif defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UPLOAD_COPY_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define UPLOAD_COPY_NEON
+#endif
+
+namespace
+{
+	// Copies smaller than this don't fill enough lines to gain from streaming
+	const u64 stream_threshold = 256;
+
+	// Size of the parts, which the worker threads take, a multiple of the upload alignment
+	const u64 part_size = 256 * 1024;
+}
+
+void stream_copy(void* destination, const void* source, u64 size)
+{
+	u8* output = (u8*)destination;
+	const u8* input = (const u8*)source;
+
+#if defined(UPLOAD_COPY_AVX2) || defined(UPLOAD_COPY_SSE2) || defined(UPLOAD_COPY_NEON)
+	if (size >= stream_threshold)
+	{
+		// Copy up to the first cache line, then stream whole lines
+		u64 head = (upload_alignment - ((uintptr_t)output & (upload_alignment - 1))) & (upload_alignment - 1);
+		memcpy(output, input, head);
+		output += head;
+		input += head;
+		size -= head;
+
+		u8* end = output + (size & ~(upload_alignment - 1));
+
+#if defined(UPLOAD_COPY_AVX2)
+		for (; output < end; output += 64, input += 64)
+		{
+			_mm256_stream_si256((__m256i*)output, _mm256_loadu_si256((const __m256i*)input));
+			_mm256_stream_si256((__m256i*)(output + 32), _mm256_loadu_si256((const __m256i*)(input + 32)));
+		}
+
+		_mm_sfence();
+#elif defined(UPLOAD_COPY_SSE2)
+		for (; output < end; output += 64, input += 64)
+		{
+			_mm_stream_si128((__m128i*)output, _mm_loadu_si128((const __m128i*)input));
+			_mm_stream_si128((__m128i*)(output + 16), _mm_loadu_si128((const __m128i*)(input + 16)));
+			_mm_stream_si128((__m128i*)(output + 32), _mm_loadu_si128((const __m128i*)(input + 32)));
+			_mm_stream_si128((__m128i*)(output + 48), _mm_loadu_si128((const __m128i*)(input + 48)));
+		}
+
+		_mm_sfence();
+#else
+		// NEON has no non-temporal store intrinsic, whole lines are still written in order, so they combine
+		for (; output < end; output += 64, input += 64)
+		{
+			vst1q_u8(output, vld1q_u8(input));
+			vst1q_u8(output + 16, vld1q_u8(input + 16));
+			vst1q_u8(output + 32, vld1q_u8(input + 32));
+			vst1q_u8(output + 48, vld1q_u8(input + 48));
+		}
+#endif
+
+		size &= upload_alignment - 1;
+	}
+#endif
+
+	memcpy(output, input, size);
+}
+
+ImGuiUploadCopier::~ImGuiUploadCopier()
+{
+	{
+		std::lock_guard<std::mutex> lock(worker_mutex);
+		exiting = true;
+	}
+
+	worker_wake.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ImGuiUploadCopier::initialize(u32 thread_count, u64 parallel_upload_bytes)
+{
+	parallel_bytes = parallel_upload_bytes;
+
+	// The calling thread also copies, so one less worker is needed
+	for (u32 i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(&ImGuiUploadCopier::worker_loop, this);
+	}
+}
+
+void ImGuiUploadCopier::add(void* destination, const void* source, u64 size)
+{
+	Copy copy;
+	copy.destination = (u8*)destination;
+	copy.source = (const u8*)source;
+	copy.size = size;
+
+	copies.push_back(copy);
+	pending_bytes += size;
+}
+
+void ImGuiUploadCopier::flush()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	if (workers.empty() || pending_bytes < parallel_bytes)
+	{
+		for (const Copy& copy : copies)
+		{
+			stream_copy(copy.destination, copy.source, copy.size);
+		}
+	}
+	else
+	{
+		// Large copies are split, so that the threads finish at about the same time
+		parts.clear();
+
+		for (const Copy& copy : copies)
+		{
+			for (u64 offset = 0; offset < copy.size; offset += part_size)
+			{
+				Copy part;
+				part.destination = copy.destination + offset;
+				part.source = copy.source + offset;
+				part.size = std::min(part_size, copy.size - offset);
+				parts.push_back(part);
+			}
+		}
+
+		next_part = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(worker_mutex);
+			busy_workers = static_cast<u32>(workers.size());
+			batch_index++;
+		}
+
+		worker_wake.notify_all();
+		copy_parts();
+
+		std::unique_lock<std::mutex> lock(worker_mutex);
+		worker_done.wait(lock, [&] { return busy_workers == 0; });
+	}
+
+	copied_bytes = pending_bytes;
+	copy_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	copies.clear();
+	pending_bytes = 0;
+}
+
+void ImGuiUploadCopier::discard()
+{
+	copies.clear();
+	pending_bytes = 0;
+}
+
+void ImGuiUploadCopier::copy_parts()
+{
+	u32 part;
+
+	while ((part = next_part++) < parts.size())
+	{
+		stream_copy(parts[part].destination, parts[part].source, parts[part].size);
+	}
+}
+
+void ImGuiUploadCopier::worker_loop()
+{
+	u64 last_batch = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(worker_mutex);
+			worker_wake.wait(lock, [&] { return exiting || batch_index != last_batch; });
+
+			if (exiting)
+			{
+				return;
+			}
+
+			last_batch = batch_index;
+		}
+
+		copy_parts();
+
+		std::lock_guard<std::mutex> lock(worker_mutex);
+
+		if (--busy_workers == 0)
+		{
+			worker_done.notify_one();
+		}
+	}
+}
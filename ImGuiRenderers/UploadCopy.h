@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// Headers
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Alignment of mapped upload memory, so that whole cache lines are streamed into it
+const u64 upload_alignment = 64;
+
+// Copies into mapped memory with non-temporal stores, which don't pull the destination into the cache. Upload memory
+// is usually write-combined, where this writes whole lines at once instead of reading them first. Small copies use memcpy.
+void stream_copy(void* destination, const void* source, u64 size);
+
+// Collects the copies of a frame and copies them together. Frames with at least parallel_bytes of copies are split
+// across the worker threads, the calling thread copies too.
+class ImGuiUploadCopier
+{
+public:
+	~ImGuiUploadCopier();
+
+	// Thread count of 0 or 1 copies on the calling thread only
+	void initialize(u32 thread_count, u64 parallel_bytes);
+
+	// The source has to stay valid until the next flush
+	void add(void* destination, const void* source, u64 size);
+
+	// Copies everything added since the last flush and returns once all of it is written
+	void flush();
+
+	// Drops the copies added since the last flush, e.g. when their destination is freed
+	void discard();
+
+	// Bytes and time of the copies of the last flush
+	u64 copied_bytes = 0;
+	u64 copy_nanoseconds = 0;
+
+private:
+	struct Copy
+	{
+		u8* destination;
+		const u8* source;
+		u64 size;
+	};
+
+	std::vector<Copy> copies;
+	std::vector<Copy> parts;
+	u64 pending_bytes = 0;
+	u64 parallel_bytes = 0;
+
+	// Worker threads, which copy parts of large frames in parallel
+	std::vector<std::thread> workers;
+	std::mutex worker_mutex;
+	std::condition_variable worker_wake;
+	std::condition_variable worker_done;
+	std::atomic<u32> next_part;
+	u64 batch_index = 0;
+	u32 busy_workers = 0;
+	bool exiting = false;
+
+	// Internal functions for the copier
+	void copy_parts();
+	void worker_loop();
+};
@@ -0,0 +1,177 @@
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define VERTEX_PACKING_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VERTEX_PACKING_NEON
+#endif
+
+namespace
+{
+	// Fewest steps per pixel, which still covers a span of 8 million pixels
+	const float min_packed_position_scale = 1.0f / 256.0f;
+
+	inline void pack_vertex(ImDrawVertPacked* destination, const ImDrawVert& source, const ImDrawVertPacking& packing)
+	{
+		destination->pos[0] = static_cast<s16>(std::min(std::max(lrintf((source.pos.x - packing.origin[0]) * packing.scale), -32768L), 32767L));
+		destination->pos[1] = static_cast<s16>(std::min(std::max(lrintf((source.pos.y - packing.origin[1]) * packing.scale), -32768L), 32767L));
+		destination->uv[0] = static_cast<u16>(std::min(std::max(lrintf(source.uv.x * 65535.0f), 0L), 65535L));
+		destination->uv[1] = static_cast<u16>(std::min(std::max(lrintf(source.uv.y * 65535.0f), 0L), 65535L));
+		destination->col = source.col;
+	}
+}
+
+void get_vertex_bounds(const ImDrawVert* vertices, u32 count, float bounds[4])
+{
+	if (count == 0)
+	{
+		bounds[0] = bounds[1] = bounds[2] = bounds[3] = 0.0f;
+		return;
+	}
+
+	float min_x = vertices[0].pos.x, min_y = vertices[0].pos.y;
+	float max_x = min_x, max_y = min_y;
+	u32 i = 1;
+
+#if defined(VERTEX_PACKING_SSE2)
+	// The position is followed by the texture coordinates, so a vertex is loaded whole and its upper lanes are ignored
+	__m128 low = _mm_loadu_ps(&vertices[0].pos.x);
+	__m128 high = low;
+
+	for (; i < count; i++)
+	{
+		__m128 position = _mm_loadu_ps(&vertices[i].pos.x);
+		low = _mm_min_ps(low, position);
+		high = _mm_max_ps(high, position);
+	}
+
+	float lows[4], highs[4];
+	_mm_storeu_ps(lows, low);
+	_mm_storeu_ps(highs, high);
+	min_x = lows[0], min_y = lows[1];
+	max_x = highs[0], max_y = highs[1];
+#elif defined(VERTEX_PACKING_NEON)
+	float32x2_t low = vld1_f32(&vertices[0].pos.x);
+	float32x2_t high = low;
+
+	for (; i < count; i++)
+	{
+		float32x2_t position = vld1_f32(&vertices[i].pos.x);
+		low = vmin_f32(low, position);
+		high = vmax_f32(high, position);
+	}
+
+	min_x = vget_lane_f32(low, 0), min_y = vget_lane_f32(low, 1);
+	max_x = vget_lane_f32(high, 0), max_y = vget_lane_f32(high, 1);
+#endif
+
+	for (; i < count; i++)
+	{
+		min_x = std::min(min_x, vertices[i].pos.x);
+		min_y = std::min(min_y, vertices[i].pos.y);
+		max_x = std::max(max_x, vertices[i].pos.x);
+		max_y = std::max(max_y, vertices[i].pos.y);
+	}
+
+	bounds[0] = min_x;
+	bounds[1] = min_y;
+	bounds[2] = max_x;
+	bounds[3] = max_y;
+}
+
+ImDrawVertPacking get_vertex_packing(const float bounds[4])
+{
+	ImDrawVertPacking packing;
+	float extent = 0.0f;
+
+	for (u32 axis = 0; axis < 2; axis++)
+	{
+		// Non-finite bounds keep the origin at zero, so the projection stays finite
+		float origin = floorf((bounds[axis] + bounds[axis + 2]) * 0.5f);
+		packing.origin[axis] = isfinite(origin) ? origin : 0.0f;
+		extent = std::max(extent, std::max(packing.origin[axis] - bounds[axis], bounds[axis + 2] - packing.origin[axis]));
+	}
+
+	// Powers of two keep the positions on whole pixels exact down to one step per pixel
+	while (extent * packing.scale > 32767.0f && packing.scale > min_packed_position_scale)
+	{
+		packing.scale *= 0.5f;
+	}
+
+	return packing;
+}
+
+void pack_vertices(ImDrawVertPacked* destination, const ImDrawVert* source, u32 count, const ImDrawVertPacking& packing)
+{
+	u32 i = 0;
+
+#if defined(VERTEX_PACKING_SSE2)
+	// Position and texture coordinates are adjacent, so both are converted with a single multiply.
+	// The texture coordinates are biased to use the signed saturating pack, then the bias is flipped back.
+	const __m128 origin = _mm_setr_ps(packing.origin[0], packing.origin[1], 0.0f, 0.0f);
+	const __m128 scale = _mm_setr_ps(packing.scale, packing.scale, 65535.0f, 65535.0f);
+	const __m128i bias = _mm_setr_epi32(0, 0, 32768, 32768);
+	const __m128i flip = _mm_setr_epi16(0, 0, -32768, -32768, 0, 0, -32768, -32768);
+	u8* output = reinterpret_cast<u8*>(destination);
+
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128i first = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&source[i].pos.x), origin), scale)), bias);
+		__m128i second = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&source[i + 1].pos.x), origin), scale)), bias);
+		__m128i packed = _mm_xor_si128(_mm_packs_epi32(first, second), flip);
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(output), packed);
+		memcpy(output + 8, &source[i].col, sizeof(u32));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(output + 12), _mm_srli_si128(packed, 8));
+		memcpy(output + 20, &source[i + 1].col, sizeof(u32));
+
+		output += sizeof(ImDrawVertPacked) * 2;
+	}
+#elif defined(VERTEX_PACKING_NEON)
+	const float origin_values[4] = { packing.origin[0], packing.origin[1], 0.0f, 0.0f };
+	const float scale_values[4] = { packing.scale, packing.scale, 65535.0f, 65535.0f };
+	const float32x4_t origin = vld1q_f32(origin_values);
+	const float32x4_t scale = vld1q_f32(scale_values);
+
+	for (; i < count; i++)
+	{
+		int32x4_t converted = vcvtnq_s32_f32(vmulq_f32(vsubq_f32(vld1q_f32(&source[i].pos.x), origin), scale));
+		int16x4_t position = vqmovn_s32(converted);
+		uint16x4_t uv = vqmovun_s32(converted);
+
+		vst1_lane_u32(reinterpret_cast<u32*>(destination[i].pos), vreinterpret_u32_s16(position), 0);
+		vst1_lane_u32(reinterpret_cast<u32*>(destination[i].uv), vreinterpret_u32_u16(uv), 1);
+		destination[i].col = source[i].col;
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		pack_vertex(destination + i, source[i], packing);
+	}
+}
+
+void pack_quad(ImDrawQuadPacked* destination, const ImDrawVert& top_left, const ImDrawVert& bottom_right, const ImDrawVertPacking& packing)
+{
+	ImDrawVertPacked corners[2];
+	pack_vertex(&corners[0], top_left, packing);
+	pack_vertex(&corners[1], bottom_right, packing);
+
+	ImDrawQuadPacked quad;
+	quad.pos[0] = corners[0].pos[0];
+	quad.pos[1] = corners[0].pos[1];
+	quad.pos[2] = corners[1].pos[0];
+	quad.pos[3] = corners[1].pos[1];
+	quad.uv[0] = corners[0].uv[0];
+	quad.uv[1] = corners[0].uv[1];
+	quad.uv[2] = corners[1].uv[0];
+	quad.uv[3] = corners[1].uv[1];
+	quad.col = top_left.col;
+
+	*destination = quad;
+}
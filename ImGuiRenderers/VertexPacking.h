@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// A compact vertex for uploading: 16-bit fixed-point position, 16-bit UNORM texture coordinates and the colour.
+// It is 12 bytes instead of the 20 bytes of ImDrawVert. Positions are relative to the origin of an ImDrawVertPacking.
+struct ImDrawVertPacked
+{
+	s16 pos[2];
+	u16 uv[2];
+	u32 col;
+};
+
+static_assert(sizeof(ImDrawVertPacked) == 12, "Packed vertices must be 12 bytes");
+
+// Number of fixed-point steps per pixel in the packed positions, unless the vertices span too far for it
+const float packed_position_scale = 4.0f;
+
+// Origin and fixed-point steps per pixel of packed positions, which the projection undoes. Vertices within 8192 pixels
+// of the origin keep quarter pixels, ones spanning further get fewer steps per pixel instead of being clamped.
+struct ImDrawVertPacking
+{
+	float origin[2] = { 0.0f, 0.0f };
+	float scale = packed_position_scale;
+};
+
+// Bounds of the positions of the vertices as min x, min y, max x and max y
+void get_vertex_bounds(const ImDrawVert* vertices, u32 count, float bounds[4]);
+
+// Chooses the packing for positions within the bounds, with the origin on a whole pixel in their middle
+ImDrawVertPacking get_vertex_packing(const float bounds[4]);
+
+// An axis-aligned, uniformly coloured quad, which is drawn as an instance instead of 4 vertices and 6 indices
+struct ImDrawQuad
+{
+	float pos[4]; // Top left and bottom right corner
+	float uv[4];  // Texture coordinates of the same corners
+	u32 col;
+};
+
+// The quad in the packed formats of ImDrawVertPacked
+struct ImDrawQuadPacked
+{
+	s16 pos[4];
+	u16 uv[4];
+	u32 col;
+};
+
+static_assert(sizeof(ImDrawQuad) == 36, "Quads must be 36 bytes");
+static_assert(sizeof(ImDrawQuadPacked) == 20, "Packed quads must be 20 bytes");
+
+// Converts vertices to the packed format. The destination may be write-combined memory, as it is only written sequentially.
+void pack_vertices(ImDrawVertPacked* destination, const ImDrawVert* source, u32 count, const ImDrawVertPacking& packing);
+
+// Converts the corners of a quad to a packed quad
+void pack_quad(ImDrawQuadPacked* destination, const ImDrawVert& top_left, const ImDrawVert& bottom_right, const ImDrawVertPacking& packing);
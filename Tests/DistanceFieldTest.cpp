@@ -0,0 +1,97 @@
+#include "Test.h"
+#include "DistanceField.h"
+
+// Headers
+#include <math.h>
+
+static const u32 size = 64;
+static const u32 spread = 4;
+
+// Signed distance to the edge of a disc in the middle of the atlas, negative inside
+static float disc_distance(u32 x, u32 y, float radius)
+{
+	float dx = x + 0.5f - size / 2;
+	float dy = y + 0.5f - size / 2;
+	return sqrtf(dx * dx + dy * dy) - radius;
+}
+
+TEST(distance_field_disc)
+{
+	// An anti-aliased disc, like a glyph in the atlas
+	std::vector<u8> coverage(size * size);
+
+	for (u32 y = 0; y < size; y++)
+	{
+		for (u32 x = 0; x < size; x++)
+		{
+			float covered = 0.5f - disc_distance(x, y, 20.0f);
+			coverage[y * size + x] = (u8)(fminf(fmaxf(covered, 0.0f), 1.0f) * 255.0f);
+		}
+	}
+
+	std::vector<u8> field(size * size);
+	build_distance_field(field.data(), coverage.data(), size, size, spread);
+
+	// Within the spread, the field follows the distance to the edge with sub-pixel accuracy
+	float largest_error = 0;
+
+	for (u32 y = 0; y < size; y++)
+	{
+		for (u32 x = 0; x < size; x++)
+		{
+			float distance = disc_distance(x, y, 20.0f);
+			float field_distance = (0.5f - field[y * size + x] / 255.0f) * 2.0f * spread;
+
+			if (fabsf(distance) < spread - 0.5f)
+			{
+				largest_error = fmaxf(largest_error, fabsf(field_distance - distance));
+			}
+		}
+	}
+
+	log(INFO, "Largest error of the distance field: %.3f pixels.", largest_error);
+	CHECK(largest_error < 0.6f);
+
+	// Beyond the spread it's clamped, the middle and the corners are far inside and outside
+	CHECK(field[(size / 2) * size + size / 2] == 255);
+	CHECK(field[0] == 0);
+	CHECK(field[size * size - 1] == 0);
+
+	// Symmetric like the disc
+	for (u32 x = 0; x < size; x++)
+	{
+		CHECK(field[(size / 2) * size + x] == field[x * size + size / 2]);
+	}
+}
+
+TEST(distance_field_empty)
+{
+	std::vector<u8> coverage(size * size, 0);
+	std::vector<u8> field(size * size, 0xAA);
+	build_distance_field(field.data(), coverage.data(), size, size, spread);
+
+	u32 outside = 0;
+
+	for (u8 value : field)
+	{
+		outside += value == 0;
+	}
+
+	CHECK(outside == size * size);
+}
+
+TEST(distance_field_full)
+{
+	std::vector<u8> coverage(size * size, 255);
+	std::vector<u8> field(size * size, 0xAA);
+	build_distance_field(field.data(), coverage.data(), size, size, spread);
+
+	u32 inside = 0;
+
+	for (u8 value : field)
+	{
+		inside += value == 255;
+	}
+
+	CHECK(inside == size * size);
+}
@@ -0,0 +1,462 @@
+#ifdef _WIN32
+// Winsock 2 has to come before windows.h, which includes the first version
+#include <winsock2.h>
+#endif
+
+#include "Test.h"
+#include "DrawDataRemote.h"
+
+// Headers
+#include <string.h>
+#include <thread>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef int SOCKET;
+#define INVALID_SOCKET -1
+#define closesocket close
+#endif
+
+static const u64 test_texture = 77;
+
+// Draw lists of a frame, which the server sends and the client is compared against
+struct TestFrame
+{
+	ImDrawList lists[2];
+	ImDrawList* pointers[2];
+	ImDrawData draw_data;
+};
+
+static void fill_frame(TestFrame& frame, u32 seed, u32 vertex_count)
+{
+	for (u32 l = 0; l < 2; l++)
+	{
+		ImDrawList& list = frame.lists[l];
+		u32 index_count = vertex_count / 3 * 3;
+
+		list.VtxBuffer.resize(vertex_count);
+		list.IdxBuffer.resize(index_count);
+		list.CmdBuffer.resize(2);
+
+		for (u32 i = 0; i < vertex_count; i++)
+		{
+			ImDrawVert& vertex = list.VtxBuffer[i];
+			vertex.pos = ImVec2((float)(i % 97 + seed), (float)(i / 97 + l));
+			vertex.uv = ImVec2(0.5f, 0.5f);
+			vertex.col = 0xFF000000 | (seed * 31 + i);
+		}
+
+		for (u32 i = 0; i < index_count; i++)
+		{
+			list.IdxBuffer[i] = (ImDrawIdx)((i * 7 + seed) % std::min<u32>(vertex_count, 0x10000));
+		}
+
+		// One command samples the font atlas, the other a texture of the server
+		list.CmdBuffer[0] = ImDrawCmd();
+		list.CmdBuffer[0].ElemCount = index_count / 3 * 2;
+		list.CmdBuffer[0].ClipRect = ImVec4(0, 0, 100.0f + seed, 100);
+		list.CmdBuffer[0].TextureId = ImGui::GetIO().Fonts->TexID;
+		list.CmdBuffer[1] = ImDrawCmd();
+		list.CmdBuffer[1].ElemCount = index_count - list.CmdBuffer[0].ElemCount;
+		list.CmdBuffer[1].ClipRect = ImVec4(10, 20, 30, 40.0f + seed);
+		list.CmdBuffer[1].TextureId = (ImTextureID)(uintptr_t)test_texture;
+
+		frame.pointers[l] = &list;
+	}
+
+	frame.draw_data = ImDrawData();
+	frame.draw_data.Valid = true;
+	frame.draw_data.CmdLists = frame.pointers;
+	frame.draw_data.CmdListsCount = 2;
+	frame.draw_data.TotalVtxCount = 2 * vertex_count;
+	frame.draw_data.TotalIdxCount = frame.lists[0].IdxBuffer.size() * 2;
+}
+
+static bool same_frame(const ImDrawData* received, const TestFrame& frame)
+{
+	if (!received || received->CmdListsCount != frame.draw_data.CmdListsCount)
+	{
+		return false;
+	}
+
+	for (s32 l = 0; l < received->CmdListsCount; l++)
+	{
+		const ImDrawList& list = *received->CmdLists[l];
+		const ImDrawList& sent = frame.lists[l];
+
+		if (list.VtxBuffer.size() != sent.VtxBuffer.size() || list.IdxBuffer.size() != sent.IdxBuffer.size() || list.CmdBuffer.size() != sent.CmdBuffer.size())
+		{
+			return false;
+		}
+
+		if (memcmp(list.VtxBuffer.Data, sent.VtxBuffer.Data, sent.VtxBuffer.size() * sizeof(ImDrawVert)) != 0 ||
+			memcmp(list.IdxBuffer.Data, sent.IdxBuffer.Data, sent.IdxBuffer.size() * sizeof(ImDrawIdx)) != 0)
+		{
+			return false;
+		}
+
+		for (s32 c = 0; c < list.CmdBuffer.size(); c++)
+		{
+			const ImDrawCmd& command = list.CmdBuffer[c];
+			const ImDrawCmd& sent_command = sent.CmdBuffer[c];
+
+			// The texture of the server is looked up as test_texture + 1000
+			ImTextureID texture = sent_command.TextureId == ImGui::GetIO().Fonts->TexID ? sent_command.TextureId : (ImTextureID)(uintptr_t)(test_texture + 1000);
+
+			if (command.ElemCount != sent_command.ElemCount || memcmp(&command.ClipRect, &sent_command.ClipRect, sizeof(ImVec4)) != 0 || command.TextureId != texture)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// Textures, which the client received
+struct TestTextures
+{
+	u32 uploads = 0;
+	u32 releases = 0;
+	u32 width = 0;
+	u32 height = 0;
+	u8 first_byte = 0;
+};
+
+static void upload_texture(u64 texture, const u8* pixels, u32 width, u32 height, void* user_data)
+{
+	TestTextures& textures = *(TestTextures*)user_data;
+
+	if (texture != test_texture)
+	{
+		return;
+	}
+
+	if (!pixels)
+	{
+		textures.releases++;
+		return;
+	}
+
+	textures.uploads++;
+	textures.width = width;
+	textures.height = height;
+	textures.first_byte = pixels[0];
+}
+
+static ImTextureID lookup_texture(u64 texture, void* user_data)
+{
+	(void)user_data;
+	return (ImTextureID)(uintptr_t)(texture + 1000);
+}
+
+// Polls the client until the check accepts what it returned, or it times out or disconnects
+template <typename Check>
+static bool read_until(ImGuiDrawDataClient& client, Check check)
+{
+	double deadline = test_seconds() + 5.0;
+
+	while (test_seconds() < deadline && client.is_connected())
+	{
+		if (check(client.read_frame()))
+		{
+			return true;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return false;
+}
+
+// Accepts the client on the server, which only happens when writing a frame, while the client connects on a thread
+static bool connect_client(ImGuiDrawDataServer& server, ImGuiDrawDataClient& client, const char* address, u16 port, TestFrame& frame)
+{
+	bool connected = false;
+	std::thread viewer([&] { connected = client.connect(address, port); });
+
+	double deadline = test_seconds() + 5.0;
+
+	while (!server.is_connected() && test_seconds() < deadline)
+	{
+		server.write_frame(&frame.draw_data);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	viewer.join();
+
+	return connected;
+}
+
+static void test_loopback(const char* address, u16 port, bool compress)
+{
+	std::vector<u8> pixels(4 * 2 * 4, 9);
+
+	ImGuiDrawDataServer server;
+	CHECK(server.listen(address, port, ImGui::GetIO().Fonts, compress));
+	server.set_texture((ImTextureID)(uintptr_t)test_texture, pixels.data(), 4, 2);
+
+	TestTextures textures;
+	ImGuiDrawDataClient client;
+	client.set_texture_callbacks(upload_texture, lookup_texture, &textures);
+
+	// Connecting sends the font atlas, the texture and the keyframe
+	TestFrame keyframe;
+	fill_frame(keyframe, 1, 300);
+
+	if (!connect_client(server, client, address, port, keyframe))
+	{
+		CHECK(!"The client failed to connect");
+		return;
+	}
+
+	ImFontAtlas font_atlas = {};
+	CHECK(client.load_font_atlas(&font_atlas));
+
+	unsigned char* font_pixels;
+	int font_width, font_height;
+	ImGui::GetIO().Fonts->GetTexDataAsRGBA32(&font_pixels, &font_width, &font_height);
+	CHECK(font_atlas.TexWidth == font_width && font_atlas.TexHeight == font_height);
+	CHECK(font_atlas.TexPixelsRGBA32 && memcmp(font_atlas.TexPixelsRGBA32, font_pixels, (size_t)font_width * font_height * 4) == 0);
+
+	CHECK(read_until(client, [&](ImDrawData* draw_data) { return same_frame(draw_data, keyframe); }));
+	CHECK(textures.uploads == 1 && textures.width == 4 && textures.height == 2 && textures.first_byte == 9);
+
+	// The next frame is a delta to the keyframe
+	TestFrame delta;
+	fill_frame(delta, 2, 300);
+	CHECK(server.write_frame(&delta.draw_data));
+	CHECK(read_until(client, [&](ImDrawData* draw_data) { return same_frame(draw_data, delta); }));
+	CHECK(server.sent_frames == 2 && server.dropped_frames == 0);
+
+	// A frame larger than the socket buffers is still being sent, so the one after it is dropped
+	TestFrame large;
+	fill_frame(large, 3, 1000000);
+	TestFrame latest;
+	fill_frame(latest, 4, 300);
+	CHECK(server.write_frame(&large.draw_data));
+	CHECK(server.write_frame(&latest.draw_data));
+	CHECK(server.dropped_frames == 1);
+
+	// Writing keeps flushing the large frame, until the latest one gets through
+	CHECK(read_until(client, [&](ImDrawData* draw_data)
+	{
+		server.write_frame(&latest.draw_data);
+		return same_frame(draw_data, latest);
+	}));
+
+	// Unchanged pixels aren't sent again, and pixels changed several times before a frame are only sent once
+	server.set_texture((ImTextureID)(uintptr_t)test_texture, pixels.data(), 4, 2);
+	pixels[0] = 10;
+	server.set_texture((ImTextureID)(uintptr_t)test_texture, pixels.data(), 4, 2);
+	pixels[0] = 11;
+	server.set_texture((ImTextureID)(uintptr_t)test_texture, pixels.data(), 4, 2);
+	CHECK(server.write_frame(&latest.draw_data));
+	CHECK(read_until(client, [&](ImDrawData* draw_data) { (void)draw_data; return textures.uploads != 1; }));
+	CHECK(textures.uploads == 2 && textures.first_byte == 11);
+
+	// Releasing the texture releases it on the client
+	server.release_texture((ImTextureID)(uintptr_t)test_texture);
+	CHECK(server.write_frame(&latest.draw_data));
+	CHECK(read_until(client, [&](ImDrawData* draw_data) { (void)draw_data; return textures.releases != 0; }));
+	CHECK(textures.uploads == 2 && textures.releases == 1);
+
+	// The client sees the stream end when the server closes it
+	server.close();
+	read_until(client, [&](ImDrawData* draw_data) { (void)draw_data; return false; });
+	CHECK(!client.is_connected());
+}
+
+static u16 test_port()
+{
+	const char* port = test_option("port");
+	return port ? (u16)atoi(port) : 47311;
+}
+
+TEST(draw_data_remote_tcp)
+{
+	test_loopback("127.0.0.1", test_port(), false);
+#ifdef IMGUI_RENDERERS_USE_LZ4
+	test_loopback("127.0.0.1", test_port(), true);
+#endif
+}
+
+#ifndef _WIN32
+TEST(draw_data_remote_unix_socket)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/tmp/imgui_renderers_test_%d.sock", (int)getpid());
+	test_loopback(path, 0, false);
+}
+#endif
+
+TEST(draw_data_remote_chunk_limit)
+{
+	ImGuiDrawDataServer server;
+	CHECK(server.listen("127.0.0.1", test_port(), ImGui::GetIO().Fonts));
+
+	// The font atlas is larger than the limit, so the client refuses the stream instead of allocating for it
+	ImGuiDrawDataClient client;
+	client.max_chunk_size = 8;
+
+	TestFrame frame;
+	fill_frame(frame, 1, 30);
+	CHECK(!connect_client(server, client, "127.0.0.1", test_port(), frame));
+	CHECK(!client.is_connected());
+}
+
+static void append_chunk(std::vector<u8>& stream, u32 type, const std::vector<u8>& payload)
+{
+	ImGuiCaptureChunk chunk = {};
+	chunk.type = type;
+	chunk.size = (u32)payload.size();
+	chunk.stored_size = chunk.size;
+
+	stream.insert(stream.end(), (const u8*)&chunk, (const u8*)&chunk + sizeof(chunk));
+	stream.insert(stream.end(), payload.begin(), payload.end());
+}
+
+template <typename T>
+static void append_value(std::vector<u8>& payload, T value)
+{
+	payload.insert(payload.end(), (const u8*)&value, (const u8*)&value + sizeof(value));
+}
+
+// A stream of the header and the chunk, which a hostile server could send
+static std::vector<u8> hostile_stream(u32 type, const std::vector<u8>& payload)
+{
+	ImGuiCaptureHeader header = {};
+	memcpy(header.magic, "IMDC", 4);
+	header.version = capture_version;
+	header.vertex_size = sizeof(ImDrawVert);
+	header.index_size = sizeof(ImDrawIdx);
+
+	std::vector<u8> stream((const u8*)&header, (const u8*)&header + sizeof(header));
+	append_chunk(stream, type, payload);
+
+	return stream;
+}
+
+// Sends the bytes to the client in place of a server and returns whether it connected, which needs a font atlas
+static bool connect_raw(ImGuiDrawDataClient& client, const std::vector<u8>& stream)
+{
+#ifdef _WIN32
+	WSADATA data;
+	WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+
+	SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(test_port());
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	bool connected = false;
+
+	if (listener != INVALID_SOCKET && bind(listener, (sockaddr*)&address, sizeof(address)) == 0 && listen(listener, 1) == 0)
+	{
+		std::thread viewer([&] { connected = client.connect("127.0.0.1", test_port(), 1000); });
+
+		// The client gives up after a second, so the accept doesn't wait for it any longer
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(listener, &readable);
+		timeval timeout = { 5, 0 };
+
+		SOCKET handle = select((int)listener + 1, &readable, nullptr, nullptr, &timeout) > 0 ? accept(listener, nullptr, nullptr) : INVALID_SOCKET;
+
+		if (handle != INVALID_SOCKET)
+		{
+			send(handle, (const char*)stream.data(), (int)stream.size(), 0);
+		}
+
+		viewer.join();
+
+		if (handle != INVALID_SOCKET)
+		{
+			closesocket(handle);
+		}
+	}
+	else
+	{
+		CHECK(!"Failed to listen for the client");
+	}
+
+	if (listener != INVALID_SOCKET)
+	{
+		closesocket(listener);
+	}
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+
+	return connected;
+}
+
+TEST(draw_data_remote_hostile_chunks)
+{
+	// A texture, whose size wraps around to 0 bytes when multiplied, is refused before it's uploaded
+	std::vector<u8> texture;
+	append_value<u64>(texture, test_texture);
+	append_value<u32>(texture, 0x80000000);
+	append_value<u32>(texture, 0x80000000);
+	append_value<u32>(texture, 0);
+
+	TestTextures textures;
+	ImGuiDrawDataClient texture_client;
+	texture_client.set_texture_callbacks(upload_texture, lookup_texture, &textures);
+	CHECK(!connect_raw(texture_client, hostile_stream(CAPTURE_CHUNK_TEXTURE, texture)));
+	CHECK(textures.uploads == 0 && textures.releases == 0);
+
+	// The same size in the font atlas is refused when it's loaded
+	std::vector<u8> font;
+	append_value<u32>(font, 0x80000000);
+	append_value<u32>(font, 0x80000000);
+	append_value<u32>(font, 0);
+
+	ImFontAtlas font_atlas = {};
+	ImGuiDrawDataClient font_client;
+	CHECK(connect_raw(font_client, hostile_stream(CAPTURE_CHUNK_FONT, font)));
+	CHECK(!font_client.load_font_atlas(&font_atlas));
+	CHECK(!font_atlas.TexPixelsRGBA32 && !font_atlas.TexPixelsAlpha8);
+
+	// Frames claiming more lists or vertices than they hold are refused before they are allocated
+	std::vector<u8> lists;
+	append_value<float>(lists, 1280.0f);
+	append_value<float>(lists, 720.0f);
+	append_value<float>(lists, 1.0f);
+	append_value<float>(lists, 1.0f);
+	std::vector<u8> vertices = lists;
+	append_value<u32>(lists, 0xFFFFFFFF);
+
+	append_value<u32>(vertices, 1);
+	append_value<u32>(vertices, 0xFFFFFFFF);
+	append_value<u32>(vertices, 0);
+	append_value<u32>(vertices, 0);
+	vertices.insert(vertices.end(), 3, 0); // Unchanged streams
+
+	const std::vector<u8>* frames[2] = { &lists, &vertices };
+
+	for (const std::vector<u8>* frame : frames)
+	{
+		ImGuiDrawDataDecoder decoder;
+		CHECK(!decoder.decode_frame(frame->data(), frame->size(), true));
+
+		std::vector<u8> stream = hostile_stream(CAPTURE_CHUNK_FONT, font);
+		append_chunk(stream, CAPTURE_CHUNK_FRAME, *frame);
+
+		ImGuiDrawDataClient frame_client;
+		bool connected = connect_raw(frame_client, stream);
+		CHECK(!connected || !read_until(frame_client, [&](ImDrawData* draw_data) { return draw_data != nullptr; }));
+		CHECK(!frame_client.is_connected());
+	}
+}
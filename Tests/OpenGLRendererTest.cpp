@@ -0,0 +1,241 @@
+#include "Test.h"
+
+#ifdef _WIN32
+#pragma comment(lib, "opengl32.lib")
+#else
+// Headers
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+static const u32 width = 128;
+static const u32 height = 64;
+
+// A context without a visible window: a hidden window on Windows, a surfaceless EGL context elsewhere. The renderer
+// draws into a framebuffer of its own, so neither needs a default framebuffer.
+class TestGLContext
+{
+public:
+	~TestGLContext()
+	{
+#ifdef _WIN32
+		wglMakeCurrent(nullptr, nullptr);
+		if (context) wglDeleteContext(context);
+		if (device_context) ReleaseDC(window, device_context);
+		if (window) DestroyWindow(window);
+#else
+		if (display != EGL_NO_DISPLAY)
+		{
+			eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+			eglTerminate(display);
+		}
+#endif
+	}
+
+	bool create()
+	{
+#ifdef _WIN32
+		window = create_test_window(width, height);
+		device_context = window ? GetDC(window) : nullptr;
+
+		if (!device_context)
+		{
+			return false;
+		}
+
+		PIXELFORMATDESCRIPTOR format = {};
+		format.nSize = sizeof(format);
+		format.nVersion = 1;
+		format.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+		format.iPixelType = PFD_TYPE_RGBA;
+		format.cColorBits = 32;
+
+		if (!SetPixelFormat(device_context, ChoosePixelFormat(device_context, &format), &format))
+		{
+			return false;
+		}
+
+		// Drivers give the legacy context the highest compatibility version, which includes 3.3
+		context = wglCreateContext(device_context);
+		return context && wglMakeCurrent(device_context, context);
+#else
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+		if (!get_platform_display)
+		{
+			return false;
+		}
+
+		display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) || !eglBindAPI(EGL_OPENGL_API))
+		{
+			display = EGL_NO_DISPLAY;
+			return false;
+		}
+
+		const EGLint attributes[] =
+		{
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+
+		context = eglCreateContext(display, nullptr, EGL_NO_CONTEXT, attributes);
+		return context != EGL_NO_CONTEXT && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+#endif
+	}
+
+	void* (*get_proc_address())(const char* name)
+	{
+#ifdef _WIN32
+		return nullptr;
+#else
+		return (void* (*)(const char*))eglGetProcAddress;
+#endif
+	}
+
+private:
+#ifdef _WIN32
+	HWND window = nullptr;
+	HDC device_context = nullptr;
+	HGLRC context = nullptr;
+#else
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+#endif
+};
+
+static void add_quad(ImDrawList& list, float x0, float y0, float x1, float y1, ImU32 colors[4])
+{
+	ImVec2 uv = ImGui::GetIO().Fonts->TexUvWhitePixel;
+	ImVec2 positions[4] = { ImVec2(x0, y0), ImVec2(x1, y0), ImVec2(x1, y1), ImVec2(x0, y1) };
+	ImDrawIdx base = (ImDrawIdx)list.VtxBuffer.size();
+	ImDrawIdx indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	s32 vertex_count = list.VtxBuffer.size();
+	list.VtxBuffer.resize(vertex_count + 4);
+
+	for (s32 i = 0; i < 4; i++)
+	{
+		list.VtxBuffer[vertex_count + i].pos = positions[i];
+		list.VtxBuffer[vertex_count + i].uv = uv;
+		list.VtxBuffer[vertex_count + i].col = colors[i];
+	}
+
+	s32 index_count = list.IdxBuffer.size();
+	list.IdxBuffer.resize(index_count + 6);
+
+	for (s32 i = 0; i < 6; i++)
+	{
+		list.IdxBuffer[index_count + i] = base + indices[i];
+	}
+}
+
+static void add_quad(ImDrawList& list, float x0, float y0, float x1, float y1, ImU32 color)
+{
+	ImU32 colors[4] = { color, color, color, color };
+	add_quad(list, x0, y0, x1, y1, colors);
+}
+
+static void add_command(ImDrawList& list, u32 element_count, ImVec4 clip_rect)
+{
+	ImDrawCmd command;
+	command.ElemCount = element_count;
+	command.ClipRect = clip_rect;
+	command.TextureId = ImGui::GetIO().Fonts->TexID;
+
+	s32 count = list.CmdBuffer.size();
+	list.CmdBuffer.resize(count + 1);
+	list.CmdBuffer[count] = command;
+}
+
+// Renders the same frames through the persistently mapped ring or by orphaning the buffer, and compares the last one.
+// The quads lie on whole pixels, so only the gradient depends on how the driver rounds the interpolated colours.
+static void render_test_frames(bool persistent_mapping)
+{
+	TestGLContext context;
+
+	if (!context.create())
+	{
+		CHECK(!"Failed to create an OpenGL context");
+		return;
+	}
+
+	ImGuiOpenGLOptions options;
+	options.get_proc_address = context.get_proc_address();
+	options.offscreen = true;
+	options.width = width;
+	options.height = height;
+	options.persistent_mapping = persistent_mapping;
+	options.ring_size = 256; // Grows on the first frame
+
+	ImGuiOpenGLRenderer renderer;
+
+	if (!renderer.initialize(nullptr, nullptr, &options))
+	{
+		CHECK(!"Failed to initialize the OpenGL renderer");
+		return;
+	}
+
+	if (persistent_mapping && !renderer.is_persistently_mapped())
+	{
+		log(WARNING, "The context has no ARB_buffer_storage, the ring falls back to orphaning.");
+	}
+
+	CHECK(persistent_mapping || !renderer.is_persistently_mapped());
+
+	ImDrawList lists[2];
+
+	// Opaque and translucent quads overlapping with blending, and a gradient
+	ImU32 gradient[4] = { 0xFF0000FF, 0xFFFF0000, 0xFFFF0000, 0xFF0000FF };
+	add_quad(lists[0], 8, 8, 40, 40, 0xFF0000FF);
+	add_quad(lists[0], 24, 24, 56, 56, 0x8000FF00);
+	add_quad(lists[0], 64, 8, 120, 24, gradient);
+	add_command(lists[0], 18, ImVec4(0, 0, (float)width, (float)height));
+
+	// A quad cut by the scissor rectangle
+	add_quad(lists[0], 60, 28, 124, 60, 0xFFFFFFFF);
+	add_command(lists[0], 6, ImVec4(70, 30, 100, 50));
+
+	// A second list, whose indices start again at 0
+	add_quad(lists[1], 4, 48, 20, 60, 0xC000FFFF);
+	add_command(lists[1], 6, ImVec4(0, 0, (float)width, (float)height));
+
+	ImDrawList* pointers[2] = { &lists[0], &lists[1] };
+
+	ImDrawData draw_data = ImDrawData();
+	draw_data.Valid = true;
+	draw_data.CmdLists = pointers;
+	draw_data.CmdListsCount = 2;
+	draw_data.TotalVtxCount = lists[0].VtxBuffer.size() + lists[1].VtxBuffer.size();
+	draw_data.TotalIdxCount = lists[0].IdxBuffer.size() + lists[1].IdxBuffer.size();
+
+	// Several frames, so the ring wraps around and the orphaned buffer is replaced
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = ImVec2((float)width, (float)height);
+	io.DisplayFramebufferScale = ImVec2(1, 1);
+
+	for (u32 frame = 0; frame < 5; frame++)
+	{
+		io.RenderDrawListsFn(&draw_data);
+	}
+
+	CHECK(renderer.get_stats().draw_calls == 3);
+
+	std::vector<u32> pixels(width * height);
+	CHECK(renderer.read_pixels(pixels.data()));
+	CHECK(compare_image("opengl_renderer", pixels.data(), width, height, 2));
+}
+
+TEST(opengl_persistent_mapping)
+{
+	render_test_frames(true);
+}
+
+TEST(opengl_orphaning)
+{
+	render_test_frames(false);
+}
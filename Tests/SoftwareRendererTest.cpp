@@ -0,0 +1,147 @@
+#include "Test.h"
+
+// Headers
+#include <string.h>
+
+// Not a multiple of the 64 pixel tiles, so the last row and column of tiles are partial
+static const u32 width = 200;
+static const u32 height = 150;
+
+static void add_vertex(ImDrawList& list, float x, float y, float u, float v, ImU32 color)
+{
+	s32 count = list.VtxBuffer.size();
+	list.VtxBuffer.resize(count + 1);
+	list.VtxBuffer[count].pos = ImVec2(x, y);
+	list.VtxBuffer[count].uv = ImVec2(u, v);
+	list.VtxBuffer[count].col = color;
+}
+
+// Adds the two triangles of the last four vertices and a command for them
+static void add_quad_command(ImDrawList& list, ImTextureID texture, ImVec4 clip_rect)
+{
+	ImDrawIdx base = (ImDrawIdx)(list.VtxBuffer.size() - 4);
+	ImDrawIdx indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	s32 index_count = list.IdxBuffer.size();
+	list.IdxBuffer.resize(index_count + 6);
+
+	for (s32 i = 0; i < 6; i++)
+	{
+		list.IdxBuffer[index_count + i] = base + indices[i];
+	}
+
+	ImDrawCmd command;
+	command.ElemCount = 6;
+	command.ClipRect = clip_rect;
+	command.TextureId = texture;
+
+	s32 count = list.CmdBuffer.size();
+	list.CmdBuffer.resize(count + 1);
+	list.CmdBuffer[count] = command;
+}
+
+// Renders the test frame with the thread count and filtering into the pixels
+static void render_test_frame(std::vector<u32>& pixels, u32 thread_count, bool bilinear_filtering)
+{
+	// A 4x4 texture of different colours, the bottom row half transparent
+	u32 texels[16];
+
+	for (u32 i = 0; i < 16; i++)
+	{
+		u32 alpha = i < 12 ? 0xFF : 0x80;
+		texels[i] = (alpha << 24) | ((i * 16) << 16) | ((255 - i * 16) << 8) | ((i % 4) * 80);
+	}
+
+	ImGuiSoftwareTexture texture;
+	texture.pixels = texels;
+	texture.width = 4;
+	texture.height = 4;
+
+	pixels.assign(width * height, 0);
+
+	ImGuiSoftwareOptions options = {};
+	options.framebuffer = pixels.data();
+	options.width = width;
+	options.height = height;
+	options.clear_color = 0xFF202020;
+	options.bilinear_filtering = bilinear_filtering;
+	options.thread_count = thread_count;
+
+	ImGuiSoftwareRenderer renderer;
+
+	if (!renderer.initialize(nullptr, nullptr, &options))
+	{
+		CHECK(!"Failed to initialize the software renderer");
+		return;
+	}
+
+	ImGuiIO& io = ImGui::GetIO();
+	ImVec2 white = io.Fonts->TexUvWhitePixel;
+	ImVec4 full = ImVec4(0, 0, (float)width, (float)height);
+	ImDrawList list;
+
+	// The texture magnified 20 times on an axis aligned quad and on a rotated one
+	add_vertex(list, 8, 8, 0, 0, 0xFFFFFFFF);
+	add_vertex(list, 88, 8, 1, 0, 0xFFFFFFFF);
+	add_vertex(list, 88, 88, 1, 1, 0xFFFFFFFF);
+	add_vertex(list, 8, 88, 0, 1, 0xFFFFFFFF);
+	add_quad_command(list, &texture, full);
+
+	add_vertex(list, 150, 8, 0, 0, 0xFFFFFFFF);
+	add_vertex(list, 192, 50, 1, 0, 0xFFFFFFFF);
+	add_vertex(list, 150, 92, 1, 1, 0xFFFFFFFF);
+	add_vertex(list, 108, 50, 0, 1, 0xFFFFFFFF);
+	add_quad_command(list, &texture, full);
+
+	// A translucent quad blended over both and the clear colour
+	add_vertex(list, 40, 40, white.x, white.y, 0x80FF8000);
+	add_vertex(list, 140, 40, white.x, white.y, 0x80FF8000);
+	add_vertex(list, 140, 110, white.x, white.y, 0x80FF8000);
+	add_vertex(list, 40, 110, white.x, white.y, 0x80FF8000);
+	add_quad_command(list, io.Fonts->TexID, full);
+
+	// A gradient cut by the scissor rectangle, across the tile borders
+	add_vertex(list, 10, 95, white.x, white.y, 0xFF0000FF);
+	add_vertex(list, 190, 95, white.x, white.y, 0xFF00FF00);
+	add_vertex(list, 190, 145, white.x, white.y, 0xFFFF0000);
+	add_vertex(list, 10, 145, white.x, white.y, 0x40FFFFFF);
+	add_quad_command(list, io.Fonts->TexID, ImVec4(30.5f, 100, 170, 139.5f));
+
+	ImDrawList* lists[1] = { &list };
+
+	ImDrawData draw_data = ImDrawData();
+	draw_data.Valid = true;
+	draw_data.CmdLists = lists;
+	draw_data.CmdListsCount = 1;
+	draw_data.TotalVtxCount = list.VtxBuffer.size();
+	draw_data.TotalIdxCount = list.IdxBuffer.size();
+
+	io.RenderDrawListsFn(&draw_data);
+}
+
+// The tiles are rasterized independently, so any number of threads gives the same pixels as one
+static void test_thread_counts(const char* image, bool bilinear_filtering)
+{
+	std::vector<u32> reference;
+	render_test_frame(reference, 1, bilinear_filtering);
+	CHECK(compare_image(image, reference.data(), width, height));
+
+	const u32 thread_counts[] = { 2, 3, 8, 0 };
+
+	for (u32 thread_count : thread_counts)
+	{
+		std::vector<u32> pixels;
+		render_test_frame(pixels, thread_count, bilinear_filtering);
+		CHECK(memcmp(pixels.data(), reference.data(), reference.size() * sizeof(u32)) == 0);
+	}
+}
+
+TEST(software_nearest)
+{
+	test_thread_counts("software_nearest", false);
+}
+
+TEST(software_bilinear)
+{
+	test_thread_counts("software_bilinear", true);
+}
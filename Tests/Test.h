@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ImGuiRenderers.h"
+
+// Headers
+#include <chrono>
+
+// A minimal test runner. Tests register themselves with TEST and report failures with CHECK, which carries on with the
+// test. Benchmarks only run with --benchmark, as they take a while and print timings instead of checking results.
+typedef void (*ImGuiTestFunction)();
+
+struct ImGuiTestRegistration
+{
+	ImGuiTestRegistration(const char* name, ImGuiTestFunction function, bool benchmark);
+};
+
+#define TEST(name) \
+	static void test_##name(); \
+	static ImGuiTestRegistration test_registration_##name(#name, test_##name, false); \
+	static void test_##name()
+
+#define BENCHMARK(name) \
+	static void benchmark_##name(); \
+	static ImGuiTestRegistration benchmark_registration_##name(#name, benchmark_##name, true); \
+	static void benchmark_##name()
+
+#define CHECK(condition) do { if (!(condition)) test_failed(__FILE__, __LINE__, #condition); } while (false)
+
+void test_failed(const char* file, s32 line, const char* condition);
+
+// Value of a command line option like --capture file, or nullptr when it wasn't passed
+const char* test_option(const char* name);
+
+// Compares RGBA8 pixels with the TGA image of the name in Tests/data, allowing each channel to differ by the tolerance.
+// A mismatch writes the pixels next to the executable as <name>.actual.tga. --update-images rewrites the reference instead.
+bool compare_image(const char* name, const u32* pixels, u32 width, u32 height, u32 tolerance = 0);
+
+inline double test_seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef _WIN32
+// A hidden window for the renderers, which need one
+HWND create_test_window(u32 width, u32 height);
+#endif
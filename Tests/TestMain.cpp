@@ -0,0 +1,276 @@
+#include "Test.h"
+
+// Headers
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct Test
+{
+	const char* name;
+	ImGuiTestFunction function;
+	bool benchmark;
+};
+
+// Function local, so that the registrations of other translation units can't run before it's constructed
+static std::vector<Test>& get_tests()
+{
+	static std::vector<Test> tests;
+	return tests;
+}
+
+static u32 failures = 0;
+static bool update_images = false;
+static std::vector<const char*> arguments;
+
+ImGuiTestRegistration::ImGuiTestRegistration(const char* name, ImGuiTestFunction function, bool benchmark)
+{
+	get_tests().push_back({ name, function, benchmark });
+}
+
+void test_failed(const char* file, s32 line, const char* condition)
+{
+	log(ERROR, "%s(%d): CHECK(%s) failed.", file, line, condition);
+	failures++;
+}
+
+const char* test_option(const char* name)
+{
+	for (size_t i = 0; i + 1 < arguments.size(); i++)
+	{
+		if (arguments[i][0] == '-' && arguments[i][1] == '-' && strcmp(arguments[i] + 2, name) == 0)
+		{
+			return arguments[i + 1];
+		}
+	}
+
+	return nullptr;
+}
+
+// The reference images live next to this file, unless --data points elsewhere
+static std::string get_data_path(const char* name)
+{
+	if (const char* data = test_option("data"))
+	{
+		return std::string(data) + "/" + name + ".tga";
+	}
+
+	std::string path = __FILE__;
+	size_t separator = path.find_last_of("/\\");
+	path = separator == std::string::npos ? std::string() : path.substr(0, separator + 1);
+	return path + "data/" + name + ".tga";
+}
+
+// Uncompressed 32-bit TGAs, which any image viewer opens, with the rows from the top
+static bool write_tga(const std::string& path, const u32* pixels, u32 width, u32 height)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+
+	if (!file)
+	{
+		log(ERROR, "Failed to open %s for writing.", path.c_str());
+		return false;
+	}
+
+	u8 header[18] = {};
+	header[2] = 2;
+	header[12] = width & 0xFF;
+	header[13] = (width >> 8) & 0xFF;
+	header[14] = height & 0xFF;
+	header[15] = (height >> 8) & 0xFF;
+	header[16] = 32;
+	header[17] = 0x28; // 8 alpha bits, top-left origin
+	fwrite(header, 1, sizeof(header), file);
+
+	// TGA stores BGRA, the framebuffers are RGBA like ImU32
+	std::vector<u8> row(width * 4);
+
+	for (u32 y = 0; y < height; y++)
+	{
+		for (u32 x = 0; x < width; x++)
+		{
+			u32 pixel = pixels[y * width + x];
+			row[x * 4 + 0] = (pixel >> 16) & 0xFF;
+			row[x * 4 + 1] = (pixel >> 8) & 0xFF;
+			row[x * 4 + 2] = pixel & 0xFF;
+			row[x * 4 + 3] = pixel >> 24;
+		}
+
+		fwrite(row.data(), 1, row.size(), file);
+	}
+
+	fclose(file);
+	return true;
+}
+
+static bool read_tga(const std::string& path, std::vector<u32>& pixels, u32& width, u32& height)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+
+	if (!file)
+	{
+		return false;
+	}
+
+	u8 header[18];
+	bool valid = fread(header, 1, sizeof(header), file) == sizeof(header) && header[2] == 2 && header[16] == 32 && (header[17] & 0x20);
+	width = header[12] | (header[13] << 8);
+	height = header[14] | (header[15] << 8);
+	std::vector<u8> data(width * height * 4);
+	valid = valid && fseek(file, header[0], SEEK_CUR) == 0 && fread(data.data(), 1, data.size(), file) == data.size();
+	fclose(file);
+
+	if (!valid)
+	{
+		log(ERROR, "%s isn't an uncompressed 32-bit TGA.", path.c_str());
+		return false;
+	}
+
+	pixels.resize(width * height);
+
+	for (u32 i = 0; i < width * height; i++)
+	{
+		pixels[i] = data[i * 4 + 2] | (data[i * 4 + 1] << 8) | (data[i * 4] << 16) | ((u32)data[i * 4 + 3] << 24);
+	}
+
+	return true;
+}
+
+bool compare_image(const char* name, const u32* pixels, u32 width, u32 height, u32 tolerance)
+{
+	std::string path = get_data_path(name);
+
+	if (update_images)
+	{
+		log(INFO, "Updating %s.", path.c_str());
+		return write_tga(path, pixels, width, height);
+	}
+
+	std::vector<u32> reference;
+	u32 reference_width = 0;
+	u32 reference_height = 0;
+
+	if (!read_tga(path, reference, reference_width, reference_height))
+	{
+		log(ERROR, "Failed to read the reference image %s. Run with --update-images to create it.", path.c_str());
+		write_tga(std::string(name) + ".actual.tga", pixels, width, height);
+		return false;
+	}
+
+	u32 differences = 0;
+	u32 largest = 0;
+
+	if (reference_width == width && reference_height == height)
+	{
+		for (u32 i = 0; i < width * height; i++)
+		{
+			for (u32 shift = 0; shift < 32; shift += 8)
+			{
+				s32 difference = abs((s32)((pixels[i] >> shift) & 0xFF) - (s32)((reference[i] >> shift) & 0xFF));
+
+				if ((u32)difference > tolerance)
+				{
+					differences++;
+					largest = largest > (u32)difference ? largest : (u32)difference;
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		log(ERROR, "%s is %ux%u, the image is %ux%u.", path.c_str(), reference_width, reference_height, width, height);
+		differences = width * height;
+	}
+
+	if (differences)
+	{
+		log(ERROR, "%u pixels differ from %s by up to %u, the image was written to %s.actual.tga.", differences, path.c_str(), largest, name);
+		write_tga(std::string(name) + ".actual.tga", pixels, width, height);
+		return false;
+	}
+
+	return true;
+}
+
+#ifdef _WIN32
+HWND create_test_window(u32 width, u32 height)
+{
+	WNDCLASSEXW window_class = {};
+	window_class.cbSize = sizeof(window_class);
+	window_class.lpfnWndProc = DefWindowProcW;
+	window_class.hInstance = GetModuleHandleW(nullptr);
+	window_class.lpszClassName = L"ImGuiRenderersTests";
+	RegisterClassExW(&window_class);
+
+	RECT rect = { 0, 0, (LONG)width, (LONG)height };
+	AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, FALSE);
+	return CreateWindowExW(0, window_class.lpszClassName, L"ImGuiRenderers tests", WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT,
+		rect.right - rect.left, rect.bottom - rect.top, nullptr, nullptr, window_class.hInstance, nullptr);
+}
+#endif
+
+// Runs all the tests, or the ones named on the command line. --benchmark runs the benchmarks instead.
+int main(int argc, char** argv)
+{
+	bool benchmarks = false;
+	std::vector<const char*> names;
+
+	for (s32 i = 1; i < argc; i++)
+	{
+		arguments.push_back(argv[i]);
+
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			benchmarks = true;
+		}
+		else if (strcmp(argv[i], "--update-images") == 0)
+		{
+			update_images = true;
+		}
+		else if (argv[i][0] == '-' && argv[i][1] == '-')
+		{
+			// Options with a value
+			if (i + 1 < argc)
+			{
+				arguments.push_back(argv[++i]);
+			}
+		}
+		else
+		{
+			names.push_back(argv[i]);
+		}
+	}
+
+	u32 run = 0;
+	u32 failed = 0;
+
+	for (const Test& test : get_tests())
+	{
+		bool selected = names.empty() ? test.benchmark == benchmarks : false;
+
+		for (const char* name : names)
+		{
+			selected = selected || strcmp(name, test.name) == 0;
+		}
+
+		if (!selected)
+		{
+			continue;
+		}
+
+		log(INFO, "%s %s", test.benchmark ? "Benchmark" : "Test", test.name);
+		u32 previous_failures = failures;
+		test.function();
+		run++;
+
+		if (failures != previous_failures)
+		{
+			log(ERROR, "%s failed.", test.name);
+			failed++;
+		}
+	}
+
+	log(INFO, "%u of %u passed.", run - failed, run);
+	return failed ? 1 : 0;
+}
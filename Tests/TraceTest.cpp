@@ -0,0 +1,87 @@
+#include "Test.h"
+#include "Trace.h"
+
+// Headers
+#include <atomic>
+#include <thread>
+
+static const char* const span_names[4] = { "first", "second", "third", "fourth" };
+static const u64 span_origin = 1000000000;
+
+// Span k starts at origin + k microseconds, lasts k % 7 microseconds and has the name k % 4, so a copy of a span,
+// which was torn by being overwritten, doesn't add up
+static bool is_test_span(const ImGuiTraceEvent& event)
+{
+	for (const char* name : span_names)
+	{
+		if (event.name == name)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool is_consistent(const ImGuiTraceEvent& event)
+{
+	u64 k = (event.start - span_origin) / 1000;
+	return event.start == span_origin + k * 1000 && event.duration == (k % 7) * 1000 && event.name == span_names[k % 4];
+}
+
+TEST(trace_concurrent_reads)
+{
+	// A small ring, which the thread overwrites many times while the spans are read
+	const u32 capacity = 64;
+	const u64 span_count = 2000000;
+	ImGuiTracer::set_enabled(true, capacity);
+
+	std::atomic<bool> done(false);
+	std::thread writer([&]
+	{
+		for (u64 k = 0; k < span_count; k++)
+		{
+			u64 start = span_origin + k * 1000;
+			ImGuiTracer::add_span(span_names[k % 4], start, start + (k % 7) * 1000);
+		}
+
+		done = true;
+	});
+
+	u64 reads = 0;
+	u64 torn = 0;
+
+	while (!done)
+	{
+		for (const ImGuiTraceEvent& event : ImGuiTracer::get_events(1e10))
+		{
+			torn += is_test_span(event) && !is_consistent(event);
+		}
+
+		reads++;
+	}
+
+	writer.join();
+	CHECK(torn == 0);
+
+	// Once the thread is done, the ring holds exactly its last spans
+	std::vector<ImGuiTraceEvent> events;
+
+	for (const ImGuiTraceEvent& event : ImGuiTracer::get_events(1e10))
+	{
+		if (is_test_span(event))
+		{
+			events.push_back(event);
+		}
+	}
+
+	CHECK(events.size() == capacity);
+
+	for (u64 i = 0; i < events.size(); i++)
+	{
+		CHECK(is_consistent(events[i]) && events[i].start == span_origin + (span_count - capacity + i) * 1000);
+	}
+
+	log(INFO, "Read the trace %llu times while it was written.", (unsigned long long)reads);
+	ImGuiTracer::set_enabled(false);
+}
@@ -0,0 +1,274 @@
+#include "Test.h"
+#include "UploadCopy.h"
+#include "Renderers/VulkanDispatch.h"
+
+// Headers
+#include <algorithm>
+#include <random>
+#include <string.h>
+
+static const u8 guard = 0xCD;
+
+// Copies of the benchmark, which are at least this large, are split across the threads
+static const u64 split_bytes = 1024 * 1024;
+
+// Copies with stream_copy at the offsets and checks the copy and that nothing around it was written
+static bool check_stream_copy(std::vector<u8>& destination, const std::vector<u8>& source, u64 destination_offset, u64 source_offset, u64 size)
+{
+	u64 end = std::min<u64>(destination.size(), destination_offset + size + upload_alignment);
+	memset(destination.data(), guard, end);
+
+	stream_copy(destination.data() + destination_offset, source.data() + source_offset, size);
+
+	for (u64 i = 0; i < end; i++)
+	{
+		bool inside = i >= destination_offset && i < destination_offset + size;
+
+		if (destination[i] != (inside ? source[source_offset + i - destination_offset] : guard))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST(stream_copy)
+{
+	const u64 max_size = 99000;
+	const u64 offsets[] = { 0, 1, 17, 63 };
+
+	std::mt19937 random(1);
+	std::vector<u8> source(max_size + upload_alignment);
+	std::vector<u8> destination(max_size + 2 * upload_alignment);
+
+	for (u8& byte : source)
+	{
+		byte = (u8)random();
+	}
+
+	// Every size around the streaming threshold and the cache lines, then larger ones up to the limit
+	for (u64 size = 0; size <= max_size; size += size < 1024 ? 1 : 997)
+	{
+		for (u32 i = 0; i < 4; i++)
+		{
+			if (!check_stream_copy(destination, source, offsets[i], offsets[(i + size) % 4], size))
+			{
+				log(ERROR, "stream_copy of %llu bytes to offset %llu failed.", (unsigned long long)size, (unsigned long long)offsets[i]);
+				CHECK(false);
+				return;
+			}
+		}
+	}
+}
+
+TEST(upload_copier)
+{
+	// Frames above the parallel threshold are split into parts across the threads
+	std::mt19937 random(2);
+	std::vector<u8> source(8 * 1024 * 1024);
+	std::vector<u8> destination(source.size());
+	std::vector<u8> reference(source.size());
+
+	for (u8& byte : source)
+	{
+		byte = (u8)random();
+	}
+
+	ImGuiUploadCopier copier;
+	copier.initialize(4, 1024 * 1024);
+
+	for (u32 frame = 0; frame < 20; frame++)
+	{
+		memset(destination.data(), 0, destination.size());
+		memset(reference.data(), 0, reference.size());
+
+		for (u64 offset = random() % 100; ; )
+		{
+			u64 size = random() % 200000;
+
+			if (offset + size > source.size())
+			{
+				break;
+			}
+
+			copier.add(destination.data() + offset, source.data() + offset, size);
+			memcpy(reference.data() + offset, source.data() + offset, size);
+			offset += size + random() % 100;
+		}
+
+		copier.flush();
+		CHECK(memcmp(destination.data(), reference.data(), destination.size()) == 0);
+	}
+}
+
+// Memory of a Vulkan device, which is host visible and coherent but not cached. On most devices the CPU writes to it
+// are write-combined, like the upload memory of the renderers.
+class WriteCombinedMemory
+{
+public:
+	u8* mapped = nullptr;
+
+	~WriteCombinedMemory()
+	{
+		if (memory) vkFreeMemory(device, memory, nullptr);
+		if (device) vkDestroyDevice(device, nullptr);
+		if (instance) vkDestroyInstance(instance, nullptr);
+	}
+
+	bool create(u64 size)
+	{
+		if (!vk.load_loader())
+		{
+			return false;
+		}
+
+		VkApplicationInfo application = {};
+		application.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+		application.apiVersion = VK_MAKE_VERSION(1, 0, 4);
+
+		VkInstanceCreateInfo instance_info = {};
+		instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+		instance_info.pApplicationInfo = &application;
+
+		if (vk.vkCreateInstance(&instance_info, nullptr, &instance) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		// Only a few functions are needed, which the loader dispatches without any extensions
+#define LOAD_FUNCTION(name) name = (PFN_##name)vk.vkGetInstanceProcAddr(instance, #name);
+		LOAD_FUNCTION(vkDestroyInstance)
+		LOAD_FUNCTION(vkEnumeratePhysicalDevices)
+		LOAD_FUNCTION(vkGetPhysicalDeviceMemoryProperties)
+		LOAD_FUNCTION(vkCreateDevice)
+		LOAD_FUNCTION(vkDestroyDevice)
+		LOAD_FUNCTION(vkAllocateMemory)
+		LOAD_FUNCTION(vkFreeMemory)
+		LOAD_FUNCTION(vkMapMemory)
+#undef LOAD_FUNCTION
+
+		u32 device_count = 1;
+		VkPhysicalDevice physical_device;
+
+		if (vkEnumeratePhysicalDevices(instance, &device_count, &physical_device) < 0 || device_count == 0)
+		{
+			return false;
+		}
+
+		VkPhysicalDeviceMemoryProperties properties;
+		vkGetPhysicalDeviceMemoryProperties(physical_device, &properties);
+
+		u32 type = properties.memoryTypeCount;
+		VkMemoryPropertyFlags wanted = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+		for (u32 i = 0; i < properties.memoryTypeCount && type == properties.memoryTypeCount; i++)
+		{
+			VkMemoryPropertyFlags flags = properties.memoryTypes[i].propertyFlags;
+			type = (flags & wanted) == wanted && !(flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) ? i : type;
+		}
+
+		if (type == properties.memoryTypeCount)
+		{
+			log(WARNING, "The device has no uncached host visible memory.");
+			return false;
+		}
+
+		float priority = 1.0f;
+		VkDeviceQueueCreateInfo queue_info = {};
+		queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queue_info.queueFamilyIndex = 0;
+		queue_info.queueCount = 1;
+		queue_info.pQueuePriorities = &priority;
+
+		VkDeviceCreateInfo device_info = {};
+		device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		device_info.queueCreateInfoCount = 1;
+		device_info.pQueueCreateInfos = &queue_info;
+
+		VkMemoryAllocateInfo allocate_info = {};
+		allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocate_info.allocationSize = size;
+		allocate_info.memoryTypeIndex = type;
+
+		return vkCreateDevice(physical_device, &device_info, nullptr, &device) == VK_SUCCESS &&
+			vkAllocateMemory(device, &allocate_info, nullptr, &memory) == VK_SUCCESS &&
+			vkMapMemory(device, memory, 0, size, 0, (void**)&mapped) == VK_SUCCESS;
+	}
+
+private:
+	ImGuiVulkanDispatch vk;
+	VkInstance instance = VK_NULL_HANDLE;
+	VkDevice device = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+
+	PFN_vkDestroyInstance vkDestroyInstance = nullptr;
+	PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices = nullptr;
+	PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties = nullptr;
+	PFN_vkCreateDevice vkCreateDevice = nullptr;
+	PFN_vkDestroyDevice vkDestroyDevice = nullptr;
+	PFN_vkAllocateMemory vkAllocateMemory = nullptr;
+	PFN_vkFreeMemory vkFreeMemory = nullptr;
+	PFN_vkMapMemory vkMapMemory = nullptr;
+};
+
+// Prints the best of several copies of the size into the destination with memcpy, stream_copy and the copier
+static void benchmark_copies(const char* memory, u8* destination, const u8* source, u64 size, ImGuiUploadCopier& copier, u32 thread_count)
+{
+	for (u32 mode = 0; mode < 3; mode++)
+	{
+		double best = 1e9;
+
+		for (u32 repeat = 0; repeat < 20; repeat++)
+		{
+			double start = test_seconds();
+
+			if (mode == 0)
+			{
+				memcpy(destination, source, size);
+			}
+			else if (mode == 1)
+			{
+				stream_copy(destination, source, size);
+			}
+			else
+			{
+				copier.add(destination, source, size);
+				copier.flush();
+			}
+
+			best = std::min(best, test_seconds() - start);
+		}
+
+		const char* names[] = { "memcpy", "stream_copy", "split" };
+		log(INFO, "%s, %6llu KB, %-11s x%u: %6.2f GB/s", memory, (unsigned long long)(size / 1024), names[mode], mode == 2 && size >= split_bytes ? thread_count : 1, size / best / 1e9);
+	}
+}
+
+BENCHMARK(copy_bandwidth)
+{
+	const u64 size = 32 * 1024 * 1024;
+	const u64 cached_size = 256 * 1024;
+	u32 thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<u8> source(size, 1);
+	std::vector<u8> destination(size);
+
+	ImGuiUploadCopier copier;
+	copier.initialize(thread_count, split_bytes);
+
+	// Cached memory, in and out of the cache
+	benchmark_copies("cached", destination.data(), source.data(), cached_size, copier, thread_count);
+	benchmark_copies("cached", destination.data(), source.data(), size, copier, thread_count);
+
+	WriteCombinedMemory write_combined;
+
+	if (!write_combined.create(size))
+	{
+		log(WARNING, "No Vulkan device with write-combined memory was found, only cached memory was measured.");
+		return;
+	}
+
+	benchmark_copies("write-combined", write_combined.mapped, source.data(), cached_size, copier, thread_count);
+	benchmark_copies("write-combined", write_combined.mapped, source.data(), size, copier, thread_count);
+}
@@ -0,0 +1,66 @@
+#include "Test.h"
+#include "VertexPacking.h"
+
+// Headers
+#include <math.h>
+
+// Packs the positions and checks that undoing the packing, like the projection does, gives them back within the error
+static bool check_round_trip(const std::vector<ImDrawVert>& vertices, float max_error, ImDrawVertPacking& packing)
+{
+	float bounds[4];
+	get_vertex_bounds(vertices.data(), (u32)vertices.size(), bounds);
+	packing = get_vertex_packing(bounds);
+
+	std::vector<ImDrawVertPacked> packed(vertices.size());
+	pack_vertices(packed.data(), vertices.data(), (u32)vertices.size(), packing);
+
+	for (u64 i = 0; i < vertices.size(); i++)
+	{
+		float x = packed[i].pos[0] / packing.scale + packing.origin[0];
+		float y = packed[i].pos[1] / packing.scale + packing.origin[1];
+
+		if (fabsf(x - vertices[i].pos.x) > max_error || fabsf(y - vertices[i].pos.y) > max_error || packed[i].col != vertices[i].col)
+		{
+			log(ERROR, "Vertex %llu at %.2f, %.2f was packed to %.2f, %.2f.", (unsigned long long)i, vertices[i].pos.x, vertices[i].pos.y, x, y);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Vertices on quarter pixels along a line, an odd count so the SIMD loops leave a tail
+static std::vector<ImDrawVert> make_line(float x, float y, float step, u32 count)
+{
+	std::vector<ImDrawVert> vertices(count);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		vertices[i].pos = ImVec2(x + floorf(i * step) * 0.25f, y - floorf(i * step * 0.5f) * 0.25f);
+		vertices[i].uv = ImVec2(0.5f, 0.5f);
+		vertices[i].col = 0xFF000000 | i;
+	}
+
+	return vertices;
+}
+
+TEST(vertex_packing)
+{
+	ImDrawVertPacking packing;
+
+	// A window far beyond 8192 pixels keeps quarter pixels, as it's packed around its own origin
+	CHECK(check_round_trip(make_line(20000.0f, -15000.25f, 3.0f, 1001), 0.0f, packing));
+	CHECK(packing.scale == packed_position_scale);
+
+	// A draw list spanning a huge canvas loses precision instead of being clamped
+	CHECK(check_round_trip(make_line(-30000.0f, 25000.0f, 197.0f, 1001), 0.5f, packing));
+	CHECK(packing.scale < packed_position_scale);
+
+	// The quads are packed like their corners
+	std::vector<ImDrawVert> corners = make_line(12345.5f, 9000.0f, 801.0f, 2);
+	ImDrawVertPacked packed[2];
+	ImDrawQuadPacked quad;
+	pack_vertices(packed, corners.data(), 2, packing);
+	pack_quad(&quad, corners[0], corners[1], packing);
+	CHECK(quad.pos[0] == packed[0].pos[0] && quad.pos[1] == packed[0].pos[1] && quad.pos[2] == packed[1].pos[0] && quad.pos[3] == packed[1].pos[1]);
+}
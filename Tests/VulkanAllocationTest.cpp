@@ -0,0 +1,223 @@
+#include "Test.h"
+
+// Counts the allocations of the Vulkan renderer once its frames reached a steady state. The heap is counted in every build
+// by replacing the global operator new, which the renderer allocates with, and by the allocator functions of ImGui's IO.
+// The debug CRT additionally reports any other malloc. Vulkan objects and memory are counted through the
+// VkAllocationCallbacks of the options. Only on Windows, as the renderer only creates Win32 surfaces.
+#ifdef _WIN32
+#include <atomic>
+#include <crtdbg.h>
+#include <malloc.h>
+#include <new>
+
+// Heap allocations are only counted on the thread, which renders, while counting is set
+static thread_local bool counting = false;
+static u64 new_allocations = 0;
+static u64 imgui_allocations = 0;
+static u64 malloc_allocations = 0;
+
+void* operator new(size_t size)
+{
+	if (counting)
+	{
+		new_allocations++;
+	}
+
+	if (void* memory = malloc(size ? size : 1))
+	{
+		return memory;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+static void* count_imgui_allocation(size_t size)
+{
+	if (counting)
+	{
+		imgui_allocations++;
+	}
+
+	return malloc(size);
+}
+
+static void free_imgui_allocation(void* memory)
+{
+	free(memory);
+}
+
+#ifdef _DEBUG
+static int count_malloc(int type, void*, size_t, int block_type, long, const unsigned char*, int)
+{
+	if (counting && (type == _HOOK_ALLOC || type == _HOOK_REALLOC) && block_type != _CRT_BLOCK)
+	{
+		malloc_allocations++;
+	}
+
+	return TRUE;
+}
+#endif
+
+// Allocations of the driver through the callbacks. Command scope allocations only last for a single call and are only reported.
+struct VulkanAllocationCounts
+{
+	std::atomic<u64> object_allocations;
+	std::atomic<u64> command_allocations;
+	std::atomic<s64> live_allocations;
+};
+
+static VKAPI_ATTR void* VKAPI_CALL counted_allocation(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	VulkanAllocationCounts& counts = *(VulkanAllocationCounts*)user_data;
+	(scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ? counts.command_allocations : counts.object_allocations)++;
+	counts.live_allocations++;
+	return _aligned_malloc(size, alignment);
+}
+
+static VKAPI_ATTR void* VKAPI_CALL counted_reallocation(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	VulkanAllocationCounts& counts = *(VulkanAllocationCounts*)user_data;
+	(scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ? counts.command_allocations : counts.object_allocations)++;
+	counts.live_allocations += (original ? 0 : 1) - (size ? 0 : 1);
+	return _aligned_realloc(original, size, alignment);
+}
+
+static VKAPI_ATTR void VKAPI_CALL counted_free(void* user_data, void* memory)
+{
+	VulkanAllocationCounts& counts = *(VulkanAllocationCounts*)user_data;
+
+	if (memory)
+	{
+		counts.live_allocations--;
+	}
+
+	_aligned_free(memory);
+}
+
+// The same window every frame, so ImGui's buffers stop growing after the first frames
+static void build_frame()
+{
+	ImGui::Begin("Allocations");
+	ImGui::Text("Every frame of this window is the same.");
+
+	for (u32 i = 0; i < 32; i++)
+	{
+		ImGui::Text("Line %u of the window", i);
+	}
+
+	ImGui::Button("Button");
+	ImGui::End();
+}
+
+TEST(vulkan_steady_state_allocations)
+{
+	HWND window = create_test_window(640, 480);
+	CHECK(window);
+
+	if (!window)
+	{
+		return;
+	}
+
+	VulkanAllocationCounts vulkan_counts;
+	vulkan_counts.object_allocations = 0;
+	vulkan_counts.command_allocations = 0;
+	vulkan_counts.live_allocations = 0;
+
+	VkAllocationCallbacks callbacks = {};
+	callbacks.pUserData = &vulkan_counts;
+	callbacks.pfnAllocation = counted_allocation;
+	callbacks.pfnReallocation = counted_reallocation;
+	callbacks.pfnFree = counted_free;
+
+	// ImGui's default allocator is malloc, so its earlier allocations can be freed by the counting functions
+	ImGuiIO& io = ImGui::GetIO();
+	void* (*previous_alloc)(size_t) = io.MemAllocFn;
+	void (*previous_free)(void*) = io.MemFreeFn;
+	io.MemAllocFn = count_imgui_allocation;
+	io.MemFreeFn = free_imgui_allocation;
+
+#ifdef _DEBUG
+	_CRT_ALLOC_HOOK previous_hook = _CrtSetAllocHook(count_malloc);
+#endif
+
+	{
+		ImGuiVulkanOptions options;
+		options.clear_value = {};
+		options.device_number = 0;
+		options.validation_layers = false;
+		options.use_precompiled_shaders = true;
+		options.allocation_callbacks = &callbacks;
+
+		ImGuiVulkanRenderer renderer;
+		bool initialized = renderer.initialize(window, GetModuleHandleW(nullptr), &options);
+		CHECK(initialized);
+
+		if (initialized)
+		{
+			const u32 warm_up_frames = 60;
+			const u32 counted_frames = 600;
+			u64 object_allocations = 0;
+			u64 command_allocations = 0;
+
+			for (u32 frame = 0; frame < warm_up_frames + counted_frames; frame++)
+			{
+				if (frame == warm_up_frames)
+				{
+					object_allocations = vulkan_counts.object_allocations;
+					command_allocations = vulkan_counts.command_allocations;
+				}
+
+				// ImGui building the window isn't counted, only the renderer and ImGui::Render calling it
+				counting = frame >= warm_up_frames;
+				renderer.new_frame();
+				counting = false;
+
+				build_frame();
+
+				counting = frame >= warm_up_frames;
+				ImGui::Render();
+				counting = false;
+			}
+
+			object_allocations = vulkan_counts.object_allocations - object_allocations;
+			command_allocations = vulkan_counts.command_allocations - command_allocations;
+			log(INFO, "%u frames: %llu operator new, %llu ImGui, %llu malloc, %llu Vulkan object and %llu command scope allocations.", counted_frames,
+				(unsigned long long)new_allocations, (unsigned long long)imgui_allocations, (unsigned long long)malloc_allocations,
+				(unsigned long long)object_allocations, (unsigned long long)command_allocations);
+
+			CHECK(new_allocations == 0);
+			CHECK(imgui_allocations == 0);
+			CHECK(malloc_allocations == 0);
+			CHECK(object_allocations == 0);
+		}
+	}
+
+	// Everything created through the callbacks was destroyed through them as well
+	CHECK(vulkan_counts.live_allocations == 0);
+
+#ifdef _DEBUG
+	_CrtSetAllocHook(previous_hook);
+#endif
+
+	io.MemAllocFn = previous_alloc;
+	io.MemFreeFn = previous_free;
+
+	DestroyWindow(window);
+}
+#endif
@@ -0,0 +1,157 @@
+#include "Test.h"
+
+// Replays a capture through the Vulkan renderer and prints the CPU time of its frames, to compare builds with and
+// without IMGUI_RENDERERS_RELEASE. Without --capture, a capture of a few busy windows is recorded first.
+#ifdef _WIN32
+#include "DrawDataCapture.h"
+
+// Headers
+#include <algorithm>
+#include <stdio.h>
+
+static const u32 window_width = 1280;
+static const u32 window_height = 720;
+
+// Windows with text, widgets and a plot, which change every frame like a live interface
+static void build_frame(u32 frame)
+{
+	float values[64];
+
+	for (u32 i = 0; i < 64; i++)
+	{
+		values[i] = (float)((frame + i * 7) % 64);
+	}
+
+	for (u32 window = 0; window < 4; window++)
+	{
+		char title[32];
+		snprintf(title, sizeof(title), "Window %u", window);
+
+		ImGui::SetNextWindowPos(ImVec2(20.0f + window * 300.0f, 20.0f + (frame % 60)));
+		ImGui::SetNextWindowSize(ImVec2(280.0f, 600.0f));
+		ImGui::Begin(title);
+
+		for (u32 line = 0; line < 40; line++)
+		{
+			ImGui::Text("Frame %u, line %u of window %u", frame, line, window);
+		}
+
+		ImGui::Button("Button");
+		ImGui::PlotLines("Plot", values, 64);
+		ImGui::End();
+	}
+}
+
+static bool initialize_renderer(ImGuiVulkanRenderer& renderer, HWND window)
+{
+	ImGuiVulkanOptions options;
+	options.clear_value = {};
+	options.device_number = 0;
+	options.validation_layers = false;
+	options.use_precompiled_shaders = true;
+
+	return renderer.initialize(window, GetModuleHandleW(nullptr), &options);
+}
+
+static bool write_capture(HWND window, const char* file_name, u32 frame_count)
+{
+	ImGuiVulkanRenderer renderer;
+
+	if (!initialize_renderer(renderer, window) || !renderer.start_capture(file_name))
+	{
+		return false;
+	}
+
+	for (u32 frame = 0; frame < frame_count; frame++)
+	{
+		renderer.new_frame();
+		build_frame(frame);
+		ImGui::Render();
+	}
+
+	renderer.stop_capture();
+
+	return true;
+}
+
+BENCHMARK(vulkan_capture_replay)
+{
+	HWND window = create_test_window(window_width, window_height);
+	CHECK(window);
+
+	if (!window)
+	{
+		return;
+	}
+
+	const char* file_name = test_option("capture");
+
+	if (!file_name)
+	{
+		file_name = "replay_benchmark.imdc";
+		CHECK(write_capture(window, file_name, 600));
+	}
+
+	ImGuiDrawDataReader reader;
+
+	if (!reader.open(file_name) || !reader.load_font_atlas(ImGui::GetIO().Fonts))
+	{
+		CHECK(!"Failed to open the capture");
+		DestroyWindow(window);
+		return;
+	}
+
+	{
+		ImGuiVulkanRenderer renderer;
+		bool initialized = initialize_renderer(renderer, window);
+		CHECK(initialized);
+
+		if (initialized)
+		{
+			// The first pass warms up the caches and the buffers, the others are measured
+			const u32 passes = 4;
+			std::vector<u64> frame_nanoseconds;
+			double start = 0;
+
+			for (u32 pass = 0; pass < passes; pass++)
+			{
+				if (pass == 1)
+				{
+					start = test_seconds();
+				}
+
+				for (u32 frame = 0; frame < reader.get_frame_count(); frame++)
+				{
+					renderer.render(reader.read_frame(frame));
+
+					if (pass > 0)
+					{
+						frame_nanoseconds.push_back(renderer.get_stats().frame_nanoseconds);
+					}
+				}
+			}
+
+			double seconds = test_seconds() - start;
+			std::sort(frame_nanoseconds.begin(), frame_nanoseconds.end());
+
+			u64 total = 0;
+
+			for (u64 nanoseconds : frame_nanoseconds)
+			{
+				total += nanoseconds;
+			}
+
+			u64 count = std::max<u64>(frame_nanoseconds.size(), 1);
+			double median = frame_nanoseconds.empty() ? 0.0 : frame_nanoseconds[count / 2] / 1000.0;
+			double slowest = frame_nanoseconds.empty() ? 0.0 : frame_nanoseconds[count * 99 / 100] / 1000.0;
+
+			log(INFO, "%s: %u frames of %s replayed %u times.", vulkan_debug_build ? "Without IMGUI_RENDERERS_RELEASE" : "With IMGUI_RENDERERS_RELEASE",
+				reader.get_frame_count(), file_name, passes - 1);
+			log(INFO, "CPU time of a frame: median %.1f us, mean %.1f us, 99th percentile %.1f us. %.1f us per frame including decoding and presenting.",
+				median, total / 1000.0 / count, slowest, seconds * 1000000.0 / count);
+		}
+	}
+
+	DestroyWindow(window);
+}
+#endif
@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+# Compiles the shaders in this directory to SPIR-V, when glslangValidator is available, and embeds the SPIR-V
+# into VulkanShaders.h/.cpp of the renderers as u32 arrays. Without glslangValidator the committed .spv files are used,
+# shaders without one are embedded empty. When spirv-val is available, every embedded module is validated for Vulkan 1.0.
+# The outputs are only rewritten when their content changes, so that builds stay incremental.
+
+import glob
+import os
+import shutil
+import struct
+import subprocess
+import sys
+
+shader_directory = os.path.dirname(os.path.abspath(__file__))
+output_directory = os.path.join(shader_directory, "..", "ImGuiRenderers", "Renderers")
+stages = { ".vert": "vertex", ".frag": "fragment" }
+
+
+# Tool id of glslang in the generator word of SPIR-V headers
+glslang_generator = 8
+
+
+def find_tool(name):
+	tool = shutil.which(name) if hasattr(shutil, "which") else None
+
+	if not tool and "VULKAN_SDK" in os.environ:
+		for directory in ("Bin", "bin"):
+			path = os.path.join(os.environ["VULKAN_SDK"], directory, name)
+
+			if os.path.exists(path) or os.path.exists(path + ".exe"):
+				tool = path
+
+	return tool
+
+
+def is_valid(validator, spirv):
+	return not validator or subprocess.call([validator, "--target-env", "vulkan1.0", spirv]) == 0
+
+
+def compile_shader(compiler, validator, source, spirv):
+	# Modules, which weren't generated by glslang, e.g. assembled by hand without the SDK, are replaced by its output
+	if os.path.exists(spirv) and os.path.getmtime(spirv) >= os.path.getmtime(source):
+		with open(spirv, "rb") as file:
+			header = file.read(12)
+
+		if len(header) == 12 and struct.unpack("<3I", header)[2] >> 16 == glslang_generator and is_valid(validator, spirv):
+			return
+
+	if subprocess.call([compiler, "-V", source, "-o", spirv]) != 0:
+		sys.exit("Failed to compile " + source)
+
+
+def array_name(source):
+	name, extension = os.path.splitext(os.path.basename(source))
+	prefix = "vulkan_" if name == "imgui" else "vulkan_" + name + "_"
+	return prefix + stages[extension]
+
+
+def write_if_changed(path, content):
+	if os.path.exists(path):
+		with open(path, "r") as file:
+			if file.read() == content:
+				return
+
+	with open(path, "w") as file:
+		file.write(content)
+
+
+def main():
+	compiler = find_tool("glslangValidator")
+	validator = find_tool("spirv-val")
+	sources = sorted(path for path in glob.glob(os.path.join(shader_directory, "*")) if os.path.splitext(path)[1] in stages)
+
+	header = [
+		"#pragma once",
+		"",
+		"// Generated by shaders/embed_shaders.py from the shaders in the shaders directory, don't edit.",
+		"",
+		"#include \"../ImGuiRenderers.h\"",
+		"",
+	]
+	source_file = [
+		"// Generated by shaders/embed_shaders.py from the shaders in the shaders directory, don't edit.",
+		"",
+		"#include \"VulkanShaders.h\"",
+	]
+
+	for source in sources:
+		spirv = source + ".spv"
+
+		if compiler:
+			compile_shader(compiler, validator, source, spirv)
+
+		name = array_name(source)
+
+		# Without SPIR-V the shader is embedded empty and the renderer leaves the features, which need it, disabled
+		if not os.path.exists(spirv):
+			sys.stderr.write("No SPIR-V for %s, it is embedded empty\n" % os.path.basename(source))
+
+			header.append("extern const u32 %s[1];" % name)
+			header.append("extern const u64 %s_size; // In bytes, 0 as the shader wasn't compiled" % name)
+
+			source_file.append("")
+			source_file.append("alignas(4) const u32 %s[1] = {};" % name)
+			source_file.append("const u64 %s_size = 0;" % name)
+			continue
+
+		if not is_valid(validator, spirv):
+			sys.exit("Invalid SPIR-V in " + spirv)
+
+		with open(spirv, "rb") as file:
+			code = file.read()
+
+		if len(code) % 4 != 0:
+			sys.exit("Invalid SPIR-V size in " + spirv)
+
+		words = struct.unpack("<%dI" % (len(code) // 4), code)
+
+		header.append("extern const u32 %s[%d];" % (name, len(words)))
+		header.append("extern const u64 %s_size; // In bytes" % name)
+
+		source_file.append("")
+		source_file.append("alignas(4) const u32 %s[%d] = {" % (name, len(words)))
+
+		for i in range(0, len(words), 8):
+			source_file.append("\t" + " ".join("0x%08X," % word for word in words[i:i + 8]))
+
+		source_file.append("};")
+		source_file.append("const u64 %s_size = sizeof(%s);" % (name, name))
+
+	write_if_changed(os.path.join(output_directory, "VulkanShaders.h"), "\n".join(header) + "\n")
+	write_if_changed(os.path.join(output_directory, "VulkanShaders.cpp"), "\n".join(source_file) + "\n")
+
+
+if __name__ == "__main__":
+	main()
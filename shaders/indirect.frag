@@ -0,0 +1,23 @@
+#version 450
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+layout(binding = 0) uniform sampler2D texture_sampler;
+
+layout(location = 0) in vec2 in_UV;
+layout(location = 1) in vec4 in_color;
+layout(location = 2) flat in vec4 in_clip_rect;
+
+layout(location = 0) out vec4 out_color;
+
+void main() 
+{
+	// Same pixels as a scissor rectangle would keep, the rectangle is in whole framebuffer pixels
+	if (gl_FragCoord.x < in_clip_rect.x || gl_FragCoord.y < in_clip_rect.y || gl_FragCoord.x >= in_clip_rect.z || gl_FragCoord.y >= in_clip_rect.w)
+	{
+		discard;
+	}
+
+	out_color = in_color * texture(texture_sampler, in_UV);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 450
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+layout (push_constant) uniform UBO {
+  mat4 projection_matrix;
+} ubo;
+
+// One instance per quad
+layout(location = 0) in vec4 in_rect;    // Top left and bottom right corner
+layout(location = 1) in vec4 in_UV_rect; // Texture coordinates of the same corners
+layout(location = 2) in vec4 in_color;
+
+layout(location = 0) out vec2 out_UV;
+layout(location = 1) out vec4 out_color;
+
+void main() 
+{
+	// The two triangles of an ImGui quad: top left, top right, bottom right and top left, bottom right, bottom left
+	const int corners[6] = int[6](0, 1, 2, 0, 2, 3);
+	int corner = corners[gl_VertexIndex];
+	vec2 weight = vec2(corner == 1 || corner == 2 ? 1.0 : 0.0, corner >= 2 ? 1.0 : 0.0);
+
+	out_UV = mix(in_UV_rect.xy, in_UV_rect.zw, weight);
+	out_color = in_color;
+	gl_Position = ubo.projection_matrix * vec4(mix(in_rect.xy, in_rect.zw, weight), 0, 1);
+	gl_Position.y = -gl_Position.y;
+}
\ No newline at end of file
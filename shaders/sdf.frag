@@ -0,0 +1,22 @@
+#version 450
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+layout(binding = 0) uniform sampler2D texture_sampler;
+
+layout(location = 0) in vec2 in_UV;
+layout(location = 1) in vec4 in_color;
+
+layout(location = 0) out vec4 out_color;
+
+void main() 
+{
+	// The alpha of the atlas is the distance to the glyph edges, 0.5 being the edge. The edge is smoothed over
+	// about a pixel on the screen, whatever the scale of the glyph.
+	float distance = texture(texture_sampler, in_UV).a;
+	float smoothing = max(fwidth(distance) * 0.5, 1.0 / 512.0);
+	float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+
+	out_color = vec4(in_color.rgb, in_color.a * coverage);
+}